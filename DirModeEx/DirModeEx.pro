@@ -22,19 +22,13 @@ DEFINES += QT_DEPRECATED_WARNINGS
 SOURCES += \
     main.cpp \
     mainwindow.cpp \
-    text_extractor.cpp \
-    csv_parser.cpp \
-    csv_lang_plugin.cpp \
-    diff_utils.cpp \
-    language_settings.cpp
+    extract_results_model.cpp
 
 HEADERS += \
     mainwindow.h \
-    text_extractor.h \
-    csv_parser.h \
-    csv_lang_plugin.h \
-    diff_utils.h \
-    language_settings.h
+    extract_results_model.h
+
+include(core.pri)
 
 FORMS += \
     mainwindow.ui
@@ -0,0 +1,19 @@
+# 基准测试目标：合成语料生成与分阶段计时，输出 JSON
+QT       = core concurrent
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+TARGET = DirModeExBench
+QMAKE_TARGET_COMPANY = TyText
+QMAKE_TARGET_PRODUCT = DirModeExBench
+QMAKE_TARGET_DESCRIPTION = DirModeEx extraction benchmark
+QMAKE_TARGET_COPYRIGHT = (c) 2025 TyText
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+SOURCES += \
+    bench_main.cpp
+
+include(core.pri)
+
+win32: LIBS += -lpsapi
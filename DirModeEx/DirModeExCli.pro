@@ -0,0 +1,21 @@
+# 命令行目标：无 Widgets，供批处理/CI 调用
+QT       = core concurrent
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+TARGET = DirModeExCli
+QMAKE_TARGET_COMPANY = TyText
+QMAKE_TARGET_PRODUCT = DirModeExCli
+QMAKE_TARGET_DESCRIPTION = DirModeEx headless command-line driver
+QMAKE_TARGET_COPYRIGHT = (c) 2025 TyText
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+SOURCES += \
+    cli_main.cpp
+
+include(core.pri)
+
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
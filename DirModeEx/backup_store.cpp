@@ -0,0 +1,309 @@
+/**
+ * @file backup_store.cpp
+ * @brief 内容寻址备份实现（Content-addressed backup store implementation）
+ *
+ * 对象路径为 objects/<哈希前两位>/<其余位>，压缩对象另加 .z 后缀；哈希始终针对原始字节。
+ * 备份保存文件的原始字节，不经解码再编码，撤销后与备份前逐字节一致。
+ */
+#include "backup_store.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <algorithm>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+#if defined(Q_OS_LINUX)
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#endif
+
+namespace
+{
+    QString objectPath(const QString &store, const QString &hash, bool compressed)
+    {
+        return QDir(store).absoluteFilePath(hash.left(2) + QLatin1Char('/') + hash.mid(2) + (compressed ? QStringLiteral(".z") : QString()));
+    }
+
+    // 目标文件与源共享数据块，不复制数据；文件系统不支持时返回 false
+    bool cloneInto(int dstFd, int srcFd)
+    {
+#if defined(Q_OS_LINUX) && defined(FICLONE)
+        return ::ioctl(dstFd, FICLONE, srcFd) == 0;
+#else
+        Q_UNUSED(dstFd);
+        Q_UNUSED(srcFd);
+        return false;
+#endif
+    }
+
+    bool hardLink(const QString &target, const QString &link)
+    {
+#if defined(Q_OS_WIN)
+        const QString t = QDir::toNativeSeparators(target);
+        const QString l = QDir::toNativeSeparators(link);
+        return CreateHardLinkW(reinterpret_cast<LPCWSTR>(l.utf16()), reinterpret_cast<LPCWSTR>(t.utf16()), nullptr) != 0;
+#else
+        return ::link(QFile::encodeName(target).constData(), QFile::encodeName(link).constData()) == 0;
+#endif
+    }
+
+    QString sha1Hex(const QByteArray &bytes)
+    {
+        return QString::fromLatin1(QCryptographicHash::hash(bytes, QCryptographicHash::Sha1).toHex());
+    }
+
+    void appendError(QString *error, const QString &msg)
+    {
+        if (!error)
+            return;
+        if (!error->isEmpty())
+            *error += QLatin1Char('\n');
+        *error += msg;
+    }
+}
+
+namespace BackupStore
+{
+
+    QString storeDir(const QString &root)
+    {
+        return QDir(root).absoluteFilePath(QStringLiteral(".csv_lang_backups/objects"));
+    }
+
+    QString manifestName()
+    {
+        return QStringLiteral("backup_manifest.json");
+    }
+
+    bool hasManifest(const QString &sessionDir)
+    {
+        return QFileInfo(QDir(sessionDir).absoluteFilePath(manifestName())).isFile();
+    }
+
+    Session::Session(const QString &root, const QString &sessionDir, const Options &options)
+        : m_root(QDir(root).absolutePath()), m_sessionDir(sessionDir), m_store(storeDir(root)), m_options(options)
+    {
+        QDir().mkpath(m_sessionDir);
+    }
+
+    Session::~Session()
+    {
+        if (!m_committed)
+            discard();
+    }
+
+    void Session::discard()
+    {
+        QMutexLocker locker(&m_lock);
+        m_entries.clear();
+        m_added.clear();
+        if (!m_committed)
+            QDir(m_sessionDir).removeRecursively(); // 只含硬链接视图，无清单即不可恢复
+    }
+
+    bool Session::add(const QString &absPath, qint64 *written)
+    {
+        if (written)
+            *written = 0;
+        const QString rel = QDir(m_root).relativeFilePath(absPath);
+        {
+            // 同一会话内重复修改的文件只保留第一次（修改前）的内容；
+            // 检查与登记在同一把锁内完成，同一路径正在复制时等待其结束，避免重复复制或提前放行改写
+            QMutexLocker locker(&m_lock);
+            while (m_inFlight.contains(rel))
+                m_settled.wait(&m_lock);
+            if (m_added.contains(rel))
+                return true;
+            m_inFlight.insert(rel);
+        }
+        // 复制失败时撤销登记，允许之后重试
+        auto release = [this, &rel]() {
+            QMutexLocker locker(&m_lock);
+            m_inFlight.remove(rel);
+            m_settled.wakeAll();
+            return false;
+        };
+        QFile src(absPath);
+        if (!src.open(QIODevice::ReadOnly))
+            return release();
+        const QByteArray bytes = src.readAll();
+        Entry entry;
+        entry.path = rel;
+        entry.blob = sha1Hex(bytes);
+        entry.size = bytes.size();
+
+        qint64 wrote = 0;
+        bool reused = true;
+        QString blobPath = objectPath(m_store, entry.blob, false);
+        if (!QFileInfo::exists(blobPath))
+        {
+            const QString zPath = objectPath(m_store, entry.blob, true);
+            if (QFileInfo::exists(zPath))
+            {
+                blobPath = zPath;
+                entry.compressed = true;
+            }
+            else
+            {
+                reused = false;
+                entry.compressed = m_options.compress;
+                blobPath = entry.compressed ? zPath : blobPath;
+                QDir().mkpath(QFileInfo(blobPath).absolutePath());
+                QSaveFile out(blobPath);
+                if (!out.open(QIODevice::WriteOnly))
+                    return release();
+                if (entry.compressed)
+                {
+                    const QByteArray packed = qCompress(bytes);
+                    out.write(packed);
+                    wrote = packed.size();
+                }
+                else if (!cloneInto(out.handle(), src.handle()))
+                {
+                    out.write(bytes);
+                    wrote = bytes.size();
+                }
+                // 并发写入同一对象时改名可能失败，对象已存在即可
+                if (!out.commit() && !QFileInfo::exists(blobPath))
+                    return release();
+                QFile::setPermissions(blobPath, QFileDevice::ReadOwner | QFileDevice::ReadGroup | QFileDevice::ReadOther);
+            }
+        }
+        src.close();
+
+        if (m_options.linkView && !entry.compressed)
+        {
+            const QString view = QDir(m_sessionDir).absoluteFilePath(rel);
+            QDir().mkpath(QFileInfo(view).absolutePath());
+            QFile::remove(view);
+            hardLink(blobPath, view); // 失败时只有清单，不影响恢复
+        }
+
+        QMutexLocker locker(&m_lock);
+        m_inFlight.remove(rel);
+        m_added.insert(rel);
+        m_settled.wakeAll();
+        m_entries.append(entry);
+        if (reused)
+            ++m_reused;
+        m_written += wrote;
+        if (written)
+            *written = wrote;
+        return true;
+    }
+
+    bool Session::commit()
+    {
+        QMutexLocker locker(&m_lock);
+        QVector<Entry> entries = m_entries;
+        std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) { return a.path < b.path; });
+        QJsonArray files;
+        for (const Entry &e : entries)
+        {
+            files.append(QJsonObject{{QStringLiteral("path"), e.path},
+                                     {QStringLiteral("blob"), e.blob},
+                                     {QStringLiteral("size"), e.size},
+                                     {QStringLiteral("compressed"), e.compressed}});
+        }
+        const QJsonObject manifest{{QStringLiteral("version"), 1},
+                                   {QStringLiteral("created"), QDateTime::currentDateTime().toString(Qt::ISODate)},
+                                   {QStringLiteral("store"), QDir(m_sessionDir).relativeFilePath(m_store)},
+                                   {QStringLiteral("bytes_written"), m_written},
+                                   {QStringLiteral("files"), files}};
+        QSaveFile f(QDir(m_sessionDir).absoluteFilePath(manifestName()));
+        if (!f.open(QIODevice::WriteOnly))
+            return false;
+        f.write(QJsonDocument(manifest).toJson(QJsonDocument::Indented));
+        if (!f.commit())
+            return false;
+        m_committed = true;
+        return true;
+    }
+
+    int Session::fileCount() const
+    {
+        QMutexLocker locker(&m_lock);
+        return m_entries.size();
+    }
+
+    int Session::reusedCount() const
+    {
+        QMutexLocker locker(&m_lock);
+        return m_reused;
+    }
+
+    qint64 Session::bytesWritten() const
+    {
+        QMutexLocker locker(&m_lock);
+        return m_written;
+    }
+
+    bool restore(const QString &sessionDir, const QString &root, QStringList *restored, QString *error)
+    {
+        QFile mf(QDir(sessionDir).absoluteFilePath(manifestName()));
+        if (!mf.open(QIODevice::ReadOnly))
+        {
+            appendError(error, QStringLiteral("缺少备份清单：%1").arg(mf.fileName()));
+            return false;
+        }
+        const QJsonObject manifest = QJsonDocument::fromJson(mf.readAll()).object();
+        const QString store = storeDir(root);
+        bool ok = true;
+        const QJsonArray files = manifest.value(QStringLiteral("files")).toArray();
+        for (const QJsonValue &v : files)
+        {
+            const QJsonObject o = v.toObject();
+            const QString rel = o.value(QStringLiteral("path")).toString();
+            const QString hash = o.value(QStringLiteral("blob")).toString();
+            const bool compressed = o.value(QStringLiteral("compressed")).toBool();
+            const QString target = QDir(root).absoluteFilePath(rel);
+
+            // 目标内容已与备份一致：不写
+            QFile cur(target);
+            if (cur.exists() && cur.size() == qint64(o.value(QStringLiteral("size")).toDouble()) && cur.open(QIODevice::ReadOnly) && sha1Hex(cur.readAll()) == hash)
+            {
+                if (restored)
+                    *restored << target;
+                continue;
+            }
+            cur.close();
+
+            QFile blob(objectPath(store, hash, compressed));
+            if (!blob.open(QIODevice::ReadOnly))
+            {
+                appendError(error, QStringLiteral("备份对象缺失：%1（%2）").arg(rel, hash));
+                ok = false;
+                continue;
+            }
+            const QByteArray bytes = compressed ? qUncompress(blob.readAll()) : blob.readAll();
+            if (sha1Hex(bytes) != hash)
+            {
+                appendError(error, QStringLiteral("备份对象校验失败：%1（%2）").arg(rel, hash));
+                ok = false;
+                continue;
+            }
+            QDir().mkpath(QFileInfo(target).absolutePath());
+            QSaveFile out(target);
+            if (!out.open(QIODevice::WriteOnly) || out.write(bytes) != bytes.size() || !out.commit())
+            {
+                appendError(error, QStringLiteral("无法写回：%1").arg(target));
+                ok = false;
+                continue;
+            }
+            if (restored)
+                *restored << target;
+        }
+        return ok;
+    }
+
+}
@@ -0,0 +1,118 @@
+/**
+ * @file backup_store.h
+ * @brief 内容寻址备份接口（Content-addressed backup store APIs）
+ *
+ * 功能名称：备份快照（Deduplicated backup snapshots）
+ * 主要用途：
+ * - CSV 导入、新增语言、英文填充的备份不再逐会话整份复制，而是按内容哈希存入项目共享对象库；
+ * - 同一内容在各会话之间只存一份：未变化的文件再次备份时不写任何数据；
+ * - 新对象优先以 reflink 克隆（Linux FICLONE，btrfs/XFS 等），不支持时写入原始字节，可选压缩；
+ * - 会话目录保留清单与指向对象的硬链接视图，仍可直接打开浏览；不支持硬链接时只有清单；
+ * - 撤销按清单从对象库恢复，校验哈希，内容未变的目标文件跳过写入；
+ *
+ * 使用示例：
+ *  BackupStore::Session backup(root, sessDir);
+ *  backup.add(path);   // 修改 path 前调用，可多线程并发
+ *  backup.commit();    // 写出清单
+ *  BackupStore::restore(sessDir, root, &restored, &err);
+ */
+#ifndef BACKUP_STORE_H
+#define BACKUP_STORE_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QMutex>
+#include <QSet>
+#include <QWaitCondition>
+
+namespace BackupStore {
+
+/** @brief 对象库目录：<项目>/.csv_lang_backups/objects（已在遍历默认排除内） */
+QString storeDir(const QString &root);
+
+/** @brief 会话目录内的清单文件名 */
+QString manifestName();
+
+/** @brief 会话目录是否含清单（无清单的旧会话为整份副本） */
+bool hasManifest(const QString &sessionDir);
+
+/**
+ * @brief 备份选项（Backup options）
+ */
+struct Options
+{
+    bool compress{false}; // 新对象以 qCompress 存储；压缩对象无法硬链接到会话视图
+    bool linkView{true};  // 在会话目录按相对路径建立硬链接视图
+};
+
+/**
+ * @class Session
+ * @brief 一次备份会话（One backup session）
+ *
+ * add() 线程安全；对象写入经临时文件原子改名，并发写入同一对象时任一成功即可。
+ * 对象写入后设为只读，避免经硬链接视图误改。
+ * 只有显式 commit() 才写出清单：操作失败时调用 discard()（或直接析构），不会留下可被“撤销”选中的空会话。
+ */
+class Session
+{
+public:
+    Session(const QString &root, const QString &sessionDir, const Options &options = Options());
+    /** @brief 未提交时丢弃会话（同 discard） */
+    ~Session();
+    Session(const Session &) = delete;
+    Session &operator=(const Session &) = delete;
+
+    /**
+     * @brief 备份一个文件的当前内容（线程安全；同一路径并发调用时后到者等待首次复制完成）
+     * @param absPath 项目内文件的绝对路径
+     * @param written 可选：本次实际写入对象库的字节数（复用或克隆时为 0）
+     * @return 读取或写入失败时返回 false
+     */
+    bool add(const QString &absPath, qint64 *written = nullptr);
+
+    /** @brief 写出清单（按路径排序）；可重复调用 */
+    bool commit();
+    /** @brief 放弃会话：清空记录；尚未提交过清单时删除会话目录（对象库中的内容寻址对象保留） */
+    void discard();
+
+    QString root() const { return m_root; }
+    QString sessionDir() const { return m_sessionDir; }
+    int fileCount() const;
+    int reusedCount() const;         // 对象库中已存在、未写入数据的文件数
+    qint64 bytesWritten() const;     // 写入对象库的总字节数
+
+private:
+    struct Entry
+    {
+        QString path;   // 相对项目根
+        QString blob;   // SHA-1 十六进制
+        qint64 size{0}; // 原始字节数
+        bool compressed{false};
+    };
+
+    QString m_root;
+    QString m_sessionDir;
+    QString m_store;
+    Options m_options;
+    mutable QMutex m_lock;
+    QVector<Entry> m_entries;
+    QSet<QString> m_added;    // 已备份的相对路径
+    QSet<QString> m_inFlight; // 正在复制的相对路径
+    QWaitCondition m_settled; // 复制结束（成功或失败）时唤醒
+    int m_reused{0};
+    qint64 m_written{0};
+    bool m_committed{false};
+};
+
+/**
+ * @brief 按会话清单恢复文件（Restore files listed in a session manifest）
+ * @param restored 输出：已恢复的目标文件（内容本已一致、跳过写入的也计入）
+ * @param error 输出：失败原因（缺少清单、对象缺失或哈希不符），多条以换行分隔
+ * @return 清单中全部文件均已恢复或无需恢复时返回 true
+ */
+bool restore(const QString &sessionDir, const QString &root, QStringList *restored, QString *error);
+
+}
+
+#endif // BACKUP_STORE_H
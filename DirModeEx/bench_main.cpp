@@ -0,0 +1,692 @@
+/**
+ * @file bench_main.cpp
+ * @brief 基准测试入口（Benchmark driver for the extraction engines）
+ *
+ * 功能名称：合成语料与分阶段计时（Synthetic corpus + per-stage timings）
+ * 主要用途：
+ * - generate：按种子确定性地生成合成 C 项目（文件数、_Tr_TEXT 密度、数组大小、GBK/UTF-8 比例、#if 嵌套深度可调）；
+ * - run：对 readTextFile / preprocess / extractBlocks / extractArrays / 并发整文件提取 / writeCsv /
+ *   Csv::parseFile / generateCFromCsv / applyTranslations（dry-run）逐阶段计时；
+ * - 结果为一个 JSON 文档：各阶段最短/中位/平均耗时、MB/s、rows/s 与阶段结束时的峰值常驻内存；
+ * - --baseline 与旧报告比对，任一阶段最短耗时超出容差即以退出码 3 结束，便于发布前在 CI 中拦截性能回退；
+ *
+ * 使用示例：
+ *  DirModeExBench generate --out D:/bench_corpus --files 2000 --gbk-ratio 0.5 --if-depth 3
+ *  DirModeExBench run --files 500 --iterations 5 --out bench.json
+ *  DirModeExBench run --root D:/proj --stages read,preprocess,extract --baseline bench.json --tolerance 0.1
+ */
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QTextCodec>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include "text_extractor.h"
+#include "block_table.h"
+#include "csv_parser.h"
+#include "csv_lang_plugin.h"
+#include "struct_layout.h"
+#include "regex_registry.h"
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+    enum ExitCode
+    {
+        ExitOk = 0,
+        ExitFailed = 1,
+        ExitUsage = 2,
+        ExitRegression = 3
+    };
+
+    int fail(ExitCode code, const QString &message)
+    {
+        const QJsonObject obj{{QStringLiteral("error"), message}, {QStringLiteral("exit_code"), int(code)}};
+        const QByteArray line = QJsonDocument(obj).toJson(QJsonDocument::Compact);
+        std::fwrite(line.constData(), 1, size_t(line.size()), stderr);
+        std::fputc('\n', stderr);
+        return code;
+    }
+
+    // 进程峰值常驻内存（字节）；无法获取时为 0
+    qint64 peakRssBytes()
+    {
+#if defined(Q_OS_WIN)
+        PROCESS_MEMORY_COUNTERS pmc;
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+            return qint64(pmc.PeakWorkingSetSize);
+        return 0;
+#else
+        struct rusage ru;
+        if (getrusage(RUSAGE_SELF, &ru) != 0)
+            return 0;
+#if defined(Q_OS_MACOS)
+        return qint64(ru.ru_maxrss); // macOS 以字节计
+#else
+        return qint64(ru.ru_maxrss) * 1024; // Linux 以 KiB 计
+#endif
+#endif
+    }
+
+    // xorshift64：跨平台、跨 Qt 版本结果一致（不依赖 qrand / QRandomGenerator 的实现）
+    struct Rng
+    {
+        quint64 s;
+        explicit Rng(quint64 seed) : s(seed * 0x9E3779B97F4A7C15ull + 0x2545F4914F6CDD1Dull) {}
+        quint32 next()
+        {
+            s ^= s << 13;
+            s ^= s >> 7;
+            s ^= s << 17;
+            return quint32(s >> 32);
+        }
+        int below(int n) { return n > 0 ? int(next() % quint32(n)) : 0; }
+        bool chance(double p) { return double(next()) < p * 4294967296.0; }
+    };
+
+    /**
+     * @brief 合成语料参数（Synthetic corpus parameters）
+     */
+    struct CorpusSpec
+    {
+        int files{200};        // 源文件数
+        int decls{40};         // 每个文件的顶层声明数
+        double density{0.7};   // 声明中 _Tr_TEXT 初始化所占比例，其余为函数与普通字符串
+        int arraySize{8};      // 结构体数组的元素数；0 表示不生成数组
+        double gbkRatio{0.3};  // 以 GBK 编码写出的文件比例，其余为 UTF-8（四分之一带 BOM）
+        int ifDepth{2};        // #if 最大嵌套深度
+        int languages{6};      // 结构体语言字段数（含 text_cn、text_en，不含 text_other）
+        quint32 seed{1};
+    };
+
+    struct CorpusInfo
+    {
+        qint64 bytes{0};
+        int gbkFiles{0};
+    };
+
+    const char *const kLangCodes[] = {"cn", "en", "vn", "ko", "tr", "ru", "pt", "es", "fa", "jp", "ar"};
+    const int kLangCount = int(sizeof(kLangCodes) / sizeof(kLangCodes[0]));
+    const char *const kWords[] = {"Start", "Stop", "Temperature", "Pressure", "Timer", "Alarm", "Confirm", "Cancel",
+                                  "Network", "Battery", "Charging", "Complete", "Failed", "Settings", "Mode", "Speed"};
+    const int kWordCount = int(sizeof(kWords) / sizeof(kWords[0]));
+
+    // 基准运行使用的宏：偶数号 FEATURE 定义，LEVEL=2；生成的条件分支约一半生效
+    QMap<QString, QString> benchDefines()
+    {
+        QMap<QString, QString> d;
+        for (int i = 0; i < 8; i += 2)
+            d.insert(QStringLiteral("FEATURE_%1").arg(i), QStringLiteral("1"));
+        d.insert(QStringLiteral("LEVEL"), QStringLiteral("2"));
+        return d;
+    }
+
+    class CorpusWriter
+    {
+    public:
+        CorpusWriter(const CorpusSpec &spec, int fileIndex)
+            : m_spec(spec), m_rng(quint64(spec.seed) * 1000003u + quint64(fileIndex)), m_file(fileIndex)
+        {
+            m_hanzi = QStringLiteral("设置温度时间开始停止确认取消错误警告模式保存加载系统参数网络连接电池充电完成失败速度压力报警定时菜单返回");
+        }
+
+        QString source()
+        {
+            m_out.clear();
+            m_out += QStringLiteral("#include \"../../include/tr_text.h\"\n\n/* 合成基准文件 %1：含 \"字符串\" 与 _Tr_TEXT 字样的注释不应被提取 */\n")
+                         .arg(m_file);
+            m_out += QStringLiteral("#define LOCAL_FLAG_%1 (%2)\n\n").arg(m_file).arg(m_rng.below(2));
+            for (int i = 0; i < m_spec.decls; ++i)
+                emitNested(i, m_rng.below(m_spec.ifDepth + 1));
+            return m_out;
+        }
+
+    private:
+        QString chinese(int minLen, int maxLen)
+        {
+            QString s;
+            const int n = minLen + m_rng.below(maxLen - minLen + 1);
+            for (int i = 0; i < n; ++i)
+                s += m_hanzi.at(m_rng.below(m_hanzi.size()));
+            return s;
+        }
+
+        // 返回 C 源码形式的字符串内容（转义已写好）
+        QString english()
+        {
+            QString s;
+            const int n = 1 + m_rng.below(4);
+            for (int i = 0; i < n; ++i)
+            {
+                if (i)
+                    s += QLatin1Char(' ');
+                s += QLatin1String(kWords[m_rng.below(kWordCount)]);
+            }
+            if (m_rng.chance(0.05))
+                s += QStringLiteral(" \\\"%1\\\"").arg(m_rng.below(100));
+            if (m_rng.chance(0.05))
+                s += QStringLiteral("\\n");
+            if (m_rng.chance(0.1))
+                s += QStringLiteral(", %1%%").arg(m_rng.below(100));
+            return s;
+        }
+
+        QString initializer(bool multiline)
+        {
+            QStringList vals;
+            vals << chinese(2, 10) << english();
+            for (int l = 2; l < m_spec.languages; ++l)
+                vals << (m_rng.chance(0.3) ? QString() : english() + QStringLiteral(" (%1)").arg(QLatin1String(kLangCodes[l])));
+            QString s = multiline ? QStringLiteral("{\n") : QStringLiteral("{ ");
+            for (int l = 0; l < vals.size(); ++l)
+            {
+                if (multiline)
+                    s += QStringLiteral("    \"%1\", // text_%2\n").arg(vals.at(l), QLatin1String(kLangCodes[l]));
+                else
+                    s += QStringLiteral("\"%1\", ").arg(vals.at(l));
+            }
+            s += multiline ? QStringLiteral("    NULL\n}") : QStringLiteral("NULL }");
+            return s;
+        }
+
+        void emitDecl(int index, const QString &suffix)
+        {
+            const QString id = QStringLiteral("%1_%2%3").arg(m_file, 4, 10, QLatin1Char('0')).arg(index, 3, 10, QLatin1Char('0')).arg(suffix);
+            if (!m_rng.chance(m_spec.density))
+            {
+                // 噪声：普通函数、局部字符串与注释
+                m_out += QStringLiteral("static int func_%1(int v)\n{\n    const char *msg = \"%2\"; /* %3 */\n    return v * %4 + (msg[0] == 'S');\n}\n\n")
+                             .arg(id, english(), chinese(1, 4))
+                             .arg(1 + m_rng.below(9));
+                return;
+            }
+            if (m_spec.arraySize > 0 && m_rng.chance(0.1))
+            {
+                m_out += QStringLiteral("const _Tr_TEXT arr_%1[] = {\n").arg(id);
+                for (int e = 0; e < m_spec.arraySize; ++e)
+                    m_out += QStringLiteral("    %1,\n").arg(initializer(false));
+                m_out += QStringLiteral("};\n\n");
+                return;
+            }
+            const bool isStatic = m_rng.chance(0.5);
+            m_out += QStringLiteral("%1const _Tr_TEXT txt_%2 = %3;\n\n")
+                         .arg(isStatic ? QStringLiteral("static ") : QString(), id, initializer(!m_rng.chance(0.2)));
+        }
+
+        void emitNested(int index, int depth)
+        {
+            if (depth <= 0)
+            {
+                emitDecl(index, QString());
+                return;
+            }
+            const int feature = m_rng.below(8);
+            switch (m_rng.below(4))
+            {
+            case 0:
+                m_out += QStringLiteral("#if defined(FEATURE_%1)\n").arg(feature);
+                break;
+            case 1:
+                m_out += QStringLiteral("#ifdef FEATURE_%1\n").arg(feature);
+                break;
+            case 2:
+                m_out += QStringLiteral("#if LEVEL >= %1 && !defined(FEATURE_%2)\n").arg(1 + m_rng.below(3)).arg(feature);
+                break;
+            default:
+                m_out += QStringLiteral("#ifndef FEATURE_%1\n").arg(feature);
+                break;
+            }
+            emitNested(index, depth - 1);
+            if (m_rng.chance(0.4))
+            {
+                m_out += QStringLiteral("#else\n");
+                emitDecl(index, QStringLiteral("_alt%1").arg(depth));
+            }
+            m_out += QStringLiteral("#endif\n");
+        }
+
+        const CorpusSpec &m_spec;
+        Rng m_rng;
+        int m_file;
+        QString m_hanzi;
+        QString m_out;
+    };
+
+    QString headerText(const CorpusSpec &spec)
+    {
+        QString h = QStringLiteral("#ifndef TR_TEXT_H\n#define TR_TEXT_H\ntypedef struct {\n");
+        for (int l = 0; l < spec.languages; ++l)
+            h += QStringLiteral("    const char *text_%1;\n").arg(QLatin1String(kLangCodes[l]));
+        h += QStringLiteral("    const char *text_other;\n} _Tr_TEXT;\n#endif\n");
+        return h;
+    }
+
+    bool writeBytes(const QString &path, const QByteArray &data, QString &error)
+    {
+        QDir().mkpath(QFileInfo(path).absolutePath());
+        QFile f(path);
+        if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate) || f.write(data) != data.size())
+        {
+            error = QStringLiteral("无法写入 %1").arg(path);
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief 生成合成语料：include/tr_text.h 与 src/mNN/fNNNN.c（每目录 64 个文件）
+     * 同一参数与种子生成的文件逐字节相同；GBK 编码器不可用时退回 UTF-8。
+     */
+    bool generateCorpus(const QString &root, const CorpusSpec &spec, CorpusInfo &info, QString &error)
+    {
+        QTextCodec *gbk = QTextCodec::codecForName("GBK");
+        if (!writeBytes(QDir(root).absoluteFilePath(QStringLiteral("include/tr_text.h")), headerText(spec).toUtf8(), error))
+            return false;
+        Rng pick(spec.seed);
+        for (int i = 0; i < spec.files; ++i)
+        {
+            const QString text = CorpusWriter(spec, i).source();
+            QByteArray data;
+            if (gbk && pick.chance(spec.gbkRatio))
+            {
+                data = gbk->fromUnicode(text);
+                ++info.gbkFiles;
+            }
+            else
+            {
+                data = text.toUtf8();
+                if (pick.chance(0.25))
+                    data.prepend("\xEF\xBB\xBF");
+            }
+            const QString path = QDir(root).absoluteFilePath(QStringLiteral("src/m%1/f%2.c").arg(i / 64, 2, 10, QLatin1Char('0')).arg(i, 4, 10, QLatin1Char('0')));
+            if (!writeBytes(path, data, error))
+                return false;
+            info.bytes += data.size();
+        }
+        return true;
+    }
+
+    CorpusSpec specFromOptions(const QCommandLineParser &p)
+    {
+        CorpusSpec s;
+        s.files = qMax(1, p.value(QStringLiteral("files")).toInt());
+        s.decls = qMax(1, p.value(QStringLiteral("decls")).toInt());
+        s.density = qBound(0.0, p.value(QStringLiteral("density")).toDouble(), 1.0);
+        s.arraySize = qMax(0, p.value(QStringLiteral("array-size")).toInt());
+        s.gbkRatio = qBound(0.0, p.value(QStringLiteral("gbk-ratio")).toDouble(), 1.0);
+        s.ifDepth = qBound(0, p.value(QStringLiteral("if-depth")).toInt(), 16);
+        s.languages = qBound(2, p.value(QStringLiteral("languages")).toInt(), kLangCount);
+        s.seed = p.value(QStringLiteral("seed")).toUInt();
+        return s;
+    }
+
+    QJsonObject specJson(const CorpusSpec &s)
+    {
+        return QJsonObject{{QStringLiteral("files"), s.files},
+                           {QStringLiteral("decls"), s.decls},
+                           {QStringLiteral("density"), s.density},
+                           {QStringLiteral("array_size"), s.arraySize},
+                           {QStringLiteral("gbk_ratio"), s.gbkRatio},
+                           {QStringLiteral("if_depth"), s.ifDepth},
+                           {QStringLiteral("languages"), s.languages},
+                           {QStringLiteral("seed"), qint64(s.seed)}};
+    }
+
+    /**
+     * @brief 单个阶段的测量结果（Per-stage measurement）
+     * bytes/rows 由阶段函数在每轮写入（各轮相同），吞吐按最短耗时计算。
+     */
+    struct Stage
+    {
+        QString name;
+        QVector<double> ms;
+        qint64 bytes{0};
+        qint64 rows{0};
+        qint64 peakRss{0};
+        qint64 regexCompiles{0}; // 首轮之后的正则编译次数；热路径不再编译时应为 0
+    };
+
+    QJsonObject stageJson(const Stage &s)
+    {
+        QVector<double> sorted = s.ms;
+        std::sort(sorted.begin(), sorted.end());
+        double sum = 0;
+        for (double v : sorted)
+            sum += v;
+        const double best = sorted.isEmpty() ? 0 : sorted.first();
+        QJsonObject o{{QStringLiteral("name"), s.name},
+                      {QStringLiteral("iterations"), sorted.size()},
+                      {QStringLiteral("min_ms"), best},
+                      {QStringLiteral("median_ms"), sorted.isEmpty() ? 0 : sorted.at(sorted.size() / 2)},
+                      {QStringLiteral("mean_ms"), sorted.isEmpty() ? 0 : sum / sorted.size()},
+                      {QStringLiteral("bytes"), s.bytes},
+                      {QStringLiteral("rows"), s.rows},
+                      {QStringLiteral("peak_rss_bytes"), s.peakRss},
+                      {QStringLiteral("regex_compiles_after_first"), s.regexCompiles}};
+        if (best > 0)
+        {
+            o.insert(QStringLiteral("mb_per_s"), double(s.bytes) / (1024.0 * 1024.0) / (best / 1000.0));
+            o.insert(QStringLiteral("rows_per_s"), double(s.rows) / (best / 1000.0));
+        }
+        return o;
+    }
+
+    struct ExtractFileFn
+    {
+        typedef BlockTable result_type;
+        QMap<QString, QString> defines;
+        QString typeName;
+        BlockTable operator()(const QString &path) const
+        {
+            return TextExtractor::extractFileTable(path, QStringLiteral("effective"), defines, typeName, false);
+        }
+    };
+
+    int runGenerate(const QCommandLineParser &p)
+    {
+        const QString out = p.value(QStringLiteral("out"));
+        if (out.isEmpty())
+            return fail(ExitUsage, QStringLiteral("generate: 缺少 --out 目录"));
+        if (QDir(out).exists() && !QDir(out).isEmpty())
+            return fail(ExitUsage, QStringLiteral("generate: 目标目录非空：%1").arg(out));
+        const CorpusSpec spec = specFromOptions(p);
+        CorpusInfo info;
+        QString err;
+        if (!generateCorpus(out, spec, info, err))
+            return fail(ExitFailed, err);
+        const QJsonObject res{{QStringLiteral("root"), QDir(out).absolutePath()},
+                              {QStringLiteral("spec"), specJson(spec)},
+                              {QStringLiteral("bytes"), info.bytes},
+                              {QStringLiteral("gbk_files"), info.gbkFiles}};
+        std::fputs(QJsonDocument(res).toJson(QJsonDocument::Indented).constData(), stdout);
+        return ExitOk;
+    }
+
+    int runBench(const QCommandLineParser &p)
+    {
+        const int iterations = qMax(1, p.value(QStringLiteral("iterations")).toInt());
+        const QString typeName = p.value(QStringLiteral("type"));
+        if (p.isSet(QStringLiteral("threads")))
+            QThreadPool::globalInstance()->setMaxThreadCount(qMax(1, p.value(QStringLiteral("threads")).toInt()));
+
+        QTemporaryDir work;
+        if (!work.isValid())
+            return fail(ExitFailed, QStringLiteral("无法创建临时目录"));
+        QJsonObject corpus;
+        QString root = p.value(QStringLiteral("root"));
+        QStringList files;
+        qint64 corpusBytes = 0;
+        if (root.isEmpty())
+        {
+            const CorpusSpec spec = specFromOptions(p);
+            root = QDir(work.path()).absoluteFilePath(QStringLiteral("corpus"));
+            CorpusInfo info;
+            QString err;
+            if (!generateCorpus(root, spec, info, err))
+                return fail(ExitFailed, err);
+            corpus.insert(QStringLiteral("generated"), true);
+            corpus.insert(QStringLiteral("spec"), specJson(spec));
+            corpus.insert(QStringLiteral("gbk_files"), info.gbkFiles);
+        }
+        else if (!QDir(root).exists())
+        {
+            return fail(ExitUsage, QStringLiteral("run: --root 必须为存在的目录"));
+        }
+        files = TextExtractor::collectSourceFiles(root, QStringList{QStringLiteral(".h"), QStringLiteral(".c")});
+        if (files.isEmpty())
+            return fail(ExitFailed, QStringLiteral("未找到源文件：%1").arg(root));
+        for (const QString &f : files)
+            corpusBytes += QFileInfo(f).size();
+        corpus.insert(QStringLiteral("root"), root);
+        corpus.insert(QStringLiteral("files"), files.size());
+        corpus.insert(QStringLiteral("bytes"), corpusBytes);
+
+        const QMap<QString, QString> defines = benchDefines();
+        const QStringList langCols = TextExtractor::discoverLanguageColumns(root, QStringList{QStringLiteral(".h"), QStringLiteral(".c")}, typeName);
+        const QString csvPath = QDir(work.path()).absoluteFilePath(QStringLiteral("bench.csv"));
+        // 布局模式文件与 CSV 同目录：generate 阶段不再扫描项目
+        QString schemaErr;
+        StructLayout::writeSchema(StructLayout::defaultSchemaPath(work.path()), typeName, langCols, schemaErr);
+
+        QVector<QString> texts(files.size());
+        QVector<QString> preprocessed(files.size());
+        QList<ExtractedBlock> rows;
+
+        // 阶段按依赖顺序排列；未选中的前置阶段在后续阶段需要时不计时地运行一次
+        struct Step
+        {
+            QString name;
+            std::function<void(Stage &)> fn;
+        };
+        const QVector<Step> steps{
+            {QStringLiteral("read"), [&](Stage &s) {
+                 for (int i = 0; i < files.size(); ++i)
+                     texts[i] = TextExtractor::readTextFile(files.at(i));
+                 s.bytes = corpusBytes;
+                 s.rows = files.size();
+             }},
+            {QStringLiteral("preprocess"), [&](Stage &s) {
+                 for (int i = 0; i < texts.size(); ++i)
+                     preprocessed[i] = TextExtractor::preprocess(texts.at(i), defines);
+                 s.bytes = corpusBytes;
+                 s.rows = files.size();
+             }},
+            {QStringLiteral("extract"), [&](Stage &s) {
+                 rows.clear();
+                 for (int i = 0; i < preprocessed.size(); ++i)
+                     rows += TextExtractor::extractBlocks(preprocessed.at(i), files.at(i), typeName, false);
+                 s.bytes = corpusBytes;
+                 s.rows = rows.size();
+             }},
+            {QStringLiteral("extract_arrays"), [&](Stage &s) {
+                 qint64 n = 0;
+                 for (int i = 0; i < preprocessed.size(); ++i)
+                     n += TextExtractor::extractArrays(preprocessed.at(i), files.at(i), typeName, false).size();
+                 s.bytes = corpusBytes;
+                 s.rows = n;
+             }},
+            {QStringLiteral("extract_parallel"), [&](Stage &s) {
+                 // 读取、预处理、提取整条流水线，按文件并发（与界面/命令行提取一致）
+                 const QList<BlockTable> perFile = QtConcurrent::blockingMapped<QList<BlockTable>>(files, ExtractFileFn{defines, typeName});
+                 qint64 n = 0;
+                 for (const BlockTable &b : perFile)
+                     n += b.size();
+                 s.bytes = corpusBytes;
+                 s.rows = n;
+             }},
+            {QStringLiteral("csv_write"), [&](Stage &s) {
+                 TextExtractor::writeCsv(csvPath, rows, langCols, langCols, true);
+                 s.bytes = QFileInfo(csvPath).size();
+                 s.rows = rows.size();
+             }},
+            {QStringLiteral("csv_parse"), [&](Stage &s) {
+                 QString err;
+                 s.rows = Csv::parseFile(csvPath, err).size();
+                 s.bytes = QFileInfo(csvPath).size();
+             }},
+            {QStringLiteral("generate"), [&](Stage &s) {
+                 const QString cOut = QDir(work.path()).absoluteFilePath(QStringLiteral("bench_gen.c"));
+                 TextExtractor::GenerateStats gen;
+                 TextExtractor::generateCFromCsv(csvPath, typeName, cOut, QDir(work.path()).absoluteFilePath(QStringLiteral("bench_gen.h")),
+                                                 false, true, QStringLiteral("g_all_texts"), false, true, true, true, langCols, QStringLiteral("indices"), 1,
+                                                 QMap<QString, QPair<QString, QString>>(), QString(), QString(), QString(), QString(), &gen);
+                 s.bytes = QFileInfo(csvPath).size();
+                 s.rows = gen.rows;
+             }},
+            {QStringLiteral("apply"), [&](Stage &s) {
+                 // dry-run 不改动源文件；完整性报告仍写入 <root>/logs
+                 QJsonObject cfg;
+                 QJsonObject map;
+                 for (int i = 0; i < langCols.size(); ++i)
+                     map[langCols.at(i).startsWith(QLatin1String("text_")) ? langCols.at(i).mid(5) : langCols.at(i)] = i;
+                 cfg[QStringLiteral("column_mapping")] = map;
+                 cfg[QStringLiteral("dry_run")] = true;
+                 cfg[QStringLiteral("strict_line_only")] = false;
+                 cfg[QStringLiteral("line_window")] = 10000;
+                 cfg[QStringLiteral("ignore_variable_name")] = true;
+                 cfg[QStringLiteral("disable_backups")] = true;
+                 cfg[QStringLiteral("log_path")] = QDir(work.path()).absoluteFilePath(QStringLiteral("apply.log"));
+                 cfg[QStringLiteral("diff_path")] = QDir(work.path()).absoluteFilePath(QStringLiteral("apply.diff"));
+                 const CsvProcessStats stats = CsvLangPlugin::applyTranslations(root, csvPath, cfg);
+                 s.bytes = corpusBytes;
+                 s.rows = stats.successCount;
+             }},
+        };
+
+        QStringList wanted;
+        for (const QString &name : p.value(QStringLiteral("stages")).split(QLatin1Char(','), Qt::SkipEmptyParts))
+            wanted << name.trimmed();
+        for (const QString &name : wanted)
+        {
+            if (std::none_of(steps.begin(), steps.end(), [&](const Step &st) { return st.name == name; }))
+                return fail(ExitUsage, QStringLiteral("run: 未知阶段 %1").arg(name));
+        }
+        int lastWanted = -1;
+        for (int i = 0; i < steps.size(); ++i)
+            if (wanted.isEmpty() || wanted.contains(steps.at(i).name))
+                lastWanted = i;
+
+        QJsonArray stages;
+        QList<Stage> measured;
+        for (int i = 0; i <= lastWanted; ++i)
+        {
+            Stage s;
+            s.name = steps.at(i).name;
+            if (!wanted.isEmpty() && !wanted.contains(s.name))
+            {
+                steps.at(i).fn(s);
+                continue;
+            }
+            qint64 compilesAfterFirst = 0;
+            for (int it = 0; it < iterations; ++it)
+            {
+                QElapsedTimer t;
+                t.start();
+                steps.at(i).fn(s);
+                s.ms << double(t.nsecsElapsed()) / 1e6;
+                if (it == 0)
+                    compilesAfterFirst = RegexRegistry::stats().compiles;
+            }
+            s.regexCompiles = RegexRegistry::stats().compiles - compilesAfterFirst;
+            s.peakRss = peakRssBytes();
+            measured << s;
+        }
+
+        // 与基准报告比对：按最短耗时，超出 (1 + tolerance) 倍记为回退
+        QHash<QString, double> baseline;
+        if (p.isSet(QStringLiteral("baseline")))
+        {
+            QFile f(p.value(QStringLiteral("baseline")));
+            if (!f.open(QIODevice::ReadOnly))
+                return fail(ExitUsage, QStringLiteral("run: 无法读取基准报告 %1").arg(f.fileName()));
+            for (const QJsonValue &v : QJsonDocument::fromJson(f.readAll()).object().value(QStringLiteral("stages")).toArray())
+            {
+                const QJsonObject o = v.toObject();
+                baseline.insert(o.value(QStringLiteral("name")).toString(), o.value(QStringLiteral("min_ms")).toDouble());
+            }
+        }
+        const double tolerance = qMax(0.0, p.value(QStringLiteral("tolerance")).toDouble());
+        QStringList regressions;
+        for (const Stage &s : measured)
+        {
+            QJsonObject o = stageJson(s);
+            const double base = baseline.value(s.name);
+            if (base > 0)
+            {
+                const bool slower = o.value(QStringLiteral("min_ms")).toDouble() > base * (1.0 + tolerance);
+                o.insert(QStringLiteral("baseline_min_ms"), base);
+                o.insert(QStringLiteral("regression"), slower);
+                if (slower)
+                    regressions << s.name;
+            }
+            stages.append(o);
+        }
+
+        QJsonObject report{{QStringLiteral("benchmark"), QStringLiteral("DirModeExBench")},
+                           {QStringLiteral("qt"), QLatin1String(qVersion())},
+                           {QStringLiteral("threads"), QThreadPool::globalInstance()->maxThreadCount()},
+                           {QStringLiteral("iterations"), iterations},
+                           {QStringLiteral("corpus"), corpus},
+                           {QStringLiteral("stages"), stages},
+                           {QStringLiteral("peak_rss_bytes"), peakRssBytes()}};
+        const RegexRegistry::Stats rx = RegexRegistry::stats();
+        report.insert(QStringLiteral("regex"), QJsonObject{{QStringLiteral("patterns"), rx.patterns},
+                                                           {QStringLiteral("compiles"), rx.compiles},
+                                                           {QStringLiteral("lookups"), rx.lookups}});
+        if (!baseline.isEmpty())
+        {
+            report.insert(QStringLiteral("tolerance"), tolerance);
+            report.insert(QStringLiteral("regressions"), QJsonArray::fromStringList(regressions));
+        }
+        const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+        std::fwrite(json.constData(), 1, size_t(json.size()), stdout);
+        if (p.isSet(QStringLiteral("out")))
+        {
+            QString err;
+            if (!writeBytes(p.value(QStringLiteral("out")), json, err))
+                return fail(ExitFailed, err);
+        }
+        if (p.isSet(QStringLiteral("keep")) && corpus.value(QStringLiteral("generated")).toBool())
+            work.setAutoRemove(false);
+        return regressions.isEmpty() ? ExitOk : ExitRegression;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("DirModeExBench"));
+
+    QCommandLineParser p;
+    p.setApplicationDescription(QStringLiteral("DirModeEx benchmark: generate | run"));
+    p.addHelpOption();
+    p.addPositionalArgument(QStringLiteral("command"), QStringLiteral("generate | run"));
+    p.addOptions({
+        {QStringLiteral("out"), QStringLiteral("generate 输出目录；run 另存 JSON 报告的路径"), QStringLiteral("path")},
+        {{QStringLiteral("r"), QStringLiteral("root")}, QStringLiteral("run 使用的现有项目（省略时按语料参数在临时目录生成）"), QStringLiteral("dir")},
+        {QStringLiteral("files"), QStringLiteral("语料文件数"), QStringLiteral("n"), QStringLiteral("200")},
+        {QStringLiteral("decls"), QStringLiteral("每文件声明数"), QStringLiteral("n"), QStringLiteral("40")},
+        {QStringLiteral("density"), QStringLiteral("_Tr_TEXT 声明比例（0-1）"), QStringLiteral("ratio"), QStringLiteral("0.7")},
+        {QStringLiteral("array-size"), QStringLiteral("结构体数组元素数（0 不生成数组）"), QStringLiteral("n"), QStringLiteral("8")},
+        {QStringLiteral("gbk-ratio"), QStringLiteral("GBK 编码文件比例（0-1）"), QStringLiteral("ratio"), QStringLiteral("0.3")},
+        {QStringLiteral("if-depth"), QStringLiteral("#if 最大嵌套深度"), QStringLiteral("n"), QStringLiteral("2")},
+        {QStringLiteral("languages"), QStringLiteral("语言字段数（2-11）"), QStringLiteral("n"), QStringLiteral("6")},
+        {QStringLiteral("seed"), QStringLiteral("随机种子"), QStringLiteral("n"), QStringLiteral("1")},
+        {QStringLiteral("type"), QStringLiteral("结构体类型名"), QStringLiteral("name"), QStringLiteral("_Tr_TEXT")},
+        {QStringLiteral("iterations"), QStringLiteral("每阶段重复次数"), QStringLiteral("n"), QStringLiteral("3")},
+        {QStringLiteral("stages"), QStringLiteral("只测这些阶段，逗号分隔（read,preprocess,extract,extract_arrays,extract_parallel,csv_write,csv_parse,generate,apply）"), QStringLiteral("list")},
+        {QStringLiteral("threads"), QStringLiteral("extract_parallel 并发线程数"), QStringLiteral("n")},
+        {QStringLiteral("baseline"), QStringLiteral("与之比对的旧 JSON 报告"), QStringLiteral("file")},
+        {QStringLiteral("tolerance"), QStringLiteral("允许的最短耗时增幅（0.1 即 10%）"), QStringLiteral("ratio"), QStringLiteral("0.1")},
+        {QStringLiteral("keep"), QStringLiteral("保留 run 生成的临时语料与输出")},
+    });
+    if (!p.parse(QCoreApplication::arguments()))
+        return fail(ExitUsage, p.errorText());
+    if (p.isSet(QStringLiteral("help")))
+    {
+        std::fputs(qPrintable(p.helpText()), stdout);
+        return ExitOk;
+    }
+    const QString command = p.positionalArguments().value(0);
+    if (command == QLatin1String("generate"))
+        return runGenerate(p);
+    if (command == QLatin1String("run"))
+        return runBench(p);
+    return fail(ExitUsage, command.isEmpty() ? QStringLiteral("缺少子命令（generate | run）") : QStringLiteral("未知子命令：%1").arg(command));
+}
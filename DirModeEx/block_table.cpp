@@ -0,0 +1,130 @@
+/**
+ * @file block_table.cpp
+ * @brief 列式提取结果容器实现（Columnar extracted-block storage implementation）
+ *
+ * 字段连续编号，第 f 个字段占字符区 [ends[f-1], ends[f])；块行只记首字段下标，
+ * 因此排序与归约只移动定长行和偏移，不复制任何字符串。
+ */
+#include "block_table.h"
+#include <algorithm>
+
+void BlockTable::clear()
+{
+    m_arena.clear();
+    m_ends.clear();
+    m_rows.clear();
+    m_files.clear();
+    m_fileIndex.clear();
+}
+
+void BlockTable::reserve(int blocks, int chars)
+{
+    m_rows.reserve(blocks);
+    m_arena.reserve(chars);
+}
+
+int BlockTable::internFile(const QString &path)
+{
+    auto it = m_fileIndex.constFind(path);
+    if (it != m_fileIndex.constEnd())
+        return it.value();
+    const int idx = m_files.size();
+    m_files.append(path);
+    m_fileIndex.insert(path, idx);
+    return idx;
+}
+
+void BlockTable::beginBlock(int file, int line, const QStringRef &variableName)
+{
+    m_arena.append(variableName);
+    m_rows.append({qint32(file), qint32(line), quint32(m_ends.size()), 0});
+    m_ends.append(quint32(m_arena.size()));
+}
+
+void BlockTable::endString()
+{
+    m_ends.append(quint32(m_arena.size()));
+    ++m_rows.last().count;
+}
+
+void BlockTable::appendString(const QStringRef &s)
+{
+    m_arena.append(s);
+    endString();
+}
+
+void BlockTable::append(const ExtractedBlock &b)
+{
+    beginBlock(internFile(b.sourceFile), b.lineNumber, b.variableName);
+    for (const QString &s : b.strings)
+        appendString(QStringRef(&s));
+}
+
+void BlockTable::append(const BlockTable &other)
+{
+    if (other.isEmpty())
+        return;
+    if (isEmpty() && m_files.isEmpty())
+    {
+        *this = other;
+        return;
+    }
+    // 文件下标重新登记；字段偏移整体平移到本表字符区末尾
+    QVector<int> fileMap(other.m_files.size());
+    for (int i = 0; i < other.m_files.size(); ++i)
+        fileMap[i] = internFile(other.m_files.at(i));
+    const quint32 charBase = quint32(m_arena.size());
+    const quint32 fieldBase = quint32(m_ends.size());
+    m_arena.append(other.m_arena);
+    m_ends.reserve(m_ends.size() + other.m_ends.size());
+    for (quint32 e : other.m_ends)
+        m_ends.append(e + charBase);
+    m_rows.reserve(m_rows.size() + other.m_rows.size());
+    for (const Row &r : other.m_rows)
+        m_rows.append({qint32(fileMap.at(r.file)), r.line, r.first + fieldBase, r.count});
+}
+
+ExtractedBlock BlockTable::block(int i) const
+{
+    const Row &r = m_rows.at(i);
+    ExtractedBlock b;
+    b.variableName = field(int(r.first)).toString();
+    b.strings.reserve(int(r.count));
+    for (quint32 s = 0; s < r.count; ++s)
+        b.strings.append(field(int(r.first + 1 + s)).toString());
+    b.sourceFile = m_files.at(r.file); // 隐式共享，不复制路径
+    b.lineNumber = r.line;
+    return b;
+}
+
+QList<ExtractedBlock> BlockTable::toList() const
+{
+    QList<ExtractedBlock> out;
+    out.reserve(m_rows.size());
+    for (int i = 0; i < m_rows.size(); ++i)
+        out.append(block(i));
+    return out;
+}
+
+BlockTable BlockTable::fromList(const QList<ExtractedBlock> &blocks)
+{
+    BlockTable t;
+    t.m_rows.reserve(blocks.size());
+    for (const ExtractedBlock &b : blocks)
+        t.append(b);
+    return t;
+}
+
+void BlockTable::sortByLine()
+{
+    std::stable_sort(m_rows.begin(), m_rows.end(), [](const Row &a, const Row &b)
+                     { return a.line < b.line; });
+}
+
+qint64 BlockTable::memoryBytes() const
+{
+    qint64 n = qint64(m_arena.capacity()) * 2 + qint64(m_ends.capacity()) * 4 + qint64(m_rows.capacity()) * qint64(sizeof(Row));
+    for (const QString &f : m_files)
+        n += qint64(f.capacity()) * 2;
+    return n;
+}
@@ -0,0 +1,107 @@
+/**
+ * @file block_table.h
+ * @brief 列式提取结果容器接口（Columnar extracted-block storage APIs）
+ *
+ * 功能名称：块表（Arena-backed ExtractedBlock table）
+ * 主要用途：
+ * - 提取时把变量名与各语言字符串连续追加到一块 UTF-16 字符区，每个字段只记一个 u32 结束偏移；
+ * - 源文件路径按下标去重，块本身只是 {文件, 行号, 首字段, 字符串数} 的定长行；
+ * - 逐文件提取、缓存命中、目录归约与 CSV 流式写出都在该结构上进行，仅在预览与结果表处转换为 ExtractedBlock；
+ *
+ * 使用示例：
+ *  BlockTable t;
+ *  const int file = t.internFile(path);
+ *  t.beginBlock(file, line, name);
+ *  t.arena().append(decoded);         // 解码器可直接向字符区追加
+ *  t.endString();
+ *  const QList<ExtractedBlock> rows = t.toList();
+ */
+#ifndef BLOCK_TABLE_H
+#define BLOCK_TABLE_H
+
+#include <QString>
+#include <QStringList>
+#include <QStringRef>
+#include <QHash>
+#include <QVector>
+#include <QList>
+#include "text_extractor.h"
+
+/**
+ * @class BlockTable
+ * @brief 只增的块表；写入须按 beginBlock → (arena 追加 + endString)* 顺序进行
+ */
+class BlockTable
+{
+public:
+    int size() const { return m_rows.size(); }
+    bool isEmpty() const { return m_rows.isEmpty(); }
+    void clear();
+    /** @brief 预留块数与字符数（Reserve rows and arena characters） */
+    void reserve(int blocks, int chars);
+
+    /** @brief 登记源文件路径，返回其下标；相同路径只存一份 */
+    int internFile(const QString &path);
+
+    /** @brief 开始一个新块：写入变量名字段，其后追加的字段均为该块的字符串 */
+    void beginBlock(int file, int line, const QStringRef &variableName);
+    void beginBlock(int file, int line, const QString &variableName) { beginBlock(file, line, QStringRef(&variableName)); }
+    /** @brief 字符区：解码器直接向末尾追加当前字符串的内容 */
+    QString &arena() { return m_arena; }
+    /** @brief 以字符区当前末尾结束一个字符串字段 */
+    void endString();
+    /** @brief 追加一个完整字符串字段 */
+    void appendString(const QStringRef &s);
+
+    /** @brief 改写块的文件与行号（反序列化时位置信息在字符串之后） */
+    void setLocation(int i, int file, int line)
+    {
+        m_rows[i].file = qint32(file);
+        m_rows[i].line = qint32(line);
+    }
+
+    /** @brief 追加一个 ExtractedBlock（Convert in from the list API） */
+    void append(const ExtractedBlock &b);
+    /** @brief 追加另一张表的全部块（归约用；文件下标重新登记） */
+    void append(const BlockTable &other);
+
+    QStringRef variableName(int i) const { return field(m_rows.at(i).first); }
+    int stringCount(int i) const { return m_rows.at(i).count; }
+    QStringRef string(int i, int s) const { return field(m_rows.at(i).first + 1 + s); }
+    const QString &sourceFile(int i) const { return m_files.at(m_rows.at(i).file); }
+    int lineNumber(int i) const { return m_rows.at(i).line; }
+
+    /** @brief 生成单个块（Materialise one block） */
+    ExtractedBlock block(int i) const;
+    /** @brief 转为列表 API（Convert out at the boundary） */
+    QList<ExtractedBlock> toList() const;
+    static BlockTable fromList(const QList<ExtractedBlock> &blocks);
+
+    /** @brief 按行号稳定排序（只重排行，字段不动） */
+    void sortByLine();
+    /** @brief 存储占用的近似字节数 */
+    qint64 memoryBytes() const;
+
+private:
+    struct Row
+    {
+        qint32 file;
+        qint32 line;
+        quint32 first; // 变量名字段下标，字符串紧随其后
+        quint32 count; // 字符串个数
+    };
+
+    QStringRef field(int f) const
+    {
+        const int begin = f == 0 ? 0 : int(m_ends.at(f - 1));
+        return m_arena.midRef(begin, int(m_ends.at(f)) - begin);
+    }
+
+    QString m_arena;
+    QVector<quint32> m_ends; // 各字段在字符区中的结束偏移
+    QVector<Row> m_rows;
+    QStringList m_files;
+    QHash<QString, int> m_fileIndex;
+};
+
+#endif // BLOCK_TABLE_H
@@ -0,0 +1,161 @@
+/**
+ * @file c_escape.h
+ * @brief C 转义序列解码接口（Shared C escape-sequence scanner）
+ *
+ * 功能名称：统一的转义扫描（One escape scanner for literals, CSV cells and the string pool）
+ * 主要用途：
+ * - 查表识别十六进制位与单字符转义，普通字符成段交给调用方，不逐字符处理；
+ * - 提取解码（LiteralDecoder）、CSV 单元格解码与字符串池字节解码共用同一套规则，结果互相一致；
+ * - CLiteral 规则：\x 读取其后全部十六进制位取低 8 位，八进制最多 3 位，\u/\U 为码点，
+ *   无数字的 \x 与未知转义按原文保留（含反斜杠）；
+ * - CsvCell 规则（CSV 历史行为）：只识别恰好两位的 \xHH 与 \n \r \t \\ \" \'，其余一律按原文保留；
+ *
+ * 使用示例：
+ *  struct Sink { void text(const QChar *p, int n); void byte(char b); void codePoint(uint v); } sink;
+ *  CEscape::decode(body.unicode(), body.size(), CEscape::Rules::CLiteral, sink);
+ */
+#ifndef C_ESCAPE_H
+#define C_ESCAPE_H
+
+#include <QChar>
+
+namespace CEscape {
+
+enum class Rules
+{
+    CLiteral, // C 字面量规则
+    CsvCell   // CSV 单元格规则（仅 \xHH 与常用单字符转义）
+};
+
+// 转义查表：十六进制字符值（非十六进制为 -1）与单字符转义目标（0 表示不识别）
+struct Tables
+{
+    qint8 hex[128];
+    char simple[128]; // CLiteral
+    char csv[128];    // CsvCell
+};
+
+constexpr Tables makeTables()
+{
+    Tables t{};
+    for (int i = 0; i < 128; ++i)
+        t.hex[i] = -1;
+    for (int i = 0; i < 10; ++i)
+        t.hex['0' + i] = qint8(i);
+    for (int i = 0; i < 6; ++i)
+    {
+        t.hex['a' + i] = qint8(10 + i);
+        t.hex['A' + i] = qint8(10 + i);
+    }
+    t.csv['n'] = t.simple['n'] = '\n';
+    t.csv['r'] = t.simple['r'] = '\r';
+    t.csv['t'] = t.simple['t'] = '\t';
+    t.csv['\\'] = t.simple['\\'] = '\\';
+    t.csv['"'] = t.simple['"'] = '"';
+    t.csv['\''] = t.simple['\''] = '\'';
+    t.simple['a'] = '\a';
+    t.simple['b'] = '\b';
+    t.simple['f'] = '\f';
+    t.simple['v'] = '\v';
+    t.simple['?'] = '?';
+    return t;
+}
+
+constexpr Tables kTables = makeTables();
+
+inline int hexDigit(QChar c)
+{
+    const ushort u = c.unicode();
+    return u < 128 ? kTables.hex[u] : -1;
+}
+
+/**
+ * @brief 解码不带引号的字面量正文
+ * @param p 正文起始
+ * @param n 正文长度
+ * @param rules 转义规则
+ * @param sink 回调：text(p, n) 原文片段、byte(b) 转义得到的单字节、codePoint(v) \u/\U 码点
+ */
+template <typename Sink>
+void decode(const QChar *p, int n, Rules rules, Sink &sink)
+{
+    const bool csv = rules == Rules::CsvCell;
+    int i = 0;
+    while (i < n)
+    {
+        int j = i;
+        while (j < n && p[j] != QLatin1Char('\\'))
+            ++j;
+        if (j > i)
+        {
+            sink.text(p + i, j - i);
+            i = j;
+            continue;
+        }
+        if (i + 1 >= n)
+        {
+            // 末尾孤立的反斜杠按原字符保留
+            sink.text(p + i, 1);
+            break;
+        }
+        const ushort e = p[i + 1].unicode();
+        if (e == 'x')
+        {
+            uint v = 0;
+            int k = i + 2;
+            const int limit = csv ? qMin(n, i + 4) : n;
+            for (int d; k < limit && (d = hexDigit(p[k])) >= 0; ++k)
+                v = (v << 4) | uint(d);
+            if (csv ? k == i + 4 : k > i + 2)
+            {
+                sink.byte(char(v & 0xFF));
+                i = k;
+                continue;
+            }
+            // 无（CSV：不足两位）十六进制数字：按原文保留
+        }
+        else if (!csv && e >= '0' && e <= '7')
+        {
+            uint v = 0;
+            int k = i + 1;
+            for (; k < n && k < i + 4 && p[k] >= QLatin1Char('0') && p[k] <= QLatin1Char('7'); ++k)
+                v = (v << 3) | uint(p[k].unicode() - '0');
+            sink.byte(char(v & 0xFF));
+            i = k;
+            continue;
+        }
+        else if (!csv && (e == 'u' || e == 'U'))
+        {
+            const int digits = e == 'u' ? 4 : 8;
+            uint v = 0;
+            int k = i + 2;
+            for (int d; k < n && k < i + 2 + digits && (d = hexDigit(p[k])) >= 0; ++k)
+                v = (v << 4) | uint(d);
+            if (k == i + 2 + digits)
+            {
+                sink.codePoint(v);
+                i = k;
+                continue;
+            }
+            // 位数不足：按未知转义处理
+        }
+        else if (e < 128)
+        {
+            const char simple = csv ? kTables.csv[e] : kTables.simple[e];
+            if (simple)
+            {
+                const QChar c = QLatin1Char(simple);
+                sink.text(&c, 1);
+                i += 2;
+                continue;
+            }
+        }
+        // 未知转义：保留反斜杠与字符
+        sink.text(p + i, 2);
+        i += 2;
+    }
+}
+
+}
+
+#endif // C_ESCAPE_H
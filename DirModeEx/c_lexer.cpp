@@ -0,0 +1,379 @@
+/**
+ * @file c_lexer.cpp
+ * @brief 轻量 C 词法分析实现（Single-pass C tokenizer implementation）
+ *
+ * 算法：逐字符线性扫描，维护行号；注释直接跳过，字符串/字符字面量整体作为一个 token，
+ * 因此字面量内的花括号、分号与 // 不会干扰后续的声明定位。
+ */
+#include "c_lexer.h"
+
+namespace CLexer
+{
+
+    static inline bool isIdentStart(ushort c)
+    {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+    }
+
+    static inline bool isIdentChar(ushort c)
+    {
+        return isIdentStart(c) || (c >= '0' && c <= '9');
+    }
+
+    QVector<Token> tokenize(const QString &text)
+    {
+        QVector<Token> out;
+        out.reserve(text.size() / 4);
+        const QChar *d = text.constData();
+        const int n = text.size();
+        int line = 1;
+        int i = 0;
+        while (i < n)
+        {
+            const ushort c = d[i].unicode();
+            if (c == '\n')
+            {
+                ++line;
+                ++i;
+                continue;
+            }
+            if (c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v')
+            {
+                ++i;
+                continue;
+            }
+            // 注释：行注释到行尾，块注释到 */（仅累计行号）
+            if (c == '/' && i + 1 < n)
+            {
+                const ushort c2 = d[i + 1].unicode();
+                if (c2 == '/')
+                {
+                    i += 2;
+                    while (i < n && d[i].unicode() != '\n')
+                        ++i;
+                    continue;
+                }
+                if (c2 == '*')
+                {
+                    i += 2;
+                    while (i < n && !(d[i].unicode() == '*' && i + 1 < n && d[i + 1].unicode() == '/'))
+                    {
+                        if (d[i].unicode() == '\n')
+                            ++line;
+                        ++i;
+                    }
+                    i = qMin(n, i + 2);
+                    continue;
+                }
+            }
+            Token t;
+            t.start = i;
+            t.line = line;
+            if (c == '"' || c == '\'')
+            {
+                // 字面量：处理反斜杠转义；未闭合时截止到行尾，避免吞掉后续代码
+                t.kind = (c == '"') ? TokenKind::String : TokenKind::Char;
+                ++i;
+                while (i < n)
+                {
+                    const ushort x = d[i].unicode();
+                    if (x == '\\' && i + 1 < n)
+                    {
+                        if (d[i + 1].unicode() == '\n')
+                            ++line;
+                        i += 2;
+                        continue;
+                    }
+                    if (x == c)
+                    {
+                        ++i;
+                        break;
+                    }
+                    if (x == '\n')
+                        break;
+                    ++i;
+                }
+            }
+            else if (isIdentStart(c))
+            {
+                t.kind = TokenKind::Identifier;
+                ++i;
+                while (i < n && isIdentChar(d[i].unicode()))
+                    ++i;
+            }
+            else if (c >= '0' && c <= '9')
+            {
+                t.kind = TokenKind::Number;
+                ++i;
+                while (i < n && (isIdentChar(d[i].unicode()) || d[i].unicode() == '.'))
+                    ++i;
+            }
+            else
+            {
+                t.kind = TokenKind::Punct;
+                ++i;
+            }
+            t.length = i - t.start;
+            out.append(t);
+        }
+        return out;
+    }
+
+    QVector<int> matchBrackets(const QString &text, const QVector<Token> &tokens)
+    {
+        QVector<int> pairs(tokens.size(), -1);
+        QVector<int> stack;
+        for (int i = 0; i < tokens.size(); ++i)
+        {
+            const Token &t = tokens[i];
+            if (t.kind != TokenKind::Punct)
+                continue;
+            const ushort c = text.at(t.start).unicode();
+            if (c == '{' || c == '[' || c == '(')
+            {
+                stack.append(i);
+            }
+            else if (c == '}' || c == ']' || c == ')')
+            {
+                const ushort open = (c == '}') ? '{' : (c == ']') ? '[' : '(';
+                // 容错：弹出到同类开括号为止，忽略条件编译造成的不平衡
+                int k = stack.size() - 1;
+                while (k >= 0 && text.at(tokens[stack[k]].start).unicode() != open)
+                    --k;
+                if (k < 0)
+                    continue;
+                pairs[stack[k]] = i;
+                pairs[i] = stack[k];
+                stack.resize(k);
+            }
+        }
+        return pairs;
+    }
+
+    // '{' 之前（跳过空白）是否为 extern "C"
+    static bool opensExternC(const QChar *d, int brace)
+    {
+        int k = brace - 1;
+        while (k >= 0 && d[k].isSpace())
+            --k;
+        if (k < 2 || d[k].unicode() != '"' || d[k - 1].unicode() != 'C' || d[k - 2].unicode() != '"')
+            return false;
+        k -= 3;
+        while (k >= 0 && d[k].isSpace())
+            --k;
+        static const char kw[] = "extern";
+        for (int j = 5; j >= 0; --j, --k)
+        {
+            if (k < 0 || d[k].unicode() != ushort(kw[j]))
+                return false;
+        }
+        return k < 0 || !isIdentChar(d[k].unicode());
+    }
+
+    QVector<Shard> splitTopLevel(const QString &text, int targetChars)
+    {
+        QVector<Shard> out;
+        const QChar *d = text.constData();
+        const int n = text.size();
+        Shard cur;
+        int line = 1;
+        int depth = 0;
+        QVector<bool> externC; // 各层花括号是否为 extern "C" 块（不计入深度）
+        int i = 0;
+        while (i < n)
+        {
+            const ushort c = d[i].unicode();
+            if (c == '\n')
+            {
+                ++line;
+                ++i;
+                continue;
+            }
+            if (c == '/' && i + 1 < n && d[i + 1].unicode() == '/')
+            {
+                i += 2;
+                while (i < n && d[i].unicode() != '\n')
+                    ++i;
+                continue;
+            }
+            if (c == '/' && i + 1 < n && d[i + 1].unicode() == '*')
+            {
+                i += 2;
+                while (i < n && !(d[i].unicode() == '*' && i + 1 < n && d[i + 1].unicode() == '/'))
+                {
+                    if (d[i].unicode() == '\n')
+                        ++line;
+                    ++i;
+                }
+                i = qMin(n, i + 2);
+                continue;
+            }
+            if (c == '"' || c == '\'')
+            {
+                ++i;
+                while (i < n)
+                {
+                    const ushort x = d[i].unicode();
+                    if (x == '\\' && i + 1 < n)
+                    {
+                        if (d[i + 1].unicode() == '\n')
+                            ++line;
+                        i += 2;
+                        continue;
+                    }
+                    if (x == c)
+                    {
+                        ++i;
+                        break;
+                    }
+                    if (x == '\n')
+                        break;
+                    ++i;
+                }
+                continue;
+            }
+            if (c == '{')
+            {
+                const bool ext = opensExternC(d, i);
+                externC.append(ext);
+                if (!ext)
+                    ++depth;
+            }
+            else if (c == '}')
+            {
+                // 容错：多余的 '}' 不使深度为负
+                if (!externC.isEmpty())
+                {
+                    if (!externC.last())
+                        --depth;
+                    externC.removeLast();
+                }
+            }
+            else if (c == ';' && depth == 0 && i + 1 - cur.start >= targetChars)
+            {
+                cur.end = i + 1;
+                out.append(cur);
+                cur.start = cur.end;
+                cur.line = line;
+            }
+            ++i;
+        }
+        if (cur.start < n || out.isEmpty())
+        {
+            cur.end = n;
+            out.append(cur);
+        }
+        return out;
+    }
+
+    // 从类型名 token i 起匹配 `Type [限定词/指针] name[...] = [&][(...)] { ... };`，成功时填充 init
+    static bool matchDeclaration(const QString &text, const QVector<Token> &tokens, const QVector<int> &pairs, int i, int consumed, Initializer &init)
+    {
+        const int n = tokens.size();
+        auto ident = [&](int idx) { return text.midRef(tokens[idx].start, tokens[idx].length); };
+        // 步骤1：类型名之后为限定词/指针/变量名/数组维度，直到 '='
+        int j = i + 1;
+        int nameIdx = -1;
+        bool isArray = false;
+        bool ok = false;
+        while (j < n)
+        {
+            const Token &t = tokens[j];
+            if (t.kind == TokenKind::Identifier)
+            {
+                if (!isArray)
+                    nameIdx = j;
+                ++j;
+                continue;
+            }
+            if (isPunct(text, t, '*'))
+            {
+                ++j;
+                continue;
+            }
+            if (isPunct(text, t, '[') && nameIdx >= 0 && pairs[j] > j)
+            {
+                isArray = true;
+                j = pairs[j] + 1;
+                continue;
+            }
+            ok = isPunct(text, t, '=') && nameIdx >= 0;
+            break;
+        }
+        if (!ok)
+            return false;
+        // 步骤2：'=' 之后允许 &(...) 或 (...) 形式的取址/转换，再要求 '{'
+        ++j;
+        if (j < n && isPunct(text, tokens[j], '&'))
+            ++j;
+        if (j < n && isPunct(text, tokens[j], '(') && pairs[j] > j)
+            j = pairs[j] + 1;
+        if (j >= n || !isPunct(text, tokens[j], '{') || pairs[j] < 0)
+            return false;
+        const int close = pairs[j];
+        if (close + 1 >= n || !isPunct(text, tokens[close + 1], ';'))
+            return false;
+        // 步骤3：回溯 static/const/struct 前缀，确定声明起始行
+        int k = i;
+        while (k > consumed && tokens[k - 1].kind == TokenKind::Identifier)
+        {
+            const QStringRef w = ident(k - 1);
+            if (w != QLatin1String("static") && w != QLatin1String("const") && w != QLatin1String("struct"))
+                break;
+            --k;
+        }
+        init.typeName = ident(i).toString();
+        init.variableName = ident(nameIdx).toString();
+        init.isArray = isArray;
+        init.line = tokens[k].line;
+        init.declStart = tokens[k].start;
+        init.declEnd = tokens[close + 1].start + 1;
+        init.openBrace = j;
+        init.closeBrace = close;
+        return true;
+    }
+
+    QList<Initializer> findInitializers(const QString &text, const QVector<Token> &tokens, const QVector<int> &pairs, const QString &typeName)
+    {
+        QList<Initializer> out;
+        const int n = tokens.size();
+        int consumed = 0; // 已被上一个声明占用的 token 边界，前缀回溯不越过它
+        for (int i = 0; i < n; ++i)
+        {
+            if (tokens[i].kind != TokenKind::Identifier || text.midRef(tokens[i].start, tokens[i].length) != typeName)
+                continue;
+            Initializer init;
+            if (!matchDeclaration(text, tokens, pairs, i, consumed, init))
+                continue;
+            out.append(init);
+            i = init.closeBrace + 1;
+            consumed = i + 1;
+        }
+        return out;
+    }
+
+    QList<Initializer> findAllInitializers(const QString &text, const QVector<Token> &tokens, const QVector<int> &pairs)
+    {
+        QList<Initializer> out;
+        const int n = tokens.size();
+        int consumed = 0;
+        for (int i = 0; i < n; ++i)
+        {
+            if (tokens[i].kind != TokenKind::Identifier)
+                continue;
+            // 存储类/限定关键字不作为类型名，由前缀回溯纳入声明
+            const QStringRef w = text.midRef(tokens[i].start, tokens[i].length);
+            if (w == QLatin1String("static") || w == QLatin1String("const") || w == QLatin1String("struct")
+                || w == QLatin1String("extern") || w == QLatin1String("volatile") || w == QLatin1String("return"))
+                continue;
+            Initializer init;
+            if (!matchDeclaration(text, tokens, pairs, i, consumed, init))
+                continue;
+            out.append(init);
+            i = init.closeBrace + 1;
+            consumed = i + 1;
+        }
+        return out;
+    }
+
+}
@@ -0,0 +1,115 @@
+/**
+ * @file c_lexer.h
+ * @brief 轻量 C 词法分析接口（Single-pass C tokenizer APIs）
+ *
+ * 功能名称：C 源码单遍词法与初始化声明定位（C tokenizer & initializer locator）
+ * 主要用途：
+ * - 一次线性扫描识别注释、字符串/字符字面量、标识符、数字与标点，并记录行号；
+ * - 基于 token 定位 `Type name[...] = { ... };` 形式的初始化声明，供提取模块共用；
+ *
+ * 使用示例：
+ *  auto toks = CLexer::tokenize(text);
+ *  auto pairs = CLexer::matchBrackets(text, toks);
+ *  for (const auto &d : CLexer::findInitializers(text, toks, pairs, "_Tr_TEXT")) { ... }
+ */
+#ifndef C_LEXER_H
+#define C_LEXER_H
+
+#include <QString>
+#include <QVector>
+#include <QList>
+
+namespace CLexer {
+
+enum class TokenKind
+{
+    Identifier,
+    Number,
+    String,
+    Char,
+    Punct
+};
+
+struct Token
+{
+    TokenKind kind{TokenKind::Punct};
+    int start{0};  // 在源文本中的字符偏移
+    int length{0};
+    int line{1};   // 1 起始行号
+};
+
+/**
+ * @brief 初始化声明定位结果（Located initializer declaration）
+ */
+struct Initializer
+{
+    QString typeName;   // 声明的类型名（struct 别名）
+    QString variableName;
+    bool isArray{false};
+    int line{0};        // 声明起始行（含 static/const/struct 前缀）
+    int declStart{0};   // 声明起始字符偏移
+    int declEnd{0};     // 结尾 ';' 之后的字符偏移
+    int openBrace{-1};  // 初始化体 '{' 的 token 下标
+    int closeBrace{-1}; // 与之匹配的 '}' 的 token 下标
+};
+
+/**
+ * @brief 单遍词法分析，跳过空白与注释（Tokenize in one pass, skipping comments）
+ * @param text 源文本
+ * @return token 序列；标点按单字符输出，未闭合的字符串截止到行尾
+ */
+QVector<Token> tokenize(const QString &text);
+
+/**
+ * @brief 计算括号配对（Match {} [] () pairs）
+ * @param text 源文本
+ * @param tokens tokenize 的结果
+ * @return 与 tokens 等长的下标表：括号 token 对应其配对下标，其余或未配对为 -1
+ */
+QVector<int> matchBrackets(const QString &text, const QVector<Token> &tokens);
+
+/**
+ * @brief 定位指定类型的初始化声明（Find `Type name = {...};` declarations）
+ * @param text 源文本
+ * @param tokens tokenize 的结果
+ * @param pairs matchBrackets 的结果
+ * @param typeName 结构体类型名（精确匹配标识符）
+ * @return 按出现顺序排列的声明；数组声明 isArray 为 true
+ */
+QList<Initializer> findInitializers(const QString &text, const QVector<Token> &tokens, const QVector<int> &pairs, const QString &typeName);
+
+/**
+ * @brief 定位任意类型的初始化声明（Find `Type name = {...};` for any type）
+ * @return 按出现顺序排列的声明；typeName 为 static/const/struct 之后的首个标识符
+ */
+QList<Initializer> findAllInitializers(const QString &text, const QVector<Token> &tokens, const QVector<int> &pairs);
+
+/**
+ * @brief 文本分片（Shard of a source buffer）
+ */
+struct Shard
+{
+    int start{0}; // 起始字符偏移
+    int end{0};   // 结束字符偏移（不含）
+    int line{1};  // 起始处的 1 起始行号
+};
+
+/**
+ * @brief 在顶层 ';' 处把文本切成约 targetChars 大小的分片（Split at top-level semicolons）
+ * 与 tokenize 相同地跳过注释与字面量；只在花括号深度为 0 处切分，`extern "C" { ... }` 内视为顶层。
+ * 任一顶层声明都完整落在某个分片内，各分片可独立 tokenize 与定位初始化声明。
+ * @return 覆盖全文且首尾相接的分片；找不到切分点时只有一片
+ */
+QVector<Shard> splitTopLevel(const QString &text, int targetChars);
+
+/**
+ * @brief 判断 token 是否为指定单字符标点（Test for a single-char punctuator）
+ */
+inline bool isPunct(const QString &text, const Token &t, char c)
+{
+    return t.kind == TokenKind::Punct && text.at(t.start) == QLatin1Char(c);
+}
+
+}
+
+#endif // C_LEXER_H
@@ -0,0 +1,136 @@
+/**
+ * @file change_set.cpp
+ * @brief 多文件事务写回实现（Transactional multi-file commit implementation）
+ *
+ * 临时文件与目标同目录，保证改名不跨文件系统；POSIX rename 与 Windows MoveFileEx 均原子替换目标。
+ * 清单在第一次改名前写出，进程中途退出时仍可由撤销恢复。
+ */
+#include "change_set.h"
+#include "backup_store.h"
+#include <QFile>
+#include <QDir>
+#include <QFileInfo>
+#include <QTextCodec>
+#include <QtConcurrent>
+#include <cstdio>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#endif
+
+namespace
+{
+    QString tempPathFor(const QString &path)
+    {
+        return path + QStringLiteral(".dirmake-tmp");
+    }
+
+    bool replaceFile(const QString &from, const QString &to)
+    {
+#if defined(Q_OS_WIN)
+        const QString f = QDir::toNativeSeparators(from);
+        const QString t = QDir::toNativeSeparators(to);
+        return MoveFileExW(reinterpret_cast<LPCWSTR>(f.utf16()), reinterpret_cast<LPCWSTR>(t.utf16()),
+                           MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+        return std::rename(QFile::encodeName(from).constData(), QFile::encodeName(to).constData()) == 0;
+#endif
+    }
+
+    // 备份原文件并写出临时文件；返回错误说明，成功时为空
+    struct StageFn
+    {
+        typedef QString result_type;
+        BackupStore::Session *backup;
+        QString operator()(const ChangeSet::Change &c) const
+        {
+            if (backup && !backup->add(c.path))
+                return QStringLiteral("备份失败：%1").arg(c.path);
+            QFile tmp(tempPathFor(c.path));
+            if (!tmp.open(QIODevice::WriteOnly | QIODevice::Truncate))
+                return QStringLiteral("无法创建临时文件：%1").arg(tmp.fileName());
+            const bool ok = tmp.write(c.bytes) == c.bytes.size();
+            tmp.close();
+            if (!ok)
+                return QStringLiteral("写入临时文件失败：%1").arg(tmp.fileName());
+            // 沿用原文件权限
+            tmp.setPermissions(QFileInfo(c.path).permissions());
+            return QString();
+        }
+    };
+
+    void removeTemps(const QVector<ChangeSet::Change> &changes, int from)
+    {
+        for (int i = from; i < changes.size(); ++i)
+            QFile::remove(tempPathFor(changes.at(i).path));
+    }
+}
+
+namespace ChangeSet
+{
+
+    QByteArray encode(const QString &text, const QString &codec, bool utf8Bom)
+    {
+        QTextCodec *c = QTextCodec::codecForName(codec.isEmpty() ? QByteArray("UTF-8") : codec.toLatin1());
+        if (!c)
+            c = QTextCodec::codecForName("UTF-8");
+        QByteArray out;
+        if (utf8Bom && codec.compare(QLatin1String("UTF-8"), Qt::CaseInsensitive) == 0)
+            out = QByteArray("\xEF\xBB\xBF");
+        out += c->fromUnicode(text);
+        return out;
+    }
+
+    Result commit(const QVector<Change> &changes, BackupStore::Session *backup)
+    {
+        Result r;
+        if (changes.isEmpty())
+        {
+            r.ok = true;
+            return r;
+        }
+
+        // 阶段1：并发备份与写临时文件；任一失败则整体放弃，原文件未被触碰
+        const QList<QString> errors = QtConcurrent::blockingMapped<QList<QString>>(changes, StageFn{backup});
+        QStringList failed;
+        for (const QString &e : errors)
+        {
+            if (!e.isEmpty())
+                failed << e;
+        }
+        if (backup && failed.isEmpty() && !backup->commit())
+            failed << QStringLiteral("无法写出备份清单：%1").arg(backup->sessionDir());
+        if (!failed.isEmpty())
+        {
+            removeTemps(changes, 0);
+            // 原文件未被修改：不留备份清单，避免“撤销”选中这次空操作
+            if (backup)
+                backup->discard();
+            r.error = failed.join(QLatin1Char('\n'));
+            return r;
+        }
+
+        // 阶段2：逐个改名替换
+        for (int i = 0; i < changes.size(); ++i)
+        {
+            const QString &path = changes.at(i).path;
+            if (replaceFile(tempPathFor(path), path))
+                continue;
+            r.error = QStringLiteral("无法替换：%1").arg(path);
+            removeTemps(changes, i);
+            if (backup)
+            {
+                QString restoreError;
+                r.rolledBack = BackupStore::restore(backup->sessionDir(), backup->root(), nullptr, &restoreError);
+                if (!restoreError.isEmpty())
+                    r.error += QLatin1Char('\n') + restoreError;
+            }
+            return r;
+        }
+        r.ok = true;
+        for (const Change &c : changes)
+            r.written << c.path;
+        return r;
+    }
+
+}
@@ -0,0 +1,65 @@
+/**
+ * @file change_set.h
+ * @brief 多文件事务写回接口（Transactional multi-file commit APIs）
+ *
+ * 功能名称：变更集提交（Apply a planned change set all-or-nothing）
+ * 主要用途：
+ * - 新增语言、英文填充先在内存中规划全部文件的新内容，再经此一次提交；
+ * - 先并发备份原文件并写出同目录临时文件，全部成功后才逐个改名替换；
+ * - 准备阶段失败时原文件不动；改名中途失败时按备份清单恢复已替换的文件；
+ *
+ * 使用示例：
+ *  QVector<ChangeSet::Change> changes{{path, ChangeSet::encode(text, codec, bom)}};
+ *  const ChangeSet::Result r = ChangeSet::commit(changes, &backup);
+ */
+#ifndef CHANGE_SET_H
+#define CHANGE_SET_H
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QVector>
+
+namespace BackupStore {
+class Session;
+}
+
+namespace ChangeSet {
+
+/**
+ * @brief 单个文件的新内容（New bytes for one file）
+ */
+struct Change
+{
+    QString path;     // 绝对路径
+    QByteArray bytes; // 已按原编码编码的完整内容
+};
+
+/**
+ * @brief 提交结果（Commit result）
+ */
+struct Result
+{
+    bool ok{false};
+    bool rolledBack{false}; // 改名中途失败并已按备份恢复
+    QStringList written;    // 成功提交时为全部文件；失败时为空
+    QString error;
+};
+
+/**
+ * @brief 按原编码编码文本（Encode text with the file's original codec）
+ * @param codec 编码名；为空时按 UTF-8
+ * @param utf8Bom 原文件带 UTF-8 BOM 时写回 BOM
+ */
+QByteArray encode(const QString &text, const QString &codec, bool utf8Bom);
+
+/**
+ * @brief 提交变更集（Commit all changes or none）
+ * @param changes 待写回的文件；路径不得重复
+ * @param backup 备份会话；提交前备份全部原文件并写出清单，改名失败时据此回滚。为空时不备份，也无法回滚
+ */
+Result commit(const QVector<Change> &changes, BackupStore::Session *backup);
+
+}
+
+#endif // CHANGE_SET_H
@@ -0,0 +1,541 @@
+/**
+ * @file cli_main.cpp
+ * @brief 命令行入口（Headless command-line driver）
+ *
+ * 功能名称：无界面批处理（Batch/CI driver, QtCore only）
+ * 主要用途：
+ * - 子命令 extract / generate / apply / fill-english / lookup，选项与界面各页一致；
+ * - stdout 每行输出一个 JSON 对象：event 为 start / progress / result / error；
+ * - 退出码：0 成功；1 执行失败；2 参数错误；3 部分失败（apply 存在失败行）；
+ *
+ * 使用示例：
+ *  DirModeExCli extract --root D:/proj --mode effective --defines "LANG=CN;DEBUG"
+ *  DirModeExCli extract --root D:/proj --chinese-only
+ *  DirModeExCli generate --csv ty_text_out.csv --c-out gen.c --h-out gen.h --annotate indices
+ *  DirModeExCli generate --csv ty_text_out.csv --c-out gen.c --schema tr_text.schema.json
+ *  DirModeExCli generate --csv ty_text_out.csv --c-out gen.c --pool suffix
+ *  DirModeExCli generate --csv ty_text_out.csv --catalog texts.trc
+ *  DirModeExCli lookup --catalog texts.trc --key g_text_ok --lang en
+ *  DirModeExCli apply --root D:/proj --csv "a.csv;b.csv" --dry-run
+ *  DirModeExCli fill-english --root D:/proj
+ */
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QDir>
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <cstdio>
+#include "text_extractor.h"
+#include "extract_cache.h"
+#include "extract_sink.h"
+#include "preprocessor.h"
+#include "csv_lang_plugin.h"
+#include "language_settings.h"
+#include "struct_layout.h"
+#include "tr_catalog.h"
+#include "dir_walker.h"
+#include "perf_stats.h"
+
+namespace
+{
+    enum ExitCode
+    {
+        ExitOk = 0,
+        ExitFailed = 1,
+        ExitUsage = 2,
+        ExitPartial = 3
+    };
+
+    // 输出一行 JSON 事件；工作线程也可能调用，串行化写出
+    void emitEvent(const QString &event, QJsonObject obj = QJsonObject())
+    {
+        static QMutex mutex;
+        obj.insert(QStringLiteral("event"), event);
+        const QByteArray line = QJsonDocument(obj).toJson(QJsonDocument::Compact);
+        QMutexLocker lock(&mutex);
+        std::fwrite(line.constData(), 1, size_t(line.size()), stdout);
+        std::fputc('\n', stdout);
+        std::fflush(stdout);
+    }
+
+    int fail(ExitCode code, const QString &message)
+    {
+        emitEvent(QStringLiteral("error"), QJsonObject{{QStringLiteral("message"), message}, {QStringLiteral("exit_code"), int(code)}});
+        return code;
+    }
+
+    QStringList splitList(const QString &s, QChar sep)
+    {
+        QStringList out;
+        for (const QString &p : s.split(sep, Qt::SkipEmptyParts))
+        {
+            const QString t = p.trimmed();
+            if (!t.isEmpty())
+                out << t;
+        }
+        return out;
+    }
+
+    // 宏定义解析 A=1;B;C=hello（与界面一致）
+    QMap<QString, QString> parseDefines(const QString &s)
+    {
+        QMap<QString, QString> defines;
+        for (const QString &t : splitList(s, QLatin1Char(';')))
+        {
+            const int eq = t.indexOf(QLatin1Char('='));
+            if (eq >= 0)
+                defines.insert(t.left(eq).trimmed(), t.mid(eq + 1).trimmed());
+            else
+                defines.insert(t, QString());
+        }
+        return defines;
+    }
+
+    bool isChineseColumn(const QString &col)
+    {
+        const QString c = col.toLower();
+        return c.endsWith(QLatin1String("_cn")) || c.endsWith(QLatin1String("_zh")) || c.endsWith(QLatin1String("_chs")) || c.endsWith(QLatin1String("_hans"));
+    }
+
+    struct CliMapFn
+    {
+        typedef BlockTable result_type;
+        QString mode;
+        QMap<QString, QString> defines;
+        QString typeName;
+        bool keepEsc;
+        std::shared_ptr<ExtractCache> cache;
+        std::shared_ptr<const Preprocessor::IncludeContext> includes;
+        BlockTable operator()(const QString &fpath) const
+        {
+            auto compute = [&](const QByteArray *content) { return TextExtractor::extractFileTable(fpath, mode, defines, typeName, keepEsc, includes.get(), content); };
+            return cache ? cache->table(fpath, compute) : compute(nullptr);
+        }
+    };
+
+    int runExtract(const QCommandLineParser &p)
+    {
+        const QString root = p.value(QStringLiteral("root"));
+        if (root.isEmpty() || !QDir(root).exists())
+            return fail(ExitUsage, QStringLiteral("extract: --root 必须为存在的目录"));
+        const bool chineseOnly = p.isSet(QStringLiteral("chinese-only"));
+        const QString outCsv = p.isSet(QStringLiteral("out"))
+                                   ? p.value(QStringLiteral("out"))
+                                   : QDir(root).absoluteFilePath(chineseOnly ? QStringLiteral("ty_text_cn.csv") : QStringLiteral("ty_text_out.csv"));
+        const QString mode = p.value(QStringLiteral("mode"));
+        if (mode != QLatin1String("all") && !TextExtractor::isEffectiveMode(mode))
+            return fail(ExitUsage, QStringLiteral("extract: 未知模式 %1（effective / effective_includes / all）").arg(mode));
+        QStringList exts = splitList(p.value(QStringLiteral("exts")), QLatin1Char(','));
+        if (exts.isEmpty())
+            exts = QStringList{QStringLiteral(".h"), QStringLiteral(".hpp"), QStringLiteral(".c"), QStringLiteral(".cpp")};
+        const QMap<QString, QString> defines = parseDefines(p.value(QStringLiteral("defines")));
+        const QString typeName = p.value(QStringLiteral("type"));
+        const bool keepEsc = p.isSet(QStringLiteral("keep-escapes"));
+        if (p.isSet(QStringLiteral("threads")))
+            QThreadPool::globalInstance()->setMaxThreadCount(qMax(1, p.value(QStringLiteral("threads")).toInt()));
+
+        PerfStats::Run perfRun;
+        // 语言列发现、文件列表、缓存指纹与包含目录共用一次目录遍历
+        DirWalker::Scope walkScope(root);
+        const QStringList langCols = TextExtractor::discoverLanguageColumns(root, exts, typeName);
+        // 直写列：中文提取仅中文列；否则取 --literal-cols，未给出时全部直写
+        QStringList literalCols;
+        if (chineseOnly)
+        {
+            for (const QString &c : langCols)
+                if (isChineseColumn(c))
+                    literalCols << c;
+            if (literalCols.isEmpty())
+                literalCols << QStringLiteral("text_cn");
+        }
+        else
+        {
+            literalCols = p.isSet(QStringLiteral("literal-cols")) ? splitList(p.value(QStringLiteral("literal-cols")), QLatin1Char(',')) : langCols;
+        }
+        const QStringList files = TextExtractor::collectSourceFiles(root, exts);
+        emitEvent(QStringLiteral("start"), QJsonObject{{QStringLiteral("command"), QStringLiteral("extract")},
+                                                       {QStringLiteral("root"), root},
+                                                       {QStringLiteral("out"), outCsv},
+                                                       {QStringLiteral("mode"), mode},
+                                                       {QStringLiteral("files"), files.size()},
+                                                       {QStringLiteral("lang_columns"), QJsonArray::fromStringList(langCols)}});
+        if (files.isEmpty())
+            return fail(ExitFailed, QStringLiteral("未找到匹配的源文件"));
+
+        Csv::WriteOptions opts;
+        opts.langColumns = langCols;
+        opts.literalColumns = literalCols;
+        opts.replaceAsciiCommaWithCn = !p.isSet(QStringLiteral("keep-comma"));
+        opts.shardRows = qMax(0, p.value(QStringLiteral("shard-rows")).toInt());
+        auto sink = ExtractSink::open(outCsv, opts, chineseOnly);
+        if (!sink)
+            return fail(ExitFailed, QStringLiteral("无法写入 CSV：%1").arg(outCsv));
+        std::shared_ptr<ExtractCache> cache;
+        if (!p.isSet(QStringLiteral("no-cache")))
+        {
+            cache = std::make_shared<ExtractCache>(root, QStringLiteral("blocks"), mode, defines, typeName, keepEsc);
+            cache->load();
+        }
+        CliMapFn mapFn{mode, defines, typeName, keepEsc, cache, TextExtractor::makeIncludeContext(root, mode, defines)};
+
+        // 事件循环只用于转发进度；归约阶段直接流式写出
+        QFutureWatcher<QList<ExtractedBlock>> watcher;
+        QEventLoop loop;
+        // 按约 1% 步长上报，避免海量文件时刷屏
+        const int step = qMax(1, files.size() / 100);
+        int lastReported = 0;
+        QObject::connect(&watcher, &QFutureWatcherBase::progressValueChanged, [&](int value) {
+            if (value - lastReported < step && value != files.size())
+                return;
+            lastReported = value;
+            emitEvent(QStringLiteral("progress"), QJsonObject{{QStringLiteral("stage"), QStringLiteral("extract")},
+                                                              {QStringLiteral("done"), value},
+                                                              {QStringLiteral("total"), files.size()}});
+        });
+        QObject::connect(&watcher, &QFutureWatcherBase::finished, &loop, &QEventLoop::quit);
+        watcher.setFuture(QtConcurrent::mappedReduced<QList<ExtractedBlock>>(files, mapFn, ExtractReduceFn{sink},
+                                                                             QtConcurrent::OrderedReduce | QtConcurrent::SequentialReduce));
+        if (!watcher.isFinished())
+            loop.exec();
+
+        if (cache)
+            cache->save();
+        const bool ok = sink->writer->close();
+        if (!ok)
+            return fail(ExitFailed, sink->writer->errorString().isEmpty() ? QStringLiteral("写入失败") : sink->writer->errorString());
+        QJsonObject res{{QStringLiteral("command"), QStringLiteral("extract")},
+                        {QStringLiteral("total_blocks"), sink->total},
+                        {QStringLiteral("written_rows"), sink->kept},
+                        {QStringLiteral("output_files"), QJsonArray::fromStringList(sink->writer->writtenFiles())}};
+        if (cache)
+        {
+            res.insert(QStringLiteral("cache_hits"), cache->hitCount());
+            res.insert(QStringLiteral("cache_misses"), cache->missCount());
+        }
+        res.insert(QStringLiteral("perf"), PerfStats::toJson(perfRun.report()));
+        emitEvent(QStringLiteral("result"), res);
+        return ExitOk;
+    }
+
+    int runGenerate(const QCommandLineParser &p)
+    {
+        const QString csv = p.value(QStringLiteral("csv"));
+        const QString outc = p.value(QStringLiteral("c-out"));
+        const QString catalogOut = p.value(QStringLiteral("catalog"));
+        if (csv.isEmpty() || !QFileInfo(csv).isFile())
+            return fail(ExitUsage, QStringLiteral("generate: --csv 必须为存在的文件"));
+        if (outc.isEmpty() && catalogOut.isEmpty())
+            return fail(ExitUsage, QStringLiteral("generate: 缺少 --c-out 或 --catalog"));
+        // 仅输出目录时不写头文件（除非显式给出 --h-out）
+        const QString headerOut = p.isSet(QStringLiteral("h-out"))
+                                      ? p.value(QStringLiteral("h-out"))
+                                      : (outc.isEmpty() ? QString() : QFileInfo(outc).dir().absoluteFilePath(QStringLiteral("generated_text_vars_dynamic.h")));
+        const QString annotate = p.value(QStringLiteral("annotate"));
+        if (annotate != QLatin1String("none") && annotate != QLatin1String("names") && annotate != QLatin1String("indices"))
+            return fail(ExitUsage, QStringLiteral("generate: --annotate 取值为 none / names / indices"));
+        const bool utf8Lit = p.isSet(QStringLiteral("utf8-literal"));
+        const QStringList litCols = utf8Lit ? splitList(p.value(QStringLiteral("literal-cols")), QLatin1Char(',')) : QStringList();
+        const QString schema = p.value(QStringLiteral("schema"));
+        if (!schema.isEmpty() && !QFileInfo(schema).isFile())
+            return fail(ExitUsage, QStringLiteral("generate: --schema 必须为存在的文件"));
+        const QString poolMode = p.value(QStringLiteral("pool"));
+        if (poolMode != QLatin1String("off") && poolMode != QLatin1String("dedup") && poolMode != QLatin1String("suffix"))
+            return fail(ExitUsage, QStringLiteral("generate: --pool 取值为 off / dedup / suffix"));
+        emitEvent(QStringLiteral("start"), QJsonObject{{QStringLiteral("command"), QStringLiteral("generate")},
+                                                       {QStringLiteral("csv"), csv},
+                                                       {QStringLiteral("c_out"), outc},
+                                                       {QStringLiteral("h_out"), headerOut},
+                                                       {QStringLiteral("catalog"), catalogOut}});
+        PerfStats::Run perfRun;
+        TextExtractor::GenerateStats gen;
+        TextExtractor::generateCFromCsv(
+            csv,
+            p.value(QStringLiteral("type")),
+            outc,
+            headerOut,
+            p.isSet(QStringLiteral("no-static")),
+            p.isSet(QStringLiteral("registry")),
+            p.value(QStringLiteral("registry-name")),
+            utf8Lit,
+            !p.isSet(QStringLiteral("no-fill-english")),
+            !p.isSet(QStringLiteral("no-null-sentinel")),
+            !p.isSet(QStringLiteral("no-verbatim")),
+            litCols,
+            annotate,
+            qBound(1, p.value(QStringLiteral("per-line")).toInt(), 12),
+            QMap<QString, QPair<QString, QString>>(),
+            QString(),
+            poolMode,
+            catalogOut,
+            schema,
+            &gen);
+        if (!gen.error.isEmpty())
+            return fail(ExitFailed, gen.error);
+        QJsonObject res{{QStringLiteral("command"), QStringLiteral("generate")},
+                        {QStringLiteral("c_out"), outc},
+                        {QStringLiteral("h_out"), headerOut},
+                        {QStringLiteral("rows"), gen.rows},
+                        {QStringLiteral("layout"), gen.layoutOrigin},
+                        {QStringLiteral("columns"), QJsonArray::fromStringList(gen.columns)},
+                        {QStringLiteral("bytes"), outc.isEmpty() ? qint64(0) : QFileInfo(outc).size()}};
+        if (!catalogOut.isEmpty())
+        {
+            res.insert(QStringLiteral("catalog"), catalogOut);
+            res.insert(QStringLiteral("catalog_bytes"), gen.catalogBytes);
+        }
+        if (!gen.pool.isEmpty())
+        {
+            QJsonArray langs;
+            qint64 naive = 0;
+            for (const StringPool::GroupStats &g : gen.pool)
+            {
+                naive += g.naiveBytes;
+                langs.append(QJsonObject{{QStringLiteral("column"), g.name},
+                                         {QStringLiteral("strings"), g.strings},
+                                         {QStringLiteral("naive_bytes"), g.naiveBytes},
+                                         {QStringLiteral("pooled_bytes"), g.pooledBytes},
+                                         {QStringLiteral("saved_bytes"), g.savedBytes()}});
+            }
+            res.insert(QStringLiteral("pool"), QJsonObject{{QStringLiteral("mode"), poolMode},
+                                                           {QStringLiteral("bytes"), gen.poolBytes},
+                                                           {QStringLiteral("naive_bytes"), naive},
+                                                           {QStringLiteral("saved_bytes"), naive - gen.poolBytes},
+                                                           {QStringLiteral("suffix_merged"), gen.poolMerged},
+                                                           {QStringLiteral("languages"), langs}});
+        }
+        // 导出实际采用的布局，之后可用 --schema 跳过项目扫描
+        const QString saveSchema = p.value(QStringLiteral("save-schema"));
+        if (!saveSchema.isEmpty())
+        {
+            QString err;
+            if (!StructLayout::writeSchema(saveSchema, p.value(QStringLiteral("type")), gen.columns, err))
+                return fail(ExitFailed, err);
+            res.insert(QStringLiteral("schema_out"), saveSchema);
+        }
+        res.insert(QStringLiteral("perf"), PerfStats::toJson(perfRun.report()));
+        emitEvent(QStringLiteral("result"), res);
+        return ExitOk;
+    }
+
+    int runLookup(const QCommandLineParser &p)
+    {
+        const QString path = p.value(QStringLiteral("catalog"));
+        const QString key = p.value(QStringLiteral("key"));
+        if (path.isEmpty() || key.isEmpty())
+            return fail(ExitUsage, QStringLiteral("lookup: 需要 --catalog 与 --key"));
+        TrCatalog::Reader reader(path);
+        QString err;
+        if (!reader.open(err))
+            return fail(ExitFailed, err);
+        const int entry = reader.find(key.toUtf8());
+        if (entry < 0)
+            return fail(ExitFailed, QStringLiteral("目录中没有键：%1").arg(key));
+        // 未给 --lang 时输出全部语言
+        QJsonObject values;
+        const QStringList langs = reader.languages();
+        const QString only = p.value(QStringLiteral("lang"));
+        for (int l = 0; l < langs.size(); ++l)
+        {
+            if (only.isEmpty() || langs.at(l) == only || langs.at(l) == QStringLiteral("text_") + only)
+                values.insert(langs.at(l), QString::fromUtf8(reader.value(entry, l)));
+        }
+        if (values.isEmpty())
+            return fail(ExitUsage, QStringLiteral("目录中没有语言列：%1").arg(only));
+        emitEvent(QStringLiteral("result"), QJsonObject{{QStringLiteral("command"), QStringLiteral("lookup")},
+                                                        {QStringLiteral("key"), key},
+                                                        {QStringLiteral("entries"), reader.entryCount()},
+                                                        {QStringLiteral("values"), values}});
+        return ExitOk;
+    }
+
+    int runApply(const QCommandLineParser &p)
+    {
+        const QString root = p.value(QStringLiteral("root"));
+        if (root.isEmpty() || !QDir(root).exists())
+            return fail(ExitUsage, QStringLiteral("apply: --root 必须为存在的目录"));
+        QStringList csvFiles;
+        for (const QString &v : p.values(QStringLiteral("csv")))
+            csvFiles << splitList(v, QLatin1Char(';'));
+        if (csvFiles.isEmpty())
+            return fail(ExitUsage, QStringLiteral("apply: 缺少 --csv"));
+        for (const QString &f : csvFiles)
+            if (!QFileInfo(f).isFile())
+                return fail(ExitUsage, QStringLiteral("apply: CSV 不存在：%1").arg(f));
+
+        // 默认配置与界面“CSV 导入”页一致：按值列顺序映射标准语言代码
+        QJsonObject cfg;
+        QJsonObject map;
+        const char *const langs[] = {"cn", "en", "vn", "ko", "tr", "ru", "pt", "es", "fa", "jp", "ar", "other"};
+        for (int i = 0; i < int(sizeof(langs) / sizeof(langs[0])); ++i)
+            map[QLatin1String(langs[i])] = i;
+        cfg[QStringLiteral("column_mapping")] = map;
+        cfg[QStringLiteral("dry_run")] = p.isSet(QStringLiteral("dry-run"));
+        cfg[QStringLiteral("strict_line_only")] = false;
+        cfg[QStringLiteral("line_window")] = 10000;
+        cfg[QStringLiteral("ignore_variable_name")] = true;
+        cfg[QStringLiteral("disable_backups")] = !p.isSet(QStringLiteral("backups"));
+        if (p.isSet(QStringLiteral("diff-context")))
+            cfg[QStringLiteral("diff_context")] = p.value(QStringLiteral("diff-context")).toInt();
+        if (p.isSet(QStringLiteral("sandbox")))
+            cfg[QStringLiteral("sandbox_output_dir")] = p.value(QStringLiteral("sandbox"));
+        // --config 给出的 JSON 覆盖默认项（键名同 CsvLangPlugin::applyTranslations）
+        if (p.isSet(QStringLiteral("config")))
+        {
+            QFile f(p.value(QStringLiteral("config")));
+            if (!f.open(QIODevice::ReadOnly))
+                return fail(ExitUsage, QStringLiteral("apply: 无法读取配置 %1").arg(f.fileName()));
+            QJsonParseError perr;
+            const QJsonDocument doc = QJsonDocument::fromJson(f.readAll(), &perr);
+            if (!doc.isObject())
+                return fail(ExitUsage, QStringLiteral("apply: 配置不是 JSON 对象：%1").arg(perr.errorString()));
+            const QJsonObject extra = doc.object();
+            for (auto it = extra.constBegin(); it != extra.constEnd(); ++it)
+                cfg[it.key()] = it.value();
+        }
+        emitEvent(QStringLiteral("start"), QJsonObject{{QStringLiteral("command"), QStringLiteral("apply")},
+                                                       {QStringLiteral("root"), root},
+                                                       {QStringLiteral("csv"), QJsonArray::fromStringList(csvFiles)},
+                                                       {QStringLiteral("dry_run"), cfg.value(QStringLiteral("dry_run")).toBool()}});
+        const QString logsDir = QDir(root).absoluteFilePath(QStringLiteral("logs"));
+        QDir().mkpath(logsDir);
+        int totalSuccess = 0, totalSkip = 0, totalFail = 0;
+        QJsonArray perCsv;
+        for (int i = 0; i < csvFiles.size(); ++i)
+        {
+            const QString base = QFileInfo(csvFiles.at(i)).completeBaseName();
+            QJsonObject cfgEach = cfg;
+            if (!cfgEach.contains(QStringLiteral("log_path")))
+                cfgEach[QStringLiteral("log_path")] = QDir(logsDir).absoluteFilePath(QStringLiteral("csv_lang_plugin_%1.log").arg(base));
+            if (!cfgEach.contains(QStringLiteral("diff_path")))
+                cfgEach[QStringLiteral("diff_path")] = QDir(logsDir).absoluteFilePath(QStringLiteral("csv_lang_plugin_%1.diff").arg(base));
+            if (!cfgEach.value(QStringLiteral("disable_backups")).toBool() && !cfgEach.contains(QStringLiteral("backups_dir")))
+            {
+                const QString backupsBase = QDir(root).absoluteFilePath(QStringLiteral(".csv_lang_backups"));
+                QDir().mkpath(backupsBase);
+                cfgEach[QStringLiteral("backups_dir")] = QDir(backupsBase).absoluteFilePath(QDateTime::currentDateTime().toString(QStringLiteral("yyyyMMdd_HHmmss_")) + base);
+            }
+            const CsvProcessStats stats = CsvLangPlugin::applyTranslations(root, csvFiles.at(i), cfgEach);
+            totalSuccess += stats.successCount;
+            totalSkip += stats.skipCount;
+            totalFail += stats.failCount;
+            const QJsonObject one{{QStringLiteral("csv"), csvFiles.at(i)},
+                                  {QStringLiteral("success"), stats.successCount},
+                                  {QStringLiteral("skipped"), stats.skipCount},
+                                  {QStringLiteral("failed"), stats.failCount},
+                                  {QStringLiteral("log"), stats.logPath},
+                                  {QStringLiteral("diff"), stats.diffPath},
+                                  {QStringLiteral("integrity_report"), stats.integrityReportPath},
+                                  {QStringLiteral("perf_report"), stats.perfReportPath},
+                                  {QStringLiteral("perf"), PerfStats::toJson(stats.perf)}};
+            perCsv.append(one);
+            emitEvent(QStringLiteral("progress"), QJsonObject{{QStringLiteral("stage"), QStringLiteral("apply")},
+                                                              {QStringLiteral("done"), i + 1},
+                                                              {QStringLiteral("total"), csvFiles.size()},
+                                                              {QStringLiteral("csv"), csvFiles.at(i)}});
+        }
+        emitEvent(QStringLiteral("result"), QJsonObject{{QStringLiteral("command"), QStringLiteral("apply")},
+                                                        {QStringLiteral("success"), totalSuccess},
+                                                        {QStringLiteral("skipped"), totalSkip},
+                                                        {QStringLiteral("failed"), totalFail},
+                                                        {QStringLiteral("files"), perCsv}});
+        return totalFail > 0 ? ExitPartial : ExitOk;
+    }
+
+    int runFillEnglish(const QCommandLineParser &p)
+    {
+        const QString root = p.value(QStringLiteral("root"));
+        if (root.isEmpty() || !QDir(root).exists())
+            return fail(ExitUsage, QStringLiteral("fill-english: --root 必须为存在的目录"));
+        emitEvent(QStringLiteral("start"), QJsonObject{{QStringLiteral("command"), QStringLiteral("fill-english")}, {QStringLiteral("root"), root}});
+        const ProjectLang::InitResult res = ProjectLang::fillMissingEntriesWithEnglish(root);
+        // 写回失败（含已回滚）退出码为 ExitFailed；success 为 false 而未失败仅表示没有需要补齐的项
+        if (res.failed)
+            return fail(ExitFailed, res.message);
+        emitEvent(QStringLiteral("result"), QJsonObject{{QStringLiteral("command"), QStringLiteral("fill-english")},
+                                                        {QStringLiteral("modified_files"), QJsonArray::fromStringList(res.modifiedFiles)},
+                                                        {QStringLiteral("log"), res.logPath},
+                                                        {QStringLiteral("backups"), res.outputDir},
+                                                        {QStringLiteral("message"), res.message}});
+        return ExitOk;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("DirModeExCli"));
+
+    QCommandLineParser p;
+    p.setApplicationDescription(QStringLiteral("DirModeEx headless driver: extract | generate | apply | fill-english | lookup"));
+    p.addHelpOption();
+    p.addPositionalArgument(QStringLiteral("command"), QStringLiteral("extract | generate | apply | fill-english | lookup"));
+    p.addOptions({
+        {{QStringLiteral("r"), QStringLiteral("root")}, QStringLiteral("项目根目录（extract/apply/fill-english）"), QStringLiteral("dir")},
+        {QStringLiteral("out"), QStringLiteral("extract 输出 CSV（默认 <root>/ty_text_out.csv，中文提取为 ty_text_cn.csv）"), QStringLiteral("file")},
+        {QStringLiteral("mode"), QStringLiteral("解析模式：effective / effective_includes / all"), QStringLiteral("mode"), QStringLiteral("effective")},
+        {QStringLiteral("defines"), QStringLiteral("宏定义，如 A=1;B;C=hello"), QStringLiteral("list")},
+        {QStringLiteral("exts"), QStringLiteral("扩展名过滤，逗号分隔（默认 .h,.hpp,.c,.cpp）"), QStringLiteral("list")},
+        {QStringLiteral("type"), QStringLiteral("结构体类型名"), QStringLiteral("name"), QStringLiteral("_Tr_TEXT")},
+        {QStringLiteral("keep-escapes"), QStringLiteral("保留字符串中的转义符")},
+        {QStringLiteral("literal-cols"), QStringLiteral("直写（不转义）的语言列，逗号分隔"), QStringLiteral("list")},
+        {QStringLiteral("keep-comma"), QStringLiteral("不将英文逗号替换为中文逗号")},
+        {QStringLiteral("shard-rows"), QStringLiteral("每个 CSV 分片的最大行数（0 不分片）"), QStringLiteral("n"), QStringLiteral("0")},
+        {QStringLiteral("chinese-only"), QStringLiteral("仅提取中文列含中文的条目")},
+        {QStringLiteral("no-cache"), QStringLiteral("不使用增量提取缓存")},
+        {QStringLiteral("threads"), QStringLiteral("并发线程数"), QStringLiteral("n")},
+        {QStringLiteral("csv"), QStringLiteral("输入 CSV（apply 可用 ; 分隔或重复给出多个）"), QStringLiteral("file")},
+        {QStringLiteral("c-out"), QStringLiteral("generate 输出 C 文件"), QStringLiteral("file")},
+        {QStringLiteral("h-out"), QStringLiteral("generate 输出头文件（默认与 C 文件同目录）"), QStringLiteral("file")},
+        {QStringLiteral("no-static"), QStringLiteral("生成的变量不加 static")},
+        {QStringLiteral("registry"), QStringLiteral("生成注册表数组")},
+        {QStringLiteral("registry-name"), QStringLiteral("注册表数组名称"), QStringLiteral("name")},
+        {QStringLiteral("utf8-literal"), QStringLiteral("--literal-cols 以外的列写为 UTF-8 十六进制转义")},
+        {QStringLiteral("no-fill-english"), QStringLiteral("缺失语言不以英文填充")},
+        {QStringLiteral("no-null-sentinel"), QStringLiteral("不写 NULL 哨兵")},
+        {QStringLiteral("no-verbatim"), QStringLiteral("不按原文写出")},
+        {QStringLiteral("annotate"), QStringLiteral("注释方式：none / names / indices"), QStringLiteral("mode"), QStringLiteral("indices")},
+        {QStringLiteral("per-line"), QStringLiteral("每行字符串数（1-12）"), QStringLiteral("n"), QStringLiteral("1")},
+        {QStringLiteral("catalog"), QStringLiteral("generate 同时输出的二进制译文目录；lookup 读取的目录"), QStringLiteral("file")},
+        {QStringLiteral("key"), QStringLiteral("lookup 查找的变量名"), QStringLiteral("name")},
+        {QStringLiteral("lang"), QStringLiteral("lookup 只输出该语言列（如 text_en 或 en）"), QStringLiteral("column")},
+        {QStringLiteral("pool"), QStringLiteral("generate 字符串池：off / dedup / suffix（去重并合并后缀）"), QStringLiteral("mode"), QStringLiteral("off")},
+        {QStringLiteral("schema"), QStringLiteral("generate 结构体布局模式文件（JSON，跳过项目扫描）"), QStringLiteral("file")},
+        {QStringLiteral("save-schema"), QStringLiteral("generate 完成后导出实际采用的布局为模式文件"), QStringLiteral("file")},
+        {QStringLiteral("dry-run"), QStringLiteral("apply 仅生成差异不写文件")},
+        {QStringLiteral("backups"), QStringLiteral("apply 前备份原文件到 .csv_lang_backups")},
+        {QStringLiteral("sandbox"), QStringLiteral("apply 写入沙箱目录而非原文件"), QStringLiteral("dir")},
+        {QStringLiteral("diff-context"), QStringLiteral("差异上下文行数"), QStringLiteral("n")},
+        {QStringLiteral("config"), QStringLiteral("apply 附加 JSON 配置（覆盖默认项）"), QStringLiteral("file")},
+    });
+    if (!p.parse(QCoreApplication::arguments()))
+        return fail(ExitUsage, p.errorText());
+    if (p.isSet(QStringLiteral("help")))
+    {
+        std::fputs(qPrintable(p.helpText()), stdout);
+        return ExitOk;
+    }
+    const QStringList args = p.positionalArguments();
+    const QString command = args.value(0);
+    if (command == QLatin1String("extract"))
+        return runExtract(p);
+    if (command == QLatin1String("generate"))
+        return runGenerate(p);
+    if (command == QLatin1String("apply"))
+        return runApply(p);
+    if (command == QLatin1String("fill-english"))
+        return runFillEnglish(p);
+    if (command == QLatin1String("lookup"))
+        return runLookup(p);
+    return fail(ExitUsage, command.isEmpty() ? QStringLiteral("缺少子命令（extract | generate | apply | fill-english | lookup）")
+                                             : QStringLiteral("未知子命令：%1").arg(command));
+}
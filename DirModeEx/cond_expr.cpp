@@ -0,0 +1,521 @@
+/**
+ * @file cond_expr.cpp
+ * @brief 条件编译表达式求值实现（Preprocessor condition evaluator implementation）
+ *
+ * 编译：手写词法 + 递归下降（按 C 运算符优先级），输出后缀指令；
+ * 求值：值栈运算，标识符在求值时查宏表展开，故同一编译结果可用于不同宏状态。
+ */
+#include "cond_expr.h"
+#include <QReadWriteLock>
+
+namespace CondExpr
+{
+
+    namespace
+    {
+        const int kMaxExpandDepth = 16;
+        const int kCompileCacheLimit = 4096; // compileCached 缓存的表达式上限
+
+        struct Tok
+        {
+            enum Kind
+            {
+                End,
+                Number,
+                Ident,
+                String,
+                Punct
+            } kind{End};
+            qint64 num{0};
+            QString text;
+        };
+
+        // 解析整数字面量（十进制/十六进制/八进制/二进制，忽略 u/l 后缀）
+        bool parseInteger(const QString &s, qint64 &value)
+        {
+            QString t = s.trimmed();
+            while (!t.isEmpty() && (t.endsWith(QLatin1Char('u')) || t.endsWith(QLatin1Char('U')) || t.endsWith(QLatin1Char('l')) || t.endsWith(QLatin1Char('L'))))
+                t.chop(1);
+            if (t.isEmpty() || !t.at(0).isDigit())
+                return false;
+            bool ok = false;
+            qulonglong v = 0;
+            if (t.startsWith(QLatin1String("0x")) || t.startsWith(QLatin1String("0X")))
+                v = t.midRef(2).toULongLong(&ok, 16);
+            else if (t.startsWith(QLatin1String("0b")) || t.startsWith(QLatin1String("0B")))
+                v = t.midRef(2).toULongLong(&ok, 2);
+            else if (t.size() > 1 && t.at(0) == QLatin1Char('0'))
+                v = t.toULongLong(&ok, 8);
+            else
+                v = t.toULongLong(&ok, 10);
+            value = qint64(v);
+            return ok;
+        }
+
+        class Lexer
+        {
+        public:
+            explicit Lexer(const QString &s) : m_s(s) {}
+
+            bool next(Tok &t)
+            {
+                const int n = m_s.size();
+                while (m_i < n && m_s.at(m_i).isSpace())
+                    ++m_i;
+                t = Tok();
+                if (m_i >= n)
+                    return true;
+                const QChar c = m_s.at(m_i);
+                if (c.isDigit())
+                {
+                    int j = m_i;
+                    while (j < n && (m_s.at(j).isLetterOrNumber() || m_s.at(j) == QLatin1Char('_')))
+                        ++j;
+                    t.kind = Tok::Number;
+                    if (!parseInteger(m_s.mid(m_i, j - m_i), t.num))
+                        return false;
+                    m_i = j;
+                    return true;
+                }
+                if (c.isLetter() || c == QLatin1Char('_'))
+                {
+                    int j = m_i;
+                    while (j < n && (m_s.at(j).isLetterOrNumber() || m_s.at(j) == QLatin1Char('_')))
+                        ++j;
+                    t.kind = Tok::Ident;
+                    t.text = m_s.mid(m_i, j - m_i);
+                    m_i = j;
+                    return true;
+                }
+                if (c == QLatin1Char('\''))
+                {
+                    // 字符常量：'a'、'\n'、'\0'
+                    int j = m_i + 1;
+                    qint64 v = 0;
+                    if (j < n && m_s.at(j) == QLatin1Char('\\') && j + 1 < n)
+                    {
+                        const QChar e = m_s.at(j + 1);
+                        v = (e == QLatin1Char('n')) ? 10 : (e == QLatin1Char('t')) ? 9 : (e == QLatin1Char('r')) ? 13 : (e == QLatin1Char('0')) ? 0 : e.unicode();
+                        j += 2;
+                    }
+                    else if (j < n)
+                    {
+                        v = m_s.at(j).unicode();
+                        ++j;
+                    }
+                    if (j >= n || m_s.at(j) != QLatin1Char('\''))
+                        return false;
+                    t.kind = Tok::Number;
+                    t.num = v;
+                    m_i = j + 1;
+                    return true;
+                }
+                if (c == QLatin1Char('"'))
+                {
+                    int j = m_i + 1;
+                    while (j < n && m_s.at(j) != QLatin1Char('"'))
+                        j += (m_s.at(j) == QLatin1Char('\\')) ? 2 : 1;
+                    if (j >= n)
+                        return false;
+                    t.kind = Tok::String;
+                    t.text = m_s.mid(m_i + 1, j - m_i - 1);
+                    m_i = j + 1;
+                    return true;
+                }
+                static const char *const twoChar[] = {"&&", "||", "==", "!=", "<=", ">=", "<<", ">>"};
+                for (const char *op : twoChar)
+                {
+                    if (m_i + 1 < n && c == QLatin1Char(op[0]) && m_s.at(m_i + 1) == QLatin1Char(op[1]))
+                    {
+                        t.kind = Tok::Punct;
+                        t.text = QLatin1String(op);
+                        m_i += 2;
+                        return true;
+                    }
+                }
+                if (QStringLiteral("()!~*/%+-<>&^|?:,").contains(c))
+                {
+                    t.kind = Tok::Punct;
+                    t.text = QString(c);
+                    ++m_i;
+                    return true;
+                }
+                return false;
+            }
+
+        private:
+            const QString &m_s;
+            int m_i{0};
+        };
+
+        class Parser
+        {
+        public:
+            explicit Parser(const QString &s) : m_lex(s) {}
+
+            Program run()
+            {
+                advance();
+                parseCond();
+                if (m_ok && m_tok.kind != Tok::End)
+                    m_ok = false;
+                m_prog.valid = m_ok;
+                return m_prog;
+            }
+
+        private:
+            void advance()
+            {
+                if (!m_lex.next(m_tok))
+                {
+                    m_ok = false;
+                    m_tok = Tok();
+                }
+            }
+            bool isPunct(const char *p) const { return m_tok.kind == Tok::Punct && m_tok.text == QLatin1String(p); }
+            void push(Op op, qint64 num = 0, const QString &s = QString())
+            {
+                Instr in;
+                in.op = op;
+                in.num = num;
+                if (op == Op::Ident || op == Op::Defined || op == Op::Str)
+                {
+                    in.str = m_prog.strings.size();
+                    m_prog.strings << s;
+                }
+                m_prog.code.append(in);
+            }
+
+            void parseCond()
+            {
+                parseBinary(0);
+                if (m_ok && isPunct("?"))
+                {
+                    advance();
+                    parseCond();
+                    if (!isPunct(":"))
+                    {
+                        m_ok = false;
+                        return;
+                    }
+                    advance();
+                    parseCond();
+                    push(Op::Cond);
+                }
+            }
+
+            // 二元运算按优先级分层：0=||, 1=&&, 2=|, 3=^, 4=&, 5=== !=, 6=< <= > >=, 7=<< >>, 8=+ -, 9=* / %
+            static bool binaryOp(const Tok &t, int level, Op &op)
+            {
+                if (t.kind != Tok::Punct)
+                    return false;
+                const QString &p = t.text;
+                switch (level)
+                {
+                case 0: if (p == QLatin1String("||")) { op = Op::Or; return true; } break;
+                case 1: if (p == QLatin1String("&&")) { op = Op::And; return true; } break;
+                case 2: if (p == QLatin1String("|")) { op = Op::BitOr; return true; } break;
+                case 3: if (p == QLatin1String("^")) { op = Op::BitXor; return true; } break;
+                case 4: if (p == QLatin1String("&")) { op = Op::BitAnd; return true; } break;
+                case 5:
+                    if (p == QLatin1String("==")) { op = Op::Eq; return true; }
+                    if (p == QLatin1String("!=")) { op = Op::Ne; return true; }
+                    break;
+                case 6:
+                    if (p == QLatin1String("<")) { op = Op::Lt; return true; }
+                    if (p == QLatin1String("<=")) { op = Op::Le; return true; }
+                    if (p == QLatin1String(">")) { op = Op::Gt; return true; }
+                    if (p == QLatin1String(">=")) { op = Op::Ge; return true; }
+                    break;
+                case 7:
+                    if (p == QLatin1String("<<")) { op = Op::Shl; return true; }
+                    if (p == QLatin1String(">>")) { op = Op::Shr; return true; }
+                    break;
+                case 8:
+                    if (p == QLatin1String("+")) { op = Op::Add; return true; }
+                    if (p == QLatin1String("-")) { op = Op::Sub; return true; }
+                    break;
+                case 9:
+                    if (p == QLatin1String("*")) { op = Op::Mul; return true; }
+                    if (p == QLatin1String("/")) { op = Op::Div; return true; }
+                    if (p == QLatin1String("%")) { op = Op::Mod; return true; }
+                    break;
+                }
+                return false;
+            }
+
+            void parseBinary(int level)
+            {
+                if (level > 9)
+                {
+                    parseUnary();
+                    return;
+                }
+                parseBinary(level + 1);
+                Op op;
+                while (m_ok && binaryOp(m_tok, level, op))
+                {
+                    advance();
+                    parseBinary(level + 1);
+                    push(op);
+                }
+            }
+
+            void parseUnary()
+            {
+                if (!m_ok)
+                    return;
+                if (isPunct("!") || isPunct("~") || isPunct("-") || isPunct("+"))
+                {
+                    const Op op = isPunct("!") ? Op::Not : isPunct("~") ? Op::BitNot : isPunct("-") ? Op::Neg : Op::Plus;
+                    advance();
+                    parseUnary();
+                    push(op);
+                    return;
+                }
+                if (m_tok.kind == Tok::Ident && m_tok.text == QLatin1String("defined"))
+                {
+                    advance();
+                    const bool paren = isPunct("(");
+                    if (paren)
+                        advance();
+                    if (m_tok.kind != Tok::Ident)
+                    {
+                        m_ok = false;
+                        return;
+                    }
+                    push(Op::Defined, 0, m_tok.text);
+                    advance();
+                    if (paren)
+                    {
+                        if (!isPunct(")"))
+                        {
+                            m_ok = false;
+                            return;
+                        }
+                        advance();
+                    }
+                    return;
+                }
+                parsePrimary();
+            }
+
+            void parsePrimary()
+            {
+                switch (m_tok.kind)
+                {
+                case Tok::Number:
+                    push(Op::Num, m_tok.num);
+                    advance();
+                    return;
+                case Tok::String:
+                    push(Op::Str, 0, m_tok.text);
+                    advance();
+                    return;
+                case Tok::Ident:
+                {
+                    const QString name = m_tok.text;
+                    advance();
+                    if (isPunct("("))
+                    {
+                        // 函数式宏调用无法在此展开：跳过实参，按 0 处理
+                        int depth = 0;
+                        do
+                        {
+                            if (isPunct("("))
+                                ++depth;
+                            else if (isPunct(")"))
+                                --depth;
+                            else if (m_tok.kind == Tok::End)
+                            {
+                                m_ok = false;
+                                return;
+                            }
+                            advance();
+                        } while (m_ok && depth > 0);
+                        push(Op::Num, 0);
+                        return;
+                    }
+                    push(Op::Ident, 0, name);
+                    return;
+                }
+                case Tok::Punct:
+                    if (isPunct("("))
+                    {
+                        advance();
+                        parseCond();
+                        if (!isPunct(")"))
+                        {
+                            m_ok = false;
+                            return;
+                        }
+                        advance();
+                        return;
+                    }
+                    break;
+                case Tok::End:
+                    break;
+                }
+                m_ok = false;
+            }
+
+            Lexer m_lex;
+            Tok m_tok;
+            Program m_prog;
+            bool m_ok{true};
+        };
+
+        struct Val
+        {
+            qint64 n{0};
+            QString sym;     // 未展开的符号或字符串，仅用于 == / != 的文本比较
+            bool str{false}; // 来自字符串字面量
+        };
+
+        Val run(const Program &prog, const MacroTable &macros, int depth);
+
+        Val identValue(const QString &name, const MacroTable &macros, int depth)
+        {
+            auto it = macros.constFind(name);
+            if (it == macros.constEnd())
+                return Val{0, name};
+            const QString v = it.value().trimmed();
+            if (v.isEmpty())
+                return Val{1, QString()}; // 仅定义无取值（如 -DNAME）按 1 处理
+            Val out;
+            if (parseInteger(v, out.n))
+                return out;
+            if (depth >= kMaxExpandDepth)
+                return Val{0, v};
+            const Program p = compileCached(v);
+            if (!p.valid)
+                return Val{0, v};
+            return run(p, macros, depth + 1);
+        }
+
+        Val run(const Program &prog, const MacroTable &macros, int depth)
+        {
+            QVector<Val> st;
+            st.reserve(prog.code.size());
+            for (const Instr &in : prog.code)
+            {
+                switch (in.op)
+                {
+                case Op::Num:
+                    st.append(Val{in.num, QString()});
+                    continue;
+                case Op::Ident:
+                    st.append(identValue(prog.strings.at(in.str), macros, depth));
+                    continue;
+                case Op::Defined:
+                    st.append(Val{macros.contains(prog.strings.at(in.str)) ? 1 : 0, QString()});
+                    continue;
+                case Op::Str:
+                    st.append(Val{0, prog.strings.at(in.str), true});
+                    continue;
+                case Op::Not:
+                case Op::BitNot:
+                case Op::Neg:
+                case Op::Plus:
+                {
+                    if (st.isEmpty())
+                        return Val();
+                    const qint64 a = st.last().n;
+                    // 取负经无符号运算，INT64_MIN 按补码回绕而非未定义行为
+                    st.last() = Val{in.op == Op::Not ? qint64(!a) : in.op == Op::BitNot ? ~a : in.op == Op::Neg ? qint64(0 - quint64(a)) : a, QString()};
+                    continue;
+                }
+                case Op::Cond:
+                {
+                    if (st.size() < 3)
+                        return Val();
+                    const Val b = st.takeLast();
+                    const Val a = st.takeLast();
+                    const Val c = st.takeLast();
+                    st.append(c.n ? a : b);
+                    continue;
+                }
+                default:
+                    break;
+                }
+                if (st.size() < 2)
+                    return Val();
+                const Val b = st.takeLast();
+                const Val a = st.takeLast();
+                qint64 r = 0;
+                switch (in.op)
+                {
+                // 与预处理器一致按 64 位补码回绕：加减乘经无符号运算；除以 0 得 0，
+                // 除以 -1 改为取负（INT64_MIN / -1 在硬件上会触发 SIGFPE），取余为 0
+                case Op::Mul: r = qint64(quint64(a.n) * quint64(b.n)); break;
+                case Op::Div: r = b.n == 0 ? 0 : b.n == -1 ? qint64(0 - quint64(a.n)) : a.n / b.n; break;
+                case Op::Mod: r = (b.n == 0 || b.n == -1) ? 0 : a.n % b.n; break;
+                case Op::Add: r = qint64(quint64(a.n) + quint64(b.n)); break;
+                case Op::Sub: r = qint64(quint64(a.n) - quint64(b.n)); break;
+                case Op::Shl: r = (b.n >= 0 && b.n < 64) ? qint64(quint64(a.n) << b.n) : 0; break;
+                case Op::Shr: r = (b.n >= 0 && b.n < 64) ? (a.n >> b.n) : 0; break;
+                case Op::Lt: r = a.n < b.n; break;
+                case Op::Le: r = a.n <= b.n; break;
+                case Op::Gt: r = a.n > b.n; break;
+                case Op::Ge: r = a.n >= b.n; break;
+                case Op::Eq:
+                case Op::Ne:
+                {
+                    // 两侧均为符号/字符串时按文本比较（兼容 LANG == CN 写法）；
+                    // 一侧为字符串字面量时与另一侧的文本比较（兼容 VER == "3"）；否则按数值
+                    auto text = [](const Val &v) { return v.sym.isEmpty() ? QString::number(v.n) : v.sym; };
+                    bool eq;
+                    if (!a.sym.isEmpty() && !b.sym.isEmpty())
+                        eq = (a.sym == b.sym);
+                    else if (a.str || b.str)
+                        eq = (text(a) == text(b));
+                    else
+                        eq = (a.n == b.n);
+                    r = (in.op == Op::Eq) ? eq : !eq;
+                    break;
+                }
+                case Op::BitAnd: r = a.n & b.n; break;
+                case Op::BitXor: r = a.n ^ b.n; break;
+                case Op::BitOr: r = a.n | b.n; break;
+                case Op::And: r = a.n && b.n; break;
+                case Op::Or: r = a.n || b.n; break;
+                default: break;
+                }
+                st.append(Val{r, QString()});
+            }
+            return st.size() == 1 ? st.first() : Val();
+        }
+    }
+
+    Program compile(const QString &expr)
+    {
+        return Parser(expr).run();
+    }
+
+    Program compileCached(const QString &expr)
+    {
+        static QReadWriteLock lock;
+        static QHash<QString, Program> cache;
+        {
+            QReadLocker r(&lock);
+            auto it = cache.constFind(expr);
+            if (it != cache.constEnd())
+                return it.value();
+        }
+        const Program p = compile(expr);
+        QWriteLocker w(&lock);
+        // 实时提取会长时间运行：表达式数超过上限时整体清空，避免无限增长
+        if (cache.size() >= kCompileCacheLimit)
+            cache.clear();
+        cache.insert(expr, p);
+        return p;
+    }
+
+    bool evaluate(const Program &prog, const MacroTable &macros)
+    {
+        if (!prog.valid)
+            return false;
+        return run(prog, macros, 0).n != 0;
+    }
+
+}
@@ -0,0 +1,80 @@
+/**
+ * @file cond_expr.h
+ * @brief 条件编译表达式求值接口（Preprocessor condition evaluator APIs）
+ *
+ * 功能名称：#if/#elif 常量表达式编译与求值（Compile & evaluate #if expressions）
+ * 主要用途：
+ * - 将表达式一次编译为后缀指令序列，之后只做栈式求值，不再逐次构造正则；
+ * - 支持 defined X / defined(X)、! ~ 一元运算、算术、移位、比较、位运算、&& || 与 ?:；
+ * - 标识符按宏表展开（对象宏可嵌套，深度受限），未定义标识符按 0 处理；
+ * - 兼容历史写法：== / != 两侧均为未定义的符号（或字符串）时按文本比较，如 LANG == CN；
+ *
+ * 使用示例：
+ *  CondExpr::MacroTable macros{{"VER", "3"}};
+ *  bool on = CondExpr::evaluate(CondExpr::compile("defined(VER) && VER >= 2"), macros);
+ */
+#ifndef COND_EXPR_H
+#define COND_EXPR_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+
+namespace CondExpr {
+
+/** @brief 宏表：宏名 → 替换文本（空串表示仅定义） */
+typedef QHash<QString, QString> MacroTable;
+
+enum class Op : quint8
+{
+    Num,     // 压入常量
+    Ident,   // 压入标识符（求值时按宏表展开）
+    Defined, // 压入 defined(标识符)
+    Str,     // 压入字符串字面量（仅用于文本比较）
+    Not, BitNot, Neg, Plus,
+    Mul, Div, Mod, Add, Sub, Shl, Shr,
+    Lt, Le, Gt, Ge, Eq, Ne,
+    BitAnd, BitXor, BitOr, And, Or,
+    Cond     // 三元 ?:
+};
+
+struct Instr
+{
+    Op op{Op::Num};
+    qint64 num{0};
+    int str{-1}; // strings 下标（Ident/Defined/Str）
+};
+
+/**
+ * @brief 编译后的表达式（Compiled expression）
+ */
+struct Program
+{
+    QVector<Instr> code;
+    QStringList strings;
+    bool valid{false};
+};
+
+/**
+ * @brief 编译表达式（Compile an #if expression）
+ * @param expr 指令后的表达式文本（注释应已去除）
+ * @return 编译结果；语法错误时 valid 为 false
+ */
+Program compile(const QString &expr);
+
+/**
+ * @brief 编译并缓存（Compile with a process-wide cache keyed by expression text）
+ * @note 线程安全；同一表达式在大量文件中重复出现时只编译一次
+ */
+Program compileCached(const QString &expr);
+
+/**
+ * @brief 求值（Evaluate a compiled expression）
+ * @return 非零为 true；程序无效时返回 false
+ */
+bool evaluate(const Program &prog, const MacroTable &macros);
+
+}
+
+#endif // COND_EXPR_H
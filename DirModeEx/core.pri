@@ -0,0 +1,53 @@
+# 无界面公共模块：DirModeEx.pro 与 DirModeExCli.pro 共用（仅依赖 QtCore/QtConcurrent）
+SOURCES += \
+    text_extractor.cpp \
+    csv_parser.cpp \
+    csv_lang_plugin.cpp \
+    diff_utils.cpp \
+    language_settings.cpp \
+    c_lexer.cpp \
+    extract_cache.cpp \
+    text_codec.cpp \
+    csv_writer.cpp \
+    csv_reader.cpp \
+    symbol_index.cpp \
+    cond_expr.cpp \
+    preprocessor.cpp \
+    extract_sink.cpp \
+    struct_layout.cpp \
+    string_pool.cpp \
+    tr_catalog.cpp \
+    live_extractor.cpp \
+    dir_walker.cpp \
+    perf_stats.cpp \
+    backup_store.cpp \
+    change_set.cpp \
+    regex_registry.cpp \
+    block_table.cpp
+
+HEADERS += \
+    text_extractor.h \
+    csv_parser.h \
+    csv_lang_plugin.h \
+    diff_utils.h \
+    language_settings.h \
+    c_lexer.h \
+    extract_cache.h \
+    text_codec.h \
+    csv_writer.h \
+    csv_reader.h \
+    symbol_index.h \
+    cond_expr.h \
+    preprocessor.h \
+    extract_sink.h \
+    struct_layout.h \
+    string_pool.h \
+    tr_catalog.h \
+    live_extractor.h \
+    dir_walker.h \
+    perf_stats.h \
+    backup_store.h \
+    change_set.h \
+    regex_registry.h \
+    block_table.h \
+    c_escape.h
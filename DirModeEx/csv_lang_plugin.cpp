@@ -9,6 +9,11 @@
 #include "csv_parser.h"
 #include "text_extractor.h"
 #include "diff_utils.h"
+#include "text_codec.h"
+#include "symbol_index.h"
+#include "perf_stats.h"
+#include "backup_store.h"
+#include "regex_registry.h"
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
@@ -17,8 +22,10 @@
 #include <QDateTime>
 #include <QRegularExpression>
 #include <QJsonDocument>
-#include <QMutex>
-#include <QMutexLocker>
+#include <QSaveFile>
+#include <QtConcurrent>
+#include <limits>
+#include <memory>
 
 // Forward declaration for function used before its definition
 static QString readFileAutoCodec(const QString &path, QString &chosenCodec, bool &utf8Bom);
@@ -53,45 +60,6 @@ static QString backupsSessionDir(const QString &root)
         return sess;
     }
 
-/**
- * @brief 判断匹配是否出现在宏定义体内（粗略启发式）
- */
-static bool inMacroContext(const QString &text, int matchStart)
-    {
-        // Skip if the initializer appears within a macro body (naive heuristic)
-        int lineStart = text.lastIndexOf(QLatin1Char('\n'), matchStart);
-        if (lineStart < 0)
-            lineStart = 0;
-        int prevDefine = text.lastIndexOf(QStringLiteral("#define"), matchStart);
-        if (prevDefine < 0)
-            return false;
-        // If #define is after last newline, we consider match within macro
-        return prevDefine > lineStart;
-    }
-
-/**
- * @brief 判断位置是否处于注释中（// 或  ）
- */
-static bool inCommentContext(const QString &text, int pos)
-    {
-        int lineStart = text.lastIndexOf(QLatin1Char('\n'), pos);
-        if (lineStart < 0) lineStart = 0;
-        int slc = text.lastIndexOf(QStringLiteral("//"), pos);
-        if (slc >= 0 && slc > lineStart)
-            return true;
-        int open = text.lastIndexOf(QStringLiteral("/*"), pos);
-        int close = text.lastIndexOf(QStringLiteral("*/"), pos);
-        return open >= 0 && open > close;
-    }
-
-/**
- * @brief 发现结构体语言字段顺序
- */
-static QStringList discoverLangOrder(const QString &root, const QString &alias)
-    {
-        return TextExtractor::discoverLanguageColumns(root, QStringList{QStringLiteral(".h"), QStringLiteral(".hpp"), QStringLiteral(".c"), QStringLiteral(".cpp")}, alias);
-    }
-
 static bool findNthBraceBlock(const QString &body, int nth, int &startContent, int &endContent)
     {
         int level = 0; int count = 0; bool inq = false;
@@ -214,7 +182,8 @@ static QString replaceInitializerBodyPreservingFormat(const QString &body,
             while (i < body.size() && (body.at(i) == QLatin1Char(' ') || body.at(i) == QLatin1Char('\t'))) { spaces++; i++; }
             indent = QStringLiteral("\n") + QString(spaces, QLatin1Char(' '));
         }
-        bool hasTailNull = QRegularExpression(QStringLiteral("\n\s*NULL\s*$")).match(body.trimmed()).hasMatch();
+        static const QRegularExpression &reTailNull = RegexRegistry::get(QStringLiteral("\n\s*NULL\s*$"));
+        bool hasTailNull = reTailNull.match(body.trimmed()).hasMatch();
 
         int enIdx = colMap.value(QStringLiteral("en"), -1);
         QString out;
@@ -255,7 +224,8 @@ static QString buildArrayBody(const QString &origBody,
             while (i < origBody.size() && (origBody.at(i) == QLatin1Char(' ') || origBody.at(i) == QLatin1Char('\t'))) { spaces++; i++; }
             indent = QStringLiteral("\n") + QString(spaces, QLatin1Char(' '));
         }
-        bool hasTailNull = QRegularExpression(QStringLiteral("\n\s*NULL\s*$")).match(origBody.trimmed()).hasMatch();
+        static const QRegularExpression &reTailNull = RegexRegistry::get(QStringLiteral("\n\s*NULL\s*$"));
+        bool hasTailNull = reTailNull.match(origBody.trimmed()).hasMatch();
         int enIdx = colMap.value(QStringLiteral("en"), -1);
         QString out;
         for (int k = 0; k < elements.size(); ++k)
@@ -281,16 +251,111 @@ static QString buildArrayBody(const QString &origBody,
         return out;
     }
 
-    static QMutex gFileWriteMutex;
+/**
+ * @brief 单个文件的待应用修改（Pending edits for one target file）
+ * 同一声明被多行命中时（如 _title 与 _info），后一行在前一行的结果上继续修改。
+ */
+struct FileEditPlan
+{
+    QString absPath;
+    SymbolFile *file{nullptr};
+    QMap<int, QString> bodies; // entries 下标 → 新初始化体
+    int rowCount{0};           // 命中的 CSV 行数
+    QStringList notes;         // 日志附注
+};
+
+/**
+ * @brief 单个文件的应用结果（Result of rewriting one file）
+ */
+struct FileEditResult
+{
+    QString absPath;
+    QString writtenPath;
+    QString diff;
+    int rowCount{0};
+    bool ok{false};
+};
+
+/**
+ * @brief 按文件应用修改：自后向前替换全部初始化体 → 一次差异 → 一次备份 → 一次原子写入
+ * 各文件互不共享状态，可由 QtConcurrent 并发映射。
+ */
+struct ApplyFileFn
+{
+    typedef FileEditResult result_type;
+    SymbolIndex *index;
+    QString projectRoot;
+    BackupStore::Session *backup; // 为空时不备份
+    QString sandboxDir;
+    bool dryRun;
+    int diffContext;
+
+    FileEditResult operator()(const FileEditPlan &plan) const
+    {
+        FileEditResult res;
+        res.absPath = plan.absPath;
+        res.writtenPath = plan.absPath;
+        res.rowCount = plan.rowCount;
+        SymbolFile &sf = *plan.file;
+        const QString before = sf.text;
+        {
+            PerfStats::Timer timer("rewrite");
+            timer.addBytes(before.size());
+            timer.addItems(plan.bodies.size());
+            // 自文件末尾向前替换，前面声明的偏移不受影响
+            for (auto it = plan.bodies.constEnd(); it != plan.bodies.constBegin();)
+            {
+                --it;
+                index->replaceBody(sf, it.key(), it.value());
+            }
+        }
+        res.diff = DiffUtils::unifiedDiff(plan.absPath, before, sf.text, diffContext);
+        if (dryRun)
+        {
+            res.ok = true;
+            return res;
+        }
+        const QString rel = QDir(projectRoot).relativeFilePath(plan.absPath);
+        if (backup)
+        {
+            // 备份保留原始字节；内容已在对象库中时不写数据
+            PerfStats::Timer timer("backup");
+            qint64 written = 0;
+            backup->add(plan.absPath, &written);
+            timer.addBytes(written);
+            timer.addItems(1);
+        }
+        if (!sandboxDir.isEmpty())
+        {
+            res.writtenPath = QDir(sandboxDir).absoluteFilePath(rel);
+            QDir().mkpath(QFileInfo(res.writtenPath).dir().absolutePath());
+        }
+        // 保留原文件编码与 UTF-8 BOM 状态；QSaveFile 保证写入原子性
+        PerfStats::Timer timer("write");
+        QTextCodec *codec = QTextCodec::codecForName(sf.codec.toLatin1());
+        QSaveFile out(res.writtenPath);
+        if (!codec || !out.open(QIODevice::WriteOnly))
+            return res;
+        if (sf.utf8Bom && sf.codec == QStringLiteral("UTF-8"))
+            out.write("\xEF\xBB\xBF");
+        const QByteArray encoded = codec->fromUnicode(sf.text);
+        out.write(encoded);
+        res.ok = out.commit();
+        timer.addBytes(encoded.size());
+        timer.addItems(1);
+        return res;
+    }
+};
 
 /**
  * @brief 将 CSV 翻译应用至 C 源文件中的初始化块
- * 过程：解析 CSV→定位初始化（按行/邻近窗口）→替换正文→写差异与日志→备份或沙箱输出。
+ * 过程：解析 CSV→按行查符号索引并按文件归并修改→各文件并发：自后向前替换、一次差异、一次备份与原子写入→汇总日志。
  */
 CsvProcessStats applyTranslations(const QString &projectRoot,
                                   const QString &csvPath,
                                   const QJsonObject &config)
     {
+        PerfStats::Run perfRun;
         CsvProcessStats stats;
         QString logPath = config.contains(QStringLiteral("log_path"))
                                   ? config.value(QStringLiteral("log_path")).toString()
@@ -414,20 +479,58 @@ CsvProcessStats applyTranslations(const QString &projectRoot,
             }
         }
 
+        // 阶段1（规划）：按行查符号索引，将修改按目标文件归并；此阶段不改动任何文本
+        SymbolIndex index(projectRoot);
+        {
+            PerfStats::Timer timer("symbol_index");
+            QStringList targets;
+            for (const CsvRow &r : rows)
+            {
+                if (r.sourcePath.isEmpty())
+                    continue;
+                targets << SymbolIndex::normalizePath(projectRoot, r.sourcePath);
+            }
+            index.preload(targets);
+            timer.addItems(targets.size());
+        }
+        QList<FileEditPlan> plans;
+        QHash<QString, int> planOf;
+        auto planFor = [&](SymbolFile *sf) -> FileEditPlan & {
+            auto it = planOf.constFind(sf->path);
+            if (it != planOf.constEnd())
+                return plans[it.value()];
+            planOf.insert(sf->path, plans.size());
+            FileEditPlan p;
+            p.absPath = sf->path;
+            p.file = sf;
+            plans.append(p);
+            return plans.last();
+        };
+        // 取声明的当前初始化体：已规划过的声明在先前结果上继续修改
+        auto currentBody = [&](FileEditPlan &plan, int idx) {
+            auto it = plan.bodies.constFind(idx);
+            if (it != plan.bodies.constEnd())
+                return it.value();
+            const SymbolEntry &e = plan.file->entries.at(idx);
+            return plan.file->text.mid(e.bodyStart, e.bodyEnd - e.bodyStart);
+        };
+        static const QRegularExpression &reNested = RegexRegistry::get(QStringLiteral(R"(^([A-Za-z_]\w*)\._(title|info)$)"));
+        static const QRegularExpression &reArrHeader = RegexRegistry::get(QStringLiteral("([A-Za-z_]\\w*)\\s*\\[\\s*\\]$"));
+        static const QRegularExpression &reQuoted = RegexRegistry::get(QStringLiteral("\"(?:\\.|[^\"\\])*\""));
+        PerfStats::Timer planTimer("plan");
+        planTimer.addItems(rows.size());
         int iRow = 0;
         while (iRow < rows.size())
         {
             const CsvRow &r = rows.at(iRow);
-            QRegularExpression reNested(QStringLiteral(R"(^([A-Za-z_]\w*)\._(title|info)$)"));
             auto nestedMatch = reNested.match(r.variableName);
             if (nestedMatch.hasMatch())
             {
                 QString baseVar = nestedMatch.captured(1);
                 QString which = nestedMatch.captured(2);
                 if (onlyInfo && which != QStringLiteral("info")) { iRow++; continue; }
-                QString absPath = r.sourcePath;
-                if (QDir::isRelativePath(absPath))
-                    absPath = QDir(projectRoot).absoluteFilePath(absPath);
+                // 同一文件的不同写法（./、..、\）归并为同一键，避免多份规划互相覆盖
+                const QString absPath = SymbolIndex::normalizePath(projectRoot, r.sourcePath);
                 if (!sourcePathFilter.isEmpty())
                 {
                     QString normRow = QDir::fromNativeSeparators(absPath);
@@ -441,81 +544,60 @@ CsvProcessStats applyTranslations(const QString &projectRoot,
                     stats.failedFiles << absPath; stats.failCount++;
                     iRow++; continue;
                 }
-                QString codec; bool bom = false; QFile f(absPath);
-                if (!f.open(QIODevice::ReadOnly)) { stats.failedFiles << absPath; stats.failCount++; iRow++; continue; }
-                f.close();
-                QString text = readFileAutoCodec(absPath, codec, bom);
-                QRegularExpression reOuter(QStringLiteral(R"((?:static\s+)?(?:const\s+)?DispMessageInfo\s+%1\s*=\s*\{(.*?)\};)" ).arg(QRegularExpression::escape(baseVar)), QRegularExpression::DotMatchesEverythingOption);
-                auto m = reOuter.match(text);
-                if (!m.hasMatch()) { stats.skippedFiles << absPath; stats.skipCount++; iRow++; continue; }
-                int declPos = m.capturedStart(0);
-                int declLine = text.left(declPos).count(QLatin1Char('\n')) + 1;
-                if (strictLineOnly)
+                SymbolFile *sf = index.file(absPath);
+                if (!sf) { stats.failedFiles << absPath; stats.failCount++; iRow++; continue; }
+                int declIdx = -1;
+                for (int idx : sf->byName.value(baseVar))
                 {
-                    int anchor = declLine;
-                    Q_UNUSED(anchor);
+                    const SymbolEntry &e = sf->entries.at(idx);
+                    if (!e.isArray && e.alias == QLatin1String("DispMessageInfo")) { declIdx = idx; break; }
                 }
+                if (declIdx < 0) { stats.skippedFiles << absPath; stats.skipCount++; iRow++; continue; }
+                int declLine = sf->entries.at(declIdx).line;
                 if (filterLineStart > 0 && filterLineEnd > 0)
                 {
                     if (!(declLine >= filterLineStart && declLine <= filterLineEnd))
                     { iRow++; continue; }
                 }
-                int sBody = m.capturedStart(1);
-                int eBody = m.capturedEnd(1);
-                QString body = text.mid(sBody, eBody - sBody);
+                FileEditPlan &plan = planFor(sf);
+                QString body = currentBody(plan, declIdx);
                 int s1=-1,e1=-1,s2=-1,e2=-1;
                 if (!findNthBraceBlock(body, 1, s1, e1)) { stats.skippedFiles << absPath; stats.skipCount++; iRow++; continue; }
                 if (!findNthBraceBlock(body, 2, s2, e2)) { stats.skippedFiles << absPath; stats.skipCount++; iRow++; continue; }
                 int contentStart = (which == QStringLiteral("title")) ? s1 : s2;
                 int contentEnd   = (which == QStringLiteral("title")) ? e1 : e2;
                 QString inner = body.mid(contentStart, contentEnd - contentStart);
-                QRegularExpression reQuoted(QStringLiteral("\"(?:\\.|[^\"\\])*\""));
                 int present = 0; auto qi = reQuoted.globalMatch(inner); while (qi.hasNext()) { qi.next(); ++present; }
                 QStringList structLangs = TextExtractor::defaultLanguageColumns();
                 if (present > 0 && present < structLangs.size())
                     structLangs = structLangs.mid(0, present);
                 QString newInner = replaceInitializerBodyPreservingFormat(inner, structLangs, r.values, colMap, annotateMode);
-                QString newBody = body;
-                newBody.replace(contentStart, contentEnd - contentStart, newInner);
-                QString before = text; QString after = text;
-                after.replace(sBody, eBody - sBody, newBody);
-                diffOut << DiffUtils::unifiedDiff(absPath, before, after);
-                QMutexLocker writeLock(&gFileWriteMutex);
-                QFile wf(absPath);
-                if (wf.open(QIODevice::WriteOnly | QIODevice::Truncate))
-                {
-                    if (bom && codec == QStringLiteral("UTF-8")) wf.write("\xEF\xBB\xBF");
-                    QTextStream wr(&wf); wr.setCodec(codec.toUtf8().constData()); wr << after; wf.close();
-                    stats.successFiles << absPath; stats.successCount++;
-                }
-                else { stats.failedFiles << absPath; stats.failCount++; }
+                body.replace(contentStart, contentEnd - contentStart, newInner);
+                plan.bodies.insert(declIdx, body);
+                plan.rowCount++;
                 iRow++;
                 continue;
             }
-            QString absPath = r.sourcePath;
-            if (QDir::isRelativePath(absPath))
-                absPath = QDir(projectRoot).absoluteFilePath(absPath);
+            const QString absPath = SymbolIndex::normalizePath(projectRoot, r.sourcePath);
             QFileInfo fi(absPath);
             if (!fi.exists() || !fi.isFile())
             {
                 stats.failedFiles << absPath;
                 stats.failCount++;
                 log << QStringLiteral("  路径无效: ") << absPath << QStringLiteral("\n");
+                iRow++;
                 continue;
             }
-            QFile f(absPath);
-            if (!f.open(QIODevice::ReadOnly))
+            SymbolFile *sf = index.file(absPath);
+            if (!sf)
             {
                 stats.failedFiles << absPath;
                 stats.failCount++;
                 log << QStringLiteral("  无法读取: ") << absPath << QStringLiteral("\n");
+                iRow++;
                 continue;
             }
-            f.close();
-            QString codec;
-            bool bom = false;
-            QString text = readFileAutoCodec(absPath, codec, bom);
-            if (text.isEmpty())
+            if (sf->text.isEmpty())
             {
                 stats.failedFiles << absPath;
                 stats.failCount++;
@@ -525,71 +607,37 @@ CsvProcessStats applyTranslations(const QString &projectRoot,
             }
 
             // 处理数组CSV：variableName 形如 "...var[]" 作为头行，后续空var行作为元素
-            QRegularExpression reArrHeader(QStringLiteral("([A-Za-z_]\\w*)\\s*\\[\\s*\\]$"));
             auto arrMatch = reArrHeader.match(r.variableName);
             if (arrMatch.hasMatch())
             {
                 QString varName = arrMatch.captured(1);
-                QString patt = QStringLiteral(R"((?:static\s+)?(?:const\s+)?(?:struct\s+)?(\w+)(?:\s+\w+)*\s+(?:\*+\s*)?%1\s*\[[^\]]*\]\s*=\s*\{(.*?)\};)" ).arg(QRegularExpression::escape(varName));
-                QRegularExpression reArr(patt, QRegularExpression::DotMatchesEverythingOption);
+                // 优先取锚点行附近（上 50 行、下 200 行）的数组声明，否则取文件内首个同名数组
                 int anchorLine = r.lineNumber > 0 ? r.lineNumber : 1;
-                QStringList linesText = text.split(QLatin1Char('\n'));
-                QVector<int> offsets(linesText.size() + 1);
-                int acc = 0;
-                for (int i = 0; i < linesText.size(); ++i) { offsets[i] = acc; acc += linesText[i].size() + 1; }
-                offsets[linesText.size()] = acc;
-                int startIdx = qBound(0, anchorLine - 1 - 50, linesText.size());
-                int endIdx = qBound(0, anchorLine - 1 + 200, linesText.size());
-                int subStart = offsets[startIdx];
-                int subLen = offsets[endIdx] - subStart;
-                if (subLen < 0 || subStart < 0 || subStart >= text.size()) subStart = 0, subLen = text.size();
-                QString sub = text.mid(subStart, subLen);
-                auto m = reArr.match(sub);
-                if (!m.hasMatch())
+                int declIdx = -1;
+                bool nearAnchor = false;
+                for (int idx : sf->byName.value(varName))
                 {
-                    m = reArr.match(text);
-                    if (!m.hasMatch())
-                    {
-                        stats.skippedFiles << absPath;
-                        stats.skipCount++;
-                        iRow++;
+                    const SymbolEntry &e = sf->entries.at(idx);
+                    if (!e.isArray)
                         continue;
-                    }
-                    int s = m.capturedStart(2);
-                    int e = m.capturedEnd(2);
-                    QString origBody = text.mid(s, e - s);
-                    QList<QStringList> elems;
-                    iRow++;
-                    while (iRow < rows.size())
+                    if (declIdx < 0)
+                        declIdx = idx;
+                    if (e.line >= anchorLine - 50 && e.line < anchorLine + 200)
                     {
-                        const CsvRow &ri = rows.at(iRow);
-                        if (!ri.variableName.isEmpty()) break;
-                        elems.append(ri.values);
-                        iRow++;
-                    }
-                    QString newBody = buildArrayBody(origBody, elems, colMap);
-                    QString before = text;
-                    QString after = text;
-                    after.replace(s, e - s, newBody);
-                    diffOut << DiffUtils::unifiedDiff(absPath, before, after);
-                    QMutexLocker writeLock(&gFileWriteMutex);
-                    QFile f2(absPath);
-                    if (f2.open(QIODevice::WriteOnly | QIODevice::Truncate))
-                    {
-                        if (bom && codec == QStringLiteral("UTF-8")) f2.write("\xEF\xBB\xBF");
-                        QTextStream wr(&f2); wr.setCodec(codec.toUtf8().constData()); wr << after; f2.close();
-                        stats.successFiles << absPath; stats.successCount++;
-                        log << QStringLiteral("  修改(数组): ") << QDir(projectRoot).relativeFilePath(absPath) << QStringLiteral("  var=") << varName << QStringLiteral("\n");
-                    }
-                    else
-                    {
-                        stats.failedFiles << absPath; stats.failCount++;
+                        declIdx = idx;
+                        nearAnchor = true;
+                        break;
                     }
+                }
+                if (declIdx < 0)
+                {
+                    stats.skippedFiles << absPath;
+                    stats.skipCount++;
+                    iRow++;
                     continue;
                 }
-                int s = subStart + m.capturedStart(2);
-                int e = subStart + m.capturedEnd(2);
-                QString origBody = text.mid(s, e - s);
+                FileEditPlan &plan = planFor(sf);
+                QString origBody = currentBody(plan, declIdx);
                 // 收集元素行
                 QList<QStringList> elems;
                 iRow++;
@@ -598,7 +646,7 @@ CsvProcessStats applyTranslations(const QString &projectRoot,
                     const CsvRow &ri = rows.at(iRow);
                     if (!ri.variableName.isEmpty()) break;
                     QStringList vals = ri.values;
-                    if (!vals.isEmpty())
+                    if (nearAnchor && !vals.isEmpty())
                     {
                         QString v0 = vals.first().trimmed();
                         if (v0 == (varName + QStringLiteral("[]"))) vals.removeFirst();
@@ -606,117 +654,53 @@ CsvProcessStats applyTranslations(const QString &projectRoot,
                     elems.append(vals);
                     iRow++;
                 }
-                QString newBody = buildArrayBody(origBody, elems, colMap);
-                QString before = text;
-                QString after = text;
-                after.replace(s, e - s, newBody);
-                diffOut << DiffUtils::unifiedDiff(absPath, before, after);
-                QMutexLocker writeLock(&gFileWriteMutex);
-                QFile f2(absPath);
-                if (f2.open(QIODevice::WriteOnly | QIODevice::Truncate))
-                {
-                    if (bom && codec == QStringLiteral("UTF-8")) f2.write("\xEF\xBB\xBF");
-                    QTextStream wr(&f2); wr.setCodec(codec.toUtf8().constData()); wr << after; f2.close();
-                    stats.successFiles << absPath; stats.successCount++;
-                    log << QStringLiteral("  修改(数组): ") << QDir(projectRoot).relativeFilePath(absPath) << QStringLiteral("  var=") << varName << QStringLiteral("\n");
-                }
-                else
-                {
-                    stats.failedFiles << absPath; stats.failCount++;
-                }
+                plan.bodies.insert(declIdx, buildArrayBody(origBody, elems, colMap));
+                plan.rowCount++;
+                plan.notes << QStringLiteral("数组 var=%1").arg(varName);
                 continue;
             }
 
             // find initializer at exact lineNumber first, fallback to nearest within a window
-            // Pattern characteristics:
-            // - optional: static/const/struct and additional qualifiers (e.g., PROGMEM)
-            // - optional: array declarator [] after variable name
-            // - captures alias/type in group(1), initializer body in group(2)
-            QString pattern;
+            // 候选来自符号索引：指定变量名时按名查表，ignore_variable_name 时取文件内全部声明；
+            // 结构体数组与宏定义体内的声明不参与匹配（注释已在词法阶段排除）
             bool ignoreVarName = ignoreVarNameDefault;
             if (!r.variableName.isEmpty())
                 ignoreVarName = false;
+            QVector<int> candidates;
             if (ignoreVarName)
             {
-                // 支持复合字面量地址取值：=&(type){...}
-                pattern = QStringLiteral(R"((?:static\s+)?(?:const\s+)?(?:struct\s+)?(\w+)(?:\s+\w+)*\s+(?:\*+\s*)?\w+\s*(?:\[[^\]]*\])?\s*=\s*(?:&\s*\([^)]*\)\s*)?\{(.*?)\};)" );
+                candidates.reserve(sf->entries.size());
+                for (int i = 0; i < sf->entries.size(); ++i)
+                    candidates.append(i);
             }
             else
             {
-                pattern = QStringLiteral(R"((?:static\s+)?(?:const\s+)?(?:struct\s+)?(\w+)(?:\s+\w+)*\s+(?:\*+\s*)?%1\s*(?:\[[^\]]*\])?\s*=\s*(?:&\s*\([^)]*\)\s*)?\{(.*?)\};)" )
-                              .arg(QRegularExpression::escape(r.variableName));
+                candidates = sf->byName.value(r.variableName);
             }
-            QRegularExpression reInitVar(pattern, QRegularExpression::DotMatchesEverythingOption);
-            auto it = reInitVar.globalMatch(text);
-            bool matched = false;
-            int bestStart = -1;
-            int bestEnd = -1;
-            QString alias;
-            bool matchedExact = false;
-            int exactStart = -1;
-            int exactEnd = -1;
-            QString aliasExact;
+            int exactIdx = -1;
+            int nearestIdx = -1;
             int nearestDist = std::numeric_limits<int>::max();
-            int nearestStart = -1;
-            int nearestEnd = -1;
-            QString aliasNearest;
-            while (it.hasNext())
+            for (int idx : candidates)
             {
-                auto m = it.next();
-                int declPos = m.capturedStart(0);
-                int s = m.capturedStart(2);
-                int e = m.capturedEnd(2);
-                int lineAt = text.left(declPos).count(QLatin1Char('\n')) + 1;
-                QString declText = m.captured(0);
-                int eqPos = declText.indexOf(QLatin1Char('='));
-                if (eqPos > 0)
-                {
-                    QString left = declText.left(eqPos);
-                    if (left.contains(QLatin1Char('[')))
-                    {
-                        continue; // 跳过结构体数组声明
-                    }
-                }
-                if (inMacroContext(text, s))
-                {
-                    continue;
-                }
-                if (inCommentContext(text, s))
-                {
+                const SymbolEntry &e = sf->entries.at(idx);
+                if (e.isArray || e.inMacro)
                     continue;
-                }
-                int dist = qAbs(lineAt - r.lineNumber);
+                int dist = qAbs(e.line - r.lineNumber);
                 if (dist == 0)
                 {
-                    matchedExact = true;
-                    exactStart = s;
-                    exactEnd = e;
-                    aliasExact = m.captured(1);
+                    exactIdx = idx;
                     break; // exact match wins
                 }
                 if (dist < nearestDist)
                 {
                     nearestDist = dist;
-                    nearestStart = s;
-                    nearestEnd = e;
-                    aliasNearest = m.captured(1);
+                    nearestIdx = idx;
                 }
             }
-            if (matchedExact)
-            {
-                matched = true;
-                bestStart = exactStart;
-                bestEnd = exactEnd;
-                alias = aliasExact;
-            }
-            else if (!strictLineOnly && nearestStart >= 0 && nearestDist <= lineWindow)
-            {
-                matched = true;
-                bestStart = nearestStart;
-                bestEnd = nearestEnd;
-                alias = aliasNearest;
-            }
-            if (!matched)
+            int bestIdx = exactIdx;
+            if (bestIdx < 0 && !strictLineOnly && nearestIdx >= 0 && nearestDist <= lineWindow)
+                bestIdx = nearestIdx;
+            if (bestIdx < 0)
             {
                 stats.skippedFiles << absPath;
                 stats.skipCount++;
@@ -728,7 +712,7 @@ CsvProcessStats applyTranslations(const QString &projectRoot,
                 continue;
             }
 
-            QStringList structLangs = aliasHint.isEmpty() ? discoverLangOrder(projectRoot, alias) : discoverLangOrder(projectRoot, aliasHint);
+            QStringList structLangs = index.languageOrder(aliasHint.isEmpty() ? sf->entries.at(bestIdx).alias : aliasHint);
             if (structLangs.isEmpty())
             {
                 stats.skippedFiles << absPath;
@@ -738,75 +722,77 @@ CsvProcessStats applyTranslations(const QString &projectRoot,
                 continue;
             }
 
-            QString before = text;
-            QString body = text.mid(bestStart, bestEnd - bestStart);
-            QString newBody = replaceInitializerBodyPreservingFormat(body, structLangs, r.values, colMap, annotateMode);
-            QString after = text;
-            after.replace(bestStart, bestEnd - bestStart, newBody);
+            FileEditPlan &plan = planFor(sf);
+            const QString body = currentBody(plan, bestIdx);
+            plan.bodies.insert(bestIdx, replaceInitializerBodyPreservingFormat(body, structLangs, r.values, colMap, annotateMode));
+            plan.rowCount++;
+            iRow++;
+        }
 
-            // write diff
-            diffOut << DiffUtils::unifiedDiff(absPath, before, after);
+        planTimer.stop();
 
-            // backup and write (serialize writes to avoid races)
-            QMutexLocker writeLock(&gFileWriteMutex);
-            QString rel = QDir(projectRoot).relativeFilePath(absPath);
-            if (!sessDir.isEmpty())
-            {
-                QString backupPath = QDir(sessDir).absoluteFilePath(rel);
-                QDir().mkpath(QFileInfo(backupPath).dir().absolutePath());
-                QFile bf(backupPath);
-                if (bf.open(QIODevice::WriteOnly | QIODevice::Truncate))
-                {
-                    QTextStream bts(&bf);
-                    bts.setCodec("GB2312");
-                    bts << before;
-                    bf.close();
-                }
-            }
-            if (!dryRun)
-            {
-                if (useSandbox)
-                {
-                    QString targetPath = QDir(sandboxDir).absoluteFilePath(rel);
-                    QDir().mkpath(QFileInfo(targetPath).dir().absolutePath());
-                    QFile tf(targetPath);
-                    if (tf.open(QIODevice::WriteOnly | QIODevice::Truncate))
-                    {
-                        if (bom && codec == QStringLiteral("UTF-8"))
-                            tf.write("\xEF\xBB\xBF");
-                        QTextStream wr(&tf);
-                        wr.setCodec(codec.toUtf8().constData());
-                        wr << after;
-                        tf.close();
-                        stats.successFiles << targetPath;
-                        stats.successCount++;
-                        log << QStringLiteral("  写入沙箱: ") << QDir(projectRoot).relativeFilePath(targetPath) << QStringLiteral("\n");
-                    }
-                }
-                else if (f.open(QIODevice::WriteOnly | QIODevice::Truncate))
-                {
-                    // 保留原文件编码与 UTF-8 BOM 状态
-                    if (bom && codec == QStringLiteral("UTF-8"))
-                        f.write("\xEF\xBB\xBF");
-                    QTextStream wr(&f);
-                    wr.setCodec(codec.toUtf8().constData());
-                    wr << after;
-                    f.close();
-                    stats.successFiles << absPath;
-                    stats.successCount++;
-                    log << QStringLiteral("  修改: ") << rel << QStringLiteral("\n");
-                }
-            }
-            else
+        // 阶段2（应用）：每个文件一次替换、一次差异、一次原子写入，文件之间并发
+        const int diffContext = config.contains(QStringLiteral("diff_context")) ? config.value(QStringLiteral("diff_context")).toInt() : 3;
+        std::unique_ptr<BackupStore::Session> backup;
+        if (!sessDir.isEmpty() && !dryRun)
+        {
+            BackupStore::Options backupOpts;
+            backupOpts.compress = config.value(QStringLiteral("backups_compress")).toBool();
+            backup.reset(new BackupStore::Session(projectRoot, sessDir, backupOpts));
+        }
+        ApplyFileFn applyFn{&index, projectRoot, backup.get(), useSandbox ? sandboxDir : QString(), dryRun, diffContext};
+        const QList<FileEditResult> results = QtConcurrent::blockingMapped<QList<FileEditResult>>(plans, applyFn);
+        if (backup)
+        {
+            backup->commit();
+            log << QStringLiteral("备份: %1 个文件，复用 %2 个，写入 %3 KB\n")
+                       .arg(backup->fileCount())
+                       .arg(backup->reusedCount())
+                       .arg(backup->bytesWritten() / 1024);
+        }
+        for (int i = 0; i < results.size(); ++i)
+        {
+            const FileEditResult &res = results.at(i);
+            diffOut << res.diff;
+            const QString rel = QDir(projectRoot).relativeFilePath(res.writtenPath);
+            const QString notes = plans.at(i).notes.isEmpty() ? QString() : QStringLiteral("  ") + plans.at(i).notes.join(QStringLiteral("; "));
+            if (!res.ok)
             {
-                stats.successFiles << absPath;
-                stats.successCount++;
-                log << QStringLiteral("  预览修改: ") << rel << QStringLiteral("\n");
+                stats.failedFiles << res.absPath;
+                stats.failCount += res.rowCount;
+                log << QStringLiteral("  写入失败: ") << rel << notes << QStringLiteral("\n");
+                continue;
             }
-            iRow++;
+            stats.successFiles << res.writtenPath;
+            stats.successCount += res.rowCount;
+            const QString verb = dryRun ? QStringLiteral("  预览修改: ") : (useSandbox ? QStringLiteral("  写入沙箱: ") : QStringLiteral("  修改: "));
+            log << verb << rel << QStringLiteral("  行数=") << res.rowCount << notes << QStringLiteral("\n");
         }
 
         log << QStringLiteral("成功:") << stats.successCount << QStringLiteral(" 跳过:") << stats.skipCount << QStringLiteral(" 失败:") << stats.failCount << QStringLiteral("\n");
+
+        // 阶段耗时：写入日志、追加到完整性报告，另存 JSON 供看板采集
+        stats.perf = perfRun.report();
+        const QStringList perfLines = PerfStats::formatLines(stats.perf);
+        for (const QString &line : perfLines)
+            log << line << QStringLiteral("\n");
+        QFile integAppend(integPath);
+        if (integAppend.open(QIODevice::Append))
+        {
+            QTextStream ts(&integAppend);
+            ts.setCodec("UTF-8");
+            ts << QStringLiteral("\n阶段耗时:\n");
+            for (const QString &line : perfLines)
+                ts << line << QStringLiteral("\n");
+        }
+        stats.perfReportPath = QDir(projectRoot).absoluteFilePath(QStringLiteral("logs/csv_perf_report.json"));
+        PerfStats::writeJson(stats.perfReportPath, stats.perf,
+                             QJsonObject{{QStringLiteral("csv"), csvPath},
+                                         {QStringLiteral("dry_run"), dryRun},
+                                         {QStringLiteral("rows"), rows.size()},
+                                         {QStringLiteral("success"), stats.successCount},
+                                         {QStringLiteral("skipped"), stats.skipCount},
+                                         {QStringLiteral("failed"), stats.failCount}});
         log << QDateTime::currentDateTime().toString(QStringLiteral("yyyy-MM-dd HH:mm:ss")) << QStringLiteral(" END\n\n");
         logF.close();
         diffF.close();
@@ -817,73 +803,8 @@ CsvProcessStats applyTranslations(const QString &projectRoot,
     }
 
 }
-    static QString decodeWithCodec(const QByteArray &data, const char *name)
-    {
-        QTextCodec *c = QTextCodec::codecForName(name);
-        return c ? c->toUnicode(data) : QString();
-    }
-
-    // 自动编码检测：返回文本，并输出所选编码与是否存在 UTF-8 BOM
+    // 自动编码检测：返回文本，并输出所选编码与是否存在 UTF-8 BOM；持平时偏好 GB18030
     static QString readFileAutoCodec(const QString &path, QString &chosenCodec, bool &utf8Bom)
     {
-        chosenCodec.clear();
-        utf8Bom = false;
-        QFile f(path);
-        if (!f.open(QIODevice::ReadOnly))
-            return QString();
-        QByteArray data = f.readAll();
-        f.close();
-
-        if (data.startsWith("\xEF\xBB\xBF"))
-        {
-            utf8Bom = true;
-            chosenCodec = QStringLiteral("UTF-8");
-            return QString::fromUtf8(data.constData() + 3, data.size() - 3);
-        }
-        if (data.size() >= 2 && (uchar)data[0] == 0xFF && (uchar)data[1] == 0xFE)
-        {
-            chosenCodec = QStringLiteral("UTF-16LE");
-            QTextCodec *c = QTextCodec::codecForName("UTF-16LE");
-            return c ? c->toUnicode(data) : QString();
-        }
-        if (data.size() >= 2 && (uchar)data[0] == 0xFE && (uchar)data[1] == 0xFF)
-        {
-            chosenCodec = QStringLiteral("UTF-16BE");
-            QTextCodec *c = QTextCodec::codecForName("UTF-16BE");
-            return c ? c->toUnicode(data) : QString();
-        }
-
-        auto countReplacement = [](const QString &s) -> int {
-            int cnt = 0;
-            for (int i = 0; i < s.size(); ++i)
-                if (s.at(i).unicode() == 0xFFFD)
-                    ++cnt;
-            return cnt;
-        };
-
-        QString utf8 = decodeWithCodec(data, "UTF-8");
-        int repUtf8 = countReplacement(utf8);
-        QString gb18030 = decodeWithCodec(data, "GB18030");
-        int repGb18030 = countReplacement(gb18030);
-        QString gbk = decodeWithCodec(data, "GBK");
-        int repGbk = countReplacement(gbk);
-        QString gb2312 = decodeWithCodec(data, "GB2312");
-        int repGb2312 = countReplacement(gb2312);
-
-        // 选择替换字符最少的解码结果；持平时偏好 GB18030
-        QString best = gb18030;
-        int minRep = repGb18030;
-        chosenCodec = QStringLiteral("GB18030");
-        auto consider = [&](const QString &s, int rep, const QString &codec) {
-            if (rep < minRep)
-            {
-                minRep = rep;
-                best = s;
-                chosenCodec = codec;
-            }
-        };
-        consider(utf8, repUtf8, QStringLiteral("UTF-8"));
-        consider(gbk, repGbk, QStringLiteral("GBK"));
-        consider(gb2312, repGb2312, QStringLiteral("GB2312"));
-        return best;
+        return TextCodec::readFile(path, &chosenCodec, &utf8Bom, TextCodec::Tie::Gb18030);
     }
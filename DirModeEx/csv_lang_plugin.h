@@ -6,6 +6,7 @@
  * 主要用途：
  * - 将 CSV 中的多语言文本应用到 C 结构体初始化块；
  * - 保留格式与注释，生成差异与日志；
+ * - 初始化声明经 SymbolIndex 按文件索引一次，逐行应用为查表而非全文件正则扫描；
  *
  * 使用示例：
  *  QJsonObject cfg; cfg["dry_run"] = true; auto stats = CsvLangPlugin::applyTranslations(root, csv, cfg);
@@ -17,6 +18,7 @@
 #include <QStringList>
 #include <QList>
 #include <QJsonObject>
+#include "perf_stats.h"
 
 struct CsvProcessStats {
     int successCount{0};
@@ -33,6 +35,8 @@ struct CsvProcessStats {
     QString diffPath;
     QString outputDir; // backups session folder to open after completion
     QString integrityReportPath; // 数据完整性报告路径
+    PerfStats::Report perf;      // 各阶段耗时与计数（解析、索引、规划、替换、差异、备份、写回）
+    QString perfReportPath;      // 阶段耗时 JSON 路径
 };
 
 namespace CsvLangPlugin {
@@ -47,6 +51,9 @@ namespace CsvLangPlugin {
  * - `column_mapping`: 列索引映射（相对 CSV 值列）；
  * - `exclude_macros`: 排除宏包裹部分；
  * - `dry_run`: 仅生成差异不写文件；
+ * - `diff_context`: 差异上下文行数（默认 3）；
+ * - `backups_dir`: 备份会话目录（默认 .csv_lang_backups/时间戳）；`disable_backups`: 不备份；
+ * - `backups_compress`: 新备份对象压缩存储（见 BackupStore）；
  * @return CsvProcessStats 处理统计（成功/跳过/失败及文件列表、日志路径、diff 路径等）
  */
 CsvProcessStats applyTranslations(const QString &projectRoot,
@@ -6,6 +6,7 @@
  * 主要用途：
  * - 解析带引号与转义的 CSV 文本；
  * - 输出行结构，支持源位置与变量名；
+ * - 底层由 Csv::MappedReader 内存映射读取，引号内允许跨行字段；
  *
  * 使用示例：
  *  QString err; auto rows = Csv::parseFile(csvPath, err);
@@ -0,0 +1,204 @@
+/**
+ * @file csv_reader.cpp
+ * @brief 内存映射 CSV 读取实现（Memory-mapped CSV reader implementation）
+ *
+ * 算法：单个状态机逐字节扫描，维护 inQuotes；引号外的逗号切分字段、换行结束记录，引号内的换行计入物理行号。
+ * GB18030 下遇到首字节（>=0x81）整体跳过其尾字节，避免把尾字节 0x5C 误认为反斜杠转义。
+ */
+#include "csv_reader.h"
+#include "text_codec.h"
+#include <QTextCodec>
+#include <climits>
+
+namespace Csv
+{
+
+    MappedReader::MappedReader(const QString &path)
+        : m_path(path), m_file(path)
+    {
+        m_fields.reserve(16);
+    }
+
+    bool MappedReader::open()
+    {
+        if (!m_file.open(QIODevice::ReadOnly))
+        {
+            m_error = QStringLiteral("无法打开CSV: %1").arg(m_path);
+            return false;
+        }
+        const qint64 size = m_file.size();
+        const char *begin = nullptr;
+        int n = 0;
+        if (size > 0 && size < qint64(INT_MAX))
+        {
+            begin = reinterpret_cast<const char *>(m_file.map(0, size));
+            n = int(size);
+        }
+        if (!begin)
+        {
+            // 映射失败（管道、特殊文件系统等）：退化为一次性读取
+            m_owned = m_file.readAll();
+            begin = m_owned.constData();
+            n = m_owned.size();
+        }
+        // 编码判定直接在映射区上进行，不复制
+        const QByteArray raw = QByteArray::fromRawData(begin, n);
+        const TextCodec::Detection d = TextCodec::detect(raw, TextCodec::Tie::Utf8);
+        m_codecName = d.codec;
+        if (d.codec.startsWith(QLatin1String("UTF-16")))
+        {
+            // UTF-16 无法按字节切分：转为 UTF-8 后再读
+            m_owned = TextCodec::decode(raw, d).toUtf8();
+            begin = m_owned.constData();
+            m_pos = begin;
+            m_end = begin + m_owned.size();
+        }
+        else
+        {
+            m_pos = begin + d.bomLength;
+            m_end = begin + n;
+            m_ascii = d.pureAscii;
+            m_gb18030 = (d.codec == QLatin1String("GB18030"));
+            if (m_gb18030)
+                m_codec = QTextCodec::codecForName("GB18030");
+        }
+        if (m_pos >= m_end)
+        {
+            m_error = QStringLiteral("无法打开CSV: %1").arg(m_path);
+            return false;
+        }
+        m_line = 1;
+        return true;
+    }
+
+    bool MappedReader::next()
+    {
+        m_fields.clear(); // Qt 5.7 起保留容量
+        if (!m_error.isEmpty() || m_pos >= m_end)
+            return false;
+        m_recordLine = m_line;
+        m_blank = true;
+        const char *p = m_pos;
+        const char *fieldStart = p;
+        bool escaped = false;
+        bool inQuotes = false;
+        while (p < m_end)
+        {
+            const uchar c = uchar(*p);
+            if (inQuotes)
+            {
+                if (c == '"')
+                {
+                    // "" 为转义引号，否则结束引号段
+                    if (p + 1 < m_end && p[1] == '"')
+                        p += 2;
+                    else
+                    {
+                        inQuotes = false;
+                        ++p;
+                    }
+                    continue;
+                }
+                if (c == '\\' && p + 1 < m_end && p[1] == '"')
+                {
+                    p += 2;
+                    continue;
+                }
+                if (c == '\n')
+                    ++m_line;
+                p += (m_gb18030 && c >= 0x81 && p + 1 < m_end) ? 2 : 1;
+                continue;
+            }
+            if (c == '\n')
+                break;
+            if (c == ',')
+            {
+                m_fields.append(FieldView{fieldStart, int(p - fieldStart), escaped});
+                fieldStart = ++p;
+                escaped = false;
+                m_blank = false;
+                continue;
+            }
+            if (c == '"')
+            {
+                inQuotes = true;
+                escaped = true;
+                m_blank = false;
+                ++p;
+                continue;
+            }
+            if (c != ' ' && c != '\t' && c != '\r' && c != '\v' && c != '\f')
+                m_blank = false;
+            p += (m_gb18030 && c >= 0x81 && p + 1 < m_end) ? 2 : 1;
+        }
+        if (inQuotes)
+        {
+            m_error = QStringLiteral("第 %1 行解析失败: 未关闭的引号").arg(m_recordLine);
+            m_fields.clear();
+            m_pos = m_end;
+            return false;
+        }
+        // 记录以 CRLF 结束时去掉 \r
+        const char *fieldEnd = p;
+        if (fieldEnd > fieldStart && fieldEnd[-1] == '\r')
+            --fieldEnd;
+        m_fields.append(FieldView{fieldStart, int(fieldEnd - fieldStart), escaped});
+        if (p < m_end)
+        {
+            ++p;
+            ++m_line;
+        }
+        m_pos = p;
+        return true;
+    }
+
+    QString MappedReader::decodeBytes(const char *p, int n) const
+    {
+        if (n <= 0)
+            return QString();
+        if (m_ascii)
+            return QString::fromLatin1(p, n);
+        if (m_codec)
+            return m_codec->toUnicode(p, n);
+        return QString::fromUtf8(p, n);
+    }
+
+    QString MappedReader::field(int i) const
+    {
+        if (i < 0 || i >= m_fields.size())
+            return QString();
+        const FieldView &v = m_fields[i];
+        if (!v.escaped)
+            return decodeBytes(v.data, v.size);
+        // 去引号并还原 "" / \" 转义；其余字节原样保留
+        QByteArray buf;
+        buf.reserve(v.size);
+        bool inQuotes = false;
+        for (int k = 0; k < v.size; ++k)
+        {
+            const uchar c = uchar(v.data[k]);
+            if (c == '"')
+            {
+                if (inQuotes && k + 1 < v.size && v.data[k + 1] == '"')
+                {
+                    buf.append('"');
+                    ++k;
+                }
+                else
+                    inQuotes = !inQuotes;
+                continue;
+            }
+            if (inQuotes && c == '\\' && k + 1 < v.size && v.data[k + 1] == '"')
+            {
+                buf.append('"');
+                ++k;
+                continue;
+            }
+            buf.append(char(c));
+            if (m_gb18030 && c >= 0x81 && k + 1 < v.size)
+                buf.append(v.data[++k]);
+        }
+        return decodeBytes(buf.constData(), buf.size());
+    }
+
+}
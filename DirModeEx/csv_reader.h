@@ -0,0 +1,94 @@
+/**
+ * @file csv_reader.h
+ * @brief 内存映射 CSV 读取接口（Memory-mapped CSV reader APIs）
+ *
+ * 功能名称：零拷贝 RFC4180 读取（Zero-copy RFC4180 reader）
+ * 主要用途：
+ * - 以 QFile::map 映射整个文件，直接在字节上切分记录与字段，不做整文件解码与按行拆分；
+ * - 引号内允许逗号与换行（跨行字段），兼容 "" 与 \" 两种引号转义；
+ * - 每条记录只产生指向映射区的字段视图，调用方按需把指定列物化为 QString；
+ * - 额外内存只与单条记录的字段数相关，与文件大小无关；
+ *
+ * 使用示例：
+ *  Csv::MappedReader r(csvPath);
+ *  if (!r.open()) return r.errorString();
+ *  while (r.next()) { if (r.isBlank()) continue; QString var = r.field(2); }
+ *  if (r.hasError()) return r.errorString();
+ */
+#ifndef CSV_READER_H
+#define CSV_READER_H
+
+#include <QString>
+#include <QByteArray>
+#include <QVector>
+#include <QFile>
+
+class QTextCodec;
+
+namespace Csv {
+
+/**
+ * @brief 字段视图（Field view into the mapping）
+ * @details data/size 指向原始字节（含引号）；escaped 表示字段内出现过引号，物化时需去引号与转义。
+ */
+struct FieldView
+{
+    const char *data{nullptr};
+    int size{0};
+    bool escaped{false};
+};
+
+/**
+ * @class MappedReader
+ * @brief 内存映射的逐记录 CSV 读取器
+ *
+ * 编码：UTF-8（含 BOM）与 GB18030 直接在映射字节上切分（分隔符与引号均不会出现在多字节序列的尾字节中）；
+ * UTF-16 文件先转为 UTF-8 后再切分。
+ */
+class MappedReader
+{
+public:
+    explicit MappedReader(const QString &path);
+
+    /** @brief 打开并映射文件；文件不存在或无内容时返回 false */
+    bool open();
+    /** @brief 前进到下一条记录；到达末尾或遇到错误时返回 false（以 hasError 区分） */
+    bool next();
+
+    int fieldCount() const { return m_fields.size(); }
+    const FieldView &view(int i) const { return m_fields[i]; }
+    /** @brief 物化第 i 列（去引号、还原转义并解码） */
+    QString field(int i) const;
+    /** @brief 当前记录起始物理行号（1 起） */
+    int lineNumber() const { return m_recordLine; }
+    /** @brief 当前记录是否为空白行（仅含空白字符） */
+    bool isBlank() const { return m_blank; }
+    /** @brief 文件物理总行数；读到末尾后有效 */
+    int lineCount() const { return m_line; }
+
+    QString codecName() const { return m_codecName; }
+    bool hasError() const { return !m_error.isEmpty(); }
+    QString errorString() const { return m_error; }
+
+private:
+    QString decodeBytes(const char *p, int n) const;
+
+    QString m_path;
+    QFile m_file;
+    QByteArray m_owned; // 映射失败或 UTF-16 转码时持有数据
+    const char *m_pos{nullptr};
+    const char *m_end{nullptr};
+    QVector<FieldView> m_fields;
+    int m_line{1};
+    int m_recordLine{0};
+    bool m_blank{true};
+    bool m_ascii{false};
+    bool m_gb18030{false};
+    QTextCodec *m_codec{nullptr};
+    QString m_codecName;
+    QString m_error;
+};
+
+}
+
+#endif // CSV_READER_H
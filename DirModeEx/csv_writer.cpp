@@ -0,0 +1,283 @@
+/**
+ * @file csv_writer.cpp
+ * @brief 流式 CSV 写出实现（Streaming CSV writer implementation）
+ *
+ * 编码：直接由 UTF-16 编码为 UTF-8 写入字节缓冲，单元格转义与编码在同一次遍历内完成，
+ * 不产生中间 QString；缓冲在整个写出过程中复用。
+ */
+#include "csv_writer.h"
+#include "perf_stats.h"
+#include "block_table.h"
+#include <QVarLengthArray>
+#include <QDir>
+#include <QFileInfo>
+
+namespace Csv
+{
+
+    StreamWriter::StreamWriter(const QString &outputPath, const WriteOptions &options)
+        : m_outputPath(outputPath), m_opts(options)
+    {
+        // 定位英文/中文列索引以用于缺失填充
+        for (int i = 0; i < m_opts.langColumns.size(); ++i)
+        {
+            const QString c = m_opts.langColumns[i].toLower();
+            if (m_idxEn < 0 && (c == QLatin1String("text_en") || c == QLatin1String("en") || c.endsWith(QLatin1String("_en")) || c.contains(QLatin1String("english"))))
+                m_idxEn = i;
+            if (m_idxCn < 0 && (c == QLatin1String("text_cn") || c == QLatin1String("cn") || c.endsWith(QLatin1String("_cn")) || c.endsWith(QLatin1String("_zh")) || c.endsWith(QLatin1String("_chs")) || c.endsWith(QLatin1String("_hans"))))
+                m_idxCn = i;
+        }
+        m_buf.reserve(m_opts.bufferBytes + 4096);
+    }
+
+    StreamWriter::~StreamWriter()
+    {
+        discard();
+    }
+
+    bool StreamWriter::open()
+    {
+        discard();
+        m_rows = 0;
+        m_part = 0;
+        m_ok = true;
+        m_files.clear();
+        return openPart();
+    }
+
+    bool StreamWriter::openPart()
+    {
+        // 前一片只刷新不提交：全部分片在 close 时一起替换目标文件
+        if (m_file)
+            m_ok = flush() && m_ok;
+        QString path = m_outputPath;
+        if (m_opts.shardRows > 0)
+        {
+            const QFileInfo fi(m_outputPath);
+            path = fi.dir().absoluteFilePath(QStringLiteral("%1_part%2.csv").arg(fi.completeBaseName()).arg(m_part + 1, 2, 10, QLatin1Char('0')));
+        }
+        std::unique_ptr<QSaveFile> part(new QSaveFile(path));
+        if (!part->open(QIODevice::WriteOnly | QIODevice::Unbuffered))
+        {
+            m_error = QStringLiteral("无法写入 CSV：%1").arg(path);
+            m_ok = false;
+            return false;
+        }
+        m_file = part.get();
+        m_parts.push_back(std::move(part));
+        ++m_part;
+        m_rowsInPart = 0;
+        m_files << path;
+        // BOM 与表头
+        m_buf.append("\xEF\xBB\xBF");
+        m_buf.append("source_file,line_number,variable_name");
+        for (const QString &c : m_opts.langColumns)
+        {
+            m_buf.append(',');
+            m_buf.append(c.toUtf8());
+        }
+        m_buf.append('\n');
+        return true;
+    }
+
+    bool StreamWriter::flush()
+    {
+        if (m_buf.isEmpty())
+            return true;
+        const bool ok = m_file->write(m_buf) == m_buf.size();
+        // 只补充字节数；耗时由调用方（writeCsv、ExtractSink）按批计时
+        PerfStats::add("csv_write", 0, m_buf.size(), 0, 0);
+        if (!ok)
+            m_error = QStringLiteral("写入失败：%1").arg(m_file->fileName());
+        m_buf.resize(0); // reserve 过的缓冲保留容量
+        return ok;
+    }
+
+    void StreamWriter::appendCell(const QStringRef &s, bool replaceComma)
+    {
+        // 规则：CRLF/LF/CR -> 字面 \n，TAB -> 字面 \t，" -> ""，可选 , -> ，（U+FF0C）
+        m_buf.append('"');
+        const QChar *p = s.unicode();
+        const int n = s.size();
+        for (int i = 0; i < n; ++i)
+        {
+            const ushort c = p[i].unicode();
+            if (c < 0x80)
+            {
+                switch (c)
+                {
+                case '\r':
+                    if (i + 1 < n && p[i + 1].unicode() == '\n')
+                        ++i;
+                    m_buf.append("\\n", 2);
+                    break;
+                case '\n':
+                    m_buf.append("\\n", 2);
+                    break;
+                case '\t':
+                    m_buf.append("\\t", 2);
+                    break;
+                case '"':
+                    m_buf.append("\"\"", 2);
+                    break;
+                case ',':
+                    if (replaceComma)
+                        m_buf.append("\xEF\xBC\x8C", 3);
+                    else
+                        m_buf.append(',');
+                    break;
+                default:
+                    m_buf.append(char(c));
+                }
+            }
+            else if (c < 0x800)
+            {
+                m_buf.append(char(0xC0 | (c >> 6)));
+                m_buf.append(char(0x80 | (c & 0x3F)));
+            }
+            else if (QChar::isHighSurrogate(c) && i + 1 < n && p[i + 1].isLowSurrogate())
+            {
+                const uint u = QChar::surrogateToUcs4(c, p[i + 1].unicode());
+                ++i;
+                m_buf.append(char(0xF0 | (u >> 18)));
+                m_buf.append(char(0x80 | ((u >> 12) & 0x3F)));
+                m_buf.append(char(0x80 | ((u >> 6) & 0x3F)));
+                m_buf.append(char(0x80 | (u & 0x3F)));
+            }
+            else if (QChar::isSurrogate(c))
+            {
+                m_buf.append("\xEF\xBF\xBD", 3); // 孤立代理项写为替换符
+            }
+            else
+            {
+                m_buf.append(char(0xE0 | (c >> 12)));
+                m_buf.append(char(0x80 | ((c >> 6) & 0x3F)));
+                m_buf.append(char(0x80 | (c & 0x3F)));
+            }
+        }
+        m_buf.append('"');
+    }
+
+    bool StreamWriter::writeRow(const QString &file, int line, const QStringRef &name, const QStringRef *strs, int count)
+    {
+        if (!m_file)
+            return false;
+        if (m_opts.shardRows > 0 && m_rowsInPart >= m_opts.shardRows && !openPart())
+            return false;
+        appendCell(QStringRef(&file), false);
+        m_buf.append(',');
+        const QString lineText = QString::number(line);
+        appendCell(QStringRef(&lineText), false);
+        m_buf.append(',');
+        appendCell(name, false);
+        for (int i = 0; i < m_opts.langColumns.size(); ++i)
+        {
+            const QStringRef *v = (i < count) ? &strs[i] : nullptr;
+            if (!v || v->isEmpty())
+            {
+                // 空值按英文/中文/首个非空值回退填充
+                const QStringRef *fill = nullptr;
+                if (m_idxEn >= 0 && m_idxEn < count && !strs[m_idxEn].isEmpty())
+                    fill = &strs[m_idxEn];
+                if (!fill && m_idxCn >= 0 && m_idxCn < count && !strs[m_idxCn].isEmpty())
+                    fill = &strs[m_idxCn];
+                for (int k = 0; !fill && k < count; ++k)
+                {
+                    if (!strs[k].isEmpty())
+                        fill = &strs[k];
+                }
+                v = fill;
+            }
+            m_buf.append(',');
+            if (v)
+                appendCell(*v, m_opts.replaceAsciiCommaWithCn);
+            else
+                m_buf.append("\"\"", 2);
+        }
+        m_buf.append('\n');
+        ++m_rows;
+        ++m_rowsInPart;
+        if (m_buf.size() >= m_opts.bufferBytes)
+            m_ok = flush() && m_ok;
+        return m_ok;
+    }
+
+    bool StreamWriter::write(const ExtractedBlock &r)
+    {
+        QVarLengthArray<QStringRef, 16> strs;
+        for (const QString &v : r.strings)
+            strs.append(QStringRef(&v));
+        return writeRow(r.sourceFile, r.lineNumber, QStringRef(&r.variableName), strs.constData(), strs.size());
+    }
+
+    bool StreamWriter::write(const BlockTable &table, int row)
+    {
+        QVarLengthArray<QStringRef, 16> strs;
+        for (int i = 0, n = table.stringCount(row); i < n; ++i)
+            strs.append(table.string(row, i));
+        return writeRow(table.sourceFile(row), table.lineNumber(row), table.variableName(row), strs.constData(), strs.size());
+    }
+
+    bool StreamWriter::write(const QList<ExtractedBlock> &rows)
+    {
+        for (const ExtractedBlock &r : rows)
+        {
+            if (!write(r))
+                return false;
+        }
+        return true;
+    }
+
+    bool StreamWriter::close()
+    {
+        if (!m_file)
+            return false;
+        m_ok = flush() && m_ok;
+        if (!m_ok)
+        {
+            discard();
+            return false;
+        }
+        for (const auto &part : m_parts)
+        {
+            if (!part->commit())
+            {
+                m_error = QStringLiteral("写入失败：%1").arg(part->fileName());
+                m_ok = false;
+            }
+        }
+        m_parts.clear();
+        m_file = nullptr;
+        if (m_ok)
+            removeStaleParts();
+        return m_ok;
+    }
+
+    void StreamWriter::discard()
+    {
+        for (const auto &part : m_parts)
+            part->cancelWriting();
+        m_parts.clear(); // 未提交的 QSaveFile 析构时删除临时文件
+        m_file = nullptr;
+        m_buf.resize(0);
+    }
+
+    void StreamWriter::removeStaleParts()
+    {
+        // 上次分片更多（或本次未分片）时，删除不属于本次输出的 <name>_partNN.csv
+        const QFileInfo fi(m_outputPath);
+        const QDir dir = fi.dir();
+        const QString prefix = fi.completeBaseName() + QStringLiteral("_part");
+        for (const QString &name : dir.entryList({prefix + QStringLiteral("*.csv")}, QDir::Files))
+        {
+            const QStringRef digits = name.midRef(prefix.size(), name.size() - prefix.size() - 4);
+            bool numeric = !digits.isEmpty();
+            for (const QChar c : digits)
+                numeric = numeric && c.isDigit();
+            const QString path = dir.absoluteFilePath(name);
+            if (numeric && !m_files.contains(path))
+                QFile::remove(path);
+        }
+    }
+
+}
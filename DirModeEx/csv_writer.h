@@ -0,0 +1,97 @@
+/**
+ * @file csv_writer.h
+ * @brief 流式 CSV 写出接口（Streaming CSV writer APIs）
+ *
+ * 功能名称：提取结果流式写出（Streaming writer for extracted blocks）
+ * 主要用途：
+ * - 边提取边写：逐批接收 ExtractedBlock，直接编码进可复用的 UTF-8 字节缓冲，缓冲满后整块写盘；
+ * - 峰值内存只与缓冲大小相关，不随行数增长；
+ * - 分片为显式选项：shardRows>0 时按行数切分为 `<name>_partNN.csv`，每片均带 BOM 与表头；
+ * - 各片先写入临时文件（QSaveFile），close 成功时才整体替换目标文件；失败或中途放弃时原输出保持不变；
+ *
+ * 使用示例：
+ *  Csv::WriteOptions o; o.langColumns = cols; o.shardRows = 0;
+ *  Csv::StreamWriter w(outCsv, o);
+ *  if (w.open()) { w.write(blocks); w.close(); }
+ */
+#ifndef CSV_WRITER_H
+#define CSV_WRITER_H
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QSaveFile>
+#include <memory>
+#include <vector>
+#include "text_extractor.h"
+
+class BlockTable;
+
+namespace Csv {
+
+/**
+ * @brief 写出选项（Writer options）
+ */
+struct WriteOptions
+{
+    QStringList langColumns;           // 语言列顺序（表头第 4 列起）
+    QStringList literalColumns;        // 直写列（与 writeCsv 签名保持一致，当前所有列均直写）
+    bool replaceAsciiCommaWithCn{true}; // 语言列内英文逗号替换为全角逗号
+    int shardRows{0};                  // 每片最大行数；0 表示不分片
+    int bufferBytes{1 << 20};          // 写盘缓冲阈值
+};
+
+/**
+ * @class StreamWriter
+ * @brief 流式 CSV 写出器（UTF-8 BOM，RFC4180 引号转义，换行/制表符写为字面 \n/\t）
+ *
+ * 缺失值按 英文列→中文列→首个非空值 回退填充，与历史 writeCsv 行为一致。
+ */
+class StreamWriter
+{
+public:
+    StreamWriter(const QString &outputPath, const WriteOptions &options);
+    ~StreamWriter();
+
+    /** @brief 打开首个输出文件并写表头 */
+    bool open();
+    /** @brief 追加一行 */
+    bool write(const ExtractedBlock &row);
+    /** @brief 追加块表中的一行（不生成中间 ExtractedBlock） */
+    bool write(const BlockTable &table, int row);
+    /** @brief 追加一批行 */
+    bool write(const QList<ExtractedBlock> &rows);
+    /** @brief 刷新缓冲并提交全部分片（替换目标文件，清理上次遗留的多余分片）；返回整个写出过程是否成功 */
+    bool close();
+    /** @brief 放弃本次写出：丢弃临时文件，目标文件保持原样（析构时未 close 亦同） */
+    void discard();
+
+    int rowsWritten() const { return m_rows; }
+    QStringList writtenFiles() const { return m_files; }
+    QString errorString() const { return m_error; }
+
+private:
+    bool openPart();
+    bool flush();
+    void removeStaleParts();
+    bool writeRow(const QString &file, int line, const QStringRef &name, const QStringRef *strs, int count);
+    void appendCell(const QStringRef &s, bool replaceComma);
+
+    QString m_outputPath;
+    WriteOptions m_opts;
+    std::vector<std::unique_ptr<QSaveFile>> m_parts; // 已打开、尚未提交的分片
+    QSaveFile *m_file{nullptr};                      // 当前分片
+    QByteArray m_buf;
+    int m_idxEn{-1};
+    int m_idxCn{-1};
+    int m_rows{0};
+    int m_rowsInPart{0};
+    int m_part{0};
+    bool m_ok{true};
+    QStringList m_files;
+    QString m_error;
+};
+
+}
+
+#endif // CSV_WRITER_H
@@ -3,72 +3,325 @@
  * @brief 差异工具实现（Unified diff implementation）
  *
  * 生成统一 diff 文本，保留文件标头，按增删改行输出 hunk；
- * 算法：双列表遍历，遇到相同行时尽量合并上下文；其余以 -/+ 记录。
+ * 算法：
+ * - 预过滤：去掉公共前缀/后缀；剩余行按内容映射为整数编号，只在一侧出现的行必然是增删，直接标记；
+ * - 其余行以 Myers O(ND) 线性空间二分（middle snake）求最短编辑脚本；
+ * - 按上下文行数合并相邻改动，生成带正确行号区间的 @@ 标头。
  */
 #include "diff_utils.h"
-#include <QStringList>
+#include "perf_stats.h"
+#include <QHash>
+#include <QVector>
+#include <QStringRef>
 
 namespace DiffUtils
 {
 
-    static QStringList splitLines(const QString &s)
+    namespace
     {
-        return s.split(QLatin1String("\n"), Qt::KeepEmptyParts);
+        // 单次二分允许的最大编辑距离，超出时该子区间整体视为替换，避免病态输入耗时过长
+        const int kMaxBisectCost = 4096;
+
+        struct MyersDiff
+        {
+            const int *a;
+            const int *b;
+            char *delA; // a 中被删除的行
+            char *insB; // b 中被插入的行
+            QVector<int> v1;
+            QVector<int> v2;
+
+            void markAll(int aLo, int aHi, int bLo, int bHi)
+            {
+                for (int i = aLo; i < aHi; ++i)
+                    delA[i] = 1;
+                for (int j = bLo; j < bHi; ++j)
+                    insB[j] = 1;
+            }
+
+            // 对 a[aLo,aHi) 与 b[bLo,bHi) 求编辑脚本
+            void run(int aLo, int aHi, int bLo, int bHi)
+            {
+                // 去掉公共前缀/后缀
+                while (aLo < aHi && bLo < bHi && a[aLo] == b[bLo])
+                {
+                    ++aLo;
+                    ++bLo;
+                }
+                while (aLo < aHi && bLo < bHi && a[aHi - 1] == b[bHi - 1])
+                {
+                    --aHi;
+                    --bHi;
+                }
+                if (aLo == aHi || bLo == bHi)
+                {
+                    markAll(aLo, aHi, bLo, bHi);
+                    return;
+                }
+                int x = 0, y = 0;
+                if (!bisect(aLo, aHi, bLo, bHi, x, y))
+                {
+                    markAll(aLo, aHi, bLo, bHi);
+                    return;
+                }
+                run(aLo, x, bLo, y);
+                run(x, aHi, y, bHi);
+            }
+
+            // 双向同时推进，找到前后路径重叠的中间蛇；成功时返回分割点 (x, y)
+            bool bisect(int aLo, int aHi, int bLo, int bHi, int &sx, int &sy)
+            {
+                const int n = aHi - aLo;
+                const int m = bHi - bLo;
+                const int maxD = qMin((n + m + 1) / 2, kMaxBisectCost);
+                const int offset = maxD + 1;
+                const int len = 2 * offset + 1;
+                v1.fill(-1, len);
+                v2.fill(-1, len);
+                v1[offset + 1] = 0;
+                v2[offset + 1] = 0;
+                const int delta = n - m;
+                const bool front = (delta % 2) != 0;
+                int k1start = 0, k1end = 0, k2start = 0, k2end = 0;
+                for (int d = 0; d < maxD; ++d)
+                {
+                    // 正向
+                    for (int k1 = -d + k1start; k1 <= d - k1end; k1 += 2)
+                    {
+                        const int k1o = offset + k1;
+                        int x1 = (k1 == -d || (k1 != d && v1[k1o - 1] < v1[k1o + 1])) ? v1[k1o + 1] : v1[k1o - 1] + 1;
+                        int y1 = x1 - k1;
+                        while (x1 < n && y1 < m && a[aLo + x1] == b[bLo + y1])
+                        {
+                            ++x1;
+                            ++y1;
+                        }
+                        v1[k1o] = x1;
+                        if (x1 > n)
+                            k1end += 2;
+                        else if (y1 > m)
+                            k1start += 2;
+                        else if (front)
+                        {
+                            const int k2o = offset + delta - k1;
+                            if (k2o >= 0 && k2o < len && v2[k2o] != -1 && x1 >= n - v2[k2o])
+                            {
+                                sx = aLo + x1;
+                                sy = bLo + y1;
+                                return true;
+                            }
+                        }
+                    }
+                    // 反向
+                    for (int k2 = -d + k2start; k2 <= d - k2end; k2 += 2)
+                    {
+                        const int k2o = offset + k2;
+                        int x2 = (k2 == -d || (k2 != d && v2[k2o - 1] < v2[k2o + 1])) ? v2[k2o + 1] : v2[k2o - 1] + 1;
+                        int y2 = x2 - k2;
+                        while (x2 < n && y2 < m && a[aHi - 1 - x2] == b[bHi - 1 - y2])
+                        {
+                            ++x2;
+                            ++y2;
+                        }
+                        v2[k2o] = x2;
+                        if (x2 > n)
+                            k2end += 2;
+                        else if (y2 > m)
+                            k2start += 2;
+                        else if (!front)
+                        {
+                            const int k1o = offset + delta - k2;
+                            if (k1o >= 0 && k1o < len && v1[k1o] != -1)
+                            {
+                                const int x1 = v1[k1o];
+                                const int y1 = offset + x1 - k1o;
+                                if (x1 >= n - x2)
+                                {
+                                    sx = aLo + x1;
+                                    sy = bLo + y1;
+                                    return true;
+                                }
+                            }
+                        }
+                    }
+                }
+                return false;
+            }
+        };
+
+        struct Op
+        {
+            char tag; // ' ' / '-' / '+'
+            int ai;   // 该操作前已消费的 a 行数
+            int bi;   // 该操作前已消费的 b 行数
+        };
     }
 
     /**
      * @brief 生成统一 diff 文本
-     * 规则：输出头（---/+++），遍历两序列，拼接 -/+ 行；连续相同行作为上下文；每段以 @@ 标头给出范围。
+     * 规则：输出头（---/+++）；改动间距不超过 2×context 的合并为一个 hunk；
+     * 标头行号为 1 起始，区间长度为 0 时起始行取其前一行（与 GNU diff 一致）。
      */
-    QString unifiedDiff(const QString &filePath, const QString &original, const QString &modified)
+    QString unifiedDiff(const QString &filePath, const QString &original, const QString &modified, int context)
     {
-        QStringList a = splitLines(original);
-        QStringList b = splitLines(modified);
+        if (context < 0)
+            context = 0;
+        PerfStats::Timer timer("diff");
+        const QVector<QStringRef> a = original.splitRef(QLatin1Char('\n'), Qt::KeepEmptyParts);
+        const QVector<QStringRef> b = modified.splitRef(QLatin1Char('\n'), Qt::KeepEmptyParts);
+        const int n = a.size();
+        const int m = b.size();
+        timer.addBytes(original.size() + modified.size());
+        timer.addItems(n + m);
         QString out;
         out += QStringLiteral("--- %1\n").arg(filePath);
         out += QStringLiteral("+++ %1\n").arg(filePath);
-        int i = 0, j = 0;
-        int hunkStartA = 0, hunkStartB = 0;
-        QStringList hunk;
-        auto flush = [&]()
-        {
-            if (hunk.isEmpty())
-                return;
-            int lenA = i - hunkStartA;
-            int lenB = j - hunkStartB;
-            out += QStringLiteral("@@ -%1,%2 +%3,%4 @@\n").arg(hunkStartA + 1).arg(lenA).arg(hunkStartB + 1).arg(lenB);
-            out += hunk.join(QLatin1String("\n")) + QStringLiteral("\n");
-            hunk.clear();
+
+        // 步骤1：公共前缀/后缀直接比较字符串，近似相同的大文件在此即完成大部分工作
+        int pre = 0;
+        while (pre < n && pre < m && a[pre] == b[pre])
+            ++pre;
+        int suf = 0;
+        while (suf < n - pre && suf < m - pre && a[n - 1 - suf] == b[m - 1 - suf])
+            ++suf;
+        if (pre == n && pre == m)
+            return out;
+
+        // 步骤2：中段行按内容编号；只在一侧出现的行必为增删，不参与 Myers
+        QHash<QStringRef, int> ids;
+        QVector<int> idA(n - pre - suf), idB(m - pre - suf);
+        QVector<int> countA, countB;
+        auto intern = [&](const QStringRef &s) {
+            auto it = ids.constFind(s);
+            if (it != ids.constEnd())
+                return it.value();
+            const int id = ids.size();
+            ids.insert(s, id);
+            countA.append(0);
+            countB.append(0);
+            return id;
         };
-        while (i < a.size() || j < b.size())
+        for (int i = 0; i < idA.size(); ++i)
+        {
+            idA[i] = intern(a[pre + i]);
+            ++countA[idA[i]];
+        }
+        for (int j = 0; j < idB.size(); ++j)
         {
-            if (i < a.size() && j < b.size() && a[i] == b[j])
+            idB[j] = intern(b[pre + j]);
+            ++countB[idB[j]];
+        }
+        QVector<char> delA(n, 0), insB(m, 0);
+        QVector<int> redA, redB, mapA, mapB; // 参与 Myers 的行及其在原序列中的下标
+        for (int i = 0; i < idA.size(); ++i)
+        {
+            if (countB[idA[i]] == 0)
+                delA[pre + i] = 1;
+            else
             {
-                if (!hunk.isEmpty() && hunk.size() < 3)
-                    hunk << QStringLiteral(" ") + a[i];
-                else
-                    flush();
-                hunkStartA = i + 1;
-                hunkStartB = j + 1;
-                i++;
-                j++;
+                redA.append(idA[i]);
+                mapA.append(pre + i);
             }
+        }
+        for (int j = 0; j < idB.size(); ++j)
+        {
+            if (countA[idB[j]] == 0)
+                insB[pre + j] = 1;
             else
             {
-                if (i < a.size())
+                redB.append(idB[j]);
+                mapB.append(pre + j);
+            }
+        }
+
+        // 步骤3：Myers 求最短编辑脚本并映射回原行号
+        {
+            QVector<char> rDel(redA.size(), 0), rIns(redB.size(), 0);
+            MyersDiff md{redA.constData(), redB.constData(), rDel.data(), rIns.data(), {}, {}};
+            md.run(0, redA.size(), 0, redB.size());
+            for (int i = 0; i < rDel.size(); ++i)
+                if (rDel[i])
+                    delA[mapA[i]] = 1;
+            for (int j = 0; j < rIns.size(); ++j)
+                if (rIns[j])
+                    insB[mapB[j]] = 1;
+        }
+
+        // 步骤4：生成操作序列（同一改动组内先删后增）
+        QVector<Op> ops;
+        ops.reserve(n + m);
+        {
+            int i = 0, j = 0;
+            while (i < n || j < m)
+            {
+                if (i < n && delA[i])
                 {
-                    hunk << QStringLiteral("-") + a[i];
-                    i++;
+                    ops.append(Op{'-', i, j});
+                    ++i;
                 }
-                if (j < b.size())
+                else if (j < m && insB[j])
                 {
-                    hunk << QStringLiteral("+") + b[j];
-                    j++;
+                    ops.append(Op{'+', i, j});
+                    ++j;
                 }
+                else
+                {
+                    ops.append(Op{' ', i, j});
+                    ++i;
+                    ++j;
+                }
+            }
+        }
+
+        // 步骤5：按上下文合并改动为 hunk
+        const int total = ops.size();
+        int k = 0;
+        while (k < total)
+        {
+            while (k < total && ops[k].tag == ' ')
+                ++k;
+            if (k >= total)
+                break;
+            const int start = qMax(0, k - context);
+            int lastChange = k;
+            int scan = k + 1;
+            while (scan < total)
+            {
+                if (ops[scan].tag != ' ')
+                {
+                    lastChange = scan;
+                    ++scan;
+                    continue;
+                }
+                if (scan - lastChange > 2 * context)
+                    break;
+                ++scan;
+            }
+            const int end = qMin(total, lastChange + context + 1);
+            int lenA = 0, lenB = 0;
+            for (int t = start; t < end; ++t)
+            {
+                if (ops[t].tag != '+')
+                    ++lenA;
+                if (ops[t].tag != '-')
+                    ++lenB;
+            }
+            const int startA = lenA ? ops[start].ai + 1 : ops[start].ai;
+            const int startB = lenB ? ops[start].bi + 1 : ops[start].bi;
+            out += QStringLiteral("@@ -%1,%2 +%3,%4 @@\n").arg(startA).arg(lenA).arg(startB).arg(lenB);
+            for (int t = start; t < end; ++t)
+            {
+                const Op &op = ops[t];
+                out += QLatin1Char(op.tag);
+                if (op.tag == '+')
+                    out += b[op.bi];
+                else
+                    out += a[op.ai];
+                out += QLatin1Char('\n');
             }
+            k = end;
         }
-        flush();
         return out;
     }
 
-}
\ No newline at end of file
+}
@@ -5,6 +5,7 @@
  * 功能名称：生成统一 diff（Generate unified diffs）
  * 主要用途：
  * - 对单文件的原始与修改内容生成统一格式差异文本；
+ * - Myers O(ND) 最短编辑脚本，公共前后缀与单侧独有行先行过滤，近似相同的大文件接近线性；
  *
  * 使用示例：
  *  QString d = DiffUtils::unifiedDiff(path, orig, mod);
@@ -21,9 +22,10 @@ namespace DiffUtils {
  * @param filePath 文件路径（用于标头显示）
  * @param original 原始文本
  * @param modified 修改后文本
- * @return 统一 diff 文本
+ * @param context 每个 hunk 前后保留的上下文行数
+ * @return 统一 diff 文本；无差异时仅含文件标头
  */
-QString unifiedDiff(const QString &filePath, const QString &original, const QString &modified);
+QString unifiedDiff(const QString &filePath, const QString &original, const QString &modified, int context = 3);
 
 }
 
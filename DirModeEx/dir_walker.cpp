@@ -0,0 +1,393 @@
+/**
+ * @file dir_walker.cpp
+ * @brief 目录遍历实现（Shared directory walker implementation）
+ *
+ * 按层并发：当前层的全部目录交给 QtConcurrent 同时列举（entryInfoList 顺带完成 stat），
+ * 文件与子目录分别先过排除规则，被排除的目录不再进入；整层完成后再处理下一层，最后统一按路径排序，
+ * 结果与线程调度无关。
+ */
+#include "dir_walker.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QTextStream>
+#include <QtConcurrent>
+#include <algorithm>
+#include <memory>
+
+namespace
+{
+    // 文件系统大小写：Windows 不敏感
+    QRegularExpression::PatternOptions caseOptions()
+    {
+#ifdef Q_OS_WIN
+        return QRegularExpression::CaseInsensitiveOption;
+#else
+        return QRegularExpression::NoPatternOption;
+#endif
+    }
+
+    QString globToRegex(const QString &glob)
+    {
+        QString rx;
+        const int n = glob.size();
+        for (int i = 0; i < n; ++i)
+        {
+            const QChar c = glob.at(i);
+            if (c == QLatin1Char('*'))
+            {
+                if (i + 1 < n && glob.at(i + 1) == QLatin1Char('*'))
+                {
+                    ++i;
+                    if (i + 1 < n && glob.at(i + 1) == QLatin1Char('/'))
+                    {
+                        ++i;
+                        rx += QStringLiteral("(?:.*/)?"); // **/ 匹配零或多层目录
+                    }
+                    else
+                    {
+                        rx += QStringLiteral(".*");
+                    }
+                }
+                else
+                {
+                    rx += QStringLiteral("[^/]*");
+                }
+            }
+            else if (c == QLatin1Char('?'))
+            {
+                rx += QStringLiteral("[^/]");
+            }
+            else if (c == QLatin1Char('['))
+            {
+                const int close = glob.indexOf(QLatin1Char(']'), i + 2);
+                if (close < 0)
+                {
+                    rx += QStringLiteral("\\[");
+                    continue;
+                }
+                QString set = glob.mid(i + 1, close - i - 1);
+                if (set.startsWith(QLatin1Char('!')))
+                    set[0] = QLatin1Char('^');
+                set.replace(QLatin1Char('\\'), QStringLiteral("\\\\"));
+                rx += QLatin1Char('[') + set + QLatin1Char(']');
+                i = close;
+            }
+            else if (c == QLatin1Char('\\') && i + 1 < n)
+            {
+                rx += QRegularExpression::escape(QString(glob.at(++i)));
+            }
+            else
+            {
+                rx += QRegularExpression::escape(QString(c));
+            }
+        }
+        return QLatin1Char('^') + rx + QLatin1Char('$');
+    }
+
+    struct DirResult
+    {
+        QVector<DirWalker::Entry> files;
+        QStringList dirs;
+    };
+
+    struct ListDirFn
+    {
+        typedef DirResult result_type;
+        QString base;
+        const DirWalker::IgnoreRules *rules;
+        DirResult operator()(const QString &dir) const
+        {
+            DirResult out;
+            // 不含 QDir::Hidden：与 QDirIterator 默认一致，跳过隐藏文件与目录
+            const QFileInfoList infos = QDir(dir).entryInfoList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot, QDir::Unsorted);
+            for (const QFileInfo &fi : infos)
+            {
+                const QString path = fi.filePath();
+                const QString rel = path.mid(base.size() + (base.endsWith(QLatin1Char('/')) ? 0 : 1));
+                const bool isDir = fi.isDir();
+                if (rules && rules->isIgnored(rel, isDir))
+                    continue;
+                if (isDir)
+                {
+                    // 不跟随目录符号链接，避免环路
+                    if (!fi.isSymLink())
+                        out.dirs << path;
+                    continue;
+                }
+                DirWalker::Entry e;
+                e.path = path;
+                e.size = fi.size();
+                e.mtime = fi.lastModified().toMSecsSinceEpoch();
+                out.files.append(e);
+            }
+            return out;
+        }
+    };
+
+    bool isDefault(const DirWalker::Options &o)
+    {
+        return o.ignore.isEmpty() && o.defaultIgnores && o.ignoreFile;
+    }
+
+    DirWalker::Listing walkTree(const QString &root, const DirWalker::Options &options)
+    {
+        DirWalker::Listing out;
+        const QString base = QDir(root).path();
+        out.root = base;
+        if (!QFileInfo(base).isDir())
+            return out;
+        DirWalker::IgnoreRules rules;
+        if (options.defaultIgnores)
+            rules.add(DirWalker::defaultIgnoreRules());
+        if (options.ignoreFile)
+            rules.loadFile(QDir(base).absoluteFilePath(DirWalker::ignoreFileName()));
+        rules.add(options.ignore);
+        const ListDirFn listFn{base, rules.isEmpty() ? nullptr : &rules};
+
+        QStringList level{base};
+        while (!level.isEmpty())
+        {
+            // 单个目录时直接在本线程列举，省去调度开销
+            const QList<DirResult> results = level.size() == 1 ? QList<DirResult>{listFn(level.first())}
+                                                               : QtConcurrent::blockingMapped<QList<DirResult>>(level, listFn);
+            QStringList next;
+            for (const DirResult &r : results)
+            {
+                out.files += r.files;
+                next += r.dirs;
+            }
+            out.dirs += next;
+            level = next;
+        }
+        std::sort(out.files.begin(), out.files.end(), [](const DirWalker::Entry &a, const DirWalker::Entry &b) { return a.path < b.path; });
+        out.dirs.sort();
+        return out;
+    }
+
+    QString scopeKey(const QString &root)
+    {
+        return QDir(root).absolutePath();
+    }
+
+    struct ScopeSlot
+    {
+        int refs{0};
+        std::shared_ptr<const DirWalker::Listing> listing;
+    };
+
+    QMutex &scopeLock()
+    {
+        static QMutex m;
+        return m;
+    }
+
+    QHash<QString, ScopeSlot> &scopes()
+    {
+        static QHash<QString, ScopeSlot> s;
+        return s;
+    }
+
+    // 作用域内取共享遍历结果；不在作用域内时返回空指针
+    std::shared_ptr<const DirWalker::Listing> scopedListing(const QString &root)
+    {
+        const QString key = scopeKey(root);
+        {
+            QMutexLocker lock(&scopeLock());
+            auto it = scopes().find(key);
+            if (it == scopes().end())
+                return nullptr;
+            if (it->listing)
+                return it->listing;
+        }
+        // 遍历在锁外进行；并发首次请求时各自遍历，先写入者生效
+        auto listing = std::make_shared<const DirWalker::Listing>(walkTree(root, DirWalker::Options()));
+        QMutexLocker lock(&scopeLock());
+        auto it = scopes().find(key);
+        if (it == scopes().end())
+            return listing;
+        if (!it->listing)
+            it->listing = listing;
+        return it->listing;
+    }
+
+    QStringList normalizedExts(const QStringList &extensions)
+    {
+        QStringList exts;
+        for (const QString &e : extensions)
+        {
+            if (!e.trimmed().isEmpty())
+                exts << e.trimmed().toLower();
+        }
+        return exts;
+    }
+
+    bool matchesExt(const QString &path, const QStringList &exts)
+    {
+        if (exts.isEmpty())
+            return true;
+        for (const QString &e : exts)
+        {
+            if (path.endsWith(e, Qt::CaseInsensitive))
+                return true;
+        }
+        return false;
+    }
+}
+
+namespace DirWalker
+{
+
+    QString ignoreFileName()
+    {
+        return QStringLiteral(".dirmakeignore");
+    }
+
+    QStringList defaultIgnoreRules()
+    {
+        return QStringList{QStringLiteral("build*/"),
+                           QStringLiteral(".csv_lang_backups/"),
+                           QStringLiteral(".lang_init_backups/"),
+                           QStringLiteral(".lang_fill_eng_backups/"),
+                           QStringLiteral("csv_import_sandbox/"),
+                           QStringLiteral(".csv_lang_cache/"),
+                           QStringLiteral(".git/")};
+    }
+
+    void IgnoreRules::add(const QString &line)
+    {
+        QString p = line;
+        // 行尾空白忽略（转义的空格除外）
+        while (p.endsWith(QLatin1Char(' ')) && !p.endsWith(QStringLiteral("\\ ")))
+            p.chop(1);
+        if (p.isEmpty() || p.startsWith(QLatin1Char('#')))
+            return;
+        Rule r;
+        if (p.startsWith(QLatin1Char('!')))
+        {
+            r.negate = true;
+            p.remove(0, 1);
+        }
+        else if (p.startsWith(QStringLiteral("\\!")) || p.startsWith(QStringLiteral("\\#")))
+        {
+            p.remove(0, 1);
+        }
+        if (p.endsWith(QLatin1Char('/')))
+        {
+            r.dirOnly = true;
+            p.chop(1);
+        }
+        // 开头或中间有 / 的规则相对根目录锚定
+        r.anchored = p.contains(QLatin1Char('/'));
+        if (p.startsWith(QLatin1Char('/')))
+            p.remove(0, 1);
+        if (p.isEmpty())
+            return;
+        r.re = QRegularExpression(globToRegex(p), caseOptions());
+        if (!r.re.isValid())
+            return;
+        m_rules.append(r);
+    }
+
+    void IgnoreRules::add(const QStringList &lines)
+    {
+        for (const QString &l : lines)
+            add(l);
+    }
+
+    bool IgnoreRules::loadFile(const QString &path)
+    {
+        QFile f(path);
+        if (!f.open(QIODevice::ReadOnly | QIODevice::Text))
+            return false;
+        QTextStream ts(&f);
+        ts.setCodec("UTF-8");
+        while (!ts.atEnd())
+            add(ts.readLine());
+        return true;
+    }
+
+    bool IgnoreRules::isIgnored(const QString &relPath, bool isDir) const
+    {
+        const QString name = relPath.mid(relPath.lastIndexOf(QLatin1Char('/')) + 1);
+        bool ignored = false;
+        for (const Rule &r : m_rules)
+        {
+            if (r.dirOnly && !isDir)
+                continue;
+            if (r.re.match(r.anchored ? relPath : name).hasMatch())
+                ignored = !r.negate;
+        }
+        return ignored;
+    }
+
+    Listing walk(const QString &root, const Options &options)
+    {
+        if (isDefault(options))
+        {
+            if (std::shared_ptr<const Listing> listing = scopedListing(root))
+            {
+                Listing out = *listing;
+                const QString base = QDir(root).path();
+                if (out.root != base)
+                {
+                    for (Entry &e : out.files)
+                        e.path = base + e.path.mid(listing->root.size());
+                    for (QString &d : out.dirs)
+                        d = base + d.mid(listing->root.size());
+                    out.root = base;
+                }
+                return out;
+            }
+        }
+        return walkTree(root, options);
+    }
+
+    QVector<Entry> collectEntries(const QString &root, const QStringList &extensions, const Options &options)
+    {
+        const QStringList exts = normalizedExts(extensions);
+        std::shared_ptr<const Listing> listing = isDefault(options) ? scopedListing(root) : nullptr;
+        if (!listing)
+            listing = std::make_shared<const Listing>(walk(root, options));
+        // 共享结果可能来自同一目录的另一种写法（相对/绝对、分隔符），按本次根目录改写前缀
+        const QString base = QDir(root).path();
+        const bool rebase = listing->root != base;
+        QVector<Entry> out;
+        for (const Entry &e : listing->files)
+        {
+            if (!matchesExt(e.path, exts))
+                continue;
+            out.append(e);
+            if (rebase)
+                out.last().path = base + e.path.mid(listing->root.size());
+        }
+        return out;
+    }
+
+    QStringList collect(const QString &root, const QStringList &extensions, const Options &options)
+    {
+        QStringList out;
+        for (const Entry &e : collectEntries(root, extensions, options))
+            out << e.path;
+        return out;
+    }
+
+    Scope::Scope(const QString &root)
+        : m_key(scopeKey(root))
+    {
+        QMutexLocker lock(&scopeLock());
+        ++scopes()[m_key].refs;
+    }
+
+    Scope::~Scope()
+    {
+        QMutexLocker lock(&scopeLock());
+        auto it = scopes().find(m_key);
+        if (it != scopes().end() && --it->refs <= 0)
+            scopes().erase(it);
+    }
+
+}
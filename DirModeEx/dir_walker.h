@@ -0,0 +1,130 @@
+/**
+ * @file dir_walker.h
+ * @brief 目录遍历接口（Shared directory walker APIs）
+ *
+ * 功能名称：统一的源文件遍历（One walker for every pass）
+ * 主要用途：
+ * - 提取、语言列发现、包含目录、缓存与布局指纹、语言初始化等各处共用同一遍历；
+ * - 在目录层面剪枝：build*、.csv_lang_backups、csv_import_sandbox、.csv_lang_cache 等不再进入；
+ * - 支持 .gitignore 语法的排除规则：调用方传入，或写在项目根的 .dirmakeignore；
+ * - 同一层的目录并发列举与 stat，大小与修改时间随结果返回，指纹计算无需再次 stat；
+ * - Scope 存活期间，同一根目录的多次收集复用一次遍历（一次提取的各阶段共享文件列表）；
+ *
+ * 使用示例：
+ *  DirWalker::Scope scope(root);   // 本次提取内只遍历一次
+ *  const QStringList files = DirWalker::collect(root, {".c", ".h"});
+ *  const auto headers = DirWalker::collectEntries(root, {".h"});   // 带 size/mtime
+ */
+#ifndef DIR_WALKER_H
+#define DIR_WALKER_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QRegularExpression>
+
+namespace DirWalker {
+
+/** @brief 项目根目录下的排除规则文件名（.gitignore 语法） */
+QString ignoreFileName();
+
+/** @brief 默认排除规则（build* 目录与工具自身的备份、沙箱、缓存目录等） */
+QStringList defaultIgnoreRules();
+
+/**
+ * @class IgnoreRules
+ * @brief .gitignore 语法子集（Subset of .gitignore syntax）
+ *
+ * 支持：空行与 # 注释、! 取反、结尾 / 仅匹配目录、含 / 的规则相对根目录锚定、
+ * 不含 / 的规则匹配任意层级的名称、* ? [...] 与 **；后出现的规则优先。
+ * 被排除目录下的文件无法再被 ! 规则找回（与 git 一致，目录已被剪枝）。
+ */
+class IgnoreRules
+{
+public:
+    void add(const QString &line);
+    void add(const QStringList &lines);
+    /** @brief 读取规则文件；不存在时返回 false */
+    bool loadFile(const QString &path);
+    /**
+     * @brief 判断相对路径是否被排除
+     * @param relPath 相对根目录、以 / 分隔的路径
+     * @param isDir 是否为目录
+     */
+    bool isIgnored(const QString &relPath, bool isDir) const;
+    bool isEmpty() const { return m_rules.isEmpty(); }
+
+private:
+    struct Rule
+    {
+        QRegularExpression re;
+        bool negate{false};
+        bool dirOnly{false};
+        bool anchored{false};
+    };
+    QVector<Rule> m_rules;
+};
+
+/**
+ * @brief 遍历选项（Walk options）
+ */
+struct Options
+{
+    QStringList ignore;         // 额外排除规则（追加在默认规则与规则文件之后）
+    bool defaultIgnores{true};  // 是否应用 defaultIgnoreRules()
+    bool ignoreFile{true};      // 是否读取根目录的 ignoreFileName()
+};
+
+struct Entry
+{
+    QString path;     // 以根目录为前缀、/ 分隔
+    qint64 size{0};
+    qint64 mtime{0};  // 毫秒时间戳
+};
+
+/**
+ * @brief 一次遍历的结果（Walk result）
+ */
+struct Listing
+{
+    QString root;         // 路径前缀（QDir(root).path()）
+    QVector<Entry> files; // 全部未排除的文件，按路径排序
+    QStringList dirs;     // 进入过的子目录（不含根目录），按路径排序
+};
+
+/**
+ * @brief 遍历根目录（不跟随符号链接，跳过隐藏项，与此前 QDirIterator 行为一致）
+ */
+Listing walk(const QString &root, const Options &options = Options());
+
+/**
+ * @brief 收集扩展名匹配的文件（大小写不敏感），按路径排序
+ * @param extensions 扩展名列表，如 ".c"；为空时返回全部文件
+ */
+QStringList collect(const QString &root, const QStringList &extensions, const Options &options = Options());
+
+/** @brief 同 collect，附带大小与修改时间 */
+QVector<Entry> collectEntries(const QString &root, const QStringList &extensions, const Options &options = Options());
+
+/**
+ * @class Scope
+ * @brief 共享遍历作用域（Share one walk per root while alive）
+ *
+ * 作用域内以默认选项对同一根目录的 walk/collect 只遍历一次，之后按扩展名过滤同一份结果；
+ * 可嵌套、可跨线程使用。作用域内新增的文件不会被看到，应只包住一次提取的准备阶段。
+ */
+class Scope
+{
+public:
+    explicit Scope(const QString &root);
+    ~Scope();
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+private:
+    QString m_key;
+};
+
+}
+
+#endif // DIR_WALKER_H
@@ -0,0 +1,371 @@
+/**
+ * @file extract_cache.cpp
+ * @brief 增量提取缓存实现（Incremental extraction cache implementation）
+ *
+ * 文件格式（QDataStream，Qt_5_12）：
+ *   magic(quint32) version(quint32) params(QString) count(quint32)
+ *   count × { relPath(QString) size(qint64) mtime(qint64) hash(quint64) payload(QByteArray) }
+ * 命中判定：大小与修改时间一致直接命中；否则读取内容计算 FNV-1a 64 哈希，一致则命中并刷新时间。
+ * 未命中时文件只读一次：同一份字节既计算哈希又交给提取函数解码，记录的哈希与结果必然对应。
+ */
+#include "extract_cache.h"
+#include "dir_walker.h"
+#include "perf_stats.h"
+#include "block_table.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDataStream>
+#include <QSaveFile>
+#include <QCryptographicHash>
+#include <QMutexLocker>
+#include <QVarLengthArray>
+#include <QtEndian>
+
+namespace
+{
+    const quint32 kCacheMagic = 0x43534C43; // 'CSLC'
+    // 提取逻辑或序列化格式变化时递增，旧缓存自动失效
+    // v2：effective 预处理改为保留行号
+    // v3：相邻字面量拼接，支持八进制与 \u/\U 转义
+    // v4：转义规则与字符串池统一（\x 读全部十六进制位，未知转义保留反斜杠）
+    const quint32 kCacheVersion = 4;
+
+    quint64 fnv1a64(const QByteArray &data)
+    {
+        quint64 h = 1469598103934665603ULL;
+        const uchar *p = reinterpret_cast<const uchar *>(data.constData());
+        for (int i = 0, n = data.size(); i < n; ++i)
+        {
+            h ^= p[i];
+            h *= 1099511628211ULL;
+        }
+        return h;
+    }
+
+    QByteArray encodeBlocks(const QList<ExtractedBlock> &blocks)
+    {
+        QByteArray out;
+        QDataStream ds(&out, QIODevice::WriteOnly);
+        ds.setVersion(QDataStream::Qt_5_12);
+        ds << quint32(blocks.size());
+        for (const ExtractedBlock &b : blocks)
+            ds << b.variableName << b.strings << b.sourceFile << qint32(b.lineNumber);
+        return out;
+    }
+
+    bool decodeBlocks(const QByteArray &data, QList<ExtractedBlock> &blocks)
+    {
+        QDataStream ds(data);
+        ds.setVersion(QDataStream::Qt_5_12);
+        quint32 n = 0;
+        ds >> n;
+        blocks.clear();
+        blocks.reserve(int(n));
+        for (quint32 i = 0; i < n && ds.status() == QDataStream::Ok; ++i)
+        {
+            ExtractedBlock b;
+            qint32 line = 0;
+            ds >> b.variableName >> b.strings >> b.sourceFile >> line;
+            b.lineNumber = line;
+            blocks.append(b);
+        }
+        return ds.status() == QDataStream::Ok;
+    }
+
+    // 块表与列表共用同一载荷格式：字符串按 QDataStream 的 QString 布局（字节长度 + 大端 UTF-16）直接读写字符区
+    void writeRef(QDataStream &ds, const QStringRef &s)
+    {
+        ds << quint32(s.size() * 2);
+        if (s.isEmpty())
+            return;
+        QVarLengthArray<quint16, 256> be(s.size());
+        qToBigEndian<quint16>(s.unicode(), s.size(), be.data());
+        ds.writeRawData(reinterpret_cast<const char *>(be.constData()), s.size() * 2);
+    }
+
+    bool readInto(QDataStream &ds, QString &arena)
+    {
+        quint32 bytes = 0;
+        ds >> bytes;
+        if (ds.status() != QDataStream::Ok)
+            return false;
+        if (bytes == 0xFFFFFFFFu || bytes == 0)
+            return true;
+        if (bytes & 1u)
+            return false;
+        const int chars = int(bytes / 2);
+        const int at = arena.size();
+        arena.resize(at + chars);
+        ushort *dst = reinterpret_cast<ushort *>(arena.data() + at);
+        if (ds.readRawData(reinterpret_cast<char *>(dst), int(bytes)) != int(bytes))
+            return false;
+        qFromBigEndian<quint16>(dst, chars, dst);
+        return true;
+    }
+
+    QByteArray encodeTable(const BlockTable &t)
+    {
+        QByteArray out;
+        QDataStream ds(&out, QIODevice::WriteOnly);
+        ds.setVersion(QDataStream::Qt_5_12);
+        ds << quint32(t.size());
+        for (int i = 0; i < t.size(); ++i)
+        {
+            writeRef(ds, t.variableName(i));
+            ds << quint32(t.stringCount(i));
+            for (int s = 0; s < t.stringCount(i); ++s)
+                writeRef(ds, t.string(i, s));
+            ds << t.sourceFile(i) << qint32(t.lineNumber(i));
+        }
+        return out;
+    }
+
+    bool decodeTable(const QByteArray &data, BlockTable &t)
+    {
+        QDataStream ds(data);
+        ds.setVersion(QDataStream::Qt_5_12);
+        quint32 n = 0;
+        ds >> n;
+        t.clear();
+        QString name;
+        QString file;
+        for (quint32 i = 0; i < n && ds.status() == QDataStream::Ok; ++i)
+        {
+            ds >> name;
+            quint32 strings = 0;
+            ds >> strings;
+            if (ds.status() != QDataStream::Ok)
+                return false;
+            // 行号与文件在字符串之后，先占位，读完再回填
+            t.beginBlock(0, 0, name);
+            for (quint32 s = 0; s < strings; ++s)
+            {
+                if (!readInto(ds, t.arena()))
+                    return false;
+                t.endString();
+            }
+            qint32 line = 0;
+            ds >> file >> line;
+            t.setLocation(t.size() - 1, t.internFile(file), line);
+        }
+        return ds.status() == QDataStream::Ok;
+    }
+
+    QByteArray encodeArrays(const QList<ExtractedArray> &arrays)
+    {
+        QByteArray out;
+        QDataStream ds(&out, QIODevice::WriteOnly);
+        ds.setVersion(QDataStream::Qt_5_12);
+        ds << quint32(arrays.size());
+        for (const ExtractedArray &a : arrays)
+            ds << a.arrayName << a.sourceFile << qint32(a.lineNumber) << a.elements;
+        return out;
+    }
+
+    bool decodeArrays(const QByteArray &data, QList<ExtractedArray> &arrays)
+    {
+        QDataStream ds(data);
+        ds.setVersion(QDataStream::Qt_5_12);
+        quint32 n = 0;
+        ds >> n;
+        arrays.clear();
+        arrays.reserve(int(n));
+        for (quint32 i = 0; i < n && ds.status() == QDataStream::Ok; ++i)
+        {
+            ExtractedArray a;
+            qint32 line = 0;
+            ds >> a.arrayName >> a.sourceFile >> line >> a.elements;
+            a.lineNumber = line;
+            arrays.append(a);
+        }
+        return ds.status() == QDataStream::Ok;
+    }
+
+    // 项目头文件的 路径+大小+修改时间 指纹：跟随包含时任一头文件变化即整体失效
+    QString headersFingerprint(const QString &root)
+    {
+        QByteArray acc;
+        // 遍历时已取得大小与修改时间，无需逐个再 stat
+        for (const DirWalker::Entry &h : DirWalker::collectEntries(root, QStringList{QStringLiteral(".h"), QStringLiteral(".hpp")}))
+        {
+            acc += h.path.toUtf8();
+            acc += QByteArray::number(h.size);
+            acc += QByteArray::number(h.mtime);
+        }
+        return QString::number(fnv1a64(acc), 16);
+    }
+}
+
+ExtractCache::ExtractCache(const QString &root, const QString &kind, const QString &mode,
+                           const QMap<QString, QString> &defines, const QString &typeName, bool preserveEscapes)
+    : m_root(QDir(root).absolutePath())
+{
+    // 参数串：QMap 按键有序，保证同一组宏定义得到同一缓存文件
+    QStringList defs;
+    for (auto it = defines.constBegin(); it != defines.constEnd(); ++it)
+        defs << it.key() + QLatin1Char('=') + it.value();
+    m_params = QStringLiteral("%1|%2|%3|%4|%5").arg(kind, mode, typeName, preserveEscapes ? QStringLiteral("1") : QStringLiteral("0"), defs.join(QLatin1Char(';')));
+    const QByteArray digest = QCryptographicHash::hash(m_params.toUtf8(), QCryptographicHash::Md5).toHex().left(12);
+    m_cacheFile = QDir(m_root).absoluteFilePath(QStringLiteral(".csv_lang_cache/%1_%2.bin").arg(kind, QString::fromLatin1(digest)));
+    // 头文件指纹不参与文件名，只参与参数校验，避免每次改头文件都遗留旧缓存文件
+    if (TextExtractor::followsIncludes(mode))
+        m_params += QLatin1Char('|') + headersFingerprint(m_root);
+}
+
+bool ExtractCache::load()
+{
+    m_loaded.clear();
+    QFile f(m_cacheFile);
+    if (!f.open(QIODevice::ReadOnly))
+        return false;
+    QDataStream ds(&f);
+    ds.setVersion(QDataStream::Qt_5_12);
+    quint32 magic = 0, version = 0, count = 0;
+    QString params;
+    ds >> magic >> version >> params >> count;
+    if (ds.status() != QDataStream::Ok || magic != kCacheMagic || version != kCacheVersion || params != m_params)
+        return false;
+    m_loaded.reserve(int(count));
+    for (quint32 i = 0; i < count; ++i)
+    {
+        QString rel;
+        Entry e;
+        ds >> rel >> e.size >> e.mtime >> e.hash >> e.payload;
+        if (ds.status() != QDataStream::Ok)
+        {
+            // 截断或损坏：丢弃全部，按冷启动处理
+            m_loaded.clear();
+            return false;
+        }
+        m_loaded.insert(rel, e);
+    }
+    return true;
+}
+
+bool ExtractCache::save()
+{
+    QDir().mkpath(QFileInfo(m_cacheFile).absolutePath());
+    QSaveFile f(m_cacheFile);
+    if (!f.open(QIODevice::WriteOnly))
+        return false;
+    QDataStream ds(&f);
+    ds.setVersion(QDataStream::Qt_5_12);
+    QMutexLocker lock(&m_mutex);
+    ds << kCacheMagic << kCacheVersion << m_params << quint32(m_current.size());
+    for (auto it = m_current.constBegin(); it != m_current.constEnd(); ++it)
+        ds << it.key() << it.value().size << it.value().mtime << it.value().hash << it.value().payload;
+    return f.commit();
+}
+
+bool ExtractCache::lookup(const QString &path, QByteArray &payload, Entry &probe, QByteArray &content)
+{
+    const QFileInfo fi(path);
+    probe.size = fi.size();
+    probe.mtime = fi.lastModified().toMSecsSinceEpoch();
+    probe.hash = 0;
+    const QString rel = QDir(m_root).relativeFilePath(fi.absoluteFilePath());
+    auto it = m_loaded.constFind(rel);
+    if (it == m_loaded.constEnd() || it->size != probe.size)
+        return false;
+    Entry hit = *it;
+    if (it->mtime != probe.mtime)
+    {
+        // 时间变化（如检出/touch）：以内容哈希确认是否真正修改；未命中时这份内容直接交给提取
+        if (!readContent(path, content, probe))
+            return false;
+        if (probe.hash != it->hash)
+            return false;
+        hit.mtime = probe.mtime;
+    }
+    payload = hit.payload;
+    QMutexLocker lock(&m_mutex);
+    m_current.insert(rel, hit);
+    return true;
+}
+
+bool ExtractCache::readContent(const QString &path, QByteArray &content, Entry &probe)
+{
+    if (probe.hash != 0)
+        return true; // 命中判定时已读过
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly))
+        return false;
+    content = f.readAll();
+    probe.size = content.size();
+    probe.hash = fnv1a64(content);
+    return true;
+}
+
+void ExtractCache::store(const QString &path, Entry probe, const QByteArray &payload)
+{
+    probe.payload = payload;
+    const QString rel = QDir(m_root).relativeFilePath(QFileInfo(path).absoluteFilePath());
+    QMutexLocker lock(&m_mutex);
+    m_current.insert(rel, probe);
+}
+
+QList<ExtractedBlock> ExtractCache::blocks(const QString &path, const std::function<QList<ExtractedBlock>(const QByteArray *)> &compute)
+{
+    QByteArray payload;
+    QByteArray content;
+    Entry probe;
+    QList<ExtractedBlock> out;
+    if (lookup(path, payload, probe, content) && decodeBlocks(payload, out))
+    {
+        m_hits.fetchAndAddRelaxed(1);
+        PerfStats::count("cache_hit");
+        return out;
+    }
+    m_misses.fetchAndAddRelaxed(1);
+    PerfStats::count("cache_miss");
+    // 哈希与提取使用同一份字节，避免提取后二次读取时文件已变
+    if (!readContent(path, content, probe))
+        return compute(nullptr);
+    out = compute(&content);
+    store(path, probe, encodeBlocks(out));
+    return out;
+}
+
+BlockTable ExtractCache::table(const QString &path, const std::function<BlockTable(const QByteArray *)> &compute)
+{
+    QByteArray payload;
+    QByteArray content;
+    Entry probe;
+    BlockTable out;
+    if (lookup(path, payload, probe, content) && decodeTable(payload, out))
+    {
+        m_hits.fetchAndAddRelaxed(1);
+        PerfStats::count("cache_hit");
+        return out;
+    }
+    m_misses.fetchAndAddRelaxed(1);
+    PerfStats::count("cache_miss");
+    if (!readContent(path, content, probe))
+        return compute(nullptr);
+    out = compute(&content);
+    store(path, probe, encodeTable(out));
+    return out;
+}
+
+QList<ExtractedArray> ExtractCache::arrays(const QString &path, const std::function<QList<ExtractedArray>(const QByteArray *)> &compute)
+{
+    QByteArray payload;
+    QByteArray content;
+    Entry probe;
+    QList<ExtractedArray> out;
+    if (lookup(path, payload, probe, content) && decodeArrays(payload, out))
+    {
+        m_hits.fetchAndAddRelaxed(1);
+        PerfStats::count("cache_hit");
+        return out;
+    }
+    m_misses.fetchAndAddRelaxed(1);
+    PerfStats::count("cache_miss");
+    if (!readContent(path, content, probe))
+        return compute(nullptr);
+    out = compute(&content);
+    store(path, probe, encodeArrays(out));
+    return out;
+}
@@ -0,0 +1,106 @@
+/**
+ * @file extract_cache.h
+ * @brief 增量提取缓存接口（Incremental extraction cache APIs）
+ *
+ * 功能名称：按文件缓存提取结果（Per-file extraction result cache）
+ * 主要用途：
+ * - 将每个源文件的 ExtractedBlock/ExtractedArray 结果持久化到 `<root>/.csv_lang_cache/`；
+ * - 以 路径+大小+修改时间 快速判定命中，时间变化时再以内容哈希确认，仅重新解析真正改动的文件；
+ * - 缓存文件按 种类+提取参数（mode/defines/typeName/preserveEscapes）区分，切换参数互不覆盖；
+ * - effective_includes 模式另校验项目头文件指纹，头文件改动后结果整体重算；
+ *
+ * 使用示例：
+ *  ExtractCache cache(root, "blocks", mode, defines, typeName, keepEsc);
+ *  cache.load();
+ *  auto rows = cache.blocks(path, [&](const QByteArray *bytes) { return TextExtractor::extractFile(path, mode, defines, typeName, keepEsc, nullptr, bytes); });
+ *  cache.save();
+ *
+ * 线程安全：load/save 须在单线程调用；blocks/arrays 可在 QtConcurrent 工作线程并发调用。
+ */
+#ifndef EXTRACT_CACHE_H
+#define EXTRACT_CACHE_H
+
+#include <QString>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QAtomicInt>
+#include <functional>
+#include "text_extractor.h"
+#include "block_table.h"
+
+class ExtractCache
+{
+public:
+    /**
+     * @brief 构造缓存（Construct cache for a root/kind/parameter set）
+     * @param root 项目根目录（缓存目录位于 root/.csv_lang_cache）
+     * @param kind 结果种类，如 blocks/arrays/disp
+     * @param mode 解析模式
+     * @param defines 宏定义
+     * @param typeName 结构体类型名
+     * @param preserveEscapes 是否保留转义
+     */
+    ExtractCache(const QString &root, const QString &kind, const QString &mode,
+                 const QMap<QString, QString> &defines, const QString &typeName, bool preserveEscapes);
+
+    /**
+     * @brief 载入缓存文件；不存在、版本或参数不符时视为空缓存
+     * @return 是否成功载入已有缓存
+     */
+    bool load();
+
+    /**
+     * @brief 写回缓存（仅保留本轮访问过的文件，自动清理已删除文件）
+     * @return 是否写入成功
+     */
+    bool save();
+
+    /**
+     * @brief 取单文件结构体块结果，未命中时调用 compute 并记录
+     * @param path 源文件绝对路径
+     * @param compute 实际提取函数；参数为缓存已读入并计算哈希的文件字节（读取失败时为空，由提取函数自行读取）
+     */
+    QList<ExtractedBlock> blocks(const QString &path, const std::function<QList<ExtractedBlock>(const QByteArray *)> &compute);
+
+    /**
+     * @brief 同 blocks，结果为列式块表；与 blocks 共用同一载荷格式
+     */
+    BlockTable table(const QString &path, const std::function<BlockTable(const QByteArray *)> &compute);
+
+    /**
+     * @brief 取单文件数组结果，未命中时调用 compute 并记录
+     */
+    QList<ExtractedArray> arrays(const QString &path, const std::function<QList<ExtractedArray>(const QByteArray *)> &compute);
+
+    /** @brief 缓存文件路径（Cache file path） */
+    QString cacheFilePath() const { return m_cacheFile; }
+    /** @brief 本轮命中文件数（Hit count） */
+    int hitCount() const { return m_hits.loadAcquire(); }
+    /** @brief 本轮未命中文件数（Miss count） */
+    int missCount() const { return m_misses.loadAcquire(); }
+
+private:
+    struct Entry
+    {
+        qint64 size{0};
+        qint64 mtime{0};
+        quint64 hash{0};
+        QByteArray payload; // 序列化后的提取结果
+    };
+
+    bool lookup(const QString &path, QByteArray &payload, Entry &probe, QByteArray &content);
+    bool readContent(const QString &path, QByteArray &content, Entry &probe);
+    void store(const QString &path, Entry probe, const QByteArray &payload);
+
+    QString m_root;
+    QString m_cacheFile;
+    QString m_params;
+    QHash<QString, Entry> m_loaded; // 载入后只读，可并发查找
+    QHash<QString, Entry> m_current;
+    QMutex m_mutex;
+    QAtomicInt m_hits{0};
+    QAtomicInt m_misses{0};
+};
+
+#endif // EXTRACT_CACHE_H
@@ -0,0 +1,435 @@
+/**
+ * @file extract_results_model.cpp
+ * @brief 提取结果表模型实现（Virtualised extract results model implementation）
+ *
+ * 合并：归约线程把块编码进待合并缓冲，界面线程每 100ms 取走整批，追加到字节区并一次 beginInsertRows；
+ * 筛选视图下新行就地判定后追加到视图末尾，排序视图则标记过期，提取结束后补排。
+ * 匹配直接在 UTF-8 字节上做：只折叠 ASCII 大小写，多字节字符按字节精确比较，不会跨字符误命中。
+ * 文本列按字节序排序，即 Unicode 码点序。
+ */
+#include "extract_results_model.h"
+#include <QDir>
+#include <QTimer>
+#include <QtConcurrent>
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    // 字节区上限：偏移为 u32，且 Qt5 的 QByteArray 不超过 2GB
+    const qint64 kMaxArenaBytes = qint64(1) << 30;
+
+    inline char foldAscii(char c)
+    {
+        return (c >= 'A' && c <= 'Z') ? char(c + ('a' - 'A')) : c;
+    }
+
+    QByteArray foldAscii(const QByteArray &bytes)
+    {
+        QByteArray out = bytes;
+        for (int i = 0; i < out.size(); ++i)
+            out[i] = foldAscii(out.at(i));
+        return out;
+    }
+
+    // needle 已折叠
+    bool containsFolded(const char *hay, int n, const QByteArray &needle)
+    {
+        const int m = needle.size();
+        if (m == 0)
+            return true;
+        const char *p = needle.constData();
+        for (int i = 0; i + m <= n; ++i)
+        {
+            if (foldAscii(hay[i]) != p[0])
+                continue;
+            int k = 1;
+            while (k < m && foldAscii(hay[i + k]) == p[k])
+                ++k;
+            if (k == m)
+                return true;
+        }
+        return false;
+    }
+
+    void appendField(QByteArray &bytes, QVector<quint32> &ends, const QString &text)
+    {
+        bytes += text.toUtf8();
+        ends.append(quint32(bytes.size()));
+    }
+}
+
+ExtractResultsModel::ExtractResultsModel(QObject *parent)
+    : QAbstractTableModel(parent)
+{
+    m_flushTimer = new QTimer(this);
+    m_flushTimer->setInterval(100);
+    connect(m_flushTimer, &QTimer::timeout, this, [this] { flushPending(); });
+    connect(&m_watcher, &QFutureWatcher<ViewResult>::finished, this, [this] { onViewReady(); });
+}
+
+ExtractResultsModel::~ExtractResultsModel()
+{
+    // 后台任务持有 this，析构前须等待结束
+    m_watcher.waitForFinished();
+}
+
+quint64 ExtractResultsModel::reset(const QStringList &langColumns, const QString &root)
+{
+    if (m_jobRunning)
+        m_watcher.waitForFinished();
+    m_jobRunning = false;
+    m_rebuildPending = false;
+    beginResetModel();
+    m_langColumns = langColumns;
+    m_fields = 1 + langColumns.size();
+    m_root = root;
+    m_arena = QByteArray();
+    m_ends = QVector<quint32>();
+    m_fileOf = QVector<int>();
+    m_lineOf = QVector<qint32>();
+    m_files.clear();
+    m_filePaths.clear();
+    m_fileKeys.clear();
+    m_fileIndex.clear();
+    m_view = QVector<int>();
+    m_viewActive = !m_needle.isEmpty() || m_sortColumn >= 0;
+    m_sortStale = false;
+    quint64 generation = 0;
+    {
+        QMutexLocker lock(&m_pendingLock);
+        m_pending = Pending();
+        m_committedRows = 0;
+        m_committedBytes = 0;
+        m_dropped = 0;
+        generation = ++m_generation;
+    }
+    endResetModel();
+    m_live = true;
+    m_flushTimer->start();
+    emit viewChanged();
+    return generation;
+}
+
+void ExtractResultsModel::enqueue(quint64 generation, const QList<ExtractedBlock> &blocks)
+{
+    if (blocks.isEmpty())
+        return;
+    QMutexLocker lock(&m_pendingLock);
+    if (generation != m_generation)
+        return;
+    // 同代号的 reset 已在加锁前写好列数
+    const int langs = m_fields - 1;
+    for (const ExtractedBlock &b : blocks)
+    {
+        const int rows = m_committedRows + m_pending.lines.size();
+        if ((m_rowLimit > 0 && rows >= m_rowLimit) || m_committedBytes + m_pending.bytes.size() >= kMaxArenaBytes)
+        {
+            ++m_dropped;
+            continue;
+        }
+        appendField(m_pending.bytes, m_pending.ends, b.variableName);
+        for (int l = 0; l < langs; ++l)
+            appendField(m_pending.bytes, m_pending.ends, l < b.strings.size() ? b.strings.at(l) : QString());
+        m_pending.files.append(b.sourceFile);
+        m_pending.lines.append(b.lineNumber);
+    }
+}
+
+void ExtractResultsModel::finish()
+{
+    m_live = false;
+    m_flushTimer->stop();
+    flushPending();
+    if (m_sortStale)
+        startRebuild();
+    emit viewChanged();
+}
+
+int ExtractResultsModel::internFile(const QString &path)
+{
+    auto it = m_fileIndex.constFind(path);
+    if (it != m_fileIndex.constEnd())
+        return it.value();
+    const QString rel = m_root.isEmpty() ? path : QDir(m_root).relativeFilePath(path);
+    const int idx = m_files.size();
+    m_files.append(rel);
+    m_filePaths.append(QDir::toNativeSeparators(path));
+    m_fileKeys.append(foldAscii(rel.toUtf8()));
+    m_fileIndex.insert(path, idx);
+    return idx;
+}
+
+void ExtractResultsModel::flushPending()
+{
+    // 后台任务正在读取存储：本批留待任务结束后合并
+    if (m_jobRunning)
+        return;
+    Pending batch;
+    {
+        QMutexLocker lock(&m_pendingLock);
+        if (m_pending.lines.isEmpty())
+            return;
+        std::swap(batch, m_pending);
+    }
+    const int first = m_lineOf.size();
+    const int added = batch.lines.size();
+    if (!m_viewActive)
+        beginInsertRows(QModelIndex(), first, first + added - 1);
+    const quint32 base = quint32(m_arena.size());
+    m_arena.append(batch.bytes);
+    m_ends.reserve(m_ends.size() + batch.ends.size());
+    for (quint32 e : batch.ends)
+        m_ends.append(base + e);
+    m_fileOf.reserve(first + added);
+    m_lineOf.reserve(first + added);
+    for (int i = 0; i < added; ++i)
+    {
+        m_fileOf.append(internFile(batch.files.at(i)));
+        m_lineOf.append(batch.lines.at(i));
+    }
+    {
+        QMutexLocker lock(&m_pendingLock);
+        m_committedRows = m_lineOf.size();
+        m_committedBytes = m_arena.size();
+    }
+    if (!m_viewActive)
+    {
+        endInsertRows();
+    }
+    else
+    {
+        // 筛选视图：新行就地判定；排序视图暂追加在末尾，稍后补排
+        QVector<int> accepted;
+        for (int r = first; r < first + added; ++r)
+        {
+            if (rowMatches(r, m_needle))
+                accepted.append(r);
+        }
+        if (!accepted.isEmpty())
+        {
+            beginInsertRows(QModelIndex(), m_view.size(), m_view.size() + accepted.size() - 1);
+            m_view += accepted;
+            endInsertRows();
+        }
+        if (m_sortColumn >= 0)
+            m_sortStale = true;
+    }
+    emit viewChanged();
+}
+
+void ExtractResultsModel::setFilterText(const QString &text)
+{
+    const QByteArray needle = foldAscii(text.trimmed().toUtf8());
+    if (needle == m_needle)
+        return;
+    m_needle = needle;
+    startRebuild();
+}
+
+void ExtractResultsModel::sort(int column, Qt::SortOrder order)
+{
+    if (column >= columnCount())
+        column = -1;
+    if (column == m_sortColumn && order == m_sortOrder && !m_sortStale)
+        return;
+    m_sortColumn = column;
+    m_sortOrder = order;
+    startRebuild();
+}
+
+void ExtractResultsModel::startRebuild()
+{
+    if (m_jobRunning)
+    {
+        m_rebuildPending = true;
+        return;
+    }
+    flushPending();
+    if (m_needle.isEmpty() && m_sortColumn < 0)
+    {
+        // 无筛选无排序：回到按存储顺序直出，释放排列
+        if (m_viewActive)
+        {
+            beginResetModel();
+            m_view = QVector<int>();
+            m_viewActive = false;
+            endResetModel();
+        }
+        m_sortStale = false;
+        emit viewChanged();
+        return;
+    }
+    m_jobRunning = true;
+    const quint64 generation = m_generation;
+    const int rows = m_lineOf.size();
+    const QByteArray needle = m_needle;
+    const int column = m_sortColumn;
+    const Qt::SortOrder order = m_sortOrder;
+    m_watcher.setFuture(QtConcurrent::run([this, generation, rows, needle, column, order] {
+        return computeView(generation, rows, needle, column, order);
+    }));
+    emit viewChanged();
+}
+
+void ExtractResultsModel::onViewReady()
+{
+    m_jobRunning = false;
+    const ViewResult result = m_watcher.result();
+    if (m_rebuildPending)
+    {
+        // 计算期间条件又变：丢弃本次结果，按最新条件重算
+        m_rebuildPending = false;
+        startRebuild();
+        return;
+    }
+    if (result.generation == m_generation)
+    {
+        beginResetModel();
+        m_view = result.rows;
+        m_viewActive = true;
+        m_sortStale = false;
+        endResetModel();
+    }
+    flushPending();
+    if (!m_live && m_sortStale)
+        startRebuild();
+    emit viewChanged();
+}
+
+ExtractResultsModel::ViewResult ExtractResultsModel::computeView(quint64 generation, int rows, const QByteArray &needle,
+                                                                 int column, Qt::SortOrder order) const
+{
+    ViewResult out;
+    out.generation = generation;
+    out.rows.reserve(needle.isEmpty() ? rows : qMin(rows, 4096));
+    for (int r = 0; r < rows; ++r)
+    {
+        if (needle.isEmpty() || rowMatches(r, needle))
+            out.rows.append(r);
+    }
+    if (column >= 0)
+    {
+        // 文件列按相对路径排序：先给去重后的文件排名，比较时只比整数
+        QVector<int> fileRank;
+        if (column == 0)
+        {
+            QVector<int> byName(m_files.size());
+            for (int i = 0; i < byName.size(); ++i)
+                byName[i] = i;
+            std::sort(byName.begin(), byName.end(), [this](int a, int b) { return m_files.at(a) < m_files.at(b); });
+            fileRank.resize(byName.size());
+            for (int i = 0; i < byName.size(); ++i)
+                fileRank[byName.at(i)] = i;
+        }
+        std::stable_sort(out.rows.begin(), out.rows.end(), [&](int a, int b) {
+            const int c = compareRows(a, b, column, fileRank);
+            return order == Qt::AscendingOrder ? c < 0 : c > 0;
+        });
+    }
+    return out;
+}
+
+bool ExtractResultsModel::rowMatches(int row, const QByteArray &needle) const
+{
+    if (needle.isEmpty())
+        return true;
+    const int g0 = row * m_fields;
+    quint32 begin = g0 == 0 ? 0 : m_ends.at(g0 - 1);
+    for (int f = 0; f < m_fields; ++f)
+    {
+        const quint32 end = m_ends.at(g0 + f);
+        if (containsFolded(m_arena.constData() + begin, int(end - begin), needle))
+            return true;
+        begin = end;
+    }
+    const QByteArray &file = m_fileKeys.at(m_fileOf.at(row));
+    return containsFolded(file.constData(), file.size(), needle);
+}
+
+int ExtractResultsModel::compareRows(int a, int b, int column, const QVector<int> &fileRank) const
+{
+    if (column == 0)
+    {
+        const int c = fileRank.at(m_fileOf.at(a)) - fileRank.at(m_fileOf.at(b));
+        return c != 0 ? c : m_lineOf.at(a) - m_lineOf.at(b);
+    }
+    if (column == 1)
+        return m_lineOf.at(a) - m_lineOf.at(b);
+    const int f = column - 2;
+    const int ga = a * m_fields + f;
+    const int gb = b * m_fields + f;
+    const quint32 sa = ga == 0 ? 0 : m_ends.at(ga - 1);
+    const quint32 sb = gb == 0 ? 0 : m_ends.at(gb - 1);
+    const int na = int(m_ends.at(ga) - sa);
+    const int nb = int(m_ends.at(gb) - sb);
+    const int c = std::memcmp(m_arena.constData() + sa, m_arena.constData() + sb, size_t(qMin(na, nb)));
+    return c != 0 ? c : na - nb;
+}
+
+QString ExtractResultsModel::field(int row, int f) const
+{
+    const int g = row * m_fields + f;
+    const quint32 begin = g == 0 ? 0 : m_ends.at(g - 1);
+    return QString::fromUtf8(m_arena.constData() + begin, int(m_ends.at(g) - begin));
+}
+
+int ExtractResultsModel::droppedRows() const
+{
+    QMutexLocker lock(&m_pendingLock);
+    return m_dropped;
+}
+
+qint64 ExtractResultsModel::memoryBytes() const
+{
+    return qint64(m_arena.capacity()) + qint64(m_ends.capacity()) * 4 + qint64(m_fileOf.capacity() + m_lineOf.capacity()) * 4
+           + qint64(m_view.capacity()) * 4;
+}
+
+int ExtractResultsModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return m_viewActive ? m_view.size() : m_lineOf.size();
+}
+
+int ExtractResultsModel::columnCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return 2 + m_fields;
+}
+
+QVariant ExtractResultsModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= rowCount())
+        return QVariant();
+    const int row = storageRow(index.row());
+    const int column = index.column();
+    if (role == Qt::TextAlignmentRole)
+        return column == 1 ? QVariant(int(Qt::AlignRight | Qt::AlignVCenter)) : QVariant();
+    if (role != Qt::DisplayRole && role != Qt::ToolTipRole)
+        return QVariant();
+    if (column == 0)
+    {
+        const int file = m_fileOf.at(row);
+        return role == Qt::ToolTipRole ? m_filePaths.at(file) : m_files.at(file);
+    }
+    if (column == 1)
+        return m_lineOf.at(row);
+    return field(row, column - 2);
+}
+
+QVariant ExtractResultsModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+        return QAbstractTableModel::headerData(section, orientation, role);
+    if (section == 0)
+        return QStringLiteral("文件");
+    if (section == 1)
+        return QStringLiteral("行号");
+    if (section == 2)
+        return QStringLiteral("变量名");
+    const int lang = section - 3;
+    return lang >= 0 && lang < m_langColumns.size() ? QVariant(m_langColumns.at(lang)) : QVariant();
+}
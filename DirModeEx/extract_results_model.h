@@ -0,0 +1,155 @@
+/**
+ * @file extract_results_model.h
+ * @brief 提取结果表模型接口（Virtualised extract results model APIs）
+ *
+ * 功能名称：提取结果浏览（Browse extracted strings in the main window）
+ * 主要用途：
+ * - 并发提取的归约阶段把保留下来的块增量追加到模型，界面定时批量插入，边提取边浏览；
+ * - 列式存储：变量名与各语言文本按 UTF-8 连续写入一块字节区，每个字段只记一个 u32 结束偏移，
+ *   文件路径按下标去重，仅在 data() 被视图请求时才生成 QString；
+ * - 筛选与排序在后台线程对行号排列计算，完成后一次性替换，界面线程不做全表扫描；
+ *
+ * 使用示例：
+ *  auto *model = new ExtractResultsModel(this);
+ *  const quint64 gen = model->reset(langCols, root);
+ *  sink->observer = [model, gen](const QList<ExtractedBlock> &rows) { model->enqueue(gen, rows); };
+ *  ...
+ *  model->finish();
+ *  model->setFilterText("确定");
+ */
+#ifndef EXTRACT_RESULTS_MODEL_H
+#define EXTRACT_RESULTS_MODEL_H
+
+#include <QAbstractTableModel>
+#include <QFutureWatcher>
+#include <QMutex>
+#include <QHash>
+#include <QVector>
+#include <QStringList>
+#include "text_extractor.h"
+
+class QTimer;
+
+/**
+ * @class ExtractResultsModel
+ * @brief 提取结果的只读表模型（Read-only, append-only table model）
+ *
+ * 列：文件（相对根目录）、行号、变量名、各语言列。
+ * 线程：enqueue 可在任意线程调用（只写待合并缓冲），其余接口仅限界面线程。
+ * 后台筛选/排序运行期间暂停合并，保证工作线程读取的存储不被改动。
+ */
+class ExtractResultsModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    explicit ExtractResultsModel(QObject *parent = nullptr);
+    ~ExtractResultsModel() override;
+
+    /**
+     * @brief 清空结果并按语言列重建表头，开始接收新一轮提取
+     * @param langColumns 语言列（与写出 CSV 的列一致）
+     * @param root 文件列显示为相对该目录的路径
+     * @return 本轮代号，enqueue 时传回，用于丢弃上一轮残留的结果
+     */
+    quint64 reset(const QStringList &langColumns, const QString &root);
+
+    /**
+     * @brief 追加一批结果（任意线程；在归约中调用，此处只做 UTF-8 编码）
+     * @param generation reset 返回的代号，不符时忽略
+     */
+    void enqueue(quint64 generation, const QList<ExtractedBlock> &blocks);
+
+    /**
+     * @brief 本轮提取结束：合并剩余结果，并补做提取期间追加行导致的过期排序
+     */
+    void finish();
+
+    /**
+     * @brief 设置筛选文本：匹配变量名、任一语言文本或文件名（ASCII 忽略大小写）；空串取消筛选
+     */
+    void setFilterText(const QString &text);
+
+    /** @brief 后台筛选/排序是否在运行 */
+    bool isBusy() const { return m_jobRunning; }
+    /** @brief 已存入的总行数（不受筛选影响） */
+    int storedRows() const { return m_lineOf.size(); }
+    /** @brief 超出上限未存入的行数 */
+    int droppedRows() const;
+    /** @brief 存储占用的近似字节数 */
+    qint64 memoryBytes() const;
+    /** @brief 最多存入的行数，超出部分只计数（0 不限） */
+    void setRowLimit(int rows) { m_rowLimit = rows; }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+signals:
+    /** @brief 行数、筛选或忙碌状态变化（供状态标签刷新） */
+    void viewChanged();
+
+private:
+    // 待合并的一批行：字段结束偏移相对 bytes 起始
+    struct Pending
+    {
+        QByteArray bytes;
+        QVector<quint32> ends;
+        QStringList files;
+        QVector<qint32> lines;
+    };
+    struct ViewResult
+    {
+        quint64 generation{0};
+        QVector<int> rows;
+    };
+
+    void flushPending();
+    void startRebuild();
+    void onViewReady();
+    int internFile(const QString &path);
+    int storageRow(int viewRow) const { return m_viewActive ? m_view.at(viewRow) : viewRow; }
+    QString field(int row, int f) const;
+    bool rowMatches(int row, const QByteArray &needle) const;
+    int compareRows(int a, int b, int column, const QVector<int> &fileRank) const;
+    ViewResult computeView(quint64 generation, int rows, const QByteArray &needle, int column, Qt::SortOrder order) const;
+
+    // 列式存储（仅界面线程写入；后台任务运行时只读）
+    QStringList m_langColumns;
+    int m_fields{1};                 // 每行字段数：变量名 + 各语言
+    QByteArray m_arena;              // 全部字段的 UTF-8 字节
+    QVector<quint32> m_ends;         // 第 row*m_fields+f 个字段的结束偏移
+    QVector<int> m_fileOf;
+    QVector<qint32> m_lineOf;
+    QStringList m_files;             // 显示用相对路径
+    QStringList m_filePaths;         // 原始路径（提示）
+    QVector<QByteArray> m_fileKeys;  // 筛选用：相对路径的 UTF-8（ASCII 小写）
+    QHash<QString, int> m_fileIndex;
+    QString m_root;
+
+    // 当前视图：筛选/排序后的存储行号；未启用时按存储顺序直出
+    bool m_viewActive{false};
+    QVector<int> m_view;
+    QByteArray m_needle;
+    int m_sortColumn{-1};
+    Qt::SortOrder m_sortOrder{Qt::AscendingOrder};
+    bool m_sortStale{false};         // 排序后又追加了行
+    bool m_live{false};              // 提取进行中
+    bool m_jobRunning{false};
+    bool m_rebuildPending{false};
+    QFutureWatcher<ViewResult> m_watcher;
+    QTimer *m_flushTimer{nullptr};
+
+    // 跨线程：待合并缓冲与计数
+    mutable QMutex m_pendingLock;
+    Pending m_pending;
+    quint64 m_generation{0};
+    int m_committedRows{0};
+    qint64 m_committedBytes{0};
+    int m_dropped{0};
+    int m_rowLimit{1000000};
+};
+
+#endif // EXTRACT_RESULTS_MODEL_H
@@ -0,0 +1,99 @@
+/**
+ * @file extract_sink.cpp
+ * @brief 流式提取写出实现（Streaming extract sink implementation）
+ */
+#include "extract_sink.h"
+#include "perf_stats.h"
+#include "block_table.h"
+#include "regex_registry.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QRegularExpression>
+
+void ExtractSink::consume(QList<ExtractedBlock> &preview, const BlockTable &mapped)
+{
+    // 使用 Unicode 范围匹配常用中文字符（基础汉字、扩展A、CJK符号）
+    static const QRegularExpression &reCn = RegexRegistry::get(QStringLiteral("[\\x{3400}-\\x{4DBF}\\x{4E00}-\\x{9FFF}\\x{3000}-\\x{303F}]"));
+    PerfStats::Timer timer("csv_write");
+    const int keptBefore = kept;
+    QList<ExtractedBlock> batch;
+    for (int i = 0; i < mapped.size(); ++i)
+    {
+        ++total;
+        if (chineseOnly && !cnIdx.isEmpty())
+        {
+            bool keep = false;
+            for (int idx : cnIdx)
+            {
+                if (idx >= 0 && idx < mapped.stringCount(i) && reCn.match(mapped.string(i, idx)).hasMatch()) { keep = true; break; }
+            }
+            if (!keep)
+                continue;
+        }
+        // 无已有译文可合并时直接从块表写出；否则生成 ExtractedBlock 覆盖对应列
+        auto it = translations.constEnd();
+        if (!translations.isEmpty() && langCount > 0)
+        {
+            const QString key = QDir::fromNativeSeparators(mapped.sourceFile(i)).toLower() + QStringLiteral("|") + mapped.variableName(i).toString().toLower();
+            it = translations.constFind(key);
+        }
+        const bool merge = it != translations.constEnd();
+        const bool needBlock = merge || preview.size() < 5 || observer;
+        ExtractedBlock r;
+        if (needBlock)
+            r = mapped.block(i);
+        if (merge)
+        {
+            while (r.strings.size() < langCount)
+                r.strings.append(QString());
+            for (int k = 0; k < langCount && k < it->values.size(); ++k)
+            {
+                if (!it->values.at(k).isEmpty())
+                    r.strings[k] = it->values.at(k);
+            }
+        }
+        if (writer)
+        {
+            if (merge)
+                writer->write(r);
+            else
+                writer->write(mapped, i);
+        }
+        ++kept;
+        if (preview.size() < 5)
+            preview.append(r);
+        if (observer)
+            batch.append(r);
+    }
+    timer.addItems(kept - keptBefore);
+    if (observer && !batch.isEmpty())
+        observer(batch);
+}
+
+std::shared_ptr<ExtractSink> ExtractSink::open(const QString &outCsv, const Csv::WriteOptions &options, bool chineseOnly)
+{
+    auto sink = std::make_shared<ExtractSink>();
+    sink->chineseOnly = chineseOnly;
+    sink->langCount = options.langColumns.size();
+    if (chineseOnly)
+    {
+        for (int i = 0; i < options.langColumns.size(); ++i)
+        {
+            const QString col = options.langColumns.at(i).toLower();
+            if (col.endsWith(QLatin1String("_cn")) || col.endsWith(QLatin1String("_zh")) || col.endsWith(QLatin1String("_chs")) || col.endsWith(QLatin1String("_hans")))
+                sink->cnIdx.push_back(i);
+        }
+    }
+    const QString transCsv = QFileInfo(outCsv).dir().absoluteFilePath(QStringLiteral("ty_text_cn.csv"));
+    QString err;
+    const QList<CsvRow> trs = Csv::parseFile(transCsv, err);
+    if (err.isEmpty())
+    {
+        for (const auto &r : trs)
+            sink->translations.insert(QDir::fromNativeSeparators(r.sourcePath).toLower() + QStringLiteral("|") + r.variableName.toLower(), r);
+    }
+    sink->writer.reset(new Csv::StreamWriter(outCsv, options));
+    if (!sink->writer->open())
+        return nullptr;
+    return sink;
+}
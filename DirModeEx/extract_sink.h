@@ -0,0 +1,80 @@
+/**
+ * @file extract_sink.h
+ * @brief 流式提取写出接口（Streaming extract sink APIs）
+ *
+ * 功能名称：提取结果流式写出（Stream extracted blocks to CSV）
+ * 主要用途：
+ * - 在 QtConcurrent 归约阶段逐块做中文筛选、合并同目录 ty_text_cn.csv 已有译文并写出 CSV；
+ * - 界面与命令行共用，内存不随行数增长；
+ *
+ * 使用示例：
+ *  auto sink = ExtractSink::open(outCsv, opts, chineseOnly);
+ *  auto future = QtConcurrent::mappedReduced<QList<ExtractedBlock>>(files, mapFn, ExtractReduceFn{sink},
+ *                                                                   QtConcurrent::OrderedReduce | QtConcurrent::SequentialReduce);
+ *  ...
+ *  sink->writer->close();   // 提交输出；不调用 close 时原文件保持不变
+ */
+#ifndef EXTRACT_SINK_H
+#define EXTRACT_SINK_H
+
+#include <QString>
+#include <QList>
+#include <QMap>
+#include <memory>
+#include <functional>
+#include "csv_writer.h"
+#include "csv_parser.h"
+#include "block_table.h"
+
+/**
+ * @brief 流式提取写出上下文（Streaming sink for the extract reduce step）
+ * SequentialReduce 保证 consume 串行、按文件顺序调用：逐块做中文筛选、合并已有译文并写出，
+ * 归约结果只保留前几行用于预览。
+ */
+struct ExtractSink {
+    std::unique_ptr<Csv::StreamWriter> writer;
+    bool chineseOnly{false};
+    QList<int> cnIdx;                  // 中文列索引（*_cn/_zh/_chs/_hans）
+    int langCount{0};
+    QMap<QString, CsvRow> translations; // 已有 ty_text_cn.csv 译文，键：路径|变量名（小写）
+    int total{0};                      // 原始块数
+    int kept{0};                       // 写出块数
+    // 可选：每批写出后回调本批保留的块（在归约线程调用，界面用于增量显示结果）
+    std::function<void(const QList<ExtractedBlock> &)> observer;
+
+    /**
+     * @brief 写出一个文件的提取结果（在归约线程串行调用）
+     * @param preview 预览行（最多 5 行；仅这些行与 observer 批次转为 ExtractedBlock）
+     * @param mapped 单文件块表；无需合并已有译文的行直接从块表编码写出
+     */
+    void consume(QList<ExtractedBlock> &preview, const BlockTable &mapped);
+
+    /**
+     * @brief 创建写出上下文：先读取输出目录已有的 ty_text_cn.csv 译文（中文提取时它即输出文件；新结果写入临时文件，close 成功后才替换），再打开写出器
+     * @param outCsv 输出 CSV 路径
+     * @param options 写出选项（语言列、直写列、逗号替换、分片行数）
+     * @param chineseOnly 是否仅保留中文列含中文字符的块
+     * @return 无法打开输出文件时返回空指针
+     */
+    static std::shared_ptr<ExtractSink> open(const QString &outCsv, const Csv::WriteOptions &options, bool chineseOnly);
+};
+
+/**
+ * @brief 归约函数对象：块表结果有写出上下文时交给 consume，否则转为列表拼接；列表结果直接拼接
+ */
+struct ExtractReduceFn {
+    std::shared_ptr<ExtractSink> sink;
+    void operator()(QList<ExtractedBlock> &result, const BlockTable &mapped) const
+    {
+        if (sink)
+            sink->consume(result, mapped);
+        else
+            result.append(mapped.toList());
+    }
+    void operator()(QList<ExtractedBlock> &result, const QList<ExtractedBlock> &mapped) const
+    {
+        result.append(mapped);
+    }
+};
+
+#endif // EXTRACT_SINK_H
@@ -13,7 +13,14 @@
 #include <QTextCodec>
 #include <QDateTime>
 #include <QRegularExpression>
+#include <QHash>
+#include <QtConcurrent>
 #include "text_extractor.h"
+#include "dir_walker.h"
+#include "text_codec.h"
+#include "backup_store.h"
+#include "change_set.h"
+#include "regex_registry.h"
 
 namespace ProjectLang
 {
@@ -27,7 +34,6 @@ namespace ProjectLang
                                              const QString &newLangCode,
                                              bool &changed);
     static QString readFileAutoCodec(const QString &path, QString &chosenCodec, bool &utf8Bom);
-    static bool writeTextWithCodec(const QString &path, const QString &text, const QString &codec, bool utf8Bom);
 
     /**
      * @brief 生成语言初始化日志路径（项目根 logs/lang_init.log）
@@ -73,36 +79,8 @@ namespace ProjectLang
      */
     static QStringList listCandidateFiles(const QString &root)
     {
-        QStringList exts{".h", ".hpp"};
-        QStringList result;
-        QList<QString> stack;
-        stack << QDir(root).absolutePath();
-        while (!stack.isEmpty())
-        {
-            QString path = stack.takeLast();
-            QDir d(path);
-            QFileInfoList infos = d.entryInfoList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
-            for (const QFileInfo &fi : infos)
-            {
-                if (fi.isDir())
-                {
-                    stack << fi.absoluteFilePath();
-                    continue;
-                }
-                QString name = fi.fileName().toLower();
-                bool ok = false;
-                for (const QString &e : exts)
-                    if (name.endsWith(e))
-                    {
-                        ok = true;
-                        break;
-                    }
-                if (!ok)
-                    continue;
-                result << fi.absoluteFilePath();
-            }
-        }
-        return result;
+        // 与提取共用遍历：不会改写备份、沙箱与 build* 目录中的副本
+        return DirWalker::collect(root, QStringList{QStringLiteral(".h"), QStringLiteral(".hpp")});
     }
 
     /**
@@ -110,7 +88,7 @@ namespace ProjectLang
      */
     static bool containsTextField(const QString &body)
     {
-        QRegularExpression re(R"((const\s+char\s*\*\s*(?:p_)?text_\w+\s*;))");
+        static const QRegularExpression &re = RegexRegistry::get(QString(R"((const\s+char\s*\*\s*(?:p_)?text_\w+\s*;))"));
         return re.match(body).hasMatch();
     }
 
@@ -124,8 +102,7 @@ namespace ProjectLang
     {
         changed = false;
         // Match typedef struct blocks and alias
-        QRegularExpression reBody(R"(typedef\s+struct\s*\{(.*?)\}\s*(\w+)\s*;)",
-                                  QRegularExpression::DotMatchesEverythingOption);
+        const QRegularExpression &reBody = RegexRegistry::typedefStruct();
         QString out = text;
         auto it = reBody.globalMatch(text);
         int offsetAdjust = 0;
@@ -143,7 +120,7 @@ namespace ProjectLang
             int idxOther = -1;
             int lastLangIdx = -1;
             QString indent = "    ";
-            QRegularExpression reField(R"(^([ \t]*)const\s+char\s*\*\s*(?:p_)?text_(\w+)\s*;\s*(//.*)?$)");
+            static const QRegularExpression &reField = RegexRegistry::get(QString(R"(^([ \t]*)const\s+char\s*\*\s*(?:p_)?text_(\w+)\s*;\s*(//.*)?$)"));
             bool usePrefixP = false;
             for (int i = 0; i < lines.size(); ++i)
             {
@@ -174,7 +151,7 @@ namespace ProjectLang
             // Check if target language already exists
             bool exists = false;
             QString prefix = usePrefixP ? QStringLiteral("p_text_") : QStringLiteral("text_");
-            QRegularExpression reExist(QString(R"(\b%1%2\b)").arg(prefix, QRegularExpression::escape(langCode)));
+            const QRegularExpression &reExist = RegexRegistry::get(QString(R"(\b%1%2\b)").arg(prefix, QRegularExpression::escape(langCode)));
             for (const QString &ln : lines)
             {
                 if (reExist.match(ln).hasMatch())
@@ -197,8 +174,108 @@ namespace ProjectLang
         return out;
     }
 
+    /**
+     * @brief 单个文件的规划结果（Planned rewrite of one file）
+     */
+    struct FilePlan
+    {
+        QString path;
+        QString text; // 新内容；未修改时为空
+        QString codec;
+        bool bom{false};
+        bool changed{false};
+    };
+
+    static const QStringList &discoveryExtensions()
+    {
+        static const QStringList exts{QStringLiteral(".h"), QStringLiteral(".hpp"), QStringLiteral(".c"), QStringLiteral(".cpp")};
+        return exts;
+    }
+
+    /**
+     * @brief 规划头文件：在结构体中插入新语言字段
+     */
+    struct HeaderPlanFn
+    {
+        typedef FilePlan result_type;
+        QString code;
+        FilePlan operator()(const QString &fp) const
+        {
+            FilePlan p;
+            p.path = fp;
+            const QString text = readFileAutoCodec(fp, p.codec, p.bom);
+            if (text.isEmpty())
+                return p;
+            p.text = insertNewLanguageField(text, code, p.changed);
+            if (!p.changed)
+                p.text.clear();
+            return p;
+        }
+    };
+
+    /**
+     * @brief 规划源文件：依次按各别名重写初始化（一次读取，后一别名在前一别名结果上继续）
+     */
+    struct SourcePlanFn
+    {
+        typedef FilePlan result_type;
+        QStringList aliases;
+        QHash<QString, QStringList> langsByAlias;
+        QString code;
+        FilePlan operator()(const QString &sp) const
+        {
+            FilePlan p;
+            p.path = sp;
+            QString text = readFileAutoCodec(sp, p.codec, p.bom);
+            if (text.isEmpty())
+                return p;
+            for (const QString &alias : aliases)
+            {
+                bool ch = false;
+                text = rewriteInitializersInText(text, alias, langsByAlias.value(alias), code, ch);
+                p.changed = p.changed || ch;
+            }
+            if (p.changed)
+                p.text = text;
+            return p;
+        }
+    };
+
+    /**
+     * @brief 提交规划结果并写日志；返回修改文件数
+     */
+    static int commitPlans(const QString &root, const QList<FilePlan> &plans, BackupStore::Session &backup,
+                           QTextStream &log, InitResult &res)
+    {
+        QVector<ChangeSet::Change> changes;
+        for (const FilePlan &p : plans)
+        {
+            if (p.changed)
+                changes.append(ChangeSet::Change{p.path, ChangeSet::encode(p.text, p.codec, p.bom)});
+        }
+        const ChangeSet::Result cr = ChangeSet::commit(changes, &backup);
+        if (!cr.ok)
+        {
+            log << "  FAILED: " << cr.error << "\n";
+            log << (cr.rolledBack ? "  rolled back\n" : "  no file was modified\n");
+            res.failed = true;
+            res.message = cr.rolledBack ? QStringLiteral("写回失败，已回滚全部文件：%1").arg(cr.error)
+                                        : QStringLiteral("写回失败，未修改任何文件：%1").arg(cr.error);
+            return -1;
+        }
+        for (const QString &fp : cr.written)
+        {
+            res.modifiedFiles << fp;
+            log << "  modified: " << QDir(root).relativeFilePath(fp) << "\n";
+        }
+        return cr.written.size();
+    }
+
     /**
      * @brief 添加新语言字段并批量重写初始化（以英文为模板），生成备份与日志
+     *
+     * 两阶段：先并发规划全部头文件与源文件的新内容（语言顺序按规划后的头文件推断），
+     * 再经 ChangeSet 一次提交；任一文件写回失败时全部回滚。
      */
     InitResult addLanguageAndInitialize(const QString &root, const QString &langCode)
     {
@@ -210,102 +287,50 @@ namespace ProjectLang
             return res;
         }
         QString code = langCode.trimmed();
+        DirWalker::Scope walkScope(root); // 头文件、别名与源文件列表共用一次遍历
         QString logPath = ensureLogsDir(root);
         QFile logF(logPath);
         logF.open(QIODevice::Append);
         QTextStream log(&logF);
         log.setCodec("UTF-8");
         QString sessDir = backupsSessionDir(root);
+        // 备份存入共享对象库，会话目录只含清单与硬链接视图
+        BackupStore::Session backup(root, sessDir);
 
         log << QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss")
             << " BEGIN addLanguage '" << code << "' root=" << root << "\n";
 
-        QStringList files = listCandidateFiles(root);
-        int changedCount = 0;
-        for (const QString &fp : files)
+        // 阶段1：规划头文件，得到待写回内容
+        const QList<FilePlan> headerPlans = QtConcurrent::blockingMapped<QList<FilePlan>>(listCandidateFiles(root), HeaderPlanFn{code});
+        QHash<QString, QString> pending;
+        for (const FilePlan &p : headerPlans)
         {
-            QString codec;
-            bool bom = false;
-            QString text = readFileAutoCodec(fp, codec, bom);
-            if (text.isEmpty())
-                continue;
-            bool changed = false;
-            QString out = insertNewLanguageField(text, code, changed);
-            if (!changed)
-                continue;
-            // backup
-            QDir s(sessDir);
-            QString rel = QDir(root).relativeFilePath(fp);
-            QString backupPath = s.absoluteFilePath(rel);
-            QDir().mkpath(QFileInfo(backupPath).dir().absolutePath());
-            QFile bf(backupPath);
-            if (bf.open(QIODevice::WriteOnly | QIODevice::Truncate))
-            {
-                QTextStream bts(&bf);
-                bts.setCodec(codec.isEmpty() ? "UTF-8" : codec.toUtf8().constData());
-                if (bom && codec.compare(QLatin1String("UTF-8"), Qt::CaseInsensitive) == 0)
-                    bts << QChar(0xFEFF);
-                bts << text;
-                bf.close();
-            }
-            // write
-            writeTextWithCodec(fp, out, codec, bom);
-            res.modifiedFiles << fp;
-            log << "  modified: " << rel << "\n";
-            changedCount++;
+            if (p.changed)
+                pending.insert(QDir::cleanPath(QFileInfo(p.path).absoluteFilePath()), p.text);
         }
 
-        // 更新源文件中的初始化（批量处理）
-        QStringList aliases = collectAliasesWithTextFields(root);
-        for (const QString &alias : aliases)
-        {
-            // 发现语言顺序（当前头文件顺序，已包含新语言）
-            QStringList structLangs = TextExtractor::discoverLanguageColumns(root, QStringList{QStringLiteral(".h"), QStringLiteral(".hpp"), QStringLiteral(".c"), QStringLiteral(".cpp")}, alias);
-            QStringList srcs = listSourceFiles(root);
-            for (const QString &sp : srcs)
-            {
-            QString codec;
-            bool bom = false;
-            QString text = readFileAutoCodec(sp, codec, bom);
-            if (text.isEmpty())
-                continue;
-            bool ch = false;
-            QString out = rewriteInitializersInText(text, alias, structLangs, langCode, ch);
-            if (!ch)
-                continue;
-            // backup
-                QDir s(sessDir);
-                QString rel = QDir(root).relativeFilePath(sp);
-                QString backupPath = s.absoluteFilePath(rel);
-                QDir().mkpath(QFileInfo(backupPath).dir().absolutePath());
-                QFile bf(backupPath);
-                if (bf.open(QIODevice::WriteOnly | QIODevice::Truncate))
-                {
-                    QTextStream bts(&bf);
-                    bts.setCodec(codec.isEmpty() ? "UTF-8" : codec.toUtf8().constData());
-                    if (bom && codec.compare(QLatin1String("UTF-8"), Qt::CaseInsensitive) == 0)
-                        bts << QChar(0xFEFF);
-                    bts << text;
-                    bf.close();
-                }
-                // write
-                if (writeTextWithCodec(sp, out, codec, bom))
-                {
-                    res.modifiedFiles << sp;
-                    log << "  modified: " << rel << "\n";
-                    changedCount++;
-                }
-            }
-        }
+        // 语言顺序按规划后的头文件推断（已包含新语言），每个别名只推断一次
+        SourcePlanFn sourceFn;
+        sourceFn.code = code;
+        sourceFn.aliases = collectAliasesWithTextFields(root);
+        for (const QString &alias : sourceFn.aliases)
+            sourceFn.langsByAlias.insert(alias, TextExtractor::discoverLanguageColumns(root, discoveryExtensions(), alias, pending));
+        const QList<FilePlan> sourcePlans = QtConcurrent::blockingMapped<QList<FilePlan>>(listSourceFiles(root), sourceFn);
+
+        // 阶段2：一次提交
+        const int changedCount = commitPlans(root, headerPlans + sourcePlans, backup, log, res);
 
-        log << "  backups: " << QDir(root).relativeFilePath(sessDir) << "\n";
+        log << "  backups: " << QDir(root).relativeFilePath(sessDir)
+            << " (" << backup.fileCount() << " files, " << backup.reusedCount() << " reused, "
+            << backup.bytesWritten() << " bytes written)\n";
         log << QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss") << " END\n\n";
         logF.close();
         res.logPath = logPath;
         res.outputDir = sessDir;
         res.success = (changedCount > 0);
-        res.message = changedCount > 0 ? QString("已初始化新语言 '%1'，修改 %2 个文件").arg(code).arg(changedCount)
-                                       : QString("未发现可修改的结构体或语言已存在: '%1'").arg(code);
+        if (changedCount >= 0)
+            res.message = changedCount > 0 ? QString("已初始化新语言 '%1'，修改 %2 个文件").arg(code).arg(changedCount)
+                                           : QString("未发现可修改的结构体或语言已存在: '%1'").arg(code);
         return res;
     }
 
@@ -331,40 +356,50 @@ namespace ProjectLang
         }
         QString last = sessions.first();
         QString sess = dir.absoluteFilePath(last);
-        // restore
-        QList<QString> stack;
-        stack << sess;
-        while (!stack.isEmpty())
+        // restore：新会话按清单从对象库恢复，旧会话为整份副本
+        QString restoreError;
+        if (BackupStore::hasManifest(sess))
+        {
+            BackupStore::restore(sess, root, &res.modifiedFiles, &restoreError);
+        }
+        else
         {
-            QString path = stack.takeLast();
-            QDir d(path);
-            QFileInfoList infos = d.entryInfoList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
-            for (const QFileInfo &fi : infos)
+            QList<QString> stack;
+            stack << sess;
+            while (!stack.isEmpty())
             {
-                if (fi.isDir())
-                {
-                    stack << fi.absoluteFilePath();
-                    continue;
-                }
-                QString rel = QDir(sess).relativeFilePath(fi.absoluteFilePath());
-                QString target = QDir(root).absoluteFilePath(rel);
-                QFile src(fi.absoluteFilePath());
-                QFile dst(target);
-                if (src.open(QIODevice::ReadOnly))
+                QString path = stack.takeLast();
+                QDir d(path);
+                QFileInfoList infos = d.entryInfoList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
+                for (const QFileInfo &fi : infos)
                 {
-                    QByteArray bytes = src.readAll();
-                    src.close();
-                    if (dst.open(QIODevice::WriteOnly | QIODevice::Truncate))
+                    if (fi.isDir())
                     {
-                        dst.write(bytes);
-                        dst.close();
-                        res.modifiedFiles << target;
+                        stack << fi.absoluteFilePath();
+                        continue;
+                    }
+                    QString rel = QDir(sess).relativeFilePath(fi.absoluteFilePath());
+                    QString target = QDir(root).absoluteFilePath(rel);
+                    QFile src(fi.absoluteFilePath());
+                    QFile dst(target);
+                    if (src.open(QIODevice::ReadOnly))
+                    {
+                        QByteArray bytes = src.readAll();
+                        src.close();
+                        if (dst.open(QIODevice::WriteOnly | QIODevice::Truncate))
+                        {
+                            dst.write(bytes);
+                            dst.close();
+                            res.modifiedFiles << target;
+                        }
                     }
                 }
             }
         }
         res.success = !res.modifiedFiles.isEmpty();
         res.message = res.success ? QStringLiteral("已撤销会话 %1").arg(last) : QStringLiteral("撤销失败：无文件恢复");
+        if (!restoreError.isEmpty())
+            res.message += QStringLiteral("\n") + restoreError;
         res.logPath = ensureLogsDir(root);
         return res;
     }
@@ -373,87 +408,10 @@ namespace ProjectLang
 namespace ProjectLang
 {
     // Helpers to preserve original codec/BOM when reading/writing
-    static QString decodeWithCodec(const QByteArray &data, const char *name)
-    {
-        QTextCodec *c = QTextCodec::codecForName(name);
-        return c ? c->toUnicode(data) : QString();
-    }
-
     static QString readFileAutoCodec(const QString &path, QString &chosenCodec, bool &utf8Bom)
     {
-        chosenCodec.clear();
-        utf8Bom = false;
-        QFile f(path);
-        if (!f.open(QIODevice::ReadOnly))
-            return QString();
-        QByteArray data = f.readAll();
-        f.close();
-        // BOM checks
-        if (data.startsWith("\xEF\xBB\xBF"))
-        {
-            utf8Bom = true;
-            chosenCodec = QStringLiteral("UTF-8");
-            return QString::fromUtf8(data.mid(3));
-        }
-        if (data.startsWith("\xFF\xFE"))
-        {
-            chosenCodec = QStringLiteral("UTF-16LE");
-            QTextCodec *c = QTextCodec::codecForName("UTF-16LE");
-            return c ? c->toUnicode(data.mid(2)) : QString();
-        }
-        if (data.startsWith("\xFE\xFF"))
-        {
-            chosenCodec = QStringLiteral("UTF-16BE");
-            QTextCodec *c = QTextCodec::codecForName("UTF-16BE");
-            return c ? c->toUnicode(data.mid(2)) : QString();
-        }
-        // Try common codecs and pick the one with least replacement chars
-        auto countReplacement = [](const QString &s) {
-            int cnt = 0;
-            for (QChar ch : s)
-                if (ch.unicode() == 0xFFFD)
-                    cnt++;
-            return cnt;
-        };
-        QString utf8 = decodeWithCodec(data, "UTF-8");
-        QString gb18030 = decodeWithCodec(data, "GB18030");
-        QString gbk = decodeWithCodec(data, "GBK");
-        QString gb2312 = decodeWithCodec(data, "GB2312");
-        QList<QPair<QString, QString>> candidates = {
-            {QStringLiteral("UTF-8"), utf8},
-            {QStringLiteral("GB18030"), gb18030},
-            {QStringLiteral("GBK"), gbk},
-            {QStringLiteral("GB2312"), gb2312},
-        };
-        int best = INT_MAX;
-        QString bestText;
-        QString bestCodec;
-        for (const auto &p : candidates)
-        {
-            int rc = countReplacement(p.second);
-            if (rc < best || (rc == best && p.first == QLatin1String("GB18030")))
-            {
-                best = rc;
-                bestText = p.second;
-                bestCodec = p.first;
-            }
-        }
-        chosenCodec = bestCodec.isEmpty() ? QStringLiteral("UTF-8") : bestCodec;
-        return bestText;
-    }
-
-    static bool writeTextWithCodec(const QString &path, const QString &text, const QString &codec, bool utf8Bom)
-    {
-        QFile f(path);
-        if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate))
-            return false;
-        QTextStream ts(&f);
-        ts.setCodec(codec.isEmpty() ? "UTF-8" : codec.toUtf8().constData());
-        if (utf8Bom && codec.compare(QLatin1String("UTF-8"), Qt::CaseInsensitive) == 0)
-            ts << QChar(0xFEFF);
-        ts << text;
-        f.close();
-        return true;
+        // 共用 TextCodec 单遍判定；持平时偏好 GB18030，写回时沿用原编码
+        return TextCodec::readFile(path, &chosenCodec, &utf8Bom, TextCodec::Tie::Gb18030);
     }
 
     /**
@@ -462,7 +420,7 @@ namespace ProjectLang
     static QStringList tokenizeInitializerBody(const QString &body)
     {
         QStringList tokens;
-        QRegularExpression reTok(R"("([^"\\]|\\.)*"|NULL)", QRegularExpression::DotMatchesEverythingOption);
+        static const QRegularExpression &reTok = RegexRegistry::get(QString(R"("([^"\\]|\\.)*"|NULL)"), QRegularExpression::DotMatchesEverythingOption);
         auto it = reTok.globalMatch(body);
         while (it.hasNext())
         {
@@ -481,7 +439,8 @@ namespace ProjectLang
         QString t = body;
         t = t.trimmed();
         // Remove trailing comments
-        t.replace(QRegularExpression(R"(/\*.*?\*/)", QRegularExpression::DotMatchesEverythingOption), "");
+        static const QRegularExpression &reBlock = RegexRegistry::get(QString(R"(/\*.*?\*/)"), QRegularExpression::DotMatchesEverythingOption);
+        t.replace(reBlock, "");
         QStringList parts = t.split(QLatin1Char(','), Qt::SkipEmptyParts);
         if (parts.isEmpty())
             return false;
@@ -552,9 +511,7 @@ namespace ProjectLang
                                                   bool &changed)
     {
         changed = false;
-        QRegularExpression reInit(QString(R"((?:static\s+)?(?:const\s+)?(?:struct\s+)?%1(?:\s+\w+)*\s+(?:\*+\s*)?(\w+)\s*=\s*(?:&\s*\([^)]*\)\s*)?\{(.*?)\};)"
-                                    ).arg(QRegularExpression::escape(alias)),
-                                  QRegularExpression::DotMatchesEverythingOption);
+        const QRegularExpression &reInit = RegexRegistry::initializerFor(alias);
         QString out = text;
         auto it = reInit.globalMatch(text);
         int offset = 0;
@@ -575,77 +532,72 @@ namespace ProjectLang
         return out;
     }
 
+    /**
+     * @brief 规划源文件：依次按各别名补齐缺失语言项
+     */
+    struct FillPlanFn
+    {
+        typedef FilePlan result_type;
+        QStringList aliases;
+        QHash<QString, QStringList> langsByAlias;
+        FilePlan operator()(const QString &sp) const
+        {
+            FilePlan p;
+            p.path = sp;
+            QString text = readFileAutoCodec(sp, p.codec, p.bom);
+            if (text.isEmpty())
+                return p;
+            for (const QString &alias : aliases)
+            {
+                bool ch = false;
+                text = rewriteInitializersFillMissing(text, alias, langsByAlias.value(alias), ch);
+                p.changed = p.changed || ch;
+            }
+            if (p.changed)
+                p.text = text;
+            return p;
+        }
+    };
+
     /**
      * @brief 批量填充缺失项为英文，生成备份与日志
+     * 各源文件并发规划，再经 ChangeSet 一次提交。
      */
     InitResult fillMissingEntriesWithEnglish(const QString &root)
     {
         InitResult res;
         res.success = false;
+        DirWalker::Scope walkScope(root);
         QString logPath = ensureLogsDir(root);
         QFile logF(logPath);
         logF.open(QIODevice::Append);
         QTextStream log(&logF);
         log.setCodec("UTF-8");
         QString sessDir = backupsFillEngDir(root);
+        BackupStore::Session backup(root, sessDir);
 
         log << QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss")
             << " BEGIN fillMissingWithEnglish root=" << root << "\n";
 
-        QStringList aliases = collectAliasesWithTextFields(root);
-        QStringList srcs = listSourceFiles(root);
-        int changedCount = 0;
-        for (const QString &sp : srcs)
-        {
-            QString codec;
-            bool bom = false;
-            QString text = readFileAutoCodec(sp, codec, bom);
-            if (text.isEmpty())
-                continue;
-            bool fileChanged = false;
-            QString outText = text;
-            for (const QString &alias : aliases)
-            {
-                QStringList structLangs = TextExtractor::discoverLanguageColumns(root,
-                    QStringList{QStringLiteral(".h"), QStringLiteral(".hpp"), QStringLiteral(".c"), QStringLiteral(".cpp")}, alias);
-                bool ch = false;
-                outText = rewriteInitializersFillMissing(outText, alias, structLangs, ch);
-                fileChanged = fileChanged || ch;
-            }
-            if (!fileChanged)
-                continue;
-            // backup original
-            QDir s(sessDir);
-            QString rel = QDir(root).relativeFilePath(sp);
-            QString backupPath = s.absoluteFilePath(rel);
-            QDir().mkpath(QFileInfo(backupPath).dir().absolutePath());
-            QFile bf(backupPath);
-            if (bf.open(QIODevice::WriteOnly | QIODevice::Truncate))
-            {
-                QTextStream bts(&bf);
-                bts.setCodec(codec.isEmpty() ? "UTF-8" : codec.toUtf8().constData());
-                if (bom && codec.compare(QLatin1String("UTF-8"), Qt::CaseInsensitive) == 0)
-                    bts << QChar(0xFEFF);
-                bts << text;
-                bf.close();
-            }
-            // write updated
-            if (writeTextWithCodec(sp, outText, codec, bom))
-            {
-                res.modifiedFiles << sp;
-                log << "  modified: " << rel << "\n";
-                changedCount++;
-            }
-        }
-
-        log << "  backups: " << QDir(root).relativeFilePath(sessDir) << "\n";
+        // 语言顺序与文件无关：每个别名只推断一次
+        FillPlanFn fillFn;
+        fillFn.aliases = collectAliasesWithTextFields(root);
+        for (const QString &alias : fillFn.aliases)
+            fillFn.langsByAlias.insert(alias, TextExtractor::discoverLanguageColumns(root, discoveryExtensions(), alias));
+        const QList<FilePlan> plans = QtConcurrent::blockingMapped<QList<FilePlan>>(listSourceFiles(root), fillFn);
+        const int changedCount = commitPlans(root, plans, backup, log, res);
+
+        log << "  backups: " << QDir(root).relativeFilePath(sessDir)
+            << " (" << backup.fileCount() << " files, " << backup.reusedCount() << " reused, "
+            << backup.bytesWritten() << " bytes written)\n";
         log << QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss") << " END\n\n";
         logF.close();
         res.logPath = logPath;
         res.outputDir = sessDir;
         res.success = (changedCount > 0);
-        res.message = changedCount > 0 ? QStringLiteral("已补齐英文缺失项，修改 %1 个文件").arg(changedCount)
-                                       : QStringLiteral("未发现需要补齐的初始化项");
+        if (changedCount >= 0)
+            res.message = changedCount > 0 ? QStringLiteral("已补齐英文缺失项，修改 %1 个文件").arg(changedCount)
+                                           : QStringLiteral("未发现需要补齐的初始化项");
         return res;
     }
     /**
@@ -653,36 +605,7 @@ namespace ProjectLang
      */
     static QStringList listSourceFiles(const QString &root)
     {
-        QStringList exts{QStringLiteral(".c"), QStringLiteral(".cpp")};
-        QStringList result;
-        QList<QString> stack;
-        stack << QDir(root).absolutePath();
-        while (!stack.isEmpty())
-        {
-            QString path = stack.takeLast();
-            QDir d(path);
-            QFileInfoList infos = d.entryInfoList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
-            for (const QFileInfo &fi : infos)
-            {
-                if (fi.isDir())
-                {
-                    stack << fi.absoluteFilePath();
-                    continue;
-                }
-                QString name = fi.fileName().toLower();
-                bool ok = false;
-                for (const QString &e : exts)
-                    if (name.endsWith(e))
-                    {
-                        ok = true;
-                        break;
-                    }
-                if (!ok)
-                    continue;
-                result << fi.absoluteFilePath();
-            }
-        }
-        return result;
+        return DirWalker::collect(root, QStringList{QStringLiteral(".c"), QStringLiteral(".cpp")});
     }
 
     /**
@@ -692,7 +615,7 @@ namespace ProjectLang
     {
         QStringList result;
         QStringList hdrs = listCandidateFiles(root);
-        QRegularExpression reBody(R"(typedef\s+struct\s*\{(.*?)\}\s*(\w+)\s*;)", QRegularExpression::DotMatchesEverythingOption);
+        const QRegularExpression &reBody = RegexRegistry::typedefStruct();
         for (const QString &fp : hdrs)
         {
             QString text = TextExtractor::readTextFile(fp);
@@ -793,9 +716,7 @@ namespace ProjectLang
                                              bool &changed)
     {
         changed = false;
-        QRegularExpression reInit(QString(R"((?:static\s+)?(?:const\s+)?(?:struct\s+)?%1(?:\s+\w+)*\s+(?:\*+\s*)?(\w+)\s*=\s*(?:&\s*\([^)]*\)\s*)?\{(.*?)\};)"
-                                    ).arg(QRegularExpression::escape(alias)),
-                                  QRegularExpression::DotMatchesEverythingOption);
+        const QRegularExpression &reInit = RegexRegistry::initializerFor(alias);
         QString out = text;
         auto it = reInit.globalMatch(text);
         int offset = 0;
@@ -24,11 +24,13 @@ namespace ProjectLang
      * - 在结构体中插入新的语言字段并生成备份；
      * - 回滚最近一次初始化；
      * - 用英文填充缺失语言项；
+ * - 新增语言与英文填充均先并发规划全部文件，再经 ChangeSet 一次提交，失败时不留下部分修改；
      */
 
     struct InitResult
     {
         bool success{false};
+        bool failed{false};        // 写回失败（已回滚或未修改任何文件）；success=false 且 failed=false 表示无需修改
         QStringList modifiedFiles; // absolute paths
         QString logPath;           // absolute path to log file
         QString outputDir;         // generated session folder to open
@@ -0,0 +1,233 @@
+/**
+ * @file live_extractor.cpp
+ * @brief 实时提取实现（Live, watch-driven re-extraction implementation）
+ *
+ * 文件改动（fileChanged）只把该文件记为待提取；目录改动（新增、删除、改名，以及编辑器“写临时文件再替换”）
+ * 触发一次文件列表重新收集并与旧列表比对。两类事件都只重启去抖定时器，定时到期后才开始一批提取。
+ * 替换式保存会让监视器丢失该文件，收到事件后按需重新加入。
+ */
+#include "live_extractor.h"
+#include "extract_sink.h"
+#include "dir_walker.h"
+#include <QFileSystemWatcher>
+#include <QFileInfo>
+#include <QDir>
+#include <QTimer>
+#include <QtConcurrent>
+
+namespace
+{
+    QSet<QString> toSet(const QStringList &list)
+    {
+        QSet<QString> out;
+        out.reserve(list.size());
+        for (const QString &s : list)
+            out.insert(s);
+        return out;
+    }
+
+    struct LiveMapFn
+    {
+        typedef BlockTable result_type;
+        LiveExtractor::ExtractFn fn;
+        BlockTable operator()(const QString &path) const { return fn(path); }
+    };
+}
+
+LiveExtractor::LiveExtractor(const QString &root, const QStringList &extensions, const ExtractFn &extract,
+                             const SinkFactory &openSink, QObject *parent)
+    : QObject(parent), m_root(root), m_exts(extensions), m_extract(extract), m_openSink(openSink)
+{
+    m_watcher = new QFileSystemWatcher(this);
+    connect(m_watcher, &QFileSystemWatcher::fileChanged, this, [this](const QString &p) { onFileChanged(p); });
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, [this](const QString &p) { onDirectoryChanged(p); });
+    m_debounce = new QTimer(this);
+    m_debounce->setSingleShot(true);
+    m_debounce->setInterval(300);
+    connect(m_debounce, &QTimer::timeout, this, [this] { processChanges(); });
+    connect(&m_batch, &QFutureWatcher<BlockTable>::finished, this, [this] { onBatchFinished(); });
+}
+
+LiveExtractor::~LiveExtractor()
+{
+    // 提取函数可能引用外部缓存，须等待批次结束
+    m_batch.waitForFinished();
+}
+
+void LiveExtractor::setDebounceInterval(int ms)
+{
+    m_debounce->setInterval(qMax(0, ms));
+}
+
+void LiveExtractor::start()
+{
+    stop();
+    m_active = true;
+    {
+        // 文件收集与目录监视共用一次遍历
+        DirWalker::Scope walkScope(m_root);
+        m_files = TextExtractor::collectSourceFiles(m_root, m_exts);
+        watchTree();
+    }
+    m_initial = true;
+    m_batchFiles = m_files;
+    m_clock.start();
+    m_batch.setFuture(QtConcurrent::mapped(m_batchFiles, LiveMapFn{m_extract}));
+}
+
+void LiveExtractor::stop()
+{
+    m_active = false;
+    m_debounce->stop();
+    m_batch.waitForFinished();
+    if (!m_watcher->files().isEmpty())
+        m_watcher->removePaths(m_watcher->files());
+    if (!m_watcher->directories().isEmpty())
+        m_watcher->removePaths(m_watcher->directories());
+    m_files.clear();
+    m_blocks.clear();
+    m_dirty.clear();
+    m_removed.clear();
+    m_rescan = false;
+}
+
+void LiveExtractor::watchTree()
+{
+    // 只补充尚未监视的路径；已删除的路径由监视器自动移除
+    const QSet<QString> watchedDirs = toSet(m_watcher->directories());
+    const QSet<QString> watchedFiles = toSet(m_watcher->files());
+    QStringList add;
+    if (!watchedDirs.contains(m_root))
+        add << m_root;
+    // 与文件收集同一套剪枝与排除规则：缓存、备份目录的写入不会触发重提
+    for (const QString &dir : DirWalker::walk(m_root).dirs)
+    {
+        if (!watchedDirs.contains(dir))
+            add << dir;
+    }
+    for (const QString &f : m_files)
+    {
+        if (!watchedFiles.contains(f))
+            add << f;
+    }
+    if (!add.isEmpty())
+        m_watcher->addPaths(add);
+}
+
+void LiveExtractor::onFileChanged(const QString &path)
+{
+    if (!m_active)
+        return;
+    m_dirty.insert(path);
+    // 替换式保存后监视器已移除该文件：仍存在则重新加入
+    if (QFileInfo::exists(path) && !m_watcher->files().contains(path))
+        m_watcher->addPath(path);
+    m_debounce->start();
+}
+
+void LiveExtractor::onDirectoryChanged(const QString &path)
+{
+    Q_UNUSED(path);
+    if (!m_active)
+        return;
+    m_rescan = true;
+    m_debounce->start();
+}
+
+void LiveExtractor::processChanges()
+{
+    // 批次运行中：结束后再处理累积的改动
+    if (!m_active || m_batch.isRunning())
+        return;
+    if (m_rescan)
+    {
+        m_rescan = false;
+        DirWalker::Scope walkScope(m_root);
+        const QStringList files = TextExtractor::collectSourceFiles(m_root, m_exts);
+        const QSet<QString> now = toSet(files);
+        for (const QString &f : m_files)
+        {
+            if (!now.contains(f))
+            {
+                m_blocks.remove(f);
+                m_removed << f;
+            }
+        }
+        for (const QString &f : files)
+        {
+            if (!m_blocks.contains(f))
+                m_dirty.insert(f);
+        }
+        m_files = files;
+        watchTree();
+    }
+    // 只提取仍在列表中的源文件（忽略输出 CSV、临时文件等）
+    const QSet<QString> listed = toSet(m_files);
+    QStringList batch;
+    for (const QString &f : m_dirty)
+    {
+        if (listed.contains(f))
+            batch << f;
+    }
+    m_dirty.clear();
+    m_clock.start();
+    if (batch.isEmpty())
+    {
+        if (!m_removed.isEmpty())
+            rewriteCsv(QStringList());
+        return;
+    }
+    m_batchFiles = batch;
+    m_batch.setFuture(QtConcurrent::mapped(m_batchFiles, LiveMapFn{m_extract}));
+}
+
+void LiveExtractor::onBatchFinished()
+{
+    if (!m_active)
+        return;
+    int blocks = 0;
+    for (int i = 0; i < m_batchFiles.size(); ++i)
+    {
+        const BlockTable rows = m_batch.resultAt(i);
+        blocks += rows.size();
+        m_blocks.insert(m_batchFiles.at(i), rows);
+    }
+    if (m_initial)
+    {
+        // 初始结果集与刚完成的全量提取一致，无需重写 CSV
+        m_initial = false;
+        emit ready(m_files.size(), blocks);
+    }
+    else
+    {
+        rewriteCsv(m_batchFiles);
+    }
+    m_batchFiles.clear();
+    if (!m_dirty.isEmpty() || m_rescan)
+        m_debounce->start();
+}
+
+void LiveExtractor::rewriteCsv(const QStringList &touched)
+{
+    const QStringList files = touched + m_removed;
+    m_removed.clear();
+    std::shared_ptr<ExtractSink> sink = m_openSink ? m_openSink() : nullptr;
+    if (!sink)
+    {
+        emit failed(QStringLiteral("无法打开输出 CSV"));
+        return;
+    }
+    QList<ExtractedBlock> preview;
+    for (const QString &f : m_files)
+    {
+        auto it = m_blocks.constFind(f);
+        if (it != m_blocks.constEnd())
+            sink->consume(preview, it.value());
+    }
+    if (!sink->writer || !sink->writer->close())
+    {
+        emit failed(sink->writer && !sink->writer->errorString().isEmpty() ? sink->writer->errorString() : QStringLiteral("写入 CSV 失败"));
+        return;
+    }
+    emit updated(files, sink->kept, m_clock.elapsed());
+}
@@ -50,7 +50,17 @@
 #include <QUrl>
 #include <QRegularExpression>
 #include <QFutureWatcher>
+#include <QThread>
+#include <QThreadPool>
+#include <QTimer>
 #include "text_extractor.h"
+#include "extract_cache.h"
+#include "preprocessor.h"
+#include "csv_writer.h"
+#include "extract_sink.h"
+#include "extract_results_model.h"
+#include "live_extractor.h"
+#include "dir_walker.h"
 #include "language_settings.h"
 #include "csv_lang_plugin.h"
 #include "csv_parser.h"
@@ -59,24 +69,47 @@
 
 namespace {
 struct ExtractMapFn {
+    typedef BlockTable result_type;
     QString mode;
     QMap<QString, QString> defines;
     QString typeName;
     bool keepEsc;
-    QList<ExtractedBlock> operator()(const QString &fpath) const {
-        QList<ExtractedBlock> res;
-        QString text = TextExtractor::readTextFile(fpath);
-        QString t = (mode == QStringLiteral("effective")) ? TextExtractor::preprocess(text, defines) : text;
-        auto b = TextExtractor::extractBlocks(t, fpath, typeName, keepEsc);
-        res.append(b);
-        return res;
+    std::shared_ptr<ExtractCache> cache;
+    std::shared_ptr<const Preprocessor::IncludeContext> includes;
+    BlockTable operator()(const QString &fpath) const {
+        // 与 scanDirectory 共用单文件提取（含 effective→raw 回退）与增量缓存；结果保持列式，归约时直接写出
+        auto compute = [&](const QByteArray *content) { return TextExtractor::extractFileTable(fpath, mode, defines, typeName, keepEsc, includes.get(), content); };
+        return cache ? cache->table(fpath, compute) : compute(nullptr);
+    }
+};
+struct ExtractArraysMapFn {
+    typedef QList<ExtractedArray> result_type;
+    QString mode;
+    QMap<QString, QString> defines;
+    QString typeName;
+    bool keepEsc;
+    std::shared_ptr<ExtractCache> cache;
+    std::shared_ptr<const Preprocessor::IncludeContext> includes;
+    QList<ExtractedArray> operator()(const QString &fpath) const {
+        auto compute = [&](const QByteArray *content) { return TextExtractor::extractArraysFile(fpath, mode, defines, typeName, keepEsc, includes.get(), content); };
+        return cache ? cache->arrays(fpath, compute) : compute(nullptr);
     }
 };
-struct ExtractReduceFn {
-    void operator()(QList<ExtractedBlock> &result, const QList<ExtractedBlock> &mapped) const {
+struct ExtractArraysReduceFn {
+    void operator()(QList<ExtractedArray> &result, const QList<ExtractedArray> &mapped) const {
         result.append(mapped);
     }
 };
+struct DispMessageMapFn {
+    typedef QList<ExtractedBlock> result_type;
+    QString mode;
+    QMap<QString, QString> defines;
+    std::shared_ptr<ExtractCache> cache;
+    QList<ExtractedBlock> operator()(const QString &fpath) const {
+        auto compute = [&](const QByteArray *content) { return TextExtractor::extractDispMessageInfoFile(fpath, mode, defines, nullptr, content); };
+        return cache ? cache->blocks(fpath, compute) : compute(nullptr);
+    }
+};
 }
 
 MainWindow::MainWindow(QWidget *parent)
@@ -97,108 +130,39 @@ MainWindow::MainWindow(QWidget *parent)
             });
     // 初始化提取流程的并发监视器与进度回调
     m_extractWatcher = new QFutureWatcher<QList<ExtractedBlock>>(this);
-    connect(m_extractWatcher, &QFutureWatcher<QList<ExtractedBlock>>::progressRangeChanged, this, [this](int min, int max)
-            {
-                if (m_extractProgress)
-                {
-                    m_extractProgress->setMinimum(min);
-                    m_extractProgress->setMaximum(max);
-                }
-            });
-    connect(m_extractWatcher, &QFutureWatcher<QList<ExtractedBlock>>::progressValueChanged, this, [this](int value)
-            {
-                if (m_extractProgress)
-                    m_extractProgress->setValue(value);
-            });
+    connectExtractProgress(m_extractWatcher);
     connect(m_extractWatcher, &QFutureWatcher<QList<ExtractedBlock>>::finished, this, [this]
             {
-                // 1) 取出并发任务结果：所有提取到的块（未经筛选）
-                QList<ExtractedBlock> all = m_extractWatcher->result();
+                // 1) 取出并发任务结果：归约阶段已按文件顺序筛选、合并译文并流式写出，这里只剩预览行
+                const QList<ExtractedBlock> preview = m_extractWatcher->result();
+                std::shared_ptr<ExtractSink> sink = m_extractSink;
+                m_extractSink.reset();
                 // 记录原始总数，便于新手观察流程统计
-                m_lastTotalBlocks = all.size();
+                m_lastTotalBlocks = sink ? sink->total : 0;
                 log(QStringLiteral("[完成] 并发提取结束，原始块数=%1").arg(m_lastTotalBlocks));
-
-                // 2) 如启用了“仅中文”，根据语言列位置筛选出含中文字符的条目
-                if (m_extractChineseOnly)
+                saveExtractCache(m_extractCache);
+                m_extractCache.reset();
+                if (m_resultsModel)
                 {
-                    log(QStringLiteral("[筛选] 开始中文筛选（语言列=%1）").arg(m_extractLangCols.join(QStringLiteral(", "))));
-                    auto hasChinese = [](const QString &s) {
-                        // 使用 Unicode 范围匹配常用中文字符（基础汉字、扩展A、CJK符号）
-                        static const QRegularExpression re(QStringLiteral("[\\x{3400}-\\x{4DBF}\\x{4E00}-\\x{9FFF}\\x{3000}-\\x{303F}]"));
-                        return re.match(s).hasMatch();
-                    };
-                    // 找到中文列的索引（如 *_cn、*_zh、*_chs、*_hans）
-                    QList<int> cnIdx;
-                    for (int i = 0; i < m_extractLangCols.size(); ++i)
-                    {
-                        const QString col = m_extractLangCols.at(i).toLower();
-                        if (col.endsWith(QLatin1String("_cn")) || col.endsWith(QLatin1String("_zh")) || col.endsWith(QLatin1String("_chs")) || col.endsWith(QLatin1String("_hans")))
-                            cnIdx.push_back(i);
-                    }
-                    QList<ExtractedBlock> filtered;
-                    for (const auto &r : all)
-                    {
-                        bool keep = cnIdx.isEmpty(); // 若未发现中文列，则不过滤
-                        for (int idx : cnIdx)
-                        {
-                            if (idx >= 0 && idx < r.strings.size())
-                            {
-                                if (hasChinese(r.strings.at(idx))) { keep = true; break; }
-                            }
-                        }
-                        if (keep) filtered.push_back(r);
-                    }
-                    all.swap(filtered);
-                    m_lastFilteredBlocks = all.size();
-                    log(QStringLiteral("[筛选] 中文筛选完成，保留块数=%1").arg(m_lastFilteredBlocks));
+                    m_resultsModel->finish();
+                    log(QStringLiteral("[结果] 结果表已载入 %1 行（约 %2 KB）")
+                            .arg(m_resultsModel->storedRows())
+                            .arg(m_resultsModel->memoryBytes() / 1024));
                 }
 
+                // 2) 如启用了“仅中文”，筛选已在归约中完成，这里只输出统计
+                const int kept = sink ? sink->kept : 0;
+                if (m_extractChineseOnly)
                 {
-                    QFileInfo fi(m_extractOutCsv);
-                    QString transCsv = fi.dir().absoluteFilePath(QStringLiteral("ty_text_cn.csv"));
-                    QString err;
-                    QList<CsvRow> trs = Csv::parseFile(transCsv, err);
-                    if (err.isEmpty() && !trs.isEmpty())
-                    {
-                        QMap<QString, CsvRow> idx;
-                        auto norm = [](const QString &p){ return QDir::fromNativeSeparators(p).toLower(); };
-                        for (const auto &r : trs)
-                        {
-                            QString key = norm(r.sourcePath) + QStringLiteral("|") + r.variableName.toLower();
-                            idx.insert(key, r);
-                        }
-                        for (auto &r : all)
-                        {
-                            QString key = norm(r.sourceFile) + QStringLiteral("|") + r.variableName.toLower();
-                            if (idx.contains(key))
-                            {
-                                const CsvRow &cr = idx.value(key);
-                                if (!m_extractLangCols.isEmpty())
-                                {
-                                    int need = m_extractLangCols.size();
-                                    while (r.strings.size() < need)
-                                        r.strings.append(QString());
-                                    for (int i = 0; i < need; ++i)
-                                    {
-                                        if (i < cr.values.size())
-                                        {
-                                            const QString &v = cr.values.at(i);
-                                            if (!v.isEmpty())
-                                                r.strings[i] = v;
-                                        }
-                                    }
-                                }
-                            }
-                        }
-                    }
+                    m_lastFilteredBlocks = kept;
+                    log(QStringLiteral("[筛选] 中文筛选完成，保留块数=%1").arg(m_lastFilteredBlocks));
                 }
 
-                log(QStringLiteral("[写入] 写入CSV：%1（列=%2；直写列=%3；替换英文逗号=%4）")
-                        .arg(m_extractOutCsv)
-                        .arg(m_extractLangCols.join(QStringLiteral(", ")))
-                        .arg(m_extractLiteralCols.join(QStringLiteral(", ")))
-                        .arg(m_extractReplaceCommaFlag ? QStringLiteral("是") : QStringLiteral("否")));
-                bool ok = TextExtractor::writeCsv(m_extractOutCsv, all, m_extractLangCols, m_extractLiteralCols, m_extractReplaceCommaFlag);
+                // 3) 关闭流式写出器（刷新缓冲）
+                bool ok = sink && sink->writer && sink->writer->close();
+                if (sink && sink->writer && sink->writer->writtenFiles().size() > 1)
+                    log(QStringLiteral("[写入] 已分片写出 %1 个文件").arg(sink->writer->writtenFiles().size()));
+                finishExtractPerf(m_extractRoot);
 
                 // 4) 收尾：恢复光标与状态栏、更新进度条
                 QApplication::restoreOverrideCursor();
@@ -208,27 +172,28 @@ MainWindow::MainWindow(QWidget *parent)
 
                 if (ok)
                 {
-                    int preview = qMin(5, all.size());
-                    for (int i = 0; i < preview; ++i)
+                    if (m_extractLiveCheck && m_extractLiveCheck->isChecked())
+                        startLiveExtract();
+                    for (const auto &r : preview)
                     {
-                        const auto &r = all.at(i);
                         QString first = r.strings.isEmpty() ? QStringLiteral("(empty)") : r.strings.first();
                         log(QStringLiteral("[预览] %1:%2 %3 -> %4").arg(QFileInfo(r.sourceFile).fileName()).arg(r.lineNumber).arg(r.variableName).arg(first));
                     }
                     if (m_extractChineseOnly)
                         QMessageBox::information(this, QStringLiteral("中文提取完成"), QStringLiteral("CSV 已生成：%1\n中文条目数：%2\n原始块数：%3")
                                                              .arg(m_extractOutCsv)
-                                                             .arg(all.size())
+                                                             .arg(kept)
                                                              .arg(m_lastTotalBlocks));
                     else
                         QMessageBox::information(this, QStringLiteral("提取完成"), QStringLiteral("CSV 已生成：%1\n共提取 %2 项")
                                                              .arg(m_extractOutCsv)
-                                                             .arg(all.size()));
+                                                             .arg(kept));
                     QDesktopServices::openUrl(QUrl::fromLocalFile(QFileInfo(m_extractOutCsv).dir().absolutePath()));
                 }
                 else
                 {
-                    QMessageBox::critical(this, QStringLiteral("提取失败"), QStringLiteral("处理失败"));
+                    QMessageBox::critical(this, QStringLiteral("提取失败"),
+                                          (sink && sink->writer && !sink->writer->errorString().isEmpty()) ? sink->writer->errorString() : QStringLiteral("处理失败"));
                 }
             });
     setupUiContent();
@@ -329,8 +294,47 @@ void MainWindow::setupUiContent()
     extractTopLayout->addStretch();
     extractTopLayout->addWidget(m_browseProjectBtn);
     extractLayout->addWidget(extractTop);
-    // 主体 splitter
-    extractLayout->addWidget(splitter, 1);
+    // 主体：项目文件（splitter）与提取结果两个视图
+    QTabWidget *extractViews = new QTabWidget(extractPage);
+    extractViews->addTab(splitter, QStringLiteral("项目文件"));
+    QWidget *resultsPage = new QWidget(extractViews);
+    QVBoxLayout *resultsLayout = new QVBoxLayout(resultsPage);
+    resultsLayout->setContentsMargins(0, 0, 0, 0);
+    QWidget *resultsTop = new QWidget(resultsPage);
+    QHBoxLayout *resultsTopLayout = new QHBoxLayout(resultsTop);
+    resultsTopLayout->setContentsMargins(0, 0, 0, 0);
+    m_resultsFilterEdit = new QLineEdit(resultsTop);
+    m_resultsFilterEdit->setPlaceholderText(QStringLiteral("筛选：变量名 / 文本 / 文件名"));
+    m_resultsFilterEdit->setClearButtonEnabled(true);
+    m_resultsStatusLabel = new QLabel(resultsTop);
+    resultsTopLayout->addWidget(new QLabel(QStringLiteral("筛选:")));
+    resultsTopLayout->addWidget(m_resultsFilterEdit, 1);
+    resultsTopLayout->addWidget(m_resultsStatusLabel);
+    m_resultsModel = new ExtractResultsModel(this);
+    m_resultsView = new QTableView(resultsPage);
+    m_resultsView->setModel(m_resultsModel);
+    m_resultsView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_resultsView->setWordWrap(false);
+    // 固定行高与交互列宽：20 万行时视图不逐行测量
+    m_resultsView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    m_resultsView->verticalHeader()->setDefaultSectionSize(m_resultsView->fontMetrics().height() + 6);
+    m_resultsView->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
+    m_resultsView->horizontalHeader()->setStretchLastSection(true);
+    // 初始不排序；点击表头后由模型在后台线程排序
+    m_resultsView->horizontalHeader()->setSortIndicator(-1, Qt::AscendingOrder);
+    m_resultsView->setSortingEnabled(true);
+    resultsLayout->addWidget(resultsTop);
+    resultsLayout->addWidget(m_resultsView, 1);
+    extractViews->addTab(resultsPage, QStringLiteral("提取结果"));
+    // 输入停顿 250ms 后再筛选，避免逐字触发后台任务
+    QTimer *filterDelay = new QTimer(this);
+    filterDelay->setSingleShot(true);
+    filterDelay->setInterval(250);
+    connect(m_resultsFilterEdit, &QLineEdit::textChanged, filterDelay, QOverload<>::of(&QTimer::start));
+    connect(filterDelay, &QTimer::timeout, this, [this] { m_resultsModel->setFilterText(m_resultsFilterEdit->text()); });
+    connect(m_resultsModel, &ExtractResultsModel::viewChanged, this, [this] { updateResultsStatus(); });
+    updateResultsStatus();
+    extractLayout->addWidget(extractViews, 1);
     // 选项与执行按钮
     QWidget *extractBottom = new QWidget(extractPage);
     QVBoxLayout *extractBottomLayout = new QVBoxLayout(extractBottom);
@@ -340,7 +344,7 @@ void MainWindow::setupUiContent()
     m_extractTypeCombo = new QComboBox(exRow1);
     m_extractTypeCombo->addItems(QStringList{QStringLiteral("动态文本")});
     m_extractModeCombo = new QComboBox(exRow1);
-    m_extractModeCombo->addItems(QStringList{QStringLiteral("effective"), QStringLiteral("all")});
+    m_extractModeCombo->addItems(QStringList{QStringLiteral("effective"), QStringLiteral("effective_includes"), QStringLiteral("all")});
     m_extractKeepEscapes = new QCheckBox(QStringLiteral("保留转义字符"), exRow1);
     m_extractKeepEscapes->setChecked(true);
     m_extractKeepEscapes->setToolTip(QStringLiteral("提取时保留原始转义，如\\xNN、\\n、\\t 等"));
@@ -351,6 +355,16 @@ void MainWindow::setupUiContent()
     exH1->addWidget(m_extractModeCombo);
     exH1->addSpacing(12);
     exH1->addWidget(m_extractKeepEscapes);
+    m_extractLiveCheck = new QCheckBox(QStringLiteral("实时模式"), exRow1);
+    m_extractLiveCheck->setToolTip(QStringLiteral("提取完成后监视项目目录，源文件改动时只重提改动的文件并更新 CSV"));
+    connect(m_extractLiveCheck, &QCheckBox::toggled, this, [this](bool on)
+            {
+        if (on)
+            log(QStringLiteral("[实时] 已开启：下次提取完成后开始监视"));
+        else
+            stopLiveExtract(QStringLiteral("已关闭实时模式")); });
+    exH1->addSpacing(12);
+    exH1->addWidget(m_extractLiveCheck);
     exH1->addStretch();
     // 行2：扩展名、宏定义、执行按钮
     QWidget *exRow2 = new QWidget(extractBottom);
@@ -372,11 +386,23 @@ void MainWindow::setupUiContent()
     m_extractProgress->setMinimum(0);
     m_extractProgress->setMaximum(100);
     m_extractProgress->setValue(0);
+    // 并发线程数：默认取 CPU 理想线程数，作用于全局线程池
+    m_extractThreadsSpin = new QSpinBox(exRow2);
+    m_extractThreadsSpin->setRange(1, qMax(64, QThread::idealThreadCount()));
+    m_extractThreadsSpin->setValue(qMax(1, QThread::idealThreadCount()));
+    m_extractThreadsSpin->setToolTip(QStringLiteral("提取时并发处理文件的线程数"));
+    m_extractUseCache = new QCheckBox(QStringLiteral("增量缓存"), exRow2);
+    m_extractUseCache->setChecked(true);
+    m_extractUseCache->setToolTip(QStringLiteral("复用 .csv_lang_cache 中未改动文件的提取结果"));
     exH2->addWidget(new QLabel(QStringLiteral("扩展:")));
     exH2->addWidget(m_extractExtsEdit, 1);
     exH2->addSpacing(12);
     exH2->addWidget(new QLabel(QStringLiteral("宏定义:")));
     exH2->addWidget(m_extractDefinesEdit, 1);
+    exH2->addSpacing(12);
+    exH2->addWidget(new QLabel(QStringLiteral("线程:")));
+    exH2->addWidget(m_extractThreadsSpin);
+    exH2->addWidget(m_extractUseCache);
     exH2->addStretch();
     exH2->addWidget(m_extractProgress);
     exH2->addWidget(m_extractRunBtn);
@@ -394,12 +420,21 @@ void MainWindow::setupUiContent()
     m_extractReplaceComma = new QCheckBox(QStringLiteral("替换英文逗号为中文逗号"), exRow3);
     m_extractReplaceComma->setToolTip(QStringLiteral("将文本中的 , 替换为 ，，避免CSV处理时误分列或换行"));
     m_extractReplaceComma->setChecked(true);
+    // 分片写出为显式选项：0 表示不分片，其余按行数切分为 _partNN.csv
+    m_extractShardRowsSpin = new QSpinBox(exRow3);
+    m_extractShardRowsSpin->setRange(0, 10000000);
+    m_extractShardRowsSpin->setSingleStep(1000);
+    m_extractShardRowsSpin->setValue(0);
+    m_extractShardRowsSpin->setSpecialValueText(QStringLiteral("不分片"));
     exH3->addWidget(m_extractUtf8Literal);
     exH3->addSpacing(12);
     exH3->addWidget(new QLabel(QStringLiteral("保留原文语言列:")));
     exH3->addWidget(m_extractUtf8ColsEdit, 1);
     exH3->addSpacing(12);
     exH3->addWidget(m_extractReplaceComma);
+    exH3->addSpacing(12);
+    exH3->addWidget(new QLabel(QStringLiteral("分片行数:")));
+    exH3->addWidget(m_extractShardRowsSpin);
     extractBottomLayout->addWidget(exRow1);
     extractBottomLayout->addWidget(exRow2);
     extractBottomLayout->addWidget(exRow3);
@@ -506,6 +541,16 @@ void MainWindow::setupUiContent()
     genO3->addSpacing(12);
     genO3->addWidget(new QLabel(QStringLiteral("每行条目:")));
     genO3->addWidget(m_genPerLineSpin);
+    m_genPoolCombo = new QComboBox(genOpts3);
+    m_genPoolCombo->addItems({"off", "dedup", "suffix"});
+    m_genPoolCombo->setToolTip(QStringLiteral("字符串池：dedup 全部译文去重存入一块 UTF-8 池；suffix 另合并互为后缀的字符串"));
+    genO3->addSpacing(12);
+    genO3->addWidget(new QLabel(QStringLiteral("字符串池:")));
+    genO3->addWidget(m_genPoolCombo);
+    m_genCatalog = new QCheckBox(QStringLiteral("同时输出二进制目录(.trc)"), genOpts3);
+    m_genCatalog->setToolTip(QStringLiteral("与 C 文件同名的 .trc 译文目录，固件可 mmap 后按变量名查找"));
+    genO3->addSpacing(12);
+    genO3->addWidget(m_genCatalog);
 
     m_generateRunBtn = new QPushButton(QStringLiteral("生成"), genPage);
     connect(m_generateRunBtn, SIGNAL(clicked()), this, SLOT(onGenerateRun()));
@@ -677,6 +722,177 @@ void MainWindow::log(const QString &msg)
     }
 }
 
+/**
+ * @brief 将并发任务的进度信号接到提取进度条（Bind watcher progress to the bar）
+ * @param watcher 任意结果类型的 QFutureWatcher（mappedReduced 按文件上报进度）
+ */
+void MainWindow::connectExtractProgress(QFutureWatcherBase *watcher)
+{
+    connect(watcher, &QFutureWatcherBase::progressRangeChanged, this, [this](int min, int max)
+            {
+                if (m_extractProgress)
+                {
+                    m_extractProgress->setMinimum(min);
+                    m_extractProgress->setMaximum(max);
+                }
+            });
+    connect(watcher, &QFutureWatcherBase::progressValueChanged, this, [this](int value)
+            {
+                if (m_extractProgress)
+                    m_extractProgress->setValue(value);
+            });
+}
+
+/**
+ * @brief 应用界面选择的并发线程数（Apply worker thread count）
+ * 说明：Qt5 的 mappedReduced 只使用全局线程池，因此直接设置全局池上限。
+ */
+void MainWindow::applyExtractThreadCount()
+{
+    if (m_extractThreadsSpin)
+        QThreadPool::globalInstance()->setMaxThreadCount(m_extractThreadsSpin->value());
+}
+
+/**
+ * @brief 按界面开关打开增量提取缓存（Open the incremental extraction cache）
+ * @return 未勾选“增量缓存”时返回空指针，映射函数直接提取
+ */
+std::shared_ptr<ExtractCache> MainWindow::openExtractCache(const QString &root, const QString &kind, const QString &mode,
+                                                           const QMap<QString, QString> &defines, const QString &typeName, bool keepEsc)
+{
+    if (!m_extractUseCache || !m_extractUseCache->isChecked())
+        return nullptr;
+    auto cache = std::make_shared<ExtractCache>(root, kind, mode, defines, typeName, keepEsc);
+    cache->load();
+    return cache;
+}
+
+/**
+ * @brief 创建流式写出上下文（Create the streaming extract sink）
+ * 先读取同目录已有的 ty_text_cn.csv 译文（中文提取时它即输出文件，须在截断前读取），再打开写出器。
+ * @return 无法打开输出文件时返回空指针
+ */
+std::shared_ptr<ExtractSink> MainWindow::openExtractSink()
+{
+    if (m_extractChineseOnly)
+        log(QStringLiteral("[筛选] 启用中文筛选（语言列=%1）").arg(m_extractLangCols.join(QStringLiteral(", "))));
+    Csv::WriteOptions opts;
+    opts.langColumns = m_extractLangCols;
+    opts.literalColumns = m_extractLiteralCols;
+    opts.replaceAsciiCommaWithCn = m_extractReplaceCommaFlag;
+    opts.shardRows = m_extractShardRowsSpin ? m_extractShardRowsSpin->value() : 0;
+    log(QStringLiteral("[写入] 流式写入CSV：%1（列=%2；直写列=%3；替换英文逗号=%4；分片行数=%5）")
+            .arg(m_extractOutCsv)
+            .arg(m_extractLangCols.join(QStringLiteral(", ")))
+            .arg(m_extractLiteralCols.join(QStringLiteral(", ")))
+            .arg(m_extractReplaceCommaFlag ? QStringLiteral("是") : QStringLiteral("否"))
+            .arg(opts.shardRows));
+    std::shared_ptr<ExtractSink> sink = ExtractSink::open(m_extractOutCsv, opts, m_extractChineseOnly);
+    if (sink && m_resultsModel)
+    {
+        // 结果表随归约增量填充；文件列显示为相对项目目录的路径
+        ExtractResultsModel *model = m_resultsModel;
+        const quint64 generation = model->reset(m_extractLangCols, QFileInfo(m_extractOutCsv).absolutePath());
+        sink->observer = [model, generation](const QList<ExtractedBlock> &rows) { model->enqueue(generation, rows); };
+    }
+    return sink;
+}
+
+/**
+ * @brief 以最近一次提取的参数开始实时监视（Start watching with the last extraction's settings）
+ * 初始结果集在后台经缓存重建；之后每批改动只重提改动文件，并经 openExtractSink 重写 CSV 与结果表。
+ */
+void MainWindow::startLiveExtract()
+{
+    stopLiveExtract(QString());
+    if (!m_extractFileFn || m_extractRoot.isEmpty())
+        return;
+    m_live = new LiveExtractor(m_extractRoot, m_extractExts, m_extractFileFn, [this] { return openExtractSink(); }, this);
+    connect(m_live, &LiveExtractor::ready, this, [this](int files, int blocks)
+            { log(QStringLiteral("[实时] 正在监视 %1 个文件（%2 块），源文件改动后自动更新 CSV").arg(files).arg(blocks)); });
+    connect(m_live, &LiveExtractor::updated, this, [this](const QStringList &files, int rows, qint64 ms)
+            {
+        if (m_resultsModel)
+            m_resultsModel->finish();
+        QStringList names;
+        for (const QString &f : files)
+            names << QFileInfo(f).fileName();
+        log(QStringLiteral("[实时] %1 → CSV %2 行，耗时 %3 ms").arg(names.join(QStringLiteral(", "))).arg(rows).arg(ms)); });
+    connect(m_live, &LiveExtractor::failed, this, [this](const QString &err)
+            { log(QStringLiteral("[实时] 更新失败：%1").arg(err)); });
+    log(QStringLiteral("[实时] 建立结果集：%1").arg(m_extractRoot));
+    m_live->start();
+}
+
+/**
+ * @brief 停止实时监视（Stop the live session）
+ * @param reason 非空时写入日志
+ */
+void MainWindow::stopLiveExtract(const QString &reason)
+{
+    if (!m_live)
+        return;
+    m_live->stop();
+    m_live->deleteLater();
+    m_live = nullptr;
+    if (!reason.isEmpty())
+        log(QStringLiteral("[实时] 已停止监视（%1）").arg(reason));
+}
+
+/**
+ * @brief 刷新提取结果状态标签（Update results row count / busy label）
+ */
+void MainWindow::updateResultsStatus()
+{
+    if (!m_resultsModel || !m_resultsStatusLabel)
+        return;
+    QString text = QStringLiteral("显示 %1 / 共 %2 行").arg(m_resultsModel->rowCount()).arg(m_resultsModel->storedRows());
+    const int dropped = m_resultsModel->droppedRows();
+    if (dropped > 0)
+        text += QStringLiteral("（超出上限未显示 %1 行，完整结果见 CSV）").arg(dropped);
+    if (m_resultsModel->isBusy())
+        text += QStringLiteral("  筛选/排序中…");
+    m_resultsStatusLabel->setText(text);
+}
+
+/**
+ * @brief 写回增量缓存并记录命中统计（Persist cache and log hit/miss）
+ */
+void MainWindow::saveExtractCache(const std::shared_ptr<ExtractCache> &cache)
+{
+    if (!cache)
+        return;
+    const bool ok = cache->save();
+    log(QStringLiteral("[缓存] 命中=%1, 重新解析=%2, %3：%4")
+            .arg(cache->hitCount())
+            .arg(cache->missCount())
+            .arg(ok ? QStringLiteral("已写入") : QStringLiteral("写入失败"), cache->cacheFilePath()));
+}
+
+/**
+ * @brief 开始收集本次提取的阶段耗时（Start per-stage timing for this extraction）
+ */
+void MainWindow::beginExtractPerf()
+{
+    m_extractPerf.reset(new PerfStats::Run);
+}
+
+/**
+ * @brief 记录阶段耗时到日志，并写出 <root>/logs/extract_perf.json
+ */
+void MainWindow::finishExtractPerf(const QString &root)
+{
+    if (!m_extractPerf)
+        return;
+    const PerfStats::Report report = m_extractPerf->report();
+    m_extractPerf.reset();
+    for (const QString &line : PerfStats::formatLines(report))
+        log(line);
+    const QString path = QDir(root).absoluteFilePath(QStringLiteral("logs/extract_perf.json"));
+    if (PerfStats::writeJson(path, report, QJsonObject{{QStringLiteral("root"), root}}))
+        log(QStringLiteral("[耗时] JSON：%1").arg(path));
+}
+
 /**
  * @brief 设置当前浏览路径并刷新目录与文件视图
  * @param path 目标路径
@@ -692,6 +908,8 @@ void MainWindow::setCurrentPath(const QString &path)
         m_table->setRootIndex(m_fileModel->setRootPath(path));
         m_pathEdit->setText(path);
         log(QStringLiteral("进入目录: ") + path);
+        if (m_live && QDir(path) != QDir(m_live->root()))
+            stopLiveExtract(QStringLiteral("已切换项目目录"));
         // 根据新路径刷新“保留原文语言”复选框
         refreshExtractLanguageChecks();
     }
@@ -798,6 +1016,8 @@ void MainWindow::onExtractRun()
         QMessageBox::warning(this, QStringLiteral("提取"), QStringLiteral("请选择或输入有效的项目目录。"));
         return;
     }
+    // 语言列发现、文件收集、缓存指纹与包含目录共用一次目录遍历
+    DirWalker::Scope walkScope(realDir);
     const QString outCsv = QDir(realDir).absoluteFilePath(QStringLiteral("ty_text_out.csv")); // 输出文件名（常规）
     const QString mode = m_extractModeCombo ? m_extractModeCombo->currentText() : QStringLiteral("effective"); // 解析模式（effective/everything）
     log(QStringLiteral("[提取] 目录=%1, 输出=%2, 模式=%3, 保留转义=%4").arg(realDir, outCsv, mode).arg(keepEsc ? QStringLiteral("是") : QStringLiteral("否")));
@@ -875,18 +1095,7 @@ void MainWindow::onExtractRun()
     }
     log(QStringLiteral("[提取] 直写列（不转义）：%1").arg(literalCols.join(QStringLiteral(", "))));
     // 收集文件列表
-    QStringList files;
-    QDirIterator it(realDir, QDir::Files, QDirIterator::Subdirectories);
-    auto matchExt = [&](const QString &fn)
-    { for (const QString &e : exts) if (fn.toLower().endsWith(e.toLower())) return true; return false; };
-    while (it.hasNext())
-    {
-        const QString f = it.next();
-        if (f.contains(QStringLiteral("/csv_import_sandbox/")) || f.contains(QStringLiteral("\\csv_import_sandbox\\")) ||
-            f.contains(QStringLiteral("/.csv_lang_backups/")) || f.contains(QStringLiteral("\\.csv_lang_backups\\")))
-            continue;
-        if (matchExt(QFileInfo(f).fileName())) files << f;
-    }
+    const QStringList files = TextExtractor::collectSourceFiles(realDir, exts);
     if (files.isEmpty())
     {
         QMessageBox::warning(this, QStringLiteral("提取"), QStringLiteral("未找到匹配的源文件。"));
@@ -900,20 +1109,27 @@ void MainWindow::onExtractRun()
     m_extractLiteralCols = literalCols;
     m_extractReplaceCommaFlag = m_extractReplaceComma && m_extractReplaceComma->isChecked();
     m_extractChineseOnly = false;
+    stopLiveExtract(QStringLiteral("重新提取"));
+    m_extractSink = openExtractSink();
+    if (!m_extractSink)
+    {
+        QMessageBox::critical(this, QStringLiteral("提取失败"), QStringLiteral("无法写入 CSV：%1").arg(outCsv));
+        return;
+    }
     statusBar()->showMessage(QStringLiteral("正在提取 %1 个文件…").arg(files.size()));
     QApplication::setOverrideCursor(Qt::BusyCursor);
     log(QStringLiteral("[提取] 启动并发任务（QtConcurrent）"));
-    ExtractMapFn mapFn{mode, defines, typeName, keepEsc};
-    ExtractReduceFn reduceFn{};
-    auto future = QtConcurrent::run([files, mapFn, reduceFn]() {
-        QList<ExtractedBlock> out;
-        for (const QString &f : files)
-        {
-            QList<ExtractedBlock> mapped = mapFn(f);
-            reduceFn(out, mapped);
-        }
-        return out;
-    });
+    applyExtractThreadCount();
+    beginExtractPerf();
+    m_extractCache = openExtractCache(realDir, QStringLiteral("blocks"), mode, defines, typeName, keepEsc);
+    ExtractMapFn mapFn{mode, defines, typeName, keepEsc, m_extractCache, TextExtractor::makeIncludeContext(realDir, mode, defines)};
+    m_extractRoot = realDir;
+    m_extractExts = exts;
+    m_extractFileFn = mapFn;
+    // 按文件并发映射，OrderedReduce 保证结果顺序与文件列表一致；进度按文件上报
+    // 归约阶段直接流式写 CSV，内存不随行数增长
+    auto future = QtConcurrent::mappedReduced<QList<ExtractedBlock>>(files, mapFn, ExtractReduceFn{m_extractSink},
+                                                                     QtConcurrent::OrderedReduce | QtConcurrent::SequentialReduce);
     m_extractWatcher->setFuture(future);
 }
 
@@ -933,6 +1149,7 @@ void MainWindow::onExtractChinese()
         QMessageBox::warning(this, QStringLiteral("提取"), QStringLiteral("请选择或输入有效的项目目录。"));
         return;
     }
+    DirWalker::Scope walkScope(realDir);
     const QString outCsv = QDir(realDir).absoluteFilePath(QStringLiteral("ty_text_cn.csv")); // 输出中文专用文件
     const QString mode = m_extractModeCombo ? m_extractModeCombo->currentText() : QStringLiteral("effective"); // 解析模式
     log(QStringLiteral("[中文提取] 目录=%1, 输出=%2, 模式=%3, 保留转义=%4").arg(dir, outCsv, mode).arg(keepEsc ? QStringLiteral("是") : QStringLiteral("否")));
@@ -974,18 +1191,7 @@ void MainWindow::onExtractChinese()
     if (literalCols.isEmpty()) literalCols << QStringLiteral("text_cn");
     log(QStringLiteral("[中文提取] 中文直写列：%1").arg(literalCols.join(QStringLiteral(", "))));
     // 收集文件
-    QStringList files;
-    QDirIterator it(realDir, QDir::Files, QDirIterator::Subdirectories);
-    auto matchExt = [&](const QString &fn)
-    { for (const QString &e : exts) if (fn.toLower().endsWith(e.toLower())) return true; return false; };
-    while (it.hasNext())
-    {
-        const QString f = it.next();
-        if (f.contains(QStringLiteral("/csv_import_sandbox/")) || f.contains(QStringLiteral("\\csv_import_sandbox\\")) ||
-            f.contains(QStringLiteral("/.csv_lang_backups/")) || f.contains(QStringLiteral("\\.csv_lang_backups\\")))
-            continue;
-        if (matchExt(QFileInfo(f).fileName())) files << f;
-    }
+    const QStringList files = TextExtractor::collectSourceFiles(realDir, exts);
     if (files.isEmpty())
     {
         QMessageBox::warning(this, QStringLiteral("提取"), QStringLiteral("未找到匹配的源文件。"));
@@ -999,20 +1205,27 @@ void MainWindow::onExtractChinese()
     m_extractLiteralCols = literalCols;
     m_extractReplaceCommaFlag = m_extractReplaceComma && m_extractReplaceComma->isChecked();
     m_extractChineseOnly = true;
+    stopLiveExtract(QStringLiteral("重新提取"));
+    m_extractSink = openExtractSink();
+    if (!m_extractSink)
+    {
+        QMessageBox::critical(this, QStringLiteral("提取失败"), QStringLiteral("无法写入 CSV：%1").arg(outCsv));
+        return;
+    }
     statusBar()->showMessage(QStringLiteral("正在提取 %1 个文件（中文筛选）…").arg(files.size()));
     QApplication::setOverrideCursor(Qt::BusyCursor);
     log(QStringLiteral("[中文提取] 启动并发任务（QtConcurrent）"));
-    ExtractMapFn mapFn{mode, defines, typeName, keepEsc};
-    ExtractReduceFn reduceFn{};
-    auto future = QtConcurrent::run([files, mapFn, reduceFn]() {
-        QList<ExtractedBlock> out;
-        for (const QString &f : files)
-        {
-            QList<ExtractedBlock> mapped = mapFn(f);
-            reduceFn(out, mapped);
-        }
-        return out;
-    });
+    applyExtractThreadCount();
+    beginExtractPerf();
+    m_extractCache = openExtractCache(realDir, QStringLiteral("blocks"), mode, defines, typeName, keepEsc);
+    ExtractMapFn mapFn{mode, defines, typeName, keepEsc, m_extractCache, TextExtractor::makeIncludeContext(realDir, mode, defines)};
+    m_extractRoot = realDir;
+    m_extractExts = exts;
+    m_extractFileFn = mapFn;
+    // 按文件并发映射，OrderedReduce 保证结果顺序与文件列表一致；进度按文件上报
+    // 归约阶段直接流式写 CSV，内存不随行数增长
+    auto future = QtConcurrent::mappedReduced<QList<ExtractedBlock>>(files, mapFn, ExtractReduceFn{m_extractSink},
+                                                                     QtConcurrent::OrderedReduce | QtConcurrent::SequentialReduce);
     m_extractWatcher->setFuture(future);
 }
 
@@ -1029,6 +1242,7 @@ void MainWindow::onExtractArrays()
         QMessageBox::warning(this, QStringLiteral("提取"), QStringLiteral("请选择或输入项目根目录。"));
         return;
     }
+    DirWalker::Scope walkScope(dir);
     const QString outCsv = QDir(dir).absoluteFilePath(QStringLiteral("ty_text_arrays.csv"));
     const QString mode = m_extractModeCombo ? m_extractModeCombo->currentText() : QStringLiteral("effective");
     log(QStringLiteral("[数组提取] 目录=%1, 输出=%2, 模式=%3").arg(dir, outCsv, mode));
@@ -1057,18 +1271,25 @@ void MainWindow::onExtractArrays()
     {
         literalCols = langCols;
     }
-    // 并发提取数组
-    statusBar()->showMessage(QStringLiteral("正在提取结构体数组…"));
+    // 并发提取数组：按文件映射归约，进度条按文件推进
+    const QStringList files = TextExtractor::collectSourceFiles(dir, exts);
+    statusBar()->showMessage(QStringLiteral("正在提取结构体数组（%1 个文件）…").arg(files.size()));
     QApplication::setOverrideCursor(Qt::BusyCursor);
-    auto future = QtConcurrent::run([dir, exts, mode, typeName, keepEsc]() {
-        return TextExtractor::scanDirectoryArrays(dir, exts, mode, QMap<QString, QString>{}, typeName, keepEsc);
-    });
+    applyExtractThreadCount();
+    beginExtractPerf();
+    auto cache = openExtractCache(dir, QStringLiteral("arrays"), mode, QMap<QString, QString>{}, typeName, keepEsc);
+    ExtractArraysMapFn mapFn{mode, QMap<QString, QString>{}, typeName, keepEsc, cache, TextExtractor::makeIncludeContext(dir, mode, QMap<QString, QString>{})};
+    auto future = QtConcurrent::mappedReduced<QList<ExtractedArray>>(files, mapFn, ExtractArraysReduceFn(),
+                                                                      QtConcurrent::OrderedReduce | QtConcurrent::SequentialReduce);
     auto watcher = new QFutureWatcher<QList<ExtractedArray>>(this);
-    connect(watcher, &QFutureWatcher<QList<ExtractedArray>>::finished, this, [this, watcher, outCsv, langCols, literalCols]() {
+    connectExtractProgress(watcher);
+    connect(watcher, &QFutureWatcher<QList<ExtractedArray>>::finished, this, [this, watcher, dir, outCsv, langCols, literalCols, cache]() {
         QList<ExtractedArray> arrays = watcher->result();
+        saveExtractCache(cache);
         QApplication::restoreOverrideCursor();
         statusBar()->clearMessage();
         bool ok = TextExtractor::writeArraysCsv(outCsv, arrays, langCols, literalCols, m_extractReplaceComma && m_extractReplaceComma->isChecked());
+        finishExtractPerf(dir);
         if (ok)
         {
             log(QStringLiteral("数组提取完成：%1，数组数=%2").arg(outCsv).arg(arrays.size()));
@@ -1121,8 +1342,13 @@ void MainWindow::onGenerateRun()
     const QString annotate = m_genAnnotateCombo ? m_genAnnotateCombo->currentText() : QString("names");
     const int perLine = m_genPerLineSpin ? m_genPerLineSpin->value() : 1;
     const bool fillEng = m_genFillMissingWithEnglish && m_genFillMissingWithEnglish->isChecked();
+    const QString poolMode = m_genPoolCombo ? m_genPoolCombo->currentText() : QString();
+    const QString catalogOut = (m_genCatalog && m_genCatalog->isChecked())
+                                   ? QFileInfo(outc).dir().absoluteFilePath(QFileInfo(outc).completeBaseName() + QStringLiteral(".trc"))
+                                   : QString();
     QString typeName = "_Tr_TEXT";
-    QString code = TextExtractor::generateCFromCsv(
+    TextExtractor::GenerateStats gen;
+    TextExtractor::generateCFromCsv(
         csv,
         typeName,
         outc,
@@ -1138,15 +1364,33 @@ void MainWindow::onGenerateRun()
         annotate,
         perLine,
         QMap<QString, QPair<QString, QString>>(),
-        QString());
-    if (!code.isEmpty())
-    {
+        QString(),
+        poolMode,
+        catalogOut,
+        QString(),
+        &gen);
+    if (gen.error.isEmpty())
+    {
+        log(QStringLiteral("[生成] 语言顺序来源=%1，共 %2 项：%3").arg(gen.layoutOrigin).arg(gen.rows).arg(gen.columns.join(QLatin1Char(','))));
+        if (!gen.pool.isEmpty())
+        {
+            qint64 naive = 0;
+            for (const StringPool::GroupStats &g : gen.pool)
+            {
+                naive += g.naiveBytes;
+                log(QStringLiteral("[字符串池] %1：%2 条，%3 → %4 字节，节省 %5").arg(g.name).arg(g.strings).arg(g.naiveBytes).arg(g.pooledBytes).arg(g.savedBytes()));
+            }
+            log(QStringLiteral("[字符串池] 合计 %1 → %2 字节，节省 %3（后缀合并 %4 条）").arg(naive).arg(gen.poolBytes).arg(naive - gen.poolBytes).arg(gen.poolMerged));
+        }
+        if (!catalogOut.isEmpty())
+            log(QStringLiteral("[生成] 二进制目录：%1（%2 字节）").arg(catalogOut).arg(gen.catalogBytes));
         log(QStringLiteral("生成完成：%1 和 %2").arg(outc, headerOut));
         QMessageBox::information(this, QStringLiteral("生成完成"), QStringLiteral("已生成：\n%1\n%2").arg(outc, headerOut));
     }
     else
     {
-        QMessageBox::critical(this, QStringLiteral("生成失败"), QStringLiteral("生成内容为空，请检查CSV格式。"));
+        log(QStringLiteral("[生成] 失败：%1").arg(gen.error));
+        QMessageBox::critical(this, QStringLiteral("生成失败"), QStringLiteral("生成失败，请检查CSV格式。\n%1").arg(gen.error));
     }
 }
 
@@ -1163,27 +1407,58 @@ void MainWindow::onReadErrors()
     QMap<QString, QString> defines;
     QString mode = QStringLiteral("effective");
     log(QStringLiteral("[读取报错] 扫描 DispMessageInfo 并写入: %1").arg(outCsv));
-    QList<ExtractedBlock> rows = TextExtractor::scanDispMessageInfo(root, exts, mode, defines);
-    if (rows.isEmpty())
-    {
-        QMessageBox::information(this, QStringLiteral("读取报错"), QStringLiteral("未发现 DispMessageInfo 初始化"));
-        return;
-    }
-    QString typeName = QStringLiteral("_Tr_TEXT");
-    QStringList langCols = TextExtractor::discoverLanguageColumns(root, exts, typeName);
-    if (langCols.isEmpty())
-        langCols = TextExtractor::defaultLanguageColumns();
-    QStringList literalCols; literalCols << QStringLiteral("text_cn") << QStringLiteral("text_en");
-    bool ok = TextExtractor::writeCsv(outCsv, rows, langCols, literalCols, true);
-    if (ok)
-    {
-        QMessageBox::information(this, QStringLiteral("读取报错完成"), QStringLiteral("CSV 已生成：%1\n记录数：%2").arg(outCsv).arg(rows.size()));
-        QDesktopServices::openUrl(QUrl::fromLocalFile(QFileInfo(outCsv).dir().absolutePath()));
-    }
-    else
-    {
-        QMessageBox::critical(this, QStringLiteral("写入失败"), QStringLiteral("无法写入 CSV：%1").arg(outCsv));
-    }
+    // 后台并发扫描，避免阻塞界面；语言列发现与扫描同时在工作线程进行，CSV 也在工作线程写出
+    const QStringList files = TextExtractor::collectSourceFiles(root, exts);
+    statusBar()->showMessage(QStringLiteral("正在读取报错（%1 个文件）…").arg(files.size()));
+    QApplication::setOverrideCursor(Qt::BusyCursor);
+    applyExtractThreadCount();
+    beginExtractPerf();
+    const QFuture<QStringList> langFuture = QtConcurrent::run(TextExtractor::discoverLanguageColumns, root, exts, QStringLiteral("_Tr_TEXT"));
+    auto cache = openExtractCache(root, QStringLiteral("disp"), mode, defines, QStringLiteral("DispMessageInfo"), false);
+    DispMessageMapFn mapFn{mode, defines, cache};
+    auto future = QtConcurrent::mappedReduced<QList<ExtractedBlock>>(files, mapFn, ExtractReduceFn(),
+                                                                     QtConcurrent::OrderedReduce | QtConcurrent::SequentialReduce);
+    auto watcher = new QFutureWatcher<QList<ExtractedBlock>>(this);
+    connectExtractProgress(watcher);
+    connect(watcher, &QFutureWatcher<QList<ExtractedBlock>>::finished, this, [this, watcher, root, outCsv, cache, langFuture]() {
+        const QList<ExtractedBlock> rows = watcher->result();
+        saveExtractCache(cache);
+        watcher->deleteLater();
+        if (rows.isEmpty())
+        {
+            QApplication::restoreOverrideCursor();
+            statusBar()->clearMessage();
+            finishExtractPerf(root);
+            QMessageBox::information(this, QStringLiteral("读取报错"), QStringLiteral("未发现 DispMessageInfo 初始化"));
+            return;
+        }
+        statusBar()->showMessage(QStringLiteral("正在写出 %1 …").arg(outCsv));
+        auto writeWatcher = new QFutureWatcher<bool>(this);
+        connect(writeWatcher, &QFutureWatcher<bool>::finished, this, [this, writeWatcher, root, outCsv, count = rows.size()]() {
+            const bool ok = writeWatcher->result();
+            writeWatcher->deleteLater();
+            QApplication::restoreOverrideCursor();
+            statusBar()->clearMessage();
+            finishExtractPerf(root);
+            if (ok)
+            {
+                QMessageBox::information(this, QStringLiteral("读取报错完成"), QStringLiteral("CSV 已生成：%1\n记录数：%2").arg(outCsv).arg(count));
+                QDesktopServices::openUrl(QUrl::fromLocalFile(QFileInfo(outCsv).dir().absolutePath()));
+            }
+            else
+            {
+                QMessageBox::critical(this, QStringLiteral("写入失败"), QStringLiteral("无法写入 CSV：%1").arg(outCsv));
+            }
+        });
+        writeWatcher->setFuture(QtConcurrent::run([rows, outCsv, langFuture]() {
+            QStringList langCols = langFuture.result(); // 通常已随扫描完成
+            if (langCols.isEmpty())
+                langCols = TextExtractor::defaultLanguageColumns();
+            const QStringList literalCols{QStringLiteral("text_cn"), QStringLiteral("text_en")};
+            return TextExtractor::writeCsv(outCsv, rows, langCols, literalCols, true);
+        }));
+    });
+    watcher->setFuture(future);
 }
 
 /**
@@ -1226,7 +1501,7 @@ void MainWindow::onInitNewLanguage()
     }
     else
     {
-    QMessageBox::warning(this, QStringLiteral("未变更"), res.message);
+    QMessageBox::warning(this, res.failed ? QStringLiteral("失败") : QStringLiteral("未变更"), res.message);
     }
 }
 
@@ -1280,7 +1555,7 @@ void MainWindow::onFillEnglishMissing()
     }
     else
     {
-        QMessageBox::warning(this, QStringLiteral("未变更"), res.message);
+        QMessageBox::warning(this, res.failed ? QStringLiteral("失败") : QStringLiteral("未变更"), res.message);
     }
 }
 
@@ -1353,6 +1628,7 @@ void MainWindow::onRunCsvImport()
         QString lastLogPath;
         QString lastDiffPath;
         QString lastOutputDir;
+        QStringList perfLines;
         QStringList allSuccessFiles;
         QStringList allSkippedFiles;
         QStringList allFailedFiles;
@@ -1386,6 +1662,7 @@ void MainWindow::onRunCsvImport()
             totals->lastLogPath = stats.logPath;
             totals->lastDiffPath = stats.diffPath;
             totals->lastOutputDir = stats.outputDir;
+            totals->perfLines << QStringLiteral("[耗时] %1").arg(fi.fileName()) << PerfStats::formatLines(stats.perf);
             totals->allSuccessFiles.append(stats.successFiles);
             totals->allSkippedFiles.append(stats.skippedFiles);
             totals->allFailedFiles.append(stats.failedFiles);
@@ -1406,6 +1683,8 @@ void MainWindow::onRunCsvImport()
                              .arg(totals->lastOutputDir);
         m_csvReportView->setPlainText(report);
         log(QStringLiteral("CSV导入完成：文件 %1 成功 %2 跳过 %3 失败 %4").arg(csvFiles.size()).arg(totals->totalSuccess).arg(totals->totalSkip).arg(totals->totalFail));
+        for (const QString &line : totals->perfLines)
+            log(line);
         Q_UNUSED(csvFiles);
         m_csvRunBtn->setEnabled(true);
         watcher->deleteLater();
@@ -1454,7 +1733,7 @@ void MainWindow::onRunArrayCsvImport()
         QString f = part.trimmed();
         if (!f.isEmpty()) csvFiles << f;
     }
-    struct ImportTotals { int totalSuccess{0}; int totalSkip{0}; int totalFail{0}; QString lastLogPath; QString lastDiffPath; QString lastOutputDir; };
+    struct ImportTotals { int totalSuccess{0}; int totalSkip{0}; int totalFail{0}; QString lastLogPath; QString lastDiffPath; QString lastOutputDir; QStringList perfLines; };
     auto totals = std::make_shared<ImportTotals>();
     m_csvRunArraysBtn->setEnabled(false);
     auto watcher = new QFutureWatcher<void>(this);
@@ -1475,6 +1754,7 @@ void MainWindow::onRunArrayCsvImport()
             totals->lastLogPath = stats.logPath;
             totals->lastDiffPath = stats.diffPath;
             totals->lastOutputDir = stats.outputDir;
+            totals->perfLines << QStringLiteral("[耗时] %1").arg(fi.fileName()) << PerfStats::formatLines(stats.perf);
             int prog = 5 + ((i + 1) * 90) / qMax(1, csvFiles.size());
             QMetaObject::invokeMethod(m_csvProgress, "setValue", Qt::QueuedConnection, Q_ARG(int, qMin(95, prog)));
         }
@@ -1490,6 +1770,8 @@ void MainWindow::onRunArrayCsvImport()
                              .arg(totals->lastDiffPath);
         m_csvReportView->setPlainText(report);
         log(QStringLiteral("数组CSV导入完成：成功 %1 跳过 %2 失败 %3").arg(totals->totalSuccess).arg(totals->totalSkip).arg(totals->totalFail));
+        for (const QString &line : totals->perfLines)
+            log(line);
         m_csvRunArraysBtn->setEnabled(true);
         watcher->deleteLater();
     });
@@ -1543,7 +1825,7 @@ void MainWindow::onRunErrorsCsvImport()
         if (!f.isEmpty()) csvFiles << f;
     }
 
-    struct ImportTotals { int totalSuccess{0}; int totalSkip{0}; int totalFail{0}; QString lastLogPath; QString lastDiffPath; QString lastOutputDir; };
+    struct ImportTotals { int totalSuccess{0}; int totalSkip{0}; int totalFail{0}; QString lastLogPath; QString lastDiffPath; QString lastOutputDir; QStringList perfLines; };
     auto totals = std::make_shared<ImportTotals>();
 
     m_csvRunBtn->setEnabled(false);
@@ -1566,6 +1848,7 @@ void MainWindow::onRunErrorsCsvImport()
             totals->lastLogPath = stats.logPath;
             totals->lastDiffPath = stats.diffPath;
             totals->lastOutputDir = stats.outputDir;
+            totals->perfLines << QStringLiteral("[耗时] %1").arg(fi.fileName()) << PerfStats::formatLines(stats.perf);
             int prog = 5 + ((i + 1) * 90) / qMax(1, csvFiles.size());
             QMetaObject::invokeMethod(m_csvProgress, "setValue", Qt::QueuedConnection, Q_ARG(int, qMin(95, prog)));
         }
@@ -1580,6 +1863,8 @@ void MainWindow::onRunErrorsCsvImport()
                              .arg(totals->lastDiffPath);
         m_csvReportView->setPlainText(report);
         log(QStringLiteral("报错文本导入完成：成功 %1 跳过 %2 失败 %3").arg(totals->totalSuccess).arg(totals->totalSkip).arg(totals->totalFail));
+        for (const QString &line : totals->perfLines)
+            log(line);
         m_csvRunBtn->setEnabled(true);
         watcher->deleteLater();
     });
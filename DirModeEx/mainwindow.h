@@ -26,6 +26,10 @@
 #include <QFutureWatcher>
 #include <QMutex>
 #include "text_extractor.h"
+#include "block_table.h"
+#include "perf_stats.h"
+#include <memory>
+#include <functional>
 
 // 前置声明以避免头文件包含不足导致的类型未识别错误
 class QFileSystemModel;
@@ -42,6 +46,10 @@ class QTextEdit;
 class QSpinBox;
 class QLabel;
 class QProgressBar;
+class ExtractCache;
+struct ExtractSink;
+class ExtractResultsModel;
+class LiveExtractor;
 #include <QFileSystemModel>
 #include <QTabWidget>
 #include <QTextEdit>
@@ -189,6 +197,35 @@ private:
     // 并发提取进度与监视器
     QProgressBar *m_extractProgress{nullptr};
     QFutureWatcher<QList<ExtractedBlock>> *m_extractWatcher{nullptr};
+    QSpinBox *m_extractThreadsSpin{nullptr}; // 并发提取线程数
+    QCheckBox *m_extractUseCache{nullptr};   // 是否启用增量提取缓存
+    std::shared_ptr<ExtractCache> m_extractCache; // 当前提取任务使用的缓存
+    std::shared_ptr<ExtractSink> m_extractSink;   // 当前提取任务的流式写出上下文
+    QSpinBox *m_extractShardRowsSpin{nullptr};    // CSV 分片行数（0 不分片）
+    // 提取结果浏览：列式模型 + 筛选框
+    ExtractResultsModel *m_resultsModel{nullptr};
+    QTableView *m_resultsView{nullptr};
+    QLineEdit *m_resultsFilterEdit{nullptr};
+    QLabel *m_resultsStatusLabel{nullptr};
+    void updateResultsStatus();
+    // 实时模式：提取完成后监视项目目录，仅重提改动文件并重写 CSV
+    QCheckBox *m_extractLiveCheck{nullptr};
+    LiveExtractor *m_live{nullptr};
+    QString m_extractRoot;
+    QStringList m_extractExts;
+    std::function<BlockTable(const QString &)> m_extractFileFn; // 本次提取的单文件函数（含缓存）
+    void startLiveExtract();
+    void stopLiveExtract(const QString &reason);
+    std::shared_ptr<ExtractSink> openExtractSink();
+    void connectExtractProgress(QFutureWatcherBase *watcher);
+    void applyExtractThreadCount();
+    std::shared_ptr<ExtractCache> openExtractCache(const QString &root, const QString &kind, const QString &mode,
+                                                   const QMap<QString, QString> &defines, const QString &typeName, bool keepEsc);
+    void saveExtractCache(const std::shared_ptr<ExtractCache> &cache);
+    // 本次提取的阶段耗时收集（开始于打开缓存前，结束于写完 CSV）
+    std::unique_ptr<PerfStats::Run> m_extractPerf;
+    void beginExtractPerf();
+    void finishExtractPerf(const QString &root);
     // 提取完成后所需上下文
     QString m_extractOutCsv;
     QStringList m_extractLangCols;
@@ -218,6 +255,8 @@ private:
     QCheckBox *m_genFillMissingWithEnglish{nullptr};
     QComboBox *m_genAnnotateCombo{nullptr};
     QSpinBox *m_genPerLineSpin{nullptr};
+    QComboBox *m_genPoolCombo{nullptr};
+    QCheckBox *m_genCatalog{nullptr};
 
     // 设置 & 日志
     QTextEdit *m_settingsInfo{nullptr};
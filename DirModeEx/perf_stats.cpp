@@ -0,0 +1,186 @@
+/**
+ * @file perf_stats.cpp
+ * @brief 分阶段计时实现（Per-stage timing implementation）
+ *
+ * 累计值存于进程级表，Run 记录创建时的快照，report() 返回差值；
+ * Timer 以文件或批为粒度调用，每次析构加锁一次，不在逐行路径上计时。
+ */
+#include "perf_stats.h"
+#include <QAtomicInt>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QMutex>
+#include <QSaveFile>
+#include <algorithm>
+
+namespace
+{
+    QAtomicInt g_runs{0};
+
+    QMutex &lock()
+    {
+        static QMutex m;
+        return m;
+    }
+
+    QMap<QString, PerfStats::Counter> &totals()
+    {
+        static QMap<QString, PerfStats::Counter> t;
+        return t;
+    }
+
+    QString label(const QString &stage)
+    {
+        static const QMap<QString, QString> names{
+            {QStringLiteral("decode"), QStringLiteral("读取解码")},
+            {QStringLiteral("preprocess"), QStringLiteral("预处理")},
+            {QStringLiteral("extract"), QStringLiteral("提取")},
+            {QStringLiteral("extract_arrays"), QStringLiteral("数组提取")},
+            {QStringLiteral("extract_shard"), QStringLiteral("大文件分片")},
+            {QStringLiteral("csv_write"), QStringLiteral("CSV 写出")},
+            {QStringLiteral("csv_parse"), QStringLiteral("CSV 解析")},
+            {QStringLiteral("symbol_index"), QStringLiteral("符号索引")},
+            {QStringLiteral("plan"), QStringLiteral("匹配规划")},
+            {QStringLiteral("rewrite"), QStringLiteral("替换")},
+            {QStringLiteral("diff"), QStringLiteral("差异")},
+            {QStringLiteral("backup"), QStringLiteral("备份")},
+            {QStringLiteral("write"), QStringLiteral("写回")},
+            {QStringLiteral("cache_hit"), QStringLiteral("缓存命中")},
+            {QStringLiteral("cache_miss"), QStringLiteral("缓存未命中")},
+            {QStringLiteral("regex_compile"), QStringLiteral("正则编译")}};
+        const QString n = names.value(stage);
+        return n.isEmpty() ? stage : QStringLiteral("%1(%2)").arg(stage, n);
+    }
+
+    double mbPerSec(const PerfStats::Counter &c)
+    {
+        return c.nanos > 0 ? double(c.bytes) / (1024.0 * 1024.0) / (double(c.nanos) / 1e9) : 0.0;
+    }
+}
+
+namespace PerfStats
+{
+
+    bool enabled()
+    {
+        return g_runs.loadAcquire() > 0;
+    }
+
+    void add(const char *stage, qint64 nanos, qint64 bytes, qint64 items, qint64 calls)
+    {
+        const QString key = QLatin1String(stage);
+        QMutexLocker locker(&lock());
+        Counter &c = totals()[key];
+        c.nanos += nanos;
+        c.calls += calls;
+        c.bytes += bytes;
+        c.items += items;
+    }
+
+    Timer::Timer(const char *stage)
+        : m_stage(stage), m_on(enabled())
+    {
+        if (m_on)
+            m_clock.start();
+    }
+
+    Timer::~Timer()
+    {
+        stop();
+    }
+
+    void Timer::stop()
+    {
+        if (m_on)
+            add(m_stage, m_clock.nsecsElapsed(), m_bytes, m_items);
+        m_on = false;
+    }
+
+    Run::Run()
+    {
+        QMutexLocker locker(&lock());
+        // 无其他 Run 时清空，避免进程级表无限累积
+        if (g_runs.fetchAndAddRelaxed(1) == 0)
+            totals().clear();
+        m_start = totals();
+        m_clock.start();
+    }
+
+    Run::~Run()
+    {
+        g_runs.fetchAndAddRelaxed(-1);
+    }
+
+    Report Run::report() const
+    {
+        Report r;
+        r.wallNanos = m_clock.nsecsElapsed();
+        QMutexLocker locker(&lock());
+        for (auto it = totals().constBegin(); it != totals().constEnd(); ++it)
+        {
+            Counter c = it.value();
+            const Counter base = m_start.value(it.key());
+            c.nanos -= base.nanos;
+            c.calls -= base.calls;
+            c.bytes -= base.bytes;
+            c.items -= base.items;
+            if (c.calls > 0 || c.bytes > 0)
+                r.stages.insert(it.key(), c);
+        }
+        return r;
+    }
+
+    QStringList formatLines(const Report &report)
+    {
+        QStringList lines;
+        lines << QStringLiteral("[耗时] 总计 %1 ms（并发阶段为各线程累计）").arg(double(report.wallNanos) / 1e6, 0, 'f', 1);
+        QList<QString> order = report.stages.keys();
+        std::stable_sort(order.begin(), order.end(), [&](const QString &a, const QString &b) { return report.stages.value(a).nanos > report.stages.value(b).nanos; });
+        for (const QString &name : order)
+        {
+            const Counter &c = report.stages[name];
+            QString line = QStringLiteral("[耗时] %1: ").arg(label(name));
+            if (c.nanos > 0)
+                line += QStringLiteral("%1 ms, ").arg(double(c.nanos) / 1e6, 0, 'f', 1);
+            line += QStringLiteral("调用 %1, 条目 %2").arg(c.calls).arg(c.items);
+            if (c.bytes > 0)
+                line += QStringLiteral(", %1 KB").arg(c.bytes / 1024);
+            if (c.bytes > 0 && c.nanos > 0)
+                line += QStringLiteral(", %1 MB/s").arg(mbPerSec(c), 0, 'f', 1);
+            lines << line;
+        }
+        return lines;
+    }
+
+    QJsonObject toJson(const Report &report)
+    {
+        QJsonObject stages;
+        for (auto it = report.stages.constBegin(); it != report.stages.constEnd(); ++it)
+        {
+            const Counter &c = it.value();
+            QJsonObject o{{QStringLiteral("ms"), double(c.nanos) / 1e6},
+                          {QStringLiteral("calls"), c.calls},
+                          {QStringLiteral("bytes"), c.bytes},
+                          {QStringLiteral("items"), c.items}};
+            if (c.bytes > 0 && c.nanos > 0)
+                o.insert(QStringLiteral("mb_per_s"), mbPerSec(c));
+            stages.insert(it.key(), o);
+        }
+        return QJsonObject{{QStringLiteral("wall_ms"), double(report.wallNanos) / 1e6}, {QStringLiteral("stages"), stages}};
+    }
+
+    bool writeJson(const QString &path, const Report &report, const QJsonObject &extra)
+    {
+        QJsonObject obj = toJson(report);
+        for (auto it = extra.constBegin(); it != extra.constEnd(); ++it)
+            obj.insert(it.key(), it.value());
+        QDir().mkpath(QFileInfo(path).absolutePath());
+        QSaveFile f(path);
+        if (!f.open(QIODevice::WriteOnly))
+            return false;
+        f.write(QJsonDocument(obj).toJson(QJsonDocument::Indented));
+        return f.commit();
+    }
+
+}
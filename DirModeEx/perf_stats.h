@@ -0,0 +1,130 @@
+/**
+ * @file perf_stats.h
+ * @brief 分阶段计时与计数接口（Per-stage timing and counter APIs）
+ *
+ * 功能名称：运行级耗时统计（Scoped instrumentation aggregated per run）
+ * 主要用途：
+ * - 解码、预处理、提取、CSV 写出/解析、符号索引、替换、差异、备份、写回等阶段以 Timer 记录耗时、字节数与条目数；
+ * - 缓存命中/未命中等纯计数以 count 记录；
+ * - Run 存活期间才收集，无 Run 时 Timer 只做一次原子读取；
+ * - 汇总结果可格式化为日志行（MainWindow::log、csv_integrity_report.log）或 JSON（看板、命令行 result 事件）；
+ *
+ * 使用示例：
+ *  PerfStats::Run run;
+ *  { PerfStats::Timer t("decode"); text = decode(data); t.addBytes(data.size()); }
+ *  for (const QString &line : PerfStats::formatLines(run.report())) log(line);
+ */
+#ifndef PERF_STATS_H
+#define PERF_STATS_H
+
+#include <QString>
+#include <QStringList>
+#include <QMap>
+#include <QJsonObject>
+#include <QElapsedTimer>
+
+namespace PerfStats {
+
+/**
+ * @brief 单个阶段的累计值（Accumulated values of one stage）
+ * 并发阶段的耗时为各线程之和，可能大于整次运行的墙钟时间。
+ */
+struct Counter
+{
+    qint64 nanos{0};
+    qint64 calls{0};
+    qint64 bytes{0};  // 解码、CSV 为字节；预处理、提取等文本阶段为 UTF-16 字符数
+    qint64 items{0};  // 文件数、行数或命中次数，视阶段而定
+};
+
+/**
+ * @brief 一次运行的汇总（Per-run report）
+ */
+struct Report
+{
+    qint64 wallNanos{0};            // Run 创建至 report() 的墙钟时间
+    QMap<QString, Counter> stages;  // 阶段名 → 累计值
+};
+
+/** @brief 是否有 Run 正在收集 */
+bool enabled();
+
+/**
+ * @brief 直接累加到阶段（Add to a stage without a Timer）
+ * @param calls 调用次数增量；只补充字节数时传 0
+ */
+void add(const char *stage, qint64 nanos, qint64 bytes, qint64 items, qint64 calls = 1);
+
+/** @brief 纯计数（如 cache_hit / cache_miss） */
+inline void count(const char *stage, qint64 items = 1)
+{
+    if (enabled())
+        add(stage, 0, 0, items);
+}
+
+/**
+ * @class Timer
+ * @brief 作用域计时（Scoped timer, records on destruction）
+ */
+class Timer
+{
+public:
+    explicit Timer(const char *stage);
+    ~Timer();
+    Timer(const Timer &) = delete;
+    Timer &operator=(const Timer &) = delete;
+
+    void addBytes(qint64 n) { m_bytes += n; }
+    void addItems(qint64 n) { m_items += n; }
+    /** @brief 提前结束并记录（之后析构不再记录） */
+    void stop();
+
+private:
+    const char *m_stage;
+    QElapsedTimer m_clock;
+    qint64 m_bytes{0};
+    qint64 m_items{0};
+    bool m_on{false};
+};
+
+/**
+ * @class Run
+ * @brief 收集作用域（Collection scope for one run）
+ *
+ * 可嵌套；report() 只含本 Run 创建之后的增量。计数为进程级，
+ * 同时进行的两次运行（如界面提取与实时模式）会互相计入对方的阶段。
+ */
+class Run
+{
+public:
+    Run();
+    ~Run();
+    Run(const Run &) = delete;
+    Run &operator=(const Run &) = delete;
+
+    Report report() const;
+
+private:
+    QMap<QString, Counter> m_start;
+    QElapsedTimer m_clock;
+};
+
+/**
+ * @brief 格式化为日志行：首行为总耗时，其后每个阶段一行，按耗时降序
+ */
+QStringList formatLines(const Report &report);
+
+/**
+ * @brief 转为 JSON：{"wall_ms": ..., "stages": {"decode": {"ms", "calls", "bytes", "items", "mb_per_s"}, ...}}
+ */
+QJsonObject toJson(const Report &report);
+
+/**
+ * @brief 写出 JSON 文件（UTF-8，缩进格式）
+ * @param extra 合并到顶层的附加字段（如 command、root）
+ */
+bool writeJson(const QString &path, const Report &report, const QJsonObject &extra = QJsonObject());
+
+}
+
+#endif // PERF_STATS_H
@@ -0,0 +1,382 @@
+/**
+ * @file preprocessor.cpp
+ * @brief 条件编译预处理实现（Conditional-compilation preprocessor implementation）
+ *
+ * 逐行扫描（不使用正则）：跟踪块注释状态，仅在注释外、行首为 '#' 时识别指令，
+ * 反斜杠续行合并为一条逻辑指令；条件表达式经 CondExpr::compileCached 编译一次后反复求值。
+ */
+#include "preprocessor.h"
+#include "text_codec.h"
+#include "text_extractor.h"
+#include "perf_stats.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QMutexLocker>
+
+namespace Preprocessor
+{
+
+    namespace
+    {
+        const int kMaxIncludeDepth = 32;
+
+        bool isIdentChar(QChar c)
+        {
+            return c.isLetterOrNumber() || c == QLatin1Char('_');
+        }
+
+        // 扫描一行并更新块注释状态；code 非空时写入去注释后的代码（注释以空格代替）
+        void scanComments(const QString &line, bool &inBlock, QString *code)
+        {
+            const int n = line.size();
+            QChar quote;
+            for (int i = 0; i < n; ++i)
+            {
+                const QChar c = line.at(i);
+                const QChar next = (i + 1 < n) ? line.at(i + 1) : QChar();
+                if (inBlock)
+                {
+                    if (c == QLatin1Char('*') && next == QLatin1Char('/'))
+                    {
+                        inBlock = false;
+                        ++i;
+                        if (code)
+                            code->append(QLatin1Char(' '));
+                    }
+                    continue;
+                }
+                if (!quote.isNull())
+                {
+                    if (code)
+                        code->append(c);
+                    if (c == QLatin1Char('\\') && i + 1 < n)
+                    {
+                        if (code)
+                            code->append(next);
+                        ++i;
+                    }
+                    else if (c == quote)
+                        quote = QChar();
+                    continue;
+                }
+                if (c == QLatin1Char('/') && next == QLatin1Char('*'))
+                {
+                    inBlock = true;
+                    ++i;
+                    continue;
+                }
+                if (c == QLatin1Char('/') && next == QLatin1Char('/'))
+                    break;
+                if (c == QLatin1Char('"') || c == QLatin1Char('\''))
+                    quote = c;
+                if (code)
+                    code->append(c);
+            }
+        }
+
+        // 行首（忽略空白）是否为 '#'
+        bool looksLikeDirective(const QString &line)
+        {
+            for (const QChar c : line)
+            {
+                if (c == QLatin1Char('#'))
+                    return true;
+                if (!c.isSpace())
+                    return false;
+            }
+            return false;
+        }
+
+        // 拆分指令名与参数
+        void splitDirective(const QString &code, QString &name, QString &arg)
+        {
+            const int n = code.size();
+            int i = code.indexOf(QLatin1Char('#')) + 1;
+            while (i < n && code.at(i).isSpace())
+                ++i;
+            int j = i;
+            while (j < n && isIdentChar(code.at(j)))
+                ++j;
+            name = code.mid(i, j - i);
+            arg = code.mid(j).trimmed();
+        }
+
+        // 参数首个标识符（#ifdef/#ifndef/#undef）
+        QString leadingIdent(const QString &arg)
+        {
+            int j = 0;
+            while (j < arg.size() && isIdentChar(arg.at(j)))
+                ++j;
+            return arg.left(j);
+        }
+
+        // 解析 #define：对象宏取替换文本；函数式宏只登记名称，取值为替换体
+        bool parseDefine(const QString &arg, MacroOp &op)
+        {
+            const QString name = leadingIdent(arg);
+            if (name.isEmpty() || name.at(0).isDigit())
+                return false;
+            op.undef = false;
+            op.name = name;
+            int rest = name.size();
+            if (rest < arg.size() && arg.at(rest) == QLatin1Char('('))
+            {
+                const int close = arg.indexOf(QLatin1Char(')'), rest);
+                rest = (close < 0) ? arg.size() : close + 1;
+            }
+            op.value = arg.mid(rest).trimmed();
+            return true;
+        }
+
+        /**
+         * 处理一个文件的文本
+         * macros 为当前宏表（原地更新）；record 非空时追加生效的宏操作；out 为空指针时不生成输出（头文件）
+         */
+        void process(const QString &text, const QString &path, CondExpr::MacroTable &macros, QVector<MacroOp> *record,
+                     QStringList *out, const IncludeContext *includes, QSet<QString> &visiting)
+        {
+            struct Frame
+            {
+                bool outer; // 外层是否生效
+                bool taken; // 是否已有分支命中
+            };
+            QVector<Frame> stack;
+            bool active = true;
+            bool inBlock = false;
+            const QString dir = path.isEmpty() ? QString() : QFileInfo(path).absolutePath();
+            auto apply = [&](const MacroOp &op) {
+                if (op.undef)
+                    macros.remove(op.name);
+                else
+                    macros.insert(op.name, op.value);
+                if (record)
+                    record->append(op);
+            };
+            auto evalIf = [&](const QString &expr) {
+                return CondExpr::evaluate(CondExpr::compileCached(expr), macros);
+            };
+
+            const QStringList lines = text.split(QLatin1Char('\n'));
+            const int n = lines.size();
+            if (out)
+                out->reserve(n);
+            for (int i = 0; i < n; ++i)
+            {
+                const QString &line = lines.at(i);
+                if (inBlock || !looksLikeDirective(line))
+                {
+                    scanComments(line, inBlock, nullptr);
+                    if (out)
+                        out->append(active ? line : QString());
+                    continue;
+                }
+                // 续行合并为一条逻辑指令
+                QString logical = line;
+                int last = i;
+                while (last + 1 < n)
+                {
+                    QString tail = logical;
+                    while (tail.endsWith(QLatin1Char('\r')))
+                        tail.chop(1);
+                    if (!tail.endsWith(QLatin1Char('\\')))
+                        break;
+                    tail.chop(1);
+                    logical = tail + QLatin1Char(' ') + lines.at(++last);
+                }
+                QString code;
+                scanComments(logical, inBlock, &code);
+                QString name, arg;
+                splitDirective(code, name, arg);
+
+                bool conditional = true;
+                if (name == QLatin1String("if") || name == QLatin1String("ifdef") || name == QLatin1String("ifndef"))
+                {
+                    bool cond = false;
+                    if (active)
+                    {
+                        if (name == QLatin1String("if"))
+                            cond = evalIf(arg);
+                        else
+                            cond = macros.contains(leadingIdent(arg)) == (name == QLatin1String("ifdef"));
+                    }
+                    stack.append(Frame{active, cond});
+                    active = cond;
+                }
+                else if (name == QLatin1String("elif"))
+                {
+                    if (!stack.isEmpty())
+                    {
+                        Frame &f = stack.last();
+                        if (!f.outer || f.taken)
+                            active = false;
+                        else
+                        {
+                            active = evalIf(arg);
+                            f.taken = active;
+                        }
+                    }
+                }
+                else if (name == QLatin1String("else"))
+                {
+                    if (!stack.isEmpty())
+                    {
+                        Frame &f = stack.last();
+                        active = f.outer && !f.taken;
+                        f.taken = true;
+                    }
+                }
+                else if (name == QLatin1String("endif"))
+                {
+                    if (!stack.isEmpty())
+                        active = stack.takeLast().outer;
+                }
+                else
+                {
+                    conditional = false;
+                    if (active && name == QLatin1String("define"))
+                    {
+                        MacroOp op;
+                        if (parseDefine(arg, op))
+                            apply(op);
+                    }
+                    else if (active && name == QLatin1String("undef"))
+                    {
+                        MacroOp op;
+                        op.undef = true;
+                        op.name = leadingIdent(arg);
+                        if (!op.name.isEmpty())
+                            apply(op);
+                    }
+                    else if (active && includes && name == QLatin1String("include") && arg.size() > 2)
+                    {
+                        // 仅处理 "x" 与 <x>；宏形式的包含名无法静态确定，忽略
+                        const QChar open = arg.at(0);
+                        const QChar close = (open == QLatin1Char('<')) ? QLatin1Char('>') : QLatin1Char('"');
+                        const int end = arg.indexOf(close, 1);
+                        if ((open == QLatin1Char('"') || open == QLatin1Char('<')) && end > 1)
+                        {
+                            const QString header = includes->resolve(dir, arg.mid(1, end - 1), open == QLatin1Char('<'));
+                            if (!header.isEmpty() && !visiting.contains(header) && visiting.size() < kMaxIncludeDepth)
+                            {
+                                for (const MacroOp &op : includes->headerOps(header, visiting))
+                                    apply(op);
+                            }
+                        }
+                    }
+                }
+                if (out)
+                {
+                    // 条件指令与未生效区输出空行；其余指令保留原文，行数不变
+                    const bool keep = !conditional && active;
+                    for (int k = i; k <= last; ++k)
+                        out->append(keep ? lines.at(k) : QString());
+                }
+                i = last;
+            }
+        }
+
+        CondExpr::MacroTable toMacroTable(const QMap<QString, QString> &defines)
+        {
+            CondExpr::MacroTable t;
+            t.reserve(defines.size());
+            for (auto it = defines.constBegin(); it != defines.constEnd(); ++it)
+                t.insert(it.key(), it.value());
+            return t;
+        }
+    }
+
+    IncludeContext::IncludeContext(const QStringList &includeDirs, const QMap<QString, QString> &defines)
+        : m_dirs(includeDirs), m_base(toMacroTable(defines))
+    {
+    }
+
+    QStringList IncludeContext::searchDirs(const QString &root)
+    {
+        QStringList dirs;
+        QSet<QString> seen;
+        const QString rootAbs = QDir(root).absolutePath();
+        dirs << rootAbs;
+        seen.insert(rootAbs);
+        // 头文件列表已按路径排序，目录顺序稳定
+        for (const QString &h : TextExtractor::collectSourceFiles(root, QStringList{QStringLiteral(".h"), QStringLiteral(".hpp")}))
+        {
+            const QString d = QFileInfo(h).absolutePath();
+            if (!seen.contains(d))
+            {
+                seen.insert(d);
+                dirs << d;
+            }
+        }
+        return dirs;
+    }
+
+    QString IncludeContext::resolve(const QString &includerDir, const QString &name, bool angled) const
+    {
+        const QString key = (angled ? QString() : includerDir) + QLatin1Char('|') + name;
+        {
+            QMutexLocker lock(&m_mutex);
+            auto it = m_resolved.constFind(key);
+            if (it != m_resolved.constEnd())
+                return it.value();
+        }
+        QString found;
+        if (!angled && !includerDir.isEmpty())
+        {
+            const QFileInfo fi(QDir(includerDir).filePath(name));
+            if (fi.isFile())
+                found = fi.absoluteFilePath();
+        }
+        for (int i = 0; found.isEmpty() && i < m_dirs.size(); ++i)
+        {
+            const QFileInfo fi(QDir(m_dirs.at(i)).filePath(name));
+            if (fi.isFile())
+                found = fi.absoluteFilePath();
+        }
+        QMutexLocker lock(&m_mutex);
+        m_resolved.insert(key, found);
+        return found;
+    }
+
+    QVector<MacroOp> IncludeContext::headerOps(const QString &path, QSet<QString> &visiting) const
+    {
+        {
+            QMutexLocker lock(&m_mutex);
+            auto it = m_headers.constFind(path);
+            if (it != m_headers.constEnd())
+                return it.value();
+        }
+        // 头文件以基础宏独立求值（与包含位置无关），因此结果可被所有包含者复用
+        CondExpr::MacroTable macros = m_base;
+        QVector<MacroOp> ops;
+        visiting.insert(path);
+        process(TextCodec::readFile(path, nullptr, nullptr, TextCodec::Tie::Gb18030), path, macros, &ops, nullptr, this, visiting);
+        visiting.remove(path);
+        QMutexLocker lock(&m_mutex);
+        m_headers.insert(path, ops);
+        return ops;
+    }
+
+    int IncludeContext::headerCount() const
+    {
+        QMutexLocker lock(&m_mutex);
+        return m_headers.size();
+    }
+
+    QString run(const QString &text, const QString &path, const QMap<QString, QString> &defines, const IncludeContext *includes)
+    {
+        // 跟随包含时，首次读取头文件的耗时也计入本阶段
+        PerfStats::Timer timer("preprocess");
+        timer.addBytes(text.size());
+        timer.addItems(1);
+        CondExpr::MacroTable macros = toMacroTable(defines);
+        QStringList out;
+        QSet<QString> visiting;
+        if (!path.isEmpty())
+            visiting.insert(QFileInfo(path).absoluteFilePath());
+        process(text, path, macros, nullptr, &out, includes, visiting);
+        const QString result = out.join(QLatin1Char('\n'));
+        Q_ASSERT(result.count(QLatin1Char('\n')) == text.count(QLatin1Char('\n'))); // 行数不变（见 preprocessor.h）
+        return result;
+    }
+
+}
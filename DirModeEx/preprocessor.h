@@ -0,0 +1,100 @@
+/**
+ * @file preprocessor.h
+ * @brief 条件编译预处理接口（Conditional-compilation preprocessor APIs）
+ *
+ * 功能名称：保留行号的条件编译预处理（Line-preserving #if/#ifdef preprocessing）
+ * 主要用途：
+ * - 按 C 规则维护 #if/#ifdef/#ifndef/#elif/#else/#endif 条件栈，条件由 CondExpr 编译求值；
+ * - 生效区内的 #define/#undef 即时更新宏表，后续条件可见；
+ * - 条件指令行与未生效行输出为空行，其余行原样保留，输出行号与原文一致；
+ * - 可选跟随 #include：头文件按“基础宏 + 自身及其嵌套包含”独立求值一次，
+ *   得到的宏定义序列在同一 IncludeContext 内按头文件缓存，后续包含直接回放；
+ *
+ * 使用示例：
+ *  Preprocessor::IncludeContext inc(Preprocessor::IncludeContext::searchDirs(root), defines);
+ *  QString t = Preprocessor::run(text, path, defines, &inc);
+ */
+#ifndef PREPROCESSOR_H
+#define PREPROCESSOR_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QMap>
+#include <QSet>
+#include <QMutex>
+#include "cond_expr.h"
+
+namespace Preprocessor {
+
+/** @brief 宏定义操作（#define / #undef），按出现顺序记录 */
+struct MacroOp
+{
+    bool undef{false};
+    QString name;
+    QString value;
+};
+
+/**
+ * @class IncludeContext
+ * @brief 一次提取运行内共享的 #include 解析与头文件宏状态缓存
+ *
+ * 线程安全：resolve/headerOps 可在 QtConcurrent 工作线程并发调用；
+ * 同一头文件可能被两个线程同时首次计算，结果相同，后写入者覆盖即可。
+ */
+class IncludeContext
+{
+public:
+    /**
+     * @param includeDirs 头文件搜索目录（按顺序查找）
+     * @param defines 基础宏（界面/命令行给出的预定义）
+     */
+    IncludeContext(const QStringList &includeDirs, const QMap<QString, QString> &defines);
+
+    /** @brief 默认搜索目录：项目根目录及其下所有含 .h/.hpp 的目录（Root plus every header directory） */
+    static QStringList searchDirs(const QString &root);
+
+    /**
+     * @brief 解析包含路径
+     * @param includerDir 发起包含的文件所在目录（"x" 形式优先在此查找）
+     * @param name 包含名
+     * @param angled 是否为 <x> 形式
+     * @return 头文件绝对路径；找不到时返回空串（如系统头文件）
+     */
+    QString resolve(const QString &includerDir, const QString &name, bool angled) const;
+
+    /**
+     * @brief 头文件对宏表的影响（Ordered macro ops produced by a header, memoised）
+     * @param path 头文件绝对路径
+     * @param visiting 当前包含链（防止循环包含）
+     */
+    QVector<MacroOp> headerOps(const QString &path, QSet<QString> &visiting) const;
+
+    /** @brief 已缓存宏状态的头文件数 */
+    int headerCount() const;
+
+private:
+    QStringList m_dirs;
+    CondExpr::MacroTable m_base;
+    mutable QMutex m_mutex;
+    mutable QHash<QString, QVector<MacroOp>> m_headers;
+    mutable QHash<QString, QString> m_resolved; // 目录|名称 → 路径
+};
+
+/**
+ * @brief 预处理条件编译（Preprocess conditional compilation, preserving line numbers）
+ * @param text 源文本
+ * @param path 源文件路径（跟随包含时用于解析相对路径，可为空）
+ * @param defines 预定义宏与取值（空取值视为 1）
+ * @param includes 非空时跟随 #include 获取头文件中的宏定义
+ * @return 与原文行数相同的文本
+ *
+ * 行号约定：每个输入行恰好输出一行（条件指令、未生效区与续行指令输出空行），
+ * 因此提取器直接使用预处理结果中的行号作为原文行号，无需映射。
+ */
+QString run(const QString &text, const QString &path, const QMap<QString, QString> &defines, const IncludeContext *includes = nullptr);
+
+}
+
+#endif // PREPROCESSOR_H
@@ -0,0 +1,92 @@
+/**
+ * @file regex_registry.cpp
+ * @brief 预编译正则注册表实现（Pre-compiled regex registry implementation）
+ *
+ * 以“模式串 + 选项”为键缓存，条目只增不删，返回的引用因此始终有效；
+ * 命中走读锁，未命中时加写锁复查后编译并调用 optimize() 立即完成 JIT。
+ */
+#include "regex_registry.h"
+#include "perf_stats.h"
+#include <QAtomicInteger>
+#include <QHash>
+#include <QPair>
+#include <QReadWriteLock>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    typedef QPair<QString, int> Key;
+
+    struct Registry
+    {
+        QReadWriteLock lock;
+        QHash<Key, const QRegularExpression *> index;
+        std::vector<std::unique_ptr<QRegularExpression>> owned;
+        QAtomicInteger<qint64> compiles{0};
+        QAtomicInteger<qint64> lookups{0};
+    };
+
+    Registry &registry()
+    {
+        static Registry r;
+        return r;
+    }
+}
+
+namespace RegexRegistry
+{
+
+    const QRegularExpression &get(const QString &pattern, QRegularExpression::PatternOptions options)
+    {
+        Registry &r = registry();
+        r.lookups.fetchAndAddRelaxed(1);
+        const Key key(pattern, int(options));
+        {
+            QReadLocker locker(&r.lock);
+            auto it = r.index.constFind(key);
+            if (it != r.index.constEnd())
+                return *it.value();
+        }
+        QWriteLocker locker(&r.lock);
+        auto it = r.index.constFind(key);
+        if (it != r.index.constEnd())
+            return *it.value();
+        std::unique_ptr<QRegularExpression> re(new QRegularExpression(pattern, options));
+        re->optimize();
+        r.compiles.fetchAndAddRelaxed(1);
+        PerfStats::count("regex_compile");
+        const QRegularExpression *p = re.get();
+        r.owned.push_back(std::move(re));
+        r.index.insert(key, p);
+        return *p;
+    }
+
+    const QRegularExpression &typedefStruct()
+    {
+        static const QRegularExpression &re = get(QStringLiteral("typedef\\s+struct\\s*\\{(.*?)\\}\\s*(\\w+)\\s*;"),
+                                                  QRegularExpression::DotMatchesEverythingOption);
+        return re;
+    }
+
+    const QRegularExpression &initializerFor(const QString &typeName)
+    {
+        return get(QString(R"((?:static\s+)?(?:const\s+)?(?:struct\s+)?%1(?:\s+\w+)*\s+(?:\*+\s*)?(\w+)\s*=\s*(?:&\s*\([^)]*\)\s*)?\{(.*?)\};)")
+                       .arg(QRegularExpression::escape(typeName)),
+                   QRegularExpression::DotMatchesEverythingOption);
+    }
+
+    Stats stats()
+    {
+        Registry &r = registry();
+        Stats s;
+        {
+            QReadLocker locker(&r.lock);
+            s.patterns = r.index.size();
+        }
+        s.compiles = r.compiles.loadAcquire();
+        s.lookups = r.lookups.loadAcquire();
+        return s;
+    }
+
+}
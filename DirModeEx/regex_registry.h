@@ -0,0 +1,53 @@
+/**
+ * @file regex_registry.h
+ * @brief 预编译正则注册表接口（Pre-compiled regex registry APIs）
+ *
+ * 功能名称：正则复用（Compile each pattern once per process）
+ * 主要用途：
+ * - 提取、CSV 导入、语言初始化共用同一份已编译（并 JIT 优化）的正则，不在循环内重复构造；
+ * - 依赖结构体别名、语言代码等参数的正则按最终模式串缓存，同一别名只编译一次；
+ * - 编译次数与查找次数可查询，并以 regex_compile 计入 PerfStats，便于确认热路径不再编译；
+ *
+ * 使用示例：
+ *  static const QRegularExpression &re = RegexRegistry::get(QStringLiteral("\\w+"));   // 固定模式只查一次
+ *  auto it = RegexRegistry::initializerFor(alias).globalMatch(text);                    // 按别名缓存
+ */
+#ifndef REGEX_REGISTRY_H
+#define REGEX_REGISTRY_H
+
+#include <QString>
+#include <QRegularExpression>
+
+namespace RegexRegistry {
+
+/**
+ * @brief 取得已编译的正则（Get a compiled pattern, compiling on first use）
+ * 返回的引用在进程内始终有效；多线程并发调用安全。
+ */
+const QRegularExpression &get(const QString &pattern,
+                              QRegularExpression::PatternOptions options = QRegularExpression::NoPatternOption);
+
+/** @brief typedef struct { ... } Alias;（捕获 1=结构体体，2=别名） */
+const QRegularExpression &typedefStruct();
+
+/**
+ * @brief 指定别名的结构体初始化（Initializer of a given struct alias）
+ * 形如 `static const Alias name = { ... };`，捕获 1=变量名，2=初始化体。
+ */
+const QRegularExpression &initializerFor(const QString &typeName);
+
+/**
+ * @brief 注册表计数（Registry counters）
+ */
+struct Stats
+{
+    int patterns{0};    // 已缓存的模式数
+    qint64 compiles{0}; // 编译次数（每个模式一次）
+    qint64 lookups{0};  // get() 调用次数
+};
+
+Stats stats();
+
+}
+
+#endif // REGEX_REGISTRY_H
@@ -0,0 +1,174 @@
+/**
+ * @file string_pool.cpp
+ * @brief 字符串池实现（String pool implementation）
+ *
+ * 后缀合并：把各字符串按“反转后的字节序”排序，若 rev[i] 是 rev[i+1] 的前缀，则 s[i] 是 s[i+1] 的后缀，
+ * 从后往前传递归属即可让每个字符串指向包含它的最长字符串尾部；空串合并到任意字符串的结尾 NUL。
+ * 存储顺序保持首次出现顺序，生成结果在输入不变时稳定。
+ */
+#include "string_pool.h"
+#include "c_escape.h"
+#include <algorithm>
+
+namespace
+{
+    bool reversedLess(const QByteArray &a, const QByteArray &b)
+    {
+        int i = a.size() - 1;
+        int j = b.size() - 1;
+        for (; i >= 0 && j >= 0; --i, --j)
+        {
+            const uchar ca = uchar(a.at(i));
+            const uchar cb = uchar(b.at(j));
+            if (ca != cb)
+                return ca < cb;
+        }
+        return i < 0 && j >= 0;
+    }
+
+    bool isHexDigit(char c)
+    {
+        return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+    }
+
+    // CEscape::decode 回调：输出编译器从字面量得到的字节
+    struct ByteSink
+    {
+        QByteArray &out;
+        void text(const QChar *p, int n) { out += QString::fromRawData(p, n).toUtf8(); }
+        void byte(char b) { out += b; }
+        void codePoint(uint v)
+        {
+            if (v > 0x10FFFF || (v >= 0xD800 && v <= 0xDFFF))
+                v = QChar::ReplacementCharacter;
+            out += QString::fromUcs4(&v, 1).toUtf8();
+        }
+    };
+}
+
+namespace StringPool
+{
+
+    Builder::Builder(const QStringList &groups)
+    {
+        for (const QString &g : groups)
+        {
+            GroupStats s;
+            s.name = g;
+            m_stats.append(s);
+        }
+    }
+
+    void Builder::add(const QByteArray &bytes, int group)
+    {
+        if (group >= 0 && group < m_stats.size())
+        {
+            ++m_stats[group].strings;
+            m_stats[group].naiveBytes += bytes.size() + 1;
+        }
+        if (m_index.contains(bytes))
+            return;
+        m_index.insert(bytes, m_unique.size());
+        m_unique.append(bytes);
+        m_firstGroup.append(group);
+        if (group >= 0 && group < m_stats.size())
+            ++m_stats[group].unique;
+    }
+
+    void Builder::build(bool mergeSuffixes)
+    {
+        const int n = m_unique.size();
+        // owner[i]：实际存储 s[i] 的字符串下标（未合并时为自身）
+        QVector<int> owner(n);
+        for (int i = 0; i < n; ++i)
+            owner[i] = i;
+        if (mergeSuffixes && n > 1)
+        {
+            QVector<int> order(n);
+            for (int i = 0; i < n; ++i)
+                order[i] = i;
+            std::sort(order.begin(), order.end(), [this](int a, int b) { return reversedLess(m_unique.at(a), m_unique.at(b)); });
+            for (int k = n - 2; k >= 0; --k)
+            {
+                const QByteArray &s = m_unique.at(order[k]);
+                const QByteArray &next = m_unique.at(order[k + 1]);
+                if (next.endsWith(s))
+                    owner[order[k]] = owner[order[k + 1]];
+            }
+        }
+        // 按首次出现顺序为存储者分配偏移
+        QVector<int> ownOffset(n, -1);
+        m_entries.clear();
+        m_offsets.clear();
+        m_offsets.reserve(n);
+        m_size = 0;
+        m_merged = 0;
+        for (int i = 0; i < n; ++i)
+        {
+            if (owner[i] != i)
+                continue;
+            ownOffset[i] = int(m_size);
+            m_entries.append(Entry{int(m_size), m_unique.at(i)});
+            m_size += m_unique.at(i).size() + 1;
+            const int g = m_firstGroup.at(i);
+            if (g >= 0 && g < m_stats.size())
+                m_stats[g].pooledBytes += m_unique.at(i).size() + 1;
+        }
+        for (int i = 0; i < n; ++i)
+        {
+            const int o = owner[i];
+            if (o != i)
+                ++m_merged;
+            m_offsets.insert(m_unique.at(i), ownOffset[o] + m_unique.at(o).size() - m_unique.at(i).size());
+        }
+    }
+
+    QString escapeBytes(const QByteArray &bytes)
+    {
+        QString out;
+        out.reserve(bytes.size() * 2);
+        bool afterHex = false;
+        for (int i = 0; i < bytes.size(); ++i)
+        {
+            const char c = bytes.at(i);
+            const uchar u = uchar(c);
+            // 上一个是 \xNN 且当前为十六进制字符：断开字面量，否则会被并入同一转义
+            if (afterHex && isHexDigit(c))
+                out += QStringLiteral("\" \"");
+            afterHex = false;
+            if (c == '"' || c == '\\')
+            {
+                out += QLatin1Char('\\');
+                out += QLatin1Char(c);
+            }
+            else if (c == '\n')
+                out += QStringLiteral("\\n");
+            else if (c == '\r')
+                out += QStringLiteral("\\r");
+            else if (c == '\t')
+                out += QStringLiteral("\\t");
+            else if (c == '?' && i > 0 && bytes.at(i - 1) == '?')
+                out += QStringLiteral("\\?"); // 避免三字符组
+            else if (u >= 0x20 && u < 0x7F)
+                out += QLatin1Char(c);
+            else
+            {
+                // 与十六进制输出风格一致：小写 x、大写数字
+                out += QStringLiteral("\\x") + QStringLiteral("%1").arg(uint(u), 2, 16, QLatin1Char('0')).toUpper();
+                afterHex = true;
+            }
+        }
+        return out;
+    }
+
+    QByteArray decodeCEscapes(const QString &text)
+    {
+        // 与提取解码共用 CEscape 规则：普通字符按 UTF-8，转义直接得到字节
+        QByteArray out;
+        out.reserve(text.size());
+        ByteSink sink{out};
+        CEscape::decode(text.unicode(), text.size(), CEscape::Rules::CLiteral, sink);
+        return out;
+    }
+
+}
@@ -0,0 +1,107 @@
+/**
+ * @file string_pool.h
+ * @brief 字符串池接口（String pool APIs for generated C tables）
+ *
+ * 功能名称：去重字符串池（Deduplicated, optionally suffix-merged UTF-8 blob）
+ * 主要用途：
+ * - 生成 C 代码时把所有译文收集为一块以 NUL 分隔的连续字节，相同文本只存一份；
+ * - 可选后缀合并：某字符串恰为另一字符串的后缀时直接指向其尾部（如 "Points" 复用 "Input Points"）；
+ * - 按分组（语言列）统计原始字节与入池字节，报告节省量；
+ * - 提供 C 字面量转义与 C 转义解码，保证入池字节与编译器看到的字节一致；
+ *
+ * 使用示例：
+ *  StringPool::Builder pool(langs);
+ *  pool.add(bytes, langIdx);           // 第一遍：登记全部取值
+ *  pool.build(true);                   // 布局（含后缀合并）
+ *  int off = pool.offset(bytes);       // 第二遍：取偏移写出 s_tr_pool + off
+ */
+#ifndef STRING_POOL_H
+#define STRING_POOL_H
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QHash>
+#include <QVector>
+#include <QList>
+
+namespace StringPool {
+
+/**
+ * @brief 分组统计（Per-group byte accounting）
+ * naiveBytes 为每个取值各存一份（含 NUL）的字节数；pooledBytes 为该组首次引入并实际入池的字节数，
+ * 各组 pooledBytes 之和即池大小。
+ */
+struct GroupStats
+{
+    QString name;
+    int strings{0};       // 取值个数
+    int unique{0};        // 由本组首次引入的不同字符串数
+    qint64 naiveBytes{0};
+    qint64 pooledBytes{0};
+    qint64 savedBytes() const { return naiveBytes - pooledBytes; }
+};
+
+/** @brief 池内一段实际存储的字符串（Stored entry, in blob order） */
+struct Entry
+{
+    int offset{0};
+    QByteArray bytes; // 不含结尾 NUL
+};
+
+/**
+ * @class Builder
+ * @brief 两阶段构建：add 登记 → build 布局 → offset 查询
+ */
+class Builder
+{
+public:
+    explicit Builder(const QStringList &groups);
+
+    /** @brief 登记一次取值（Record one occurrence） */
+    void add(const QByteArray &bytes, int group);
+
+    /**
+     * @brief 计算布局（Lay out the blob）
+     * @param mergeSuffixes 是否合并后缀
+     */
+    void build(bool mergeSuffixes);
+
+    /** @brief 字符串在池中的偏移；未登记时返回 -1 */
+    int offset(const QByteArray &bytes) const { return m_offsets.value(bytes, -1); }
+
+    /** @brief 实际存储的字符串（按偏移递增） */
+    const QVector<Entry> &entries() const { return m_entries; }
+    /** @brief 池总字节数（含各 NUL） */
+    qint64 size() const { return m_size; }
+    /** @brief 因后缀合并而不占空间的字符串数 */
+    int mergedCount() const { return m_merged; }
+    /** @brief 分组统计 */
+    const QList<GroupStats> &stats() const { return m_stats; }
+
+private:
+    QVector<QByteArray> m_unique;    // 首次出现顺序
+    QVector<int> m_firstGroup;
+    QHash<QByteArray, int> m_index;  // 字符串 → m_unique 下标
+    QHash<QByteArray, int> m_offsets;
+    QVector<Entry> m_entries;
+    QList<GroupStats> m_stats;
+    qint64 m_size{0};
+    int m_merged{0};
+};
+
+/**
+ * @brief 字节转为 C 字符串字面量内容（不含两侧引号）
+ * 可打印 ASCII 原样输出，其余字节写为 \xNN；\x 之后紧跟十六进制字符时断开为相邻字面量，避免被并入转义。
+ */
+QString escapeBytes(const QByteArray &bytes);
+
+/**
+ * @brief 按 C 规则解码字面量文本中的转义（\xNN、八进制、\u、\n 等），其余字符按 UTF-8 编码
+ * 用于“原样/直写”取值：规则与提取时的字面量解码相同（CEscape::Rules::CLiteral）。
+ */
+QByteArray decodeCEscapes(const QString &text);
+
+}
+
+#endif // STRING_POOL_H
@@ -0,0 +1,210 @@
+/**
+ * @file struct_layout.cpp
+ * @brief 结构体语言布局解析实现（Struct language layout resolution implementation）
+ *
+ * 缓存文件（JSON）：
+ *   { "version": 1, "layouts": { "<别名>|<后缀>": { "columns": [...], "source": "<相对路径或空>", "stamp": "<指纹>" } } }
+ * source 非空表示布局来自约定头文件，只需对它 stat；为空表示来自遍历扫描，指纹覆盖全部候选源文件。
+ */
+#include "struct_layout.h"
+#include "text_extractor.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QSaveFile>
+#include <QCryptographicHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+namespace
+{
+    const int kLayoutCacheVersion = 1;
+
+    QString cacheFilePath(const QString &root)
+    {
+        return QDir(root).absoluteFilePath(QStringLiteral(".csv_lang_cache/struct_layout.json"));
+    }
+
+    // 单个文件的 相对路径+大小+修改时间；不存在时记为 absent，文件新增也能使指纹失效
+    void appendStamp(QByteArray &acc, const QString &root, const QString &path)
+    {
+        const QFileInfo fi(path);
+        acc += QDir(root).relativeFilePath(fi.absoluteFilePath()).toUtf8();
+        if (fi.exists())
+        {
+            acc += ':' + QByteArray::number(fi.size());
+            acc += ':' + QByteArray::number(fi.lastModified().toMSecsSinceEpoch());
+        }
+        else
+        {
+            acc += ":absent";
+        }
+        acc += '\n';
+    }
+
+    // 布局指纹：约定头文件总参与；遍历扫描得到的布局另覆盖全部候选源文件
+    QString layoutStamp(const QString &root, const QStringList &extensions, const QString &source)
+    {
+        QByteArray acc;
+        appendStamp(acc, root, QDir(root).absoluteFilePath(QStringLiteral("include/tr_text.h")));
+        if (source.isEmpty())
+        {
+            for (const QString &f : TextExtractor::collectSourceFiles(root, extensions))
+                appendStamp(acc, root, f);
+        }
+        return QString::fromLatin1(QCryptographicHash::hash(acc, QCryptographicHash::Md5).toHex());
+    }
+
+    QJsonObject loadCache(const QString &root)
+    {
+        QFile f(cacheFilePath(root));
+        if (!f.open(QIODevice::ReadOnly))
+            return QJsonObject();
+        const QJsonObject obj = QJsonDocument::fromJson(f.readAll()).object();
+        if (obj.value(QStringLiteral("version")).toInt() != kLayoutCacheVersion)
+            return QJsonObject();
+        return obj;
+    }
+
+    bool saveCache(const QString &root, const QJsonObject &obj)
+    {
+        const QString path = cacheFilePath(root);
+        QDir().mkpath(QFileInfo(path).absolutePath());
+        QSaveFile f(path);
+        if (!f.open(QIODevice::WriteOnly))
+            return false;
+        f.write(QJsonDocument(obj).toJson(QJsonDocument::Indented));
+        return f.commit();
+    }
+
+    QStringList toStringList(const QJsonValue &v)
+    {
+        QStringList out;
+        for (const QJsonValue &c : v.toArray())
+        {
+            const QString s = c.toString().trimmed();
+            if (!s.isEmpty())
+                out << s;
+        }
+        return out;
+    }
+}
+
+namespace StructLayout
+{
+
+    QString defaultSchemaPath(const QString &dir)
+    {
+        return QDir(dir).absoluteFilePath(QStringLiteral("tr_text.schema.json"));
+    }
+
+    QStringList readSchema(const QString &path, const QString &typeAlias, QString &error)
+    {
+        error.clear();
+        QFile f(path);
+        if (!f.open(QIODevice::ReadOnly))
+        {
+            error = QStringLiteral("无法打开模式文件: %1").arg(path);
+            return QStringList();
+        }
+        QJsonParseError perr;
+        const QJsonDocument doc = QJsonDocument::fromJson(f.readAll(), &perr);
+        if (perr.error != QJsonParseError::NoError || !doc.isObject())
+        {
+            error = QStringLiteral("模式文件不是有效的 JSON 对象: %1").arg(perr.errorString());
+            return QStringList();
+        }
+        const QJsonObject obj = doc.object();
+        const QString type = obj.value(QStringLiteral("type")).toString();
+        if (!type.isEmpty() && !typeAlias.isEmpty() && type != typeAlias)
+        {
+            error = QStringLiteral("模式文件类型为 %1，与 %2 不符").arg(type, typeAlias);
+            return QStringList();
+        }
+        QStringList cols;
+        for (const QString &c : toStringList(obj.value(QStringLiteral("columns"))))
+            cols << (c.startsWith(QLatin1String("text_")) ? c : (QStringLiteral("text_") + c));
+        // 与扫描结果一致：末尾 text_other 哨兵不计入
+        if (!cols.isEmpty() && cols.last().compare(QLatin1String("text_other"), Qt::CaseInsensitive) == 0)
+            cols.removeLast();
+        if (cols.isEmpty())
+            error = QStringLiteral("模式文件缺少 columns");
+        return cols;
+    }
+
+    bool writeSchema(const QString &path, const QString &typeAlias, const QStringList &columns, QString &error)
+    {
+        error.clear();
+        QJsonObject obj;
+        obj.insert(QStringLiteral("type"), typeAlias);
+        obj.insert(QStringLiteral("columns"), QJsonArray::fromStringList(columns));
+        QSaveFile f(path);
+        if (!f.open(QIODevice::WriteOnly))
+        {
+            error = QStringLiteral("无法写入模式文件: %1").arg(path);
+            return false;
+        }
+        f.write(QJsonDocument(obj).toJson(QJsonDocument::Indented));
+        if (!f.commit())
+        {
+            error = f.errorString();
+            return false;
+        }
+        return true;
+    }
+
+    QStringList resolve(const QString &root, const QStringList &extensions, const QString &typeAlias,
+                        const QString &schemaPath, QString *origin, QString *error)
+    {
+        if (error)
+            error->clear();
+        // 1) 显式模式文件：不访问项目源码；无效时直接报错，避免静默采用另一种布局
+        if (!schemaPath.isEmpty())
+        {
+            QString err;
+            const QStringList cols = readSchema(schemaPath, typeAlias, err);
+            if (origin)
+                *origin = QStringLiteral("schema");
+            if (error)
+                *error = err;
+            return err.isEmpty() ? cols : QStringList();
+        }
+
+        // 2) 持久缓存：指纹一致直接复用
+        const QString absRoot = QDir(root).absolutePath();
+        const QString key = typeAlias + QLatin1Char('|') + extensions.join(QLatin1Char(';')).toLower();
+        QJsonObject cache = loadCache(absRoot);
+        QJsonObject layouts = cache.value(QStringLiteral("layouts")).toObject();
+        const QJsonObject entry = layouts.value(key).toObject();
+        if (!entry.isEmpty())
+        {
+            const QString source = entry.value(QStringLiteral("source")).toString();
+            const QStringList cols = toStringList(entry.value(QStringLiteral("columns")));
+            if (!cols.isEmpty() && entry.value(QStringLiteral("stamp")).toString() == layoutStamp(absRoot, extensions, source))
+            {
+                if (origin)
+                    *origin = QStringLiteral("cache");
+                return cols;
+            }
+        }
+
+        // 3) 扫描项目并写回缓存（写入失败不影响结果）
+        QString definedIn;
+        const QStringList cols = TextExtractor::discoverLanguageColumnsWithSource(absRoot, extensions, typeAlias, definedIn);
+        const QString source = definedIn.isEmpty() ? QString() : QDir(absRoot).relativeFilePath(definedIn);
+        QJsonObject fresh;
+        fresh.insert(QStringLiteral("columns"), QJsonArray::fromStringList(cols));
+        fresh.insert(QStringLiteral("source"), source);
+        fresh.insert(QStringLiteral("stamp"), layoutStamp(absRoot, extensions, source));
+        layouts.insert(key, fresh);
+        cache.insert(QStringLiteral("version"), kLayoutCacheVersion);
+        cache.insert(QStringLiteral("layouts"), layouts);
+        saveCache(absRoot, cache);
+        if (origin)
+            *origin = QStringLiteral("scan");
+        return cols;
+    }
+
+}
@@ -0,0 +1,61 @@
+/**
+ * @file struct_layout.h
+ * @brief 结构体语言布局解析接口（Struct language layout resolution APIs）
+ *
+ * 功能名称：语言列布局的模式文件与持久缓存（Schema file & persisted cache for struct layout）
+ * 主要用途：
+ * - 生成 C 代码前需要 _Tr_TEXT 等结构体的语言字段顺序；原先每次都遍历整个项目解析源码；
+ * - 可显式提供模式文件（JSON），完全跳过项目扫描；
+ * - 否则查询 `<root>/.csv_lang_cache/struct_layout.json`：以 路径+大小+修改时间 指纹校验，
+ *   布局来自约定头文件 include/tr_text.h 时只校验该文件，来自遍历扫描时校验全部候选源文件（仅 stat，不读内容）；
+ * - 指纹不符或无缓存时才执行 discoverLanguageColumns 并写回缓存；
+ *
+ * 模式文件格式：
+ *  { "type": "_Tr_TEXT", "columns": ["text_cn", "text_en", ...] }
+ *
+ * 使用示例：
+ *  QString origin, err;
+ *  QStringList cols = StructLayout::resolve(root, exts, "_Tr_TEXT", schemaPath, &origin, &err);
+ */
+#ifndef STRUCT_LAYOUT_H
+#define STRUCT_LAYOUT_H
+
+#include <QString>
+#include <QStringList>
+
+namespace StructLayout {
+
+/** @brief 目录下的默认模式文件路径（dir/tr_text.schema.json），存在时生成器自动采用 */
+QString defaultSchemaPath(const QString &dir);
+
+/**
+ * @brief 读取模式文件（Read a schema file）
+ * @param path 模式文件路径
+ * @param typeAlias 期望的结构体别名；文件中 type 为空时不校验
+ * @param error 失败原因
+ * @return 语言列（text_xx 形式）；失败时为空
+ */
+QStringList readSchema(const QString &path, const QString &typeAlias, QString &error);
+
+/**
+ * @brief 写出模式文件（Write a schema file）
+ * @return 是否写入成功；失败时 error 给出原因
+ */
+bool writeSchema(const QString &path, const QString &typeAlias, const QStringList &columns, QString &error);
+
+/**
+ * @brief 解析结构体语言列顺序（Resolve language columns: schema → cache → scan）
+ * @param root 项目根目录（缓存位于 root/.csv_lang_cache）
+ * @param extensions 遍历扫描时的后缀
+ * @param typeAlias 结构体别名
+ * @param schemaPath 模式文件路径；为空时走缓存/扫描
+ * @param origin 可选输出：schema / cache / scan
+ * @param error 可选输出：显式模式文件无效时的原因（此时返回空列表，不回退扫描）
+ * @return 语言列（不包含 text_other）
+ */
+QStringList resolve(const QString &root, const QStringList &extensions, const QString &typeAlias,
+                    const QString &schemaPath = QString(), QString *origin = nullptr, QString *error = nullptr);
+
+}
+
+#endif // STRUCT_LAYOUT_H
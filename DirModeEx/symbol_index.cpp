@@ -0,0 +1,140 @@
+/**
+ * @file symbol_index.cpp
+ * @brief 初始化声明符号索引实现（Initializer symbol index implementation）
+ *
+ * 建索引：TextCodec 解码一次 → CLexer 单遍词法 → 括号配对 → findAllInitializers；
+ * 注释内的声明在词法阶段已被跳过，宏定义行内的声明标记 inMacro 由调用方决定是否跳过。
+ */
+#include "symbol_index.h"
+#include "c_lexer.h"
+#include "text_codec.h"
+#include "text_extractor.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
+#include <QtConcurrent>
+
+SymbolIndex::SymbolIndex(const QString &projectRoot)
+    : m_root(projectRoot)
+{
+}
+
+namespace
+{
+    // 读取、解码并索引单个文件；无法打开时返回空指针
+    std::shared_ptr<SymbolFile> buildFile(const QString &absPath)
+    {
+        QFile f(absPath);
+        if (!f.open(QIODevice::ReadOnly))
+            return nullptr;
+        f.close();
+        auto sf = std::make_shared<SymbolFile>();
+        sf->path = absPath;
+        // 持平时偏好 GB18030，与写回原文件的模块保持一致
+        sf->text = TextCodec::readFile(absPath, &sf->codec, &sf->utf8Bom, TextCodec::Tie::Gb18030);
+        const QString &text = sf->text;
+        const QVector<CLexer::Token> toks = CLexer::tokenize(text);
+        const QVector<int> pairs = CLexer::matchBrackets(text, toks);
+        for (const CLexer::Initializer &d : CLexer::findAllInitializers(text, toks, pairs))
+        {
+            SymbolEntry e;
+            e.variableName = d.variableName;
+            e.alias = d.typeName;
+            e.line = d.line;
+            e.declStart = d.declStart;
+            e.bodyStart = toks[d.openBrace].start + 1;
+            e.bodyEnd = toks[d.closeBrace].start;
+            e.isArray = d.isArray;
+            // 与 '{' 同一行且位于其前的 '#' 视为宏定义体
+            const int braceLine = toks[d.openBrace].line;
+            for (int k = d.openBrace - 1; k >= 0 && toks[k].line == braceLine; --k)
+            {
+                if (CLexer::isPunct(text, toks[k], '#'))
+                {
+                    e.inMacro = true;
+                    break;
+                }
+            }
+            sf->byName[e.variableName].append(sf->entries.size());
+            sf->entries.append(e);
+        }
+        return sf;
+    }
+}
+
+QString SymbolIndex::normalizePath(const QString &root, const QString &path)
+{
+    // CSV 可能来自 Windows：反斜杠在任何平台都按分隔符处理
+    QString p = QDir::fromNativeSeparators(path);
+    p.replace(QLatin1Char('\\'), QLatin1Char('/'));
+    if (QDir::isRelativePath(p))
+        p = QDir(root).absoluteFilePath(p);
+    p = QDir::cleanPath(p);
+    const QString canonical = QFileInfo(p).canonicalFilePath();
+    return canonical.isEmpty() ? p : canonical;
+}
+
+SymbolFile *SymbolIndex::file(const QString &absPath)
+{
+    const QString key = normalizePath(m_root, absPath);
+    auto it = m_files.constFind(key);
+    if (it != m_files.constEnd())
+        return it.value().get();
+    auto sf = buildFile(key);
+    m_files.insert(key, sf);
+    return sf.get();
+}
+
+void SymbolIndex::preload(const QStringList &absPaths)
+{
+    QStringList pending;
+    QSet<QString> seen;
+    for (const QString &path : absPaths)
+    {
+        const QString p = normalizePath(m_root, path);
+        if (!m_files.contains(p) && !seen.contains(p))
+        {
+            seen.insert(p);
+            pending << p;
+        }
+    }
+    if (pending.isEmpty())
+        return;
+    // 各文件独立建索引，并发执行；结果按输入顺序返回后统一登记
+    const QList<std::shared_ptr<SymbolFile>> built = QtConcurrent::blockingMapped<QList<std::shared_ptr<SymbolFile>>>(pending, buildFile);
+    for (int i = 0; i < pending.size(); ++i)
+        m_files.insert(pending.at(i), built.at(i));
+}
+
+QStringList SymbolIndex::languageOrder(const QString &alias)
+{
+    auto it = m_langOrders.constFind(alias);
+    if (it != m_langOrders.constEnd())
+        return it.value();
+    const QStringList langs = TextExtractor::discoverLanguageColumns(m_root, QStringList{QStringLiteral(".h"), QStringLiteral(".hpp"), QStringLiteral(".c"), QStringLiteral(".cpp")}, alias);
+    m_langOrders.insert(alias, langs);
+    return langs;
+}
+
+void SymbolIndex::replaceBody(SymbolFile &f, int entryIdx, const QString &newBody)
+{
+    SymbolEntry &e = f.entries[entryIdx];
+    const int oldLen = e.bodyEnd - e.bodyStart;
+    const int delta = newBody.size() - oldLen;
+    const int lineDelta = newBody.count(QLatin1Char('\n')) - f.text.midRef(e.bodyStart, oldLen).count(QLatin1Char('\n'));
+    const int oldEnd = e.bodyEnd;
+    f.text.replace(e.bodyStart, oldLen, newBody);
+    e.bodyEnd += delta;
+    // 其后的声明整体平移
+    for (int i = 0; i < f.entries.size(); ++i)
+    {
+        SymbolEntry &o = f.entries[i];
+        if (o.declStart < oldEnd)
+            continue;
+        o.declStart += delta;
+        o.bodyStart += delta;
+        o.bodyEnd += delta;
+        o.line += lineDelta;
+    }
+}
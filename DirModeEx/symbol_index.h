@@ -0,0 +1,95 @@
+/**
+ * @file symbol_index.h
+ * @brief 初始化声明符号索引接口（Initializer symbol index APIs）
+ *
+ * 功能名称：翻译应用的符号索引（Symbol index for applying translations）
+ * 主要用途：
+ * - 每个源文件只读取、解码、词法分析一次，建立 变量名 → 行号/初始化体区间/结构体别名 的索引；
+ * - 结构体别名 → 语言字段顺序 的发现结果按别名缓存，整个运行期间只扫描项目一次；
+ * - 应用修改后原地更新文本与其后各声明的偏移/行号，后续行直接查表，无需重新扫描；
+ *
+ * 使用示例：
+ *  SymbolIndex idx(projectRoot);
+ *  SymbolFile *f = idx.file(absPath);
+ *  for (int i : f->byName.value(var)) { const SymbolEntry &e = f->entries.at(i); ... }
+ *  idx.replaceBody(*f, i, newBody);
+ */
+#ifndef SYMBOL_INDEX_H
+#define SYMBOL_INDEX_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QHash>
+#include <QVector>
+#include <memory>
+
+/**
+ * @brief 单个初始化声明（Indexed initializer declaration）
+ */
+struct SymbolEntry
+{
+    QString variableName;
+    QString alias;      // 结构体类型名
+    int line{0};        // 声明起始行（1 起）
+    int declStart{0};   // 声明起始字符偏移
+    int bodyStart{0};   // 初始化体 '{' 之后的字符偏移
+    int bodyEnd{0};     // 与之匹配的 '}' 的字符偏移
+    bool isArray{false};
+    bool inMacro{false}; // 位于 #define 行内
+};
+
+/**
+ * @brief 单个源文件的索引（Per-file index）
+ */
+struct SymbolFile
+{
+    QString path;
+    QString text;       // 当前文本（随 replaceBody 更新）
+    QString codec;      // 解码所用编码，写回时沿用
+    bool utf8Bom{false};
+    QList<SymbolEntry> entries;           // 按出现顺序
+    QHash<QString, QVector<int>> byName;  // 变量名 → entries 下标
+};
+
+/**
+ * @class SymbolIndex
+ * @brief 按需建立并缓存的项目符号索引
+ *
+ * 文件在首次访问或 preload 时建索引，之后的查找均为哈希查表；file/preload/languageOrder 非线程安全。
+ */
+class SymbolIndex
+{
+public:
+    explicit SymbolIndex(const QString &projectRoot);
+
+    /**
+     * @brief 规范化文件路径，作为索引与按文件归并修改的唯一键
+     * 相对路径按 root 解析；\ 视为分隔符，去除 ./ 与 ../；文件存在时取规范路径（解析符号链接）
+     */
+    static QString normalizePath(const QString &root, const QString &path);
+
+    /** @brief 取得文件索引（首次访问时读取并建索引；路径先经 normalizePath）；无法读取时返回 nullptr */
+    SymbolFile *file(const QString &absPath);
+    /** @brief 并发预建多个文件的索引（已索引的文件跳过） */
+    void preload(const QStringList &absPaths);
+    /** @brief 结构体别名的语言字段顺序（按别名缓存） */
+    QStringList languageOrder(const QString &alias);
+    /**
+     * @brief 替换第 entryIdx 个声明的初始化体，并平移其后声明的偏移与行号
+     * 只修改 f 本身，不同文件可并发调用
+     * @param f 文件索引
+     * @param entryIdx entries 下标
+     * @param newBody 新的初始化体（不含外层花括号）
+     */
+    void replaceBody(SymbolFile &f, int entryIdx, const QString &newBody);
+
+    int indexedFileCount() const { return m_files.size(); }
+
+private:
+    QString m_root;
+    QHash<QString, std::shared_ptr<SymbolFile>> m_files;
+    QHash<QString, QStringList> m_langOrders;
+};
+
+#endif // SYMBOL_INDEX_H
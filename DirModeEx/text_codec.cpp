@@ -0,0 +1,215 @@
+/**
+ * @file text_codec.cpp
+ * @brief 文本编码识别实现（Text codec detection implementation）
+ *
+ * 算法：
+ * - ASCII 前缀按 8 字节字长检测高位（编译器可向量化）；
+ * - 其后先做严格 UTF-8 校验（拒绝过长编码与代理区），错误数为 0 即判为 UTF-8；
+ * - 否则做 GB18030 双字节/四字节结构校验，比较两者的非法序列数，持平按偏好选择。
+ * GBK/GB2312/CP936 均为 GB18030 子集，其替换符数不会少于 GB18030，故无需单独尝试。
+ */
+#include "text_codec.h"
+#include "perf_stats.h"
+#include <QFile>
+#include <QTextCodec>
+#include <cstring>
+
+namespace TextCodec
+{
+
+    // 返回首个非 ASCII 字节的位置；全部为 ASCII 时返回 n
+    static int asciiPrefix(const uchar *p, int n)
+    {
+        int i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+            quint64 w;
+            std::memcpy(&w, p + i, 8);
+            if (w & 0x8080808080808080ULL)
+                break;
+        }
+        while (i < n && p[i] < 0x80)
+            ++i;
+        return i;
+    }
+
+    static int countUtf8Errors(const uchar *p, int n, int from)
+    {
+        int errors = 0;
+        int i = from;
+        while (i < n)
+        {
+            const uchar c = p[i];
+            if (c < 0x80)
+            {
+                ++i;
+                continue;
+            }
+            int need = 0;
+            uchar lo = 0x80, hi = 0xBF; // 第二字节的合法范围
+            if (c >= 0xC2 && c <= 0xDF)
+                need = 1;
+            else if (c >= 0xE0 && c <= 0xEF)
+            {
+                need = 2;
+                if (c == 0xE0) lo = 0xA0;
+                if (c == 0xED) hi = 0x9F;
+            }
+            else if (c >= 0xF0 && c <= 0xF4)
+            {
+                need = 3;
+                if (c == 0xF0) lo = 0x90;
+                if (c == 0xF4) hi = 0x8F;
+            }
+            else
+            {
+                ++errors;
+                ++i;
+                continue;
+            }
+            bool ok = (i + need < n) && p[i + 1] >= lo && p[i + 1] <= hi;
+            for (int k = 2; ok && k <= need; ++k)
+                ok = (p[i + k] & 0xC0) == 0x80;
+            if (!ok)
+            {
+                ++errors;
+                ++i;
+                continue;
+            }
+            i += need + 1;
+        }
+        return errors;
+    }
+
+    static int countGb18030Errors(const uchar *p, int n, int from)
+    {
+        int errors = 0;
+        int i = from;
+        while (i < n)
+        {
+            const uchar c = p[i];
+            if (c < 0x80)
+            {
+                ++i;
+                continue;
+            }
+            if (c == 0x80 || c == 0xFF || i + 1 >= n)
+            {
+                ++errors;
+                ++i;
+                continue;
+            }
+            const uchar b = p[i + 1];
+            if (b >= 0x40 && b <= 0xFE && b != 0x7F)
+            {
+                i += 2;
+                continue;
+            }
+            if (b >= 0x30 && b <= 0x39 && i + 3 < n && p[i + 2] >= 0x81 && p[i + 2] <= 0xFE && p[i + 3] >= 0x30 && p[i + 3] <= 0x39)
+            {
+                i += 4;
+                continue;
+            }
+            ++errors;
+            ++i;
+        }
+        return errors;
+    }
+
+    Detection detect(const QByteArray &data, Tie tie)
+    {
+        Detection d;
+        const uchar *p = reinterpret_cast<const uchar *>(data.constData());
+        const int n = data.size();
+        // BOM 优先
+        if (n >= 3 && p[0] == 0xEF && p[1] == 0xBB && p[2] == 0xBF)
+        {
+            d.codec = QStringLiteral("UTF-8");
+            d.utf8Bom = true;
+            d.bomLength = 3;
+            return d;
+        }
+        if (n >= 2 && p[0] == 0xFF && p[1] == 0xFE)
+        {
+            d.codec = QStringLiteral("UTF-16LE");
+            d.bomLength = 2;
+            return d;
+        }
+        if (n >= 2 && p[0] == 0xFE && p[1] == 0xFF)
+        {
+            d.codec = QStringLiteral("UTF-16BE");
+            d.bomLength = 2;
+            return d;
+        }
+        const QString preferred = (tie == Tie::Gb18030) ? QStringLiteral("GB18030") : QStringLiteral("UTF-8");
+        // ASCII 快速路径：两种编码解码结果相同，按偏好返回
+        const int first = asciiPrefix(p, n);
+        if (first == n)
+        {
+            d.codec = preferred;
+            d.pureAscii = true;
+            return d;
+        }
+        const int utf8Errors = countUtf8Errors(p, n, first);
+        if (utf8Errors == 0)
+        {
+            d.codec = QStringLiteral("UTF-8");
+            return d;
+        }
+        const int gbErrors = countGb18030Errors(p, n, first);
+        if (gbErrors < utf8Errors)
+            d.codec = QStringLiteral("GB18030");
+        else if (utf8Errors < gbErrors)
+            d.codec = QStringLiteral("UTF-8");
+        else
+            d.codec = preferred;
+        return d;
+    }
+
+    QString decode(const QByteArray &data, const Detection &d)
+    {
+        const char *begin = data.constData() + d.bomLength;
+        const int len = data.size() - d.bomLength;
+        if (d.pureAscii)
+            return QString::fromLatin1(begin, len);
+        if (d.codec == QLatin1String("UTF-8"))
+            return QString::fromUtf8(begin, len);
+        // 编解码器只查找一次（codecForName 内部加锁）
+        static QTextCodec *const gb18030 = QTextCodec::codecForName("GB18030");
+        static QTextCodec *const utf16le = QTextCodec::codecForName("UTF-16LE");
+        static QTextCodec *const utf16be = QTextCodec::codecForName("UTF-16BE");
+        QTextCodec *c = nullptr;
+        if (d.codec == QLatin1String("GB18030"))
+            c = gb18030;
+        else if (d.codec == QLatin1String("UTF-16LE"))
+            c = utf16le;
+        else if (d.codec == QLatin1String("UTF-16BE"))
+            c = utf16be;
+        else
+            c = QTextCodec::codecForName(d.codec.toLatin1());
+        return c ? c->toUnicode(begin, len) : QString();
+    }
+
+    QString readFile(const QString &path, QString *codecName, bool *utf8Bom, Tie tie)
+    {
+        if (codecName)
+            codecName->clear();
+        if (utf8Bom)
+            *utf8Bom = false;
+        PerfStats::Timer timer("decode");
+        QFile f(path);
+        if (!f.open(QIODevice::ReadOnly))
+            return QString();
+        const QByteArray data = f.readAll();
+        f.close();
+        timer.addBytes(data.size());
+        timer.addItems(1);
+        const Detection d = detect(data, tie);
+        if (codecName)
+            *codecName = d.codec;
+        if (utf8Bom)
+            *utf8Bom = d.utf8Bom;
+        return decode(data, d);
+    }
+
+}
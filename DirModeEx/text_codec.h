@@ -0,0 +1,69 @@
+/**
+ * @file text_codec.h
+ * @brief 文本编码识别接口（Text codec detection APIs）
+ *
+ * 功能名称：字节级编码分类与一次解码（Byte-level codec classification, decode once）
+ * 主要用途：
+ * - BOM 优先；无 BOM 时先以 8 字节为单位跳过 ASCII 前缀，再做 UTF-8 合法性与 GB18030 结构校验；
+ * - 只按判定结果解码一次，取代各模块中“五种编码全量解码再数替换符”的做法；
+ * - 纯 ASCII 文件直接走快速路径，不做任何启发式判断；
+ *
+ * 使用示例：
+ *  QString codec; bool bom = false;
+ *  QString text = TextCodec::readFile(path, &codec, &bom, TextCodec::Tie::Gb18030);
+ */
+#ifndef TEXT_CODEC_H
+#define TEXT_CODEC_H
+
+#include <QString>
+#include <QByteArray>
+
+namespace TextCodec {
+
+/**
+ * @brief 无法区分时（纯 ASCII 或两种编码错误数相同）的偏好编码
+ * 写回原文件的模块偏好 GB18030，与历史行为保持一致；其余偏好 UTF-8。
+ */
+enum class Tie
+{
+    Utf8,
+    Gb18030
+};
+
+/**
+ * @brief 编码判定结果（Detection result）
+ */
+struct Detection
+{
+    QString codec;       // UTF-8 / GB18030 / UTF-16LE / UTF-16BE
+    bool utf8Bom{false}; // 是否带 UTF-8 BOM
+    int bomLength{0};    // BOM 字节数（解码时跳过）
+    bool pureAscii{false};
+};
+
+/**
+ * @brief 单遍字节级编码判定（Classify encoding in a single scan）
+ * @param data 原始字节
+ * @param tie 无法区分时的偏好
+ * @return 判定结果；UTF-8 完全合法且含多字节序列时直接判为 UTF-8
+ */
+Detection detect(const QByteArray &data, Tie tie = Tie::Utf8);
+
+/**
+ * @brief 按判定结果解码（Decode once with the detected codec）
+ */
+QString decode(const QByteArray &data, const Detection &d);
+
+/**
+ * @brief 读取并自动解码文件（Read file and decode with detected codec）
+ * @param path 文件路径
+ * @param codecName 可选输出：判定的编码名
+ * @param utf8Bom 可选输出：是否带 UTF-8 BOM
+ * @param tie 无法区分时的偏好
+ * @return 解码文本；无法打开时返回空串
+ */
+QString readFile(const QString &path, QString *codecName = nullptr, bool *utf8Bom = nullptr, Tie tie = Tie::Utf8);
+
+}
+
+#endif // TEXT_CODEC_H
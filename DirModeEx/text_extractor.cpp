@@ -7,126 +7,265 @@
  * @Description: 这是默认设置,请设置`customMade`, 打开koroFileHeader查看配置 进行设置: https://github.com/OBKoro1/koro1FileHeader/wiki/%E9%85%8D%E7%BD%AE
  */
 #include "text_extractor.h"
+#include "c_lexer.h"
+#include "extract_cache.h"
+#include "text_codec.h"
+#include "csv_writer.h"
+#include "preprocessor.h"
+#include "csv_reader.h"
+#include "struct_layout.h"
+#include "string_pool.h"
+#include "tr_catalog.h"
+#include "dir_walker.h"
+#include "perf_stats.h"
+#include "regex_registry.h"
+#include "block_table.h"
+#include "c_escape.h"
 #include <QFile>
+#include <QSaveFile>
 #include <QTextStream>
 #include <QDir>
 #include <QRegularExpression>
 #include <QByteArray>
 #include <QFileInfo>
 #include <QSet>
+#include <QHash>
 #include <QTextCodec>
+#include <QVarLengthArray>
+#include <QtConcurrent>
+#include <algorithm>
 
 namespace
 {
-    // 解析 C 字符串字面量，支持 \xHH 按 GBK/CP936 字节解码为 Unicode
-    QString decodeCEscapedString(const QString &literal, bool preserveEscapes)
+    // 并发 map/reduce 函数对象：Qt5 要求 map 函数对象声明 result_type
+    struct BlocksMapFn
     {
-        if (literal.size() < 2 || !literal.startsWith(QLatin1Char('"')) || !literal.endsWith(QLatin1Char('"')))
-            return literal;
-        QString raw = literal.mid(1, literal.size() - 2);
-        if (preserveEscapes)
-            return raw;
-
-        QTextCodec *gbk = QTextCodec::codecForName("GBK");
-        QString out;
-        QByteArray buf; // 缓冲需要按 GBK 解码的字节（例如 \xB2\xE2）
-
-        auto flushBuf = [&]() {
-            if (buf.isEmpty()) return;
-            QString dec;
-            if (gbk)
-                dec = gbk->toUnicode(buf);
-            if (dec.isEmpty())
+        typedef BlockTable result_type;
+        QString mode;
+        QMap<QString, QString> defines;
+        QString typeName;
+        bool preserveEscapes;
+        ExtractCache *cache;
+        const Preprocessor::IncludeContext *includes;
+        BlockTable operator()(const QString &path) const
+        {
+            auto compute = [&](const QByteArray *content) { return TextExtractor::extractFileTable(path, mode, defines, typeName, preserveEscapes, includes, content); };
+            return cache ? cache->table(path, compute) : compute(nullptr);
+        }
+    };
+
+    struct ArraysMapFn
+    {
+        typedef QList<ExtractedArray> result_type;
+        QString mode;
+        QMap<QString, QString> defines;
+        QString typeName;
+        bool preserveEscapes;
+        ExtractCache *cache;
+        const Preprocessor::IncludeContext *includes;
+        QList<ExtractedArray> operator()(const QString &path) const
+        {
+            auto compute = [&](const QByteArray *content) { return TextExtractor::extractArraysFile(path, mode, defines, typeName, preserveEscapes, includes, content); };
+            return cache ? cache->arrays(path, compute) : compute(nullptr);
+        }
+    };
+
+    struct DispMapFn
+    {
+        typedef QList<ExtractedBlock> result_type;
+        QString mode;
+        QMap<QString, QString> defines;
+        ExtractCache *cache;
+        const Preprocessor::IncludeContext *includes;
+        QList<ExtractedBlock> operator()(const QString &path) const
+        {
+            auto compute = [&](const QByteArray *content) { return TextExtractor::extractDispMessageInfoFile(path, mode, defines, includes, content); };
+            return cache ? cache->blocks(path, compute) : compute(nullptr);
+        }
+    };
+
+    // 按文件顺序拼接（配合 OrderedReduce 保证输出顺序与文件列表一致）
+    template <typename T>
+    struct AppendReduceFn
+    {
+        void operator()(QList<T> &result, const QList<T> &mapped) const
+        {
+            result.append(mapped);
+        }
+    };
+
+    struct TableReduceFn
+    {
+        void operator()(BlockTable &result, const BlockTable &mapped) const
+        {
+            result.append(mapped);
+        }
+    };
+
+    using CEscape::hexDigit;
+
+    QTextCodec *gbkCodec()
+    {
+        static QTextCodec *const codec = QTextCodec::codecForName("GBK");
+        return codec;
+    }
+
+    QTextCodec *utf8Codec()
+    {
+        static QTextCodec *const codec = QTextCodec::codecForName("UTF-8");
+        return codec;
+    }
+
+    // 文本是否以 \x 转义结尾（保留转义时用于判断相邻字面量能否直接拼接）
+    bool endsWithHexEscape(const QChar *p, int n)
+    {
+        int k = n;
+        while (k > 0 && hexDigit(p[k - 1]) >= 0)
+            --k;
+        if (k == n || k < 2 || p[k - 1] != QLatin1Char('x') || p[k - 2] != QLatin1Char('\\'))
+            return false;
+        // 反斜杠本身未被转义：其前连续反斜杠数为偶数
+        int slashes = 0;
+        for (int j = k - 3; j >= 0 && p[j] == QLatin1Char('\\'); --j)
+            ++slashes;
+        return slashes % 2 == 0;
+    }
+
+    /**
+     * C 字符串字面量解码器（追加到 out 末尾）
+     * 转义规则见 CEscape::decode；\xNN 与八进制转义按字节累积，遇到普通字符或其它转义时整段解码
+     * （默认 GBK/CP936，可由构造参数指定）。相邻字面量依次 feed 即按 C 规则拼接，字节缓冲跨字面量保留。
+     */
+    class LiteralDecoder
+    {
+    public:
+        LiteralDecoder(QString &out, bool preserveEscapes, QTextCodec *byteCodec = gbkCodec(),
+                       CEscape::Rules rules = CEscape::Rules::CLiteral)
+            : m_out(out), m_preserve(preserveEscapes), m_codec(byteCodec), m_rules(rules)
+        {
+        }
+
+        void feed(const QStringRef &literal)
+        {
+            if (literal.size() < 2 || !literal.startsWith(QLatin1Char('"')) || !literal.endsWith(QLatin1Char('"')))
             {
-                // 回退：尝试按本地8位或UTF-8解码
-                dec = QString::fromLocal8Bit(buf);
-                if (dec.isEmpty())
-                    dec = QString::fromUtf8(buf);
+                flushBytes();
+                m_out.append(literal);
+                return;
             }
-            out.append(dec);
-            buf.clear();
-        };
+            decodeBody(literal.unicode() + 1, literal.size() - 2);
+        }
+
+        // 解码不带引号的字面量正文（CSV 单元格中的转义文本）
+        void feedBody(const QStringRef &body) { decodeBody(body.unicode(), body.size()); }
 
-        for (int i = 0; i < raw.size(); ++i)
+        // 处理尾部残留的字节
+        void finish() { flushBytes(); }
+
+    private:
+        void decodeBody(const QChar *p, int n)
         {
-            QChar c = raw[i];
-            if (c == QLatin1Char('\\') && i + 1 < raw.size())
+            if (m_preserve)
             {
-                QChar n = raw[i + 1];
-                if (n == QLatin1Char('x'))
-                {
-                    // 累积最多2位十六进制，形成一个字节；GBK中文通常由两个字节顺序出现
-                    int j = i + 2;
-                    int consumed = 0;
-                    while (j + 1 < raw.size() && consumed < 2)
-                    {
-                        auto h1 = raw[j];
-                        auto h2 = raw[j + 1];
-                        auto hex = QString(h1) + QString(h2);
-                        bool ok = false;
-                        int val = hex.toInt(&ok, 16);
-                        if (!ok)
-                            break;
-                        buf.append(char(val));
-                        j += 2;
-                        consumed += 2;
-                    }
-                    i = j - 1;
-                    continue;
-                }
-                // 遇到转义控制字符，先刷新 GBK 缓冲，再按 Unicode 附加
-                flushBuf();
-                switch (n.unicode())
+                // 原样保留时，\x 转义后紧跟十六进制字符须断开，否则拼接后含义改变
+                if (m_afterHex && n > 0 && hexDigit(p[0]) >= 0)
+                    m_out.append(QLatin1String("\"\""));
+                m_out.append(p, n);
+                if (n > 0)
+                    m_afterHex = endsWithHexEscape(p, n);
+                return;
+            }
+            CEscape::decode(p, n, m_rules, *this);
+        }
+
+    public:
+        // CEscape::decode 回调
+        void text(const QChar *p, int n)
+        {
+            flushBytes();
+            m_out.append(p, n);
+        }
+        void byte(char b) { m_bytes.append(b); }
+        void codePoint(uint v)
+        {
+            flushBytes();
+            appendCodePoint(v);
+        }
+
+    private:
+        void flushBytes()
+        {
+            if (m_bytes.isEmpty())
+                return;
+            const char *data = m_bytes.constData();
+            const int size = m_bytes.size();
+            bool ascii = true;
+            for (int i = 0; i < size && ascii; ++i)
+                ascii = uchar(data[i]) < 0x80;
+            if (ascii)
+            {
+                m_out.append(QLatin1String(data, size));
+            }
+            else
+            {
+                QString dec;
+                if (m_codec)
+                    dec = m_codec->toUnicode(data, size);
+                if (dec.isEmpty())
                 {
-                case 'n':
-                    out.append(QLatin1Char('\n'));
-                    i++;
-                    continue;
-                case 'r':
-                    out.append(QLatin1Char('\r'));
-                    i++;
-                    continue;
-                case 't':
-                    out.append(QLatin1Char('\t'));
-                    i++;
-                    continue;
-                case '\\':
-                    out.append(QLatin1Char('\\'));
-                    i++;
-                    continue;
-                case '"':
-                    out.append(QLatin1Char('"'));
-                    i++;
-                    continue;
-                case '\'':
-                    out.append(QLatin1Char('\''));
-                    i++;
-                    continue;
-                default:
-                    out.append(n);
-                    i++;
-                    continue;
+                    // 回退：尝试按本地8位或UTF-8解码
+                    dec = QString::fromLocal8Bit(data, size);
+                    if (dec.isEmpty())
+                        dec = QString::fromUtf8(data, size);
                 }
+                m_out.append(dec);
             }
-            // 普通字符：先刷新 GBK 缓冲，再附加当前 Unicode 字符
-            flushBuf();
-            out.append(c);
+            m_bytes.clear();
         }
-        // 处理尾部残留的 GBK 字节
-        flushBuf();
-        return out;
+
+        void appendCodePoint(uint v)
+        {
+            if (v > 0x10FFFF || (v >= 0xD800 && v <= 0xDFFF))
+                m_out.append(QChar(QChar::ReplacementCharacter));
+            else if (QChar::requiresSurrogates(v))
+                m_out.append(QChar(QChar::highSurrogate(v))).append(QChar(QChar::lowSurrogate(v)));
+            else
+                m_out.append(QChar(ushort(v)));
+        }
+
+        QString &m_out;
+        bool m_preserve;
+        bool m_afterHex{false};
+        QTextCodec *m_codec;
+        CEscape::Rules m_rules;
+        QVarLengthArray<char, 256> m_bytes;
+    };
+
+    // 从第 i 个 token 起解码一串相邻的字符串字面量（C 规则拼接为一个值）并追加到 out；返回最后一个字面量的下标
+    int decodeAdjacentLiterals(QString &out, const QString &text, const QVector<CLexer::Token> &toks, int i, int close, bool preserveEscapes)
+    {
+        LiteralDecoder dec(out, preserveEscapes);
+        for (;;)
+        {
+            dec.feed(text.midRef(toks[i].start, toks[i].length));
+            if (i + 1 >= close || toks[i + 1].kind != CLexer::TokenKind::String)
+                break;
+            ++i;
+        }
+        dec.finish();
+        return i;
     }
 
     QStringList parsePointerFields(const QString &body)
     {
         QStringList cols;
-        QRegularExpression re(QStringLiteral("(?:const\\s+char|char\\s+const|char)\\s*\\*\\s*(\\w+)\\s*;"));
+        static const QRegularExpression &re = RegexRegistry::get(QStringLiteral("(?:const\\s+char|char\\s+const|char)\\s*\\*\\s*(\\w+)\\s*;"));
+        static const QRegularExpression &m2 = RegexRegistry::get(QStringLiteral("_(\\w+)$"));
         auto it = re.globalMatch(body);
         while (it.hasNext())
         {
             auto m = it.next();
             QString name = m.captured(1);
-            QRegularExpression m2(QStringLiteral("_(\\w+)$"));
             auto mm = m2.match(name);
             QString lang = mm.hasMatch() ? mm.captured(1) : name;
             // 规范化常见命名：p_text_xx 或 text_xx -> xx
@@ -148,12 +287,145 @@ namespace
         return cols;
     }
 
+    // 收集 token 区间 (open, close) 内的字符串字面量；非首位的 NULL/nullptr 视为哨兵并截止
+    QStringList collectInitStrings(const QString &text, const QVector<CLexer::Token> &toks, int open, int close, bool preserveEscapes)
+    {
+        QStringList strs;
+        for (int i = open + 1; i < close; ++i)
+        {
+            const CLexer::Token &t = toks[i];
+            if (t.kind == CLexer::TokenKind::Identifier && i > open + 1)
+            {
+                const QStringRef w = text.midRef(t.start, t.length);
+                if (w == QLatin1String("NULL") || w == QLatin1String("nullptr"))
+                    break;
+            }
+            if (t.kind == CLexer::TokenKind::String)
+            {
+                QString v;
+                i = decodeAdjacentLiterals(v, text, toks, i, close, preserveEscapes);
+                strs << v;
+            }
+        }
+        return strs;
+    }
+
+    // 同上，但直接解码进块表字符区，不为每个字符串单独分配
+    void collectInitStringsInto(BlockTable &out, const QString &text, const QVector<CLexer::Token> &toks, int open, int close, bool preserveEscapes)
+    {
+        for (int i = open + 1; i < close; ++i)
+        {
+            const CLexer::Token &t = toks[i];
+            if (t.kind == CLexer::TokenKind::Identifier && i > open + 1)
+            {
+                const QStringRef w = text.midRef(t.start, t.length);
+                if (w == QLatin1String("NULL") || w == QLatin1String("nullptr"))
+                    break;
+            }
+            if (t.kind == CLexer::TokenKind::String)
+            {
+                i = decodeAdjacentLiterals(out.arena(), text, toks, i, close, preserveEscapes);
+                out.endString();
+            }
+        }
+    }
+
+    // 超大单文件分片：文本达到阈值（字符数）才切分，每片约 kShardChars 个字符
+    const int kShardThreshold = 8 * 1024 * 1024;
+    const int kShardChars = 2 * 1024 * 1024;
+
+    // 达到阈值且能切出多片时返回分片，否则为空
+    QVector<CLexer::Shard> shardsFor(const QString &text)
+    {
+        if (text.size() < kShardThreshold)
+            return {};
+        QVector<CLexer::Shard> shards = CLexer::splitTopLevel(text, kShardChars);
+        if (shards.size() < 2)
+            shards.clear();
+        return shards;
+    }
+
+    // 提取一段文本中的结构体单个初始化块（忽略数组声明）；lineBase 为该段之前的行数
+    int extractBlocksRange(BlockTable &out, const QString &text, const QString &sourceFile, const QString &typeName, bool preserveEscapes, int lineBase)
+    {
+        // 步骤1：单遍词法分析（注释/字面量/括号/行号），定位 `Type name = {...};`
+        const QVector<CLexer::Token> toks = CLexer::tokenize(text);
+        const QVector<int> pairs = CLexer::matchBrackets(text, toks);
+        const int before = out.size();
+        const int file = out.internFile(sourceFile);
+        for (const CLexer::Initializer &d : CLexer::findInitializers(text, toks, pairs, typeName))
+        {
+            if (d.isArray)
+                continue; // 跳过结构体数组声明
+            // 步骤2：收集花括号内的字符串字面量（至 NULL 哨兵为止）
+            out.beginBlock(file, lineBase + d.line, d.variableName);
+            collectInitStringsInto(out, text, toks, d.openBrace, d.closeBrace, preserveEscapes);
+        }
+        return out.size() - before;
+    }
+
+    // 提取一段文本中的结构体数组；lineBase 同上
+    QList<ExtractedArray> extractArraysRange(const QString &text, const QString &sourceFile, const QString &typeName, bool preserveEscapes, int lineBase)
+    {
+        // 步骤1：单遍词法分析并定位数组声明
+        const QVector<CLexer::Token> toks = CLexer::tokenize(text);
+        const QVector<int> pairs = CLexer::matchBrackets(text, toks);
+        QList<ExtractedArray> out;
+        for (const CLexer::Initializer &d : CLexer::findInitializers(text, toks, pairs, typeName))
+        {
+            if (!d.isArray)
+                continue;
+            // 步骤2：数组体内每个一级 {...} 为一个元素，按语言顺序记录字符串
+            QList<QStringList> elements;
+            for (int i = d.openBrace + 1; i < d.closeBrace; ++i)
+            {
+                if (!CLexer::isPunct(text, toks[i], '{') || pairs[i] < 0)
+                    continue;
+                QStringList strs = collectInitStrings(text, toks, i, pairs[i], preserveEscapes);
+                if (!strs.isEmpty())
+                    elements.append(strs);
+                i = pairs[i];
+            }
+            out.append({d.variableName, sourceFile, lineBase + d.line, elements});
+        }
+        return out;
+    }
+
+    // 分片 map 函数对象：各片复制为独立文本后解析，片首行号换算为全文行号
+    struct BlockShardFn
+    {
+        typedef BlockTable result_type;
+        const QString *text;
+        QString sourceFile;
+        QString typeName;
+        bool preserveEscapes;
+        BlockTable operator()(const CLexer::Shard &s) const
+        {
+            BlockTable t;
+            extractBlocksRange(t, text->mid(s.start, s.end - s.start), sourceFile, typeName, preserveEscapes, s.line - 1);
+            return t;
+        }
+    };
+
+    struct ArrayShardFn
+    {
+        typedef QList<ExtractedArray> result_type;
+        const QString *text;
+        QString sourceFile;
+        QString typeName;
+        bool preserveEscapes;
+        QList<ExtractedArray> operator()(const CLexer::Shard &s) const
+        {
+            return extractArraysRange(text->mid(s.start, s.end - s.start), sourceFile, typeName, preserveEscapes, s.line - 1);
+        }
+    };
+
     QString stripBlockComments(const QString &text)
     {
         QString t = text;
-        QRegularExpression reBlock(QStringLiteral("/\\*.*?\\*/"), QRegularExpression::DotMatchesEverythingOption);
+        static const QRegularExpression &reBlock = RegexRegistry::get(QStringLiteral("/\\*.*?\\*/"), QRegularExpression::DotMatchesEverythingOption);
         t = t.replace(reBlock, QString());
-        QRegularExpression reLine(QStringLiteral("//.*$"));
+        static const QRegularExpression &reLine = RegexRegistry::get(QStringLiteral("//.*$"));
         QStringList lines = t.split(QLatin1Char('\n'));
         for (int i = 0; i < lines.size(); ++i)
             lines[i].remove(reLine);
@@ -171,69 +443,16 @@ namespace TextExtractor
 
     QString readTextFile(const QString &path)
     {
-        QFile f(path);
-        if (!f.open(QIODevice::ReadOnly))
-            return QString();
-        QByteArray data = f.readAll();
-        f.close();
-
-        auto countReplacement = [](const QString &s) -> int {
-            int cnt = 0;
-            for (int i = 0; i < s.size(); ++i)
-            {
-                if (s.at(i).unicode() == 0xFFFD)
-                    ++cnt;
-            }
-            return cnt;
-        };
-
-        // BOM 检测优先
-        if (data.startsWith("\xEF\xBB\xBF"))
-        {
-            return QString::fromUtf8(data.constData() + 3, data.size() - 3);
-        }
-        if (data.size() >= 2 && (uchar)data[0] == 0xFF && (uchar)data[1] == 0xFE)
-        {
-            QTextCodec *c = QTextCodec::codecForName("UTF-16LE");
-            return c ? c->toUnicode(data) : QString();
-        }
-        if (data.size() >= 2 && (uchar)data[0] == 0xFE && (uchar)data[1] == 0xFF)
-        {
-            QTextCodec *c = QTextCodec::codecForName("UTF-16BE");
-            return c ? c->toUnicode(data) : QString();
-        }
-
-        auto decodeWith = [&](const char *name) -> QString {
-            QTextCodec *c = QTextCodec::codecForName(name);
-            return c ? c->toUnicode(data) : QString();
-        };
+        // 单遍字节级判定后只解码一次；持平时偏好 GB18030（更覆盖简体中文）
+        return TextCodec::readFile(path, nullptr, nullptr, TextCodec::Tie::Gb18030);
+    }
 
-        QString utf8 = decodeWith("UTF-8");
-        int repUtf8 = countReplacement(utf8);
-        QString gb18030 = decodeWith("GB18030");
-        int repGb18030 = countReplacement(gb18030);
-        QString gbk = decodeWith("GBK");
-        int repGbk = countReplacement(gbk);
-        QString gb2312 = decodeWith("GB2312");
-        int repGb2312 = countReplacement(gb2312);
-        QString cp936 = decodeWith("CP936");
-        int repCp936 = countReplacement(cp936);
-
-        // 选择替换字符最少的解码结果；持平时偏好 GB18030（更覆盖简体中文）
-        QString best = gb18030;
-        int minRep = repGb18030;
-        auto consider = [&](const QString &s, int rep) {
-            if (rep < minRep)
-            {
-                minRep = rep;
-                best = s;
-            }
-        };
-        consider(utf8, repUtf8);
-        consider(gbk, repGbk);
-        consider(gb2312, repGb2312);
-        consider(cp936, repCp936);
-        return best;
+    QString decodeText(const QByteArray &data)
+    {
+        PerfStats::Timer timer("decode");
+        timer.addBytes(data.size());
+        timer.addItems(1);
+        return TextCodec::decode(data, TextCodec::detect(data, TextCodec::Tie::Gb18030));
     }
 
     QString stripComments(const QString &text)
@@ -243,469 +462,106 @@ namespace TextExtractor
 
     QString preprocess(const QString &text, const QMap<QString, QString> &defines)
     {
-        // 预处理：仅解析 #if/#ifdef/#ifndef/#elif/#else/#endif 条件编译，其他行原样保留
-        // 步骤1：按行切分，初始化状态与栈；parentActive 表示父级是否启用，currentActive 当前分支是否启用，branchTaken 表示是否已有命中分支
-        QStringList lines = text.split(QLatin1Char('\n'));
-        QStringList out;
-        struct Frame
-        {
-            bool parentActive;
-            bool currentActive;
-            bool branchTaken;
-        };
-        QList<Frame> stack;
-        bool parentActive = true;
-        bool currentActive = true;
-        bool branchTaken = false;
-        QRegularExpression reIf(QStringLiteral("^\\s*#\\s*if\\b(.*)$"));
-        QRegularExpression reIfdef(QStringLiteral("^\\s*#\\s*ifdef\\b\\s*(\\w+).*$"));
-        QRegularExpression reIfndef(QStringLiteral("^\\s*#\\s*ifndef\\b\\s*(\\w+).*$"));
-        QRegularExpression reElif(QStringLiteral("^\\s*#\\s*elif\\b(.*)$"));
-        QRegularExpression reElse(QStringLiteral("^\\s*#\\s*else\\b.*$"));
-        QRegularExpression reEndif(QStringLiteral("^\\s*#\\s*endif\\b.*$"));
-        // 步骤2：解析条件表达式，支持 defined(NAME)、NAME ==/!= 值、宏名存在
-        auto evalCond = [&](const QString &expr) -> bool
-        {
-            QString e = expr.trimmed();
-            if (e.isEmpty())
-                return false;
-            QRegularExpression rDefined(QStringLiteral("defined\\s*\\(\\s*(\\w+)\\s*\\)"));
-            auto md = rDefined.match(e);
-            if (md.hasMatch())
-                return defines.contains(md.captured(1));
-            QRegularExpression rEq(QStringLiteral("(\\w+)\\s*(==|!=)\\s*(\\S+)"));
-            auto me = rEq.match(e);
-            if (me.hasMatch())
-            {
-                QString name = me.captured(1);
-                QString op = me.captured(2);
-                QString val = me.captured(3);
-                val.remove(QLatin1Char('"'));
-                // val.remove(QLatin1Char('\'')); 
-                QString defval = defines.value(name);
-                if (op == QLatin1String("=="))
-                    return defval == val;
-                return defval != val;
-            }
-            QRegularExpression rName(QStringLiteral("^\\w+$"));
-            if (rName.match(e).hasMatch())
-                return defines.contains(e);
-            return false;
-        };
+        // 条件编译预处理：表达式编译求值、文件内 #define/#undef 生效，输出行号与原文一致
+        return Preprocessor::run(text, QString(), defines);
+    }
 
-        // 步骤3：逐行扫描，维护条件栈，更新 parentActive/currentActive/branchTaken
-        for (const QString &line : lines)
-        {
-            auto mIf = reIf.match(line);
-            if (mIf.hasMatch())
-            {
-                bool cond = evalCond(mIf.captured(1));
-                stack.append({parentActive, currentActive, branchTaken});
-                parentActive = parentActive && currentActive;
-                currentActive = parentActive && cond;
-                branchTaken = cond;
-                continue;
-            }
-            auto mIfdef = reIfdef.match(line);
-            if (mIfdef.hasMatch())
-            {
-                bool cond = defines.contains(mIfdef.captured(1));
-                stack.append({parentActive, currentActive, branchTaken});
-                parentActive = parentActive && currentActive;
-                currentActive = parentActive && cond;
-                branchTaken = cond;
-                continue;
-            }
-            auto mIfndef = reIfndef.match(line);
-            if (mIfndef.hasMatch())
-            {
-                bool cond = !defines.contains(mIfndef.captured(1));
-                stack.append({parentActive, currentActive, branchTaken});
-                parentActive = parentActive && currentActive;
-                currentActive = parentActive && cond;
-                branchTaken = cond;
-                continue;
-            }
-            auto mElif = reElif.match(line);
-            if (mElif.hasMatch())
-            {
-                if (!stack.isEmpty())
-                {
-                    Frame &f = stack.last();
-                    parentActive = f.parentActive;
-                    if (f.branchTaken)
-                    {
-                        currentActive = false;
-                    }
-                    else
-                    {
-                        bool cond = evalCond(mElif.captured(1));
-                        currentActive = parentActive && cond;
-                        f.branchTaken = f.branchTaken || cond;
-                    }
-                    branchTaken = f.branchTaken;
-                }
-                continue;
-            }
-            if (reElse.match(line).hasMatch())
-            {
-                if (!stack.isEmpty())
-                {
-                    Frame &f = stack.last();
-                    parentActive = f.parentActive;
-                    currentActive = parentActive && (!f.branchTaken);
-                    f.branchTaken = true;
-                    branchTaken = true;
-                }
-                continue;
-            }
-            if (reEndif.match(line).hasMatch())
-            {
-                if (!stack.isEmpty())
-                {
-                    Frame f = stack.takeLast();
-                    parentActive = f.parentActive;
-                    currentActive = f.currentActive;
-                    branchTaken = f.branchTaken;
-                }
-                continue;
-            }
-            // 步骤4：当前分支有效则输出该行
-            if (parentActive && currentActive)
-                out << line;
-        }
-        return out.join(QLatin1Char('\n'));
+    bool isEffectiveMode(const QString &mode)
+    {
+        return mode == QLatin1String("effective") || followsIncludes(mode);
     }
 
-QList<ExtractedBlock> extractBlocks(const QString &text, const QString &sourceFile, const QString &typeName, bool preserveEscapes)
+    bool followsIncludes(const QString &mode)
+    {
+        return mode == QLatin1String("effective_includes");
+    }
+
+    std::shared_ptr<const Preprocessor::IncludeContext> makeIncludeContext(const QString &root, const QString &mode, const QMap<QString, QString> &defines)
+    {
+        if (!followsIncludes(mode))
+            return nullptr;
+        return std::make_shared<const Preprocessor::IncludeContext>(Preprocessor::IncludeContext::searchDirs(root), defines);
+    }
+
+int extractBlocksInto(BlockTable &out, const QString &text, const QString &sourceFile, const QString &typeName, bool preserveEscapes)
 {
-        // 解析结构体单个初始化块，忽略数组声明
-        // 步骤1：去除注释，使用正则一次性匹配完整声明与花括号体
-        QString ncAll = stripComments(text);
-        QRegularExpression reFull(QStringLiteral("(?:(?:static|const)\\s+)*(?:struct\\s+)?%1(?:\\s+\\w+)*\\s*(?:\\*+)?\\s+([A-Za-z_]\\w*)\\s*(?:\\[[^\\]]*\\])?(?:\\s+\\w+)*\\s*=\\s*(?:&\\s*\\([^)]*\\)\\s*)?\\{(.*?)\\};").arg(QRegularExpression::escape(typeName)), QRegularExpression::DotMatchesEverythingOption);
-        QRegularExpression reStringsFull(QStringLiteral("\"(?:\\.|[^\"\\])*\""));
-        auto itFull = reFull.globalMatch(ncAll);
-        QList<ExtractedBlock> fast;
-        while (itFull.hasNext())
-        {
-            auto m = itFull.next();
-            QString declText = m.captured(0);
-            int eqPos = declText.indexOf(QLatin1Char('='));
-            if (eqPos > 0)
-            {
-                QString left = declText.left(eqPos);
-                if (left.contains(QLatin1Char('[')))
-                {
-                    continue; // 跳过结构体数组声明
-                }
-            }
-            QString var = m.captured(1);
-            QString inner = m.captured(2);
-            // 步骤2：剥离末尾 NULL 哨兵，以免将其计入语言值
-            int sentinelPos = inner.indexOf(QRegularExpression(QStringLiteral("(?:^|[\\s,])(NULL|nullptr)(?:[\\s,]|$)")));
-            QString innerFor = sentinelPos > 0 ? inner.left(sentinelPos) : inner;
-            QStringList strs;
-            auto sit = reStringsFull.globalMatch(innerFor);
-            while (sit.hasNext())
-            {
-                auto sm = sit.next();
-                QString decoded = decodeCEscapedString(sm.captured(0), preserveEscapes);
-                strs << decoded;
-            }
-            int startPos = m.capturedStart(0);
-            int startPosOrig = text.indexOf(declText);
-            int finalLine = (startPosOrig >= 0) ? (text.left(startPosOrig).count(QLatin1Char('\n')) + 1)
-                                                : (ncAll.left(startPos).count(QLatin1Char('\n')) + 1);
-            fast.append({var, strs, sourceFile, finalLine});
-        }
-        // 兼容性回退：逐行扫描以适配不规则格式或换行（与 fast 合并）
-        QList<ExtractedBlock> results = fast;
-        QStringList lines = text.split(QLatin1Char('\n'));
-        // 允许类型名与变量名之间的附加限定词（如 PROGMEM），以及指针/数组声明
-        QRegularExpression reStart(QStringLiteral("(?:(?:static|const)\\s+)*(?:struct\\s+)?%1(?:\\s+\\w+)*\\s*(?:\\*+)?\\s+([A-Za-z_]\\w*)\\s*(?:\\[[^\\]]*\\])?(?:\\s+\\w+)*\\s*=\\s*").arg(QRegularExpression::escape(typeName)));
-        QRegularExpression reStrings(QStringLiteral("\"(?:\\\\.|[^\"\\\\])*\""));
-    int i = 0;
-    bool inBlockComment = false;
-    while (i < lines.size())
+    // 超大文本按顶层 ';' 分片并发解析，按分片顺序合并，行号已换算为全文行号
+    PerfStats::Timer timer("extract");
+    timer.addBytes(text.size());
+    int added = 0;
+    const QVector<CLexer::Shard> shards = shardsFor(text);
+    if (shards.isEmpty())
     {
-        QString line = lines[i];
-        QString ltrim = line.trimmed();
-        if (ltrim.contains(QLatin1String("/*")) && !ltrim.contains(QLatin1String("*/")))
-            inBlockComment = true;
-        bool lineStartsComment = ltrim.startsWith(QLatin1String("//")) || inBlockComment;
-        if (inBlockComment && ltrim.contains(QLatin1String("*/")))
-        {
-            inBlockComment = false;
-            i++;
-            continue;
-        }
-        if (lineStartsComment)
-        {
-            i++;
-            continue;
-        }
-        auto m = reStart.match(line);
-        if (!m.hasMatch())
-        {
-            i++;
-            continue;
-        }
-        {
-            // 步骤4：若为数组声明，跳过（本函数仅处理单个结构体变量）
-            int eqPos = line.indexOf(QLatin1Char('='));
-            if (eqPos > 0)
-            {
-                QString left = line.left(eqPos);
-                if (left.contains(QLatin1Char('[')))
-                {
-                    i++;
-                    continue; // 跳过结构体数组声明
-                }
-            }
-        }
-            QString var = m.captured(1);
-            int declLine = i + 1;
-            QStringList buf;
-            buf << line;
-            i++;
-            bool started = line.contains(QLatin1Char('{'));
-            int braceDepth = started ? (line.count(QLatin1Char('{')) - line.count(QLatin1Char('}'))) : 0;
-            int bodyStartLine = started ? declLine : 0;
-        if (started && braceDepth == 0 && line.contains(QStringLiteral("};")))
-        {
-            // 步骤5：单行初始化（{...};）直接解析内部字符串
-            QString nc = stripComments(line);
-            QRegularExpression reInner(QStringLiteral("\\{(.*)\\};"), QRegularExpression::DotMatchesEverythingOption);
-            auto mi = reInner.match(nc);
-            QStringList strs;
-            if (mi.hasMatch())
-            {
-                QString inner = mi.captured(1);
-                int sentinelPos = inner.indexOf(QRegularExpression(QStringLiteral("(?:^|[\\s,])(NULL|nullptr)(?:[\\s,]|$)")));
-                QString innerFor = sentinelPos > 0 ? inner.left(sentinelPos) : inner;
-                auto it2 = reStrings.globalMatch(innerFor);
-                while (it2.hasNext())
-                {
-                    auto sm = it2.next();
-                    QString decoded = decodeCEscapedString(sm.captured(0), preserveEscapes);
-                    strs << decoded;
-                }
-                int finalLine = declLine;
-                results.append({var, strs, sourceFile, finalLine});
-            }
-            continue;
-        }
-            // 步骤6：多行初始化，累积到结束的 '};'
-            while (i < lines.size())
-            {
-                buf << lines[i];
-                if (!started && lines[i].contains(QLatin1Char('{')))
-                {
-                    started = true;
-                    bodyStartLine = i + 1;
-                }
-                braceDepth += lines[i].count(QLatin1Char('{'));
-                braceDepth -= lines[i].count(QLatin1Char('}'));
-                if (started && braceDepth == 0 && lines[i].contains(QStringLiteral("};")))
-                {
-                    i++;
-                    break;
-                }
-                i++;
-            }
-            QString block = buf.join(QLatin1Char('\n'));
-            // 步骤6：多行块解析，去注释后提取内部字符串
-            QString nc = stripComments(block);
-            QRegularExpression reInner(QStringLiteral("\\{(.*)\\};"), QRegularExpression::DotMatchesEverythingOption);
-            auto mi = reInner.match(nc);
-            QStringList strs;
-        if (mi.hasMatch())
-        {
-            QString inner = mi.captured(1);
-            int sentinelPos = inner.indexOf(QRegularExpression(QStringLiteral("(?:^|[\\s,])(NULL|nullptr)(?:[\\s,]|$)")));
-            QString innerFor = sentinelPos > 0 ? inner.left(sentinelPos) : inner;
-            auto it = reStrings.globalMatch(innerFor);
-            while (it.hasNext())
-            {
-                auto sm = it.next();
-                QString decoded = decodeCEscapedString(sm.captured(0), preserveEscapes);
-                strs << decoded;
-            }
-            int finalLine = (bodyStartLine > 0) ? bodyStartLine : declLine;
-            bool exists = false;
-            for (const auto &e : results)
-            {
-                if (e.variableName == var && e.sourceFile == sourceFile && e.lineNumber == finalLine) { exists = true; break; }
-            }
-            if (!exists)
-                results.append({var, strs, sourceFile, finalLine});
-        }
+        added = extractBlocksRange(out, text, sourceFile, typeName, preserveEscapes, 0);
     }
-    return results;
+    else
+    {
+        PerfStats::count("extract_shard", shards.size());
+        const BlockTable t = QtConcurrent::blockingMappedReduced<BlockTable>(shards, BlockShardFn{&text, sourceFile, typeName, preserveEscapes}, TableReduceFn(),
+                                                                             QtConcurrent::OrderedReduce | QtConcurrent::SequentialReduce);
+        out.append(t);
+        added = t.size();
+    }
+    timer.addItems(added);
+    return added;
+}
+
+QList<ExtractedBlock> extractBlocks(const QString &text, const QString &sourceFile, const QString &typeName, bool preserveEscapes)
+{
+    BlockTable t;
+    extractBlocksInto(t, text, sourceFile, typeName, preserveEscapes);
+    return t.toList();
 }
 
 QList<ExtractedArray> extractArrays(const QString &text, const QString &sourceFile, const QString &typeName, bool preserveEscapes)
 {
-    // 解析结构体数组，每个元素对应一组语言值
-    // 步骤1：去注释并用正则一次性匹配数组声明与主体
-    QString ncAll = stripComments(text);
-QRegularExpression reDecl(QString::fromLatin1(R"((?:(?:static|const)\s+)*(?:struct\s+)?%1(?:\s+\w+)*\s*(?:\*+)?\s+([A-Za-z_]\w*)\s*\[[^\]]*\]\s*=\s*\{(.*?)\};)" )
-                                  .arg(QRegularExpression::escape(typeName)), QRegularExpression::DotMatchesEverythingOption);
-    auto it = reDecl.globalMatch(ncAll);
-QRegularExpression reElem(QString::fromLatin1(R"(\{([\s\S]*?)\})"));
-QRegularExpression reStr(QString::fromLatin1(R"("(?:\.|[^"])*")"));
+    PerfStats::Timer timer("extract_arrays");
+    timer.addBytes(text.size());
     QList<ExtractedArray> out;
-    while (it.hasNext())
+    const QVector<CLexer::Shard> shards = shardsFor(text);
+    if (shards.isEmpty())
     {
-        auto m = it.next();
-        QString var = m.captured(1);
-        QString body = m.captured(2);
-        int startPos = m.capturedStart(0);
-        QString fullDecl = m.captured(0);
-        int startPosOrig = text.indexOf(fullDecl);
-        int declLine = (startPosOrig >= 0) ? (text.left(startPosOrig).count(QLatin1Char('\n')) + 1)
-                                           : (ncAll.left(startPos).count(QLatin1Char('\n')) + 1);
-        QList<QStringList> elements;
-        auto me = reElem.globalMatch(body);
-        while (me.hasNext())
-        {
-            auto em = me.next();
-            QString inner = em.captured(1);
-            // 步骤2：剥离元素末尾的 NULL 哨兵
-            int sentinelPos = inner.indexOf(QRegularExpression(QStringLiteral("(?:^|[\s,])(NULL|nullptr)(?:[\s,]|$)")));
-            QString innerFor = sentinelPos > 0 ? inner.left(sentinelPos) : inner;
-            QStringList strs;
-            // 步骤3：提取元素内的字符串字面值并按语言顺序记录
-            auto sit = reStr.globalMatch(innerFor);
-            while (sit.hasNext())
-            {
-                auto sm = sit.next();
-                QString decoded = decodeCEscapedString(sm.captured(0), preserveEscapes);
-                strs << decoded;
-            }
-            if (!strs.isEmpty())
-                elements.append(strs);
-        }
-        out.append({var, sourceFile, declLine, elements});
+        out = extractArraysRange(text, sourceFile, typeName, preserveEscapes, 0);
     }
-    if (!out.isEmpty())
-        return out;
-
-    // 兼容性回退：按行扫描以提升健壮性（适配混合格式）
-    QStringList lines = text.split(QLatin1Char('\n'));
-    QRegularExpression reStart(QString::fromLatin1(R"((?:(?:static|const)\s+)*(?:struct\s+)?%1(?:\s+\w+)*\s*(?:\*+)?\s+([A-Za-z_]\w*)\s*\[[^\]]*\]\s*=\s*)")
-                                      .arg(QRegularExpression::escape(typeName)));
-    for (int i = 0; i < lines.size(); ++i)
+    else
     {
-        QString line = lines[i];
-        auto m = reStart.match(line);
-        if (!m.hasMatch()) continue;
-        QString var = m.captured(1);
-        int declLine = i + 1;
-        QStringList buf; buf << line; int braceDepth = line.count(QLatin1Char('{')) - line.count(QLatin1Char('}'));
-        bool started = line.contains(QLatin1Char('{'));
-        i++;
-        while (i < lines.size())
-        {
-            buf << lines[i];
-            braceDepth += lines[i].count(QLatin1Char('{'));
-            braceDepth -= lines[i].count(QLatin1Char('}'));
-            if (started && braceDepth == 0 && lines[i].contains(QStringLiteral("};")))
-            { i++; break; }
-            i++;
-        }
-        QString block = buf.join(QLatin1Char('\n'));
-        // 步骤4：多行块解析，去注释后提取内部元素
-        QString nc = stripComments(block);
-        QRegularExpression reInner(QString::fromLatin1(R"(\{(.*)\};)"), QRegularExpression::DotMatchesEverythingOption);
-        auto mi = reInner.match(nc);
-        if (!mi.hasMatch()) continue;
-        QString body = mi.captured(1);
-        QList<QStringList> elements;
-        auto me = reElem.globalMatch(body);
-        while (me.hasNext())
-        {
-            auto em = me.next();
-            QString inner = em.captured(1);
-            int sentinelPos = inner.indexOf(QRegularExpression(QStringLiteral("(?:^|[\s,])(NULL|nullptr)(?:[\s,]|$)")));
-            QString innerFor = sentinelPos > 0 ? inner.left(sentinelPos) : inner;
-            QStringList strs;
-            auto sit = reStr.globalMatch(innerFor);
-            while (sit.hasNext())
-            {
-                auto sm = sit.next();
-                QString decoded = decodeCEscapedString(sm.captured(0), preserveEscapes);
-                strs << decoded;
-            }
-            if (!strs.isEmpty()) elements.append(strs);
-        }
-        out.append({var, sourceFile, declLine, elements});
+        PerfStats::count("extract_shard", shards.size());
+        out = QtConcurrent::blockingMappedReduced<QList<ExtractedArray>>(shards, ArrayShardFn{&text, sourceFile, typeName, preserveEscapes}, AppendReduceFn<ExtractedArray>(),
+                                                                         QtConcurrent::OrderedReduce | QtConcurrent::SequentialReduce);
     }
+    timer.addItems(out.size());
     return out;
-
-    // 兼容性回退2：容忍未知类型别名（匹配任意 typedef 名称）
-    // Useful when preprocess alters type alias rendering
-    QList<ExtractedArray> out2;
-    QRegularExpression reDeclAny(QString::fromLatin1(R"((?:(?:static|const)\s+)*(?:struct\s+)?\w+(?:\s+\w+)*\s*(?:\*+)?\s+([A-Za-z_]\w*)\s*\[[^\]]*\]\s*=\s*\{(.*?)\};)"), QRegularExpression::DotMatchesEverythingOption);
-    auto it2 = reDeclAny.globalMatch(text);
-    while (it2.hasNext())
-    {
-        auto m = it2.next();
-        QString var = m.captured(1);
-        QString body = m.captured(2);
-        int startPos = m.capturedStart(0);
-        int declLine = text.left(startPos).count(QLatin1Char('\n')) + 1;
-        QList<QStringList> elements;
-        auto me = reElem.globalMatch(body);
-        while (me.hasNext())
-        {
-            auto em = me.next();
-            QString inner = em.captured(1);
-            int sentinelPos = inner.indexOf(QRegularExpression(QStringLiteral("(?:^|[\s,])(NULL|nullptr)(?:[\s,]|$)")));
-            QString innerFor = sentinelPos > 0 ? inner.left(sentinelPos) : inner;
-            QStringList strs;
-            auto sit = reStr.globalMatch(innerFor);
-            while (sit.hasNext())
-            {
-                auto sm = sit.next();
-                QString decoded = decodeCEscapedString(sm.captured(0), preserveEscapes);
-                strs << decoded;
-            }
-            if (!strs.isEmpty()) elements.append(strs);
-        }
-        if (!elements.isEmpty()) out2.append({var, sourceFile, declLine, elements});
-    }
-    return out2;
 }
 
-QList<ExtractedArray> scanDirectoryArrays(const QString &root, const QStringList &extensions, const QString &mode, const QMap<QString, QString> &defines, const QString &typeName, bool preserveEscapes)
+QList<ExtractedArray> extractArraysFile(const QString &path, const QString &mode, const QMap<QString, QString> &defines, const QString &typeName, bool preserveEscapes,
+                                       const Preprocessor::IncludeContext *includes, const QByteArray *content)
 {
-    QList<ExtractedArray> all;
-    QDir dir(root);
-    QStringList exts = extensions.isEmpty() ? QStringList{QStringLiteral(".h"), QStringLiteral(".hpp"), QStringLiteral(".c"), QStringLiteral(".cpp")} : extensions;
-    auto matchExt = [&](const QString &fn)
-    { for (const QString &e : exts) if (fn.toLower().endsWith(e.toLower())) return true; return false; };
-    QList<QString> stack; stack << dir.absolutePath();
-    while (!stack.isEmpty())
-    {
-        QString path = stack.takeLast();
-        QDir d(path);
-        QFileInfoList infos = d.entryInfoList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
-        for (const QFileInfo &fi : infos)
-        {
-            if (fi.isDir()) { stack << fi.absoluteFilePath(); continue; }
-            if (!matchExt(fi.fileName())) continue;
-            QString text = TextExtractor::readTextFile(fi.absoluteFilePath());
-            QString t = (mode == QLatin1String("effective")) ? TextExtractor::preprocess(text, defines) : text;
-            auto arrays = extractArrays(t, fi.absoluteFilePath(), typeName, preserveEscapes);
-            if (arrays.isEmpty() && mode == QLatin1String("effective"))
-            {
-                arrays = extractArrays(text, fi.absoluteFilePath(), typeName, preserveEscapes);
-            }
-            all.append(arrays);
-        }
+    QString text = content ? decodeText(*content) : readTextFile(path);
+    const bool effective = isEffectiveMode(mode);
+    QString t = effective ? Preprocessor::run(text, path, defines, followsIncludes(mode) ? includes : nullptr) : text;
+    auto arrays = extractArrays(t, path, typeName, preserveEscapes);
+    if (arrays.isEmpty() && effective)
+    {
+        arrays = extractArrays(text, path, typeName, preserveEscapes);
     }
-    return all;
+    std::stable_sort(arrays.begin(), arrays.end(), [](const ExtractedArray &a, const ExtractedArray &b)
+                     { return a.lineNumber < b.lineNumber; });
+    return arrays;
+}
+
+QList<ExtractedArray> scanDirectoryArrays(const QString &root, const QStringList &extensions, const QString &mode, const QMap<QString, QString> &defines, const QString &typeName, bool preserveEscapes)
+{
+    DirWalker::Scope walkScope(root); // 文件列表、包含目录与缓存指纹共用一次遍历
+    // 并发 map-reduce：按文件分发到线程池，OrderedReduce 保证按路径顺序合并
+    const QStringList files = collectSourceFiles(root, extensions);
+    ExtractCache cache(root, QStringLiteral("arrays"), mode, defines, typeName, preserveEscapes);
+    cache.load();
+    const auto includes = makeIncludeContext(root, mode, defines);
+    ArraysMapFn mapFn{mode, defines, typeName, preserveEscapes, &cache, includes.get()};
+    QList<ExtractedArray> out = QtConcurrent::blockingMappedReduced<QList<ExtractedArray>>(files, mapFn, AppendReduceFn<ExtractedArray>(),
+                                                                                           QtConcurrent::OrderedReduce | QtConcurrent::SequentialReduce);
+    cache.save();
+    return out;
 }
 
 static QString hexEscapeIfNeeded(const QString &s, bool literal, bool replaceComma)
@@ -767,61 +623,90 @@ bool writeArraysCsv(const QString &outputPath,
     return true;
 }
 
-    QList<ExtractedBlock> scanDirectory(const QString &root, const QStringList &extensions, const QString &mode, const QMap<QString, QString> &defines, const QString &typeName, bool preserveEscapes)
+    QStringList collectSourceFiles(const QString &root, const QStringList &extensions)
     {
-        QList<ExtractedBlock> all;
-        QDir dir(root);
+        // 统一走 DirWalker：目录级剪枝 + 排除规则；处于 DirWalker::Scope 内时复用同一次遍历
         QStringList exts = extensions;
-        auto matchExt = [&](const QString &fn)
-        { for (const QString &e : exts) if (fn.toLower().endsWith(e.toLower())) return true; return false; };
-        QList<QString> stack;
-        stack << dir.absolutePath();
-        while (!stack.isEmpty())
+        if (exts.isEmpty())
+            exts << QStringLiteral(".h") << QStringLiteral(".hpp") << QStringLiteral(".c") << QStringLiteral(".cpp");
+        return DirWalker::collect(root, exts);
+    }
+
+    BlockTable extractFileTable(const QString &path, const QString &mode, const QMap<QString, QString> &defines, const QString &typeName, bool preserveEscapes,
+                                const Preprocessor::IncludeContext *includes, const QByteArray *content)
+    {
+        QString text = content ? decodeText(*content) : readTextFile(path);
+        const bool effective = isEffectiveMode(mode);
+        QString t = effective ? Preprocessor::run(text, path, defines, followsIncludes(mode) ? includes : nullptr) : text;
+        BlockTable blocks;
+        bool needFallback = extractBlocksInto(blocks, t, path, typeName, preserveEscapes) == 0;
+        if (!needFallback && effective)
         {
-            QString path = stack.takeLast();
-            QDir d(path);
-            QFileInfoList infos = d.entryInfoList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
-            for (const QFileInfo &fi : infos)
+            for (int i = 0; i < blocks.size(); ++i)
             {
-                if (fi.isDir())
-                {
-                    stack << fi.absoluteFilePath();
-                    continue;
-                }
-                if (!matchExt(fi.fileName()))
-                    continue;
-                QString text = readTextFile(fi.absoluteFilePath());
-                QString t = (mode == QLatin1String("effective")) ? preprocess(text, defines) : text;
-                auto blocks = extractBlocks(t, fi.absoluteFilePath(), typeName, preserveEscapes);
-                bool needFallback = blocks.isEmpty();
-                if (!needFallback && mode == QLatin1String("effective"))
-                {
-                    for (const auto &b : blocks)
-                    {
-                        if (b.strings.isEmpty()) { needFallback = true; break; }
-                    }
-                }
-                if (needFallback && mode == QLatin1String("effective"))
-                {
-                    auto rawBlocks = extractBlocks(text, fi.absoluteFilePath(), typeName, preserveEscapes);
-                    if (!rawBlocks.isEmpty())
-                        blocks = rawBlocks;
-                }
-                all.append(blocks);
+                if (blocks.stringCount(i) == 0) { needFallback = true; break; }
             }
         }
-        return all;
+        if (needFallback && effective)
+        {
+            BlockTable rawBlocks;
+            if (extractBlocksInto(rawBlocks, text, path, typeName, preserveEscapes) > 0)
+                blocks = std::move(rawBlocks);
+        }
+        blocks.sortByLine();
+        return blocks;
     }
 
-    QStringList discoverLanguageColumns(const QString &root, const QStringList &extensions, const QString &typeAlias)
+    QList<ExtractedBlock> extractFile(const QString &path, const QString &mode, const QMap<QString, QString> &defines, const QString &typeName, bool preserveEscapes,
+                                      const Preprocessor::IncludeContext *includes, const QByteArray *content)
+    {
+        return extractFileTable(path, mode, defines, typeName, preserveEscapes, includes, content).toList();
+    }
+
+    BlockTable scanDirectoryTable(const QString &root, const QStringList &extensions, const QString &mode, const QMap<QString, QString> &defines, const QString &typeName, bool preserveEscapes)
+    {
+        DirWalker::Scope walkScope(root);
+        // 并发 map-reduce：QtConcurrent 线程池按块领取文件（动态负载均衡），按路径顺序归约
+        const QStringList files = collectSourceFiles(root, extensions);
+        // 增量缓存：未改动文件直接复用上次结果
+        ExtractCache cache(root, QStringLiteral("blocks"), mode, defines, typeName, preserveEscapes);
+        cache.load();
+        const auto includes = makeIncludeContext(root, mode, defines);
+        BlocksMapFn mapFn{mode, defines, typeName, preserveEscapes, &cache, includes.get()};
+        BlockTable out = QtConcurrent::blockingMappedReduced<BlockTable>(files, mapFn, TableReduceFn(),
+                                                                         QtConcurrent::OrderedReduce | QtConcurrent::SequentialReduce);
+        cache.save();
+        return out;
+    }
+
+    QList<ExtractedBlock> scanDirectory(const QString &root, const QStringList &extensions, const QString &mode, const QMap<QString, QString> &defines, const QString &typeName, bool preserveEscapes)
+    {
+        return scanDirectoryTable(root, extensions, mode, defines, typeName, preserveEscapes).toList();
+    }
+
+    // 待写回的内容优先于磁盘（键为规范化的绝对路径）
+    static QString readWithPending(const QString &path, const QHash<QString, QString> *pending)
+    {
+        if (pending)
+        {
+            auto it = pending->constFind(QDir::cleanPath(QFileInfo(path).absoluteFilePath()));
+            if (it != pending->constEnd())
+                return it.value();
+        }
+        return readTextFile(path);
+    }
+
+    static QStringList discoverColumns(const QString &root, const QStringList &extensions, const QString &typeAlias, QString &definedIn,
+                                       const QHash<QString, QString> *pending)
     {
+        definedIn.clear();
         // 仅解析指定别名的结构体（例如 _Tr_TEXT），避免误采集其它结构体字段
         // 1) 首选 include/tr_text.h（约定路径）
         {
             QString headerPath = QDir(root).absoluteFilePath(QStringLiteral("include/tr_text.h"));
-            QString text = readTextFile(headerPath);
+            QString text = readWithPending(headerPath, pending);
             QString nc = stripComments(text);
-            QRegularExpression reBody(QStringLiteral("typedef\\s+struct\\s*\\{(.*?)\\}\\s*(\\w+)\\s*;"), QRegularExpression::DotMatchesEverythingOption);
+            const QRegularExpression &reBody = RegexRegistry::typedefStruct();
             auto it = reBody.globalMatch(nc);
             while (it.hasNext())
             {
@@ -842,50 +727,31 @@ bool writeArraysCsv(const QString &outputPath,
                     {
                         norm.removeLast();
                     }
+                    definedIn = headerPath;
                     return norm;
                 }
             }
         }
-        // 2) 遍历项目中所有指定扩展的文件，仅提取目标别名的结构体
-        QStringList exts = extensions;
-        if (exts.isEmpty())
-            exts << QStringLiteral(".h") << QStringLiteral(".hpp") << QStringLiteral(".c") << QStringLiteral(".cpp");
-        auto matchExt = [&](const QString &fn)
-        { for (const QString &e : exts) if (fn.toLower().endsWith(e.toLower())) return true; return false; };
+        // 2) 遍历项目中所有指定扩展的文件（经 DirWalker，与提取、结构体布局指纹看到同一组文件），仅提取目标别名的结构体
         QStringList langs; // 保持顺序
-        QList<QString> stack;
-        stack << QDir(root).absolutePath();
-        QRegularExpression reBody(QStringLiteral("typedef\\s+struct\\s*\\{(.*?)\\}\\s*(\\w+)\\s*;"), QRegularExpression::DotMatchesEverythingOption);
-        while (!stack.isEmpty())
+        const QRegularExpression &reBody = RegexRegistry::typedefStruct();
+        for (const QString &path : collectSourceFiles(root, extensions))
         {
-            QString path = stack.takeLast();
-            QDir d(path);
-            QFileInfoList infos = d.entryInfoList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
-            for (const QFileInfo &fi : infos)
+            QString text = readWithPending(path, pending);
+            QString nc = stripComments(text);
+            auto it = reBody.globalMatch(nc);
+            while (it.hasNext())
             {
-                if (fi.isDir())
-                {
-                    stack << fi.absoluteFilePath();
-                    continue;
-                }
-                if (!matchExt(fi.fileName()))
+                auto m = it.next();
+                QString alias = m.captured(2);
+                if (alias != typeAlias)
                     continue;
-                QString text = readTextFile(fi.absoluteFilePath());
-                QString nc = stripComments(text);
-                auto it = reBody.globalMatch(nc);
-                while (it.hasNext())
+                QString body = m.captured(1);
+                QStringList cols = parsePointerFields(body);
+                for (const QString &c : cols)
                 {
-                    auto m = it.next();
-                    QString alias = m.captured(2);
-                    if (alias != typeAlias)
-                        continue;
-                    QString body = m.captured(1);
-                    QStringList cols = parsePointerFields(body);
-                    for (const QString &c : cols)
-                    {
-                        QString norm = c.startsWith(QLatin1String("text_")) ? c : (QStringLiteral("text_") + c);
-                        langs << norm;
-                    }
+                    QString norm = c.startsWith(QLatin1String("text_")) ? c : (QStringLiteral("text_") + c);
+                    langs << norm;
                 }
             }
         }
@@ -904,313 +770,143 @@ bool writeArraysCsv(const QString &outputPath,
         return norm;
     }
 
-    static QString csvEscape(const QString &s)
+    QStringList discoverLanguageColumns(const QString &root, const QStringList &extensions, const QString &typeAlias)
     {
-        QString v = s;
-        // 防止 CSV 中出现实际换行：将 CRLF/LF/CR 转为字面 "\\n"
-        v.replace(QStringLiteral("\r\n"), QStringLiteral("\\n"));
-        v.replace(QLatin1Char('\n'), QStringLiteral("\\n"));
-        v.replace(QLatin1Char('\r'), QStringLiteral("\\n"));
-        // 可选：将制表符转为字面 "\\t"，避免表格中出现控制字符
-        v.replace(QLatin1Char('\t'), QStringLiteral("\\t"));
-        QString q = v;
-        q.replace(QLatin1Char('"'), QStringLiteral("\"\""));
-        return QStringLiteral("\"") + q + QStringLiteral("\"");
+        QString definedIn;
+        return discoverColumns(root, extensions, typeAlias, definedIn, nullptr);
     }
 
-    static QString toUtf8Hex(const QString &s)
+    QStringList discoverLanguageColumns(const QString &root, const QStringList &extensions, const QString &typeAlias,
+                                        const QHash<QString, QString> &pending)
     {
-        if (s.isEmpty())
-            return QString();
-        QByteArray b = s.toUtf8();
-        QString out;
-        out.reserve(b.size() * 4);
-        for (unsigned char c : b)
-        {
-            QString hx = QStringLiteral("%1").arg(c, 2, 16, QLatin1Char('0')).toUpper();
-            out += QStringLiteral("\\x") + hx; // 保持小写 x，十六进制数字大写
-        }
-        return out;
+        QString definedIn;
+        return discoverColumns(root, extensions, typeAlias, definedIn, &pending);
+    }
+
+    QStringList discoverLanguageColumnsWithSource(const QString &root, const QStringList &extensions, const QString &typeAlias, QString &definedIn)
+    {
+        return discoverColumns(root, extensions, typeAlias, definedIn, nullptr);
     }
 
 bool writeCsv(const QString &outputPath,
               const QList<ExtractedBlock> &rows,
               const QStringList &langColumns,
               const QStringList &literalColumns,
-              bool replaceAsciiCommaWithCn)
+              bool replaceAsciiCommaWithCn,
+              int shardRows)
 {
-        // 将抽取结果写为 CSV；支持缺失填充、逗号替换，以及大文件分片写出
-        // 步骤1：判定某语言列是否为“直写列”（literal）
-        auto isLiteralCol = [&](const QString &name) -> bool {
-            QString n = name;
-            QStringList cands;
-            cands << n;
-            if (n.startsWith(QLatin1String("text_")))
-                cands << n.mid(5);
-            else
-                cands << (QStringLiteral("text_") + n);
-            for (const QString &c : cands)
-                if (literalColumns.contains(c))
-                    return true;
-            return false;
-        };
-        // 步骤2：按范围写出一个片段，保持 UTF-8 与 BOM
-        auto writeChunk = [&](const QString &path, int startIdx, int endIdx) -> bool {
-            QFile f(path);
-            if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate))
-                return false;
-            f.write("\xEF\xBB\xBF");
-            QTextStream ts(&f);
-            ts.setCodec("UTF-8");
-            QStringList headers;
-            headers << QStringLiteral("source_file") << QStringLiteral("line_number") << QStringLiteral("variable_name") << langColumns;
-            ts << headers.join(QLatin1Char(',')) << QStringLiteral("\n");
-
-            // 步骤3：定位英文/中文列索引以用于缺失填充
-            auto findEnglishIndex = [&]() -> int {
-                for (int i = 0; i < langColumns.size(); ++i)
-                {
-                    const QString c = langColumns[i].toLower();
-                    if (c == QLatin1String("text_en") || c == QLatin1String("en") || c.endsWith(QLatin1String("_en")) || c.contains(QLatin1String("english")))
-                        return i;
-                }
-                return -1;
-            };
-            auto findChineseIndex = [&]() -> int {
-                for (int i = 0; i < langColumns.size(); ++i)
-                {
-                    const QString c = langColumns[i].toLower();
-                    if (c == QLatin1String("text_cn") || c == QLatin1String("cn") || c.endsWith(QLatin1String("_cn")) || c.endsWith(QLatin1String("_zh")) || c.endsWith(QLatin1String("_chs")) || c.endsWith(QLatin1String("_hans")))
-                        return i;
-                }
-                return -1;
-            };
-            const int idxEn = findEnglishIndex();
-            const int idxCn = findChineseIndex();
-
-            // 步骤4：逐行写出，空值按英文/中文回退填充，必要时替换逗号
-            for (int ri = startIdx; ri < endIdx; ++ri)
-            {
-                const auto &r = rows.at(ri);
-                QStringList cols;
-                cols << csvEscape(r.sourceFile) << csvEscape(QString::number(r.lineNumber)) << csvEscape(r.variableName);
-                for (int i = 0; i < langColumns.size(); ++i)
-                {
-                    QString v = (i < r.strings.size()) ? r.strings[i] : QString();
-                    if (v.isEmpty())
-                    {
-                        QString fill;
-                        if (idxEn >= 0 && idxEn < r.strings.size())
-                            fill = r.strings[idxEn];
-                        if (fill.isEmpty() && idxCn >= 0 && idxCn < r.strings.size())
-                            fill = r.strings[idxCn];
-                        if (fill.isEmpty())
-                        {
-                            for (const QString &s : r.strings)
-                            {
-                                if (!s.isEmpty()) { fill = s; break; }
-                            }
-                        }
-                        v = fill;
-                    }
-                    if (replaceAsciiCommaWithCn && !v.isEmpty())
-                    {
-                        v.replace(QLatin1Char(','), QChar(0xFF0C));
-                    }
-                    cols << csvEscape(v);
-                }
-                ts << cols.join(QLatin1Char(',')) << QStringLiteral("\n");
-            }
-            f.close();
-            return true;
-        };
+    // 委托流式写出器：UTF-8 直接编码进复用缓冲；分片由 shardRows 显式控制
+    Csv::WriteOptions opts;
+    opts.langColumns = langColumns;
+    opts.literalColumns = literalColumns;
+    opts.replaceAsciiCommaWithCn = replaceAsciiCommaWithCn;
+    opts.shardRows = shardRows;
+    Csv::StreamWriter writer(outputPath, opts);
+    if (!writer.open())
+        return false;
+    PerfStats::Timer timer("csv_write");
+    timer.addItems(rows.size());
+    writer.write(rows);
+    return writer.close();
+}
 
-        // 步骤5：对于超大数据集进行分片写出以减少单文件大小
-        if (rows.size() > 5000)
+    /**
+     * 生成文件的流式写出器：沿用目标文件已有的编码、UTF-8 BOM 与换行风格（CRLF/LF），
+     * 经 QSaveFile 写出，提交前原文件保持不变；未打开文件时写入内存字符串（buffer 为空则丢弃）。
+     * line() 以换行分隔各行，输出与 QStringList::join('\n') 一致。
+     */
+    class GeneratedTextWriter
+    {
+    public:
+        explicit GeneratedTextWriter(QString *buffer = nullptr)
         {
-            int chunkSize = 2000;
-            int parts = (rows.size() + chunkSize - 1) / chunkSize;
-            QFileInfo fi(outputPath);
-            QString dir = fi.dir().absolutePath();
-            QString base = fi.completeBaseName();
-            bool allOk = true;
-            for (int p = 0; p < parts; ++p)
+            if (buffer)
             {
-                int startIdx = p * chunkSize;
-                int endIdx = qMin(rows.size(), (p + 1) * chunkSize);
-                QString partName = QStringLiteral("%1_part%2.csv").arg(base).arg(p + 1, 2, 10, QLatin1Char('0'));
-                QString outPath = QDir(dir).absoluteFilePath(partName);
-                allOk = allOk && writeChunk(outPath, startIdx, endIdx);
+                m_ts.setString(buffer);
+                m_active = true;
             }
-            return allOk;
         }
-        else
-        {
-            return writeChunk(outputPath, 0, rows.size());
-        }
-    }
 
-    static QStringList parseCsvLine(const QString &line)
-    {
-        QStringList out;
-        QString cur;
-        bool inq = false;
-        for (int i = 0; i < line.size(); ++i)
+        bool open(const QString &path, const QString &fallbackCodec = QStringLiteral("UTF-8"))
         {
-            QChar c = line[i];
-            if (inq)
+            QString codec;
+            bool utf8Bom = false;
+            QFile rf(path);
+            if (rf.open(QIODevice::ReadOnly))
             {
-                if (c == QLatin1Char('"'))
-                {
-                    if (i + 1 < line.size() && line[i + 1] == QLatin1Char('"'))
-                    {
-                        cur.append(QLatin1Char('"'));
-                        i++;
-                    }
-                    else
-                    {
-                        inq = false;
-                    }
-                }
-                else
+                // 旧文件只读头部判定编码与换行；截到最后一个换行，避免切断多字节序列
+                QByteArray head = rf.read(64 * 1024);
+                if (!rf.atEnd())
                 {
-                    cur.append(c);
+                    const int nl = head.lastIndexOf('\n');
+                    if (nl > 0)
+                        head.truncate(nl + 1);
                 }
+                const TextCodec::Detection d = TextCodec::detect(head);
+                codec = d.codec;
+                utf8Bom = d.utf8Bom;
+                m_crlf = head.indexOf('\r') >= 0;
             }
             else
             {
-                if (c == QLatin1Char('"'))
-                {
-                    inq = true;
-                }
-                else if (c == QLatin1Char(','))
-                {
-                    out << cur;
-                    cur.clear();
-                }
-                else
-                {
-                    cur.append(c);
-                }
+#ifdef Q_OS_WIN
+                m_crlf = true;
+#else
+                m_crlf = false;
+#endif
             }
-        }
-        out << cur;
-        return out;
-    }
-
-    static bool detectFileCodec(const QString &path, QString &codecName, bool &utf8Bom)
-    {
-        codecName.clear();
-        utf8Bom = false;
-        QFile f(path);
-        if (!f.exists())
-            return false;
-        if (!f.open(QIODevice::ReadOnly))
-            return false;
-        QByteArray data = f.readAll();
-        f.close();
-
-        if (data.startsWith("\xEF\xBB\xBF"))
-        {
-            utf8Bom = true;
-            codecName = QStringLiteral("UTF-8");
-            return true;
-        }
-        if (data.startsWith("\xFF\xFE"))
-        {
-            codecName = QStringLiteral("UTF-16LE");
-            return true;
-        }
-        if (data.startsWith("\xFE\xFF"))
-        {
-            codecName = QStringLiteral("UTF-16BE");
+            m_file.setFileName(path);
+            if (!m_file.open(QIODevice::WriteOnly))
+                return false;
+            m_ts.setDevice(&m_file);
+            const QString useCodec = codec.isEmpty() ? fallbackCodec : codec;
+            m_ts.setCodec(useCodec.toUtf8().constData());
+            // 仅在原文件为 UTF-8 BOM 且当前编码为 UTF-8 时保留 BOM
+            if (utf8Bom && useCodec.compare(QLatin1String("UTF-8"), Qt::CaseInsensitive) == 0)
+                m_ts << QChar(0xFEFF);
+            m_toFile = true;
+            m_active = true;
             return true;
         }
 
-        auto countReplacement = [](const QString &s) {
-            int cnt = 0;
-            for (QChar ch : s)
-                if (ch.unicode() == 0xFFFD)
-                    cnt++;
-            return cnt;
-        };
-        auto decodeWith = [&](const char *name) -> QString {
-            QTextCodec *c = QTextCodec::codecForName(name);
-            return c ? c->toUnicode(data) : QString();
-        };
-
-        struct Candidate { const char *name; QString text; int rep; };
-        Candidate cands[] = {
-            {"UTF-8", decodeWith("UTF-8"), 0},
-            {"GB18030", decodeWith("GB18030"), 0},
-            {"GBK", decodeWith("GBK"), 0},
-            {"GB2312", decodeWith("GB2312"), 0},
-            {"CP936", decodeWith("CP936"), 0},
-        };
-        for (auto &c : cands)
-            c.rep = countReplacement(c.text);
-
-        const char *best = cands[0].name;
-        int minRep = cands[0].rep;
-        for (int i = 1; i < int(sizeof(cands)/sizeof(cands[0])); ++i)
+        void line(const QString &s)
         {
-            if (cands[i].rep < minRep)
+            if (!m_active)
+                return;
+            if (m_started)
+                m_ts << (m_crlf ? QLatin1String("\r\n") : QLatin1String("\n"));
+            m_started = true;
+            if (m_toFile && s.contains(QLatin1Char('\n')))
             {
-                minRep = cands[i].rep;
-                best = cands[i].name;
+                // 值内换行同样规范为目标风格
+                QString t = s;
+                t.replace(QStringLiteral("\r\n"), QStringLiteral("\n"));
+                if (m_crlf)
+                    t.replace(QLatin1Char('\n'), QStringLiteral("\r\n"));
+                m_ts << t;
+                return;
             }
+            m_ts << s;
         }
-        codecName = QString::fromLatin1(best);
-        return true;
-    }
-
-    static bool writeTextPreserveCodec(const QString &path, const QString &text, const QString &fallbackCodec = QStringLiteral("UTF-8"))
-    {
-        QString codec;
-        bool utf8Bom = false;
-        detectFileCodec(path, codec, utf8Bom);
 
-        // 行尾风格检测：优先沿用现有文件的 CRLF/LF
-        bool preferCRLF = false;
-        if (QFile::exists(path))
-        {
-            QFile rf(path);
-            if (rf.open(QIODevice::ReadOnly))
-            {
-                QByteArray existing = rf.readAll();
-                rf.close();
-                preferCRLF = existing.contains("\r\n") || existing.indexOf('\r') >= 0;
-            }
-        }
-        else
+        bool commit()
         {
-#ifdef Q_OS_WIN
-            preferCRLF = true;
-#else
-            preferCRLF = false;
-#endif
+            if (!m_active)
+                return true;
+            m_ts.flush();
+            return m_toFile ? m_file.commit() : true;
         }
 
-        // 规范化行尾：先归一为 LF，再按目标风格输出
-        QString normalized = text;
-        normalized.replace(QStringLiteral("\r\n"), QStringLiteral("\n"));
-        if (preferCRLF)
-            normalized.replace(QLatin1Char('\n'), QStringLiteral("\r\n"));
-
-        QFile f(path);
-        if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate))
-            return false;
+        QString errorString() const { return m_file.errorString(); }
 
-        QTextStream ts(&f);
-        const QString useCodec = codec.isEmpty() ? fallbackCodec : codec;
-        ts.setCodec(useCodec.toUtf8().constData());
-        // 仅在原文件为 UTF-8 BOM 且当前编码为 UTF-8 时保留 BOM
-        if (utf8Bom && useCodec.compare(QLatin1String("UTF-8"), Qt::CaseInsensitive) == 0)
-            ts << QChar(0xFEFF);
-        ts << normalized;
-        f.close();
-        return true;
-    }
+    private:
+        QSaveFile m_file;
+        QTextStream m_ts;
+        bool m_active{false};
+        bool m_toFile{false};
+        bool m_crlf{false};
+        bool m_started{false};
+    };
 
 QString generateCFromCsv(const QString &csvPath,
                              const QString &typeName,
@@ -1227,34 +923,40 @@ QString generateCFromCsv(const QString &csvPath,
                              const QString &annotateMode,
                              int perLine,
                              const QMap<QString, QPair<QString, QString>> &sourceMap,
-                             const QString &sourceRoot)
+                             const QString &sourceRoot,
+                             const QString &poolMode,
+                             const QString &catalogPath,
+                             const QString &schemaPath,
+                             GenerateStats *stats)
 {
     Q_UNUSED(useUtf8Literal);
     Q_UNUSED(perLine);
+    GenerateStats localStats;
+    GenerateStats &st = stats ? *stats : localStats;
+    st = GenerateStats();
     // 生成流程总览：
-    // 步骤1：读取 CSV（自动编码/BOM），拆分行并解析表头
-    // 步骤2：识别语言列并建立输出语言顺序（以结构体字段为准）
+    // 步骤1：流式读取 CSV（内存映射，自动编码/BOM），解析表头
+    // 步骤2：确定结构体语言顺序（模式文件 → 布局缓存 → 扫描项目）
     // 步骤3：构建语言列索引映射（text_xx 与 xx 均可匹配）
     // 步骤4：准备格式化策略（UTF-8直写、十六进制、原样）
-    // 步骤5：准备 CSV 转义解码器（将 \\xNN 等转为字节）
-    // 步骤6：遍历数据行，写溯源注释、处理重名变量
+    // 步骤5：准备 CSV 转义解码器（将 \\xNN 等转为字节）；字符串池模式下先预读一遍登记全部取值并布局
+    // 步骤6：逐条读取数据行，写溯源注释、处理重名变量
     // 步骤7：按语言顺序取值，必要时用英文列填充缺失
     // 步骤8：根据“直写列/原样/默认”三种策略输出每个值
     // 步骤9：为每个值输出序号或名称注释，统一风格
     // 步骤10：末尾添加 NULL 哨兵行
     // 步骤11：可选生成注册表数组以便集中引用
-    // 步骤12：写入 .c/.h，保留原文件编码与 BOM、换行风格
-    // 使用与源码一致的自动编码读取，确保非 UTF-8 CSV 的中文也准确
-    // 步骤1：读取文本并按换行拆分
-    QString content = readTextFile(csvPath);
-    if (content.isEmpty())
+    // 步骤12：逐行写入 .c/.h，保留原文件编码与 BOM、换行风格，全部写完后一次提交
+    // 步骤1：打开 CSV 并读取表头（MappedReader 已去除 BOM 与行尾 \r）
+    Csv::MappedReader reader(csvPath);
+    if (!reader.open() || !reader.next())
+    {
+        st.error = reader.hasError() ? reader.errorString() : QStringLiteral("CSV 为空: %1").arg(csvPath);
         return QString();
-    QStringList allLines = content.split(QLatin1Char('\n'));
-    int lineIdx = 0;
-    QString headerLine = (lineIdx < allLines.size()) ? allLines.at(lineIdx++) : QString();
-    if (!headerLine.isEmpty() && headerLine[0].unicode() == 0xFEFF)
-        headerLine.remove(0, 1);
-    QStringList headers = parseCsvLine(headerLine);
+    }
+    QStringList headers;
+    for (int i = 0; i < reader.fieldCount(); ++i)
+        headers << reader.field(i);
         int idxSource = headers.indexOf(QStringLiteral("source_file"));
         int idxLine = headers.indexOf(QStringLiteral("line_number"));
         int idxVar = headers.indexOf(QStringLiteral("variable_name"));
@@ -1270,8 +972,19 @@ QString generateCFromCsv(const QString &csvPath,
         }
         // 项目结构体语言顺序（以 _Tr_TEXT 的字段顺序为准），自动移除 text_other 哨兵
         QString rootDir = QFileInfo(csvPath).dir().absolutePath();
-        // 步骤2：扫描项目源码推断结构体语言字段顺序
-        QStringList structLangs = discoverLanguageColumns(rootDir, QStringList{QLatin1String(".h"), QLatin1String(".hpp"), QLatin1String(".c"), QLatin1String(".cpp")}, typeName);
+        // 步骤2：未显式给出模式文件时采用 CSV 同目录的 tr_text.schema.json，否则查布局缓存，仍未命中才扫描项目
+        QString schema = schemaPath;
+        if (schema.isEmpty() && QFileInfo::exists(StructLayout::defaultSchemaPath(rootDir)))
+            schema = StructLayout::defaultSchemaPath(rootDir);
+        QString layoutError;
+        QStringList structLangs = StructLayout::resolve(rootDir, QStringList{QLatin1String(".h"), QLatin1String(".hpp"), QLatin1String(".c"), QLatin1String(".cpp")},
+                                                        typeName, schema, &st.layoutOrigin, &layoutError);
+        if (!layoutError.isEmpty())
+        {
+            st.error = layoutError;
+            return QString();
+        }
+        st.columns = structLangs;
         QStringList outLangHeaders = structLangs; // 输出按结构体顺序
         // CSV 头到索引的映射（支持 text_xx 与 xx 互相匹配）
         auto indexForLang = [&](const QString &lang)
@@ -1314,95 +1027,153 @@ QString generateCFromCsv(const QString &csvPath,
         auto fmtVerb = [&](const QString &s)
         { QString e = s; e.replace(QLatin1Char('"'), QLatin1String("\\\"")); return QStringLiteral("\"") + e + QStringLiteral("\""); };
 
-        // 步骤5：解码 CSV 内的 \\xNN 等转义，便于统一输出
-        auto decodeCsvEscapes = [&](const QString &s)
+        // 步骤5：解码 CSV 内的 \\xNN 等转义，便于统一输出（CSV 规则：仅 \\xHH 与常用单字符转义，字节按 UTF-8 解码）
+        auto decodeCsvEscapes = [](const QString &s)
+        {
+            QString out;
+            out.reserve(s.size());
+            LiteralDecoder dec(out, false, utf8Codec(), CEscape::Rules::CsvCell);
+            dec.feedBody(QStringRef(&s));
+            dec.finish();
+            return out;
+        };
+
+        // 步骤7/8：取第 k 个输出语言的值（必要时用英文列填充）；
+        // asLiteral 为 true 表示返回 C 字面量原文（全局原样，或直写列且原文已是 \xNN 形式），否则为已解码文本（UTF-8 直写）
+        auto cellValue = [&](const QStringList &cols, int k, bool &asLiteral)
         {
-            QByteArray bytes;
-            const QString raw = s;
-            for (int i = 0; i < raw.size(); ++i)
+            int csvIdx = indexForLang(outLangHeaders[k]);
+            int csvCol = (csvIdx >= 0 && csvIdx < csvLangIdx.size()) ? csvLangIdx[csvIdx] : -1;
+            QString v = (csvCol >= 0 && csvCol < cols.size()) ? cols[csvCol] : QString();
+            QString raw = v;
+            QString v2 = v;
+            if (!verbatim && v.contains(QStringLiteral("\\x")))
+                v2 = decodeCsvEscapes(v);
+            // 如果启用填充，且当前值为空或为NULL，则用英文列值填充
+            if (fillMissingWithEnglish && (v2.isEmpty() || raw.compare(QStringLiteral("NULL"), Qt::CaseInsensitive) == 0))
             {
-                QChar c = raw[i];
-                if (c == QLatin1Char('\\') && i + 1 < raw.size())
+                if (enHeaderIdx >= 0)
                 {
-                    QChar n = raw[i + 1];
-                    if (n == QLatin1Char('x'))
-                    {
-                        if (i + 3 < raw.size())
-                        {
-                            QChar h1 = raw[i + 2];
-                            QChar h2 = raw[i + 3];
-                            QString hex = QString(h1) + QString(h2);
-                            bool ok = false;
-                            int val = hex.toInt(&ok, 16);
-                            if (ok)
-                            {
-                                bytes.append(char(val));
-                                i += 3;
-                                continue;
-                            }
-                        }
-                    }
-                    else if (n == QLatin1Char('n'))
-                    {
-                        bytes.append('\n');
-                        i++;
-                        continue;
-                    }
-                    else if (n == QLatin1Char('r'))
-                    {
-                        bytes.append('\r');
-                        i++;
-                        continue;
-                    }
-                    else if (n == 't')
-                    {
-                        bytes.append('\t');
-                        i++;
-                        continue;
-                    }
-                    else if (n == '\\')
-                    {
-                        bytes.append('\\');
-                        i++;
-                        continue;
-                    }
-                    else if (n == '"')
-                    {
-                        bytes.append('"');
-                        i++;
+                    // 注意：enHeaderIdx 是 CSV 头列表中的索引（相对于 csvLangHeaders），需转换到整行列索引
+                    int encsvCol = csvLangIdx.value(enHeaderIdx, -1);
+                    QString env = (encsvCol >= 0 && encsvCol < cols.size()) ? cols[encsvCol] : QString();
+                    QString env2 = (!verbatim && env.contains(QStringLiteral("\\x"))) ? decodeCsvEscapes(env) : env;
+                    if (!env2.isEmpty())
+                        v2 = env2;
+                }
+            }
+            if (verbatim)
+            {
+                // 全局“保留原样”：不改变表示，直接输出原文本
+                asLiteral = true;
+                return raw;
+            }
+            if (literalColumns.contains(outLangHeaders.value(k)) && raw.contains(QStringLiteral("\\x")))
+            {
+                // “直写列”：如果原文本已经是 \xNN 形式，按原样输出；否则用UTF-8直写
+                asLiteral = true;
+                return raw;
+            }
+            // 默认：统一输出为 UTF-8 字面字符串
+            asLiteral = false;
+            return v2;
+        };
+
+        // 字符串池模式（dedup / suffix）：第一遍登记全部取值并布局，第二遍生成时引用偏移
+        const bool pooled = poolMode == QLatin1String("dedup") || poolMode == QLatin1String("suffix");
+        const QString poolName = QStringLiteral("s_tr_pool");
+        StringPool::Builder pool(outLangHeaders);
+        if (pooled)
+        {
+            Csv::MappedReader scan(csvPath);
+            QStringList cols;
+            if (scan.open() && scan.next())
+            {
+                while (scan.next())
+                {
+                    if (scan.isBlank())
                         continue;
-                    }
-                    else if (n == '\'')
+                    cols.clear();
+                    for (int i = 0; i < scan.fieldCount(); ++i)
+                        cols << scan.field(i);
+                    for (int k = 0; k < outLangHeaders.size(); ++k)
                     {
-                        bytes.append('\'');
-                        i++;
-                        continue;
+                        bool asLiteral = false;
+                        const QString t = cellValue(cols, k, asLiteral);
+                        pool.add(asLiteral ? StringPool::decodeCEscapes(t) : t.toUtf8(), k);
                     }
                 }
-                bytes.append(QString(c).toUtf8());
             }
-            return QString::fromUtf8(bytes);
-        };
+            if (scan.hasError())
+            {
+                st.error = scan.errorString();
+                return QString();
+            }
+            pool.build(poolMode == QLatin1String("suffix"));
+            st.pool = pool.stats();
+            st.poolBytes = pool.size();
+            st.poolMerged = pool.mergedCount();
+        }
 
-    QStringList lines;
-    lines << QStringLiteral("/* Generated from CSV by DirModeEx */")
-              << QStringLiteral("#include \"include/tr_text.h\"")
-              << QStringLiteral("#include <stddef.h>")
-              << QString();
-    QStringList decls;
+    // 步骤12：先打开输出（QSaveFile），逐行写出，全部成功后再提交
+    QString code;
+    // 仅输出目录时不在内存中累积代码
+    GeneratedTextWriter cw(cOutputPath.isEmpty() && catalogPath.isEmpty() ? &code : nullptr);
+    if (!cOutputPath.isEmpty() && !cw.open(cOutputPath))
+    {
+        st.error = QStringLiteral("无法写入: %1（%2）").arg(cOutputPath, cw.errorString());
+        return QString();
+    }
+    GeneratedTextWriter hw;
+    if (!headerOutputPath.isEmpty() && !hw.open(headerOutputPath))
+    {
+        st.error = QStringLiteral("无法写入: %1（%2）").arg(headerOutputPath, hw.errorString());
+        return QString();
+    }
+    cw.line(QStringLiteral("/* Generated from CSV by DirModeEx */"));
+    cw.line(QStringLiteral("#include \"include/tr_text.h\""));
+    cw.line(QStringLiteral("#include <stddef.h>"));
+    cw.line(QString());
+    if (pooled && !pool.entries().isEmpty())
+    {
+        // 池头注释：各语言原始字节 → 入池字节
+        qint64 naive = 0;
+        for (const StringPool::GroupStats &g : pool.stats())
+            naive += g.naiveBytes;
+        cw.line(QStringLiteral("/* String pool: %1 bytes, %2 without pooling (saved %3; %4 suffix-merged)").arg(pool.size()).arg(naive).arg(naive - pool.size()).arg(pool.mergedCount()));
+        for (const StringPool::GroupStats &g : pool.stats())
+            cw.line(QStringLiteral(" *   %1: %2 strings, %3 -> %4 bytes (saved %5)").arg(g.name).arg(g.strings).arg(g.naiveBytes).arg(g.pooledBytes).arg(g.savedBytes()));
+        cw.line(QStringLiteral(" */"));
+        cw.line(QStringLiteral("static const char %1[] =").arg(poolName));
+        for (const StringPool::Entry &e : pool.entries())
+            cw.line(QStringLiteral("    /* %1 */ \"").arg(e.offset) + StringPool::escapeBytes(e.bytes) + QStringLiteral("\\0\""));
+        cw.line(QStringLiteral("    ;"));
+        cw.line(QString());
+    }
+    hw.line(QStringLiteral("/* Declarations generated by DirModeEx */"));
+    hw.line(QStringLiteral("#pragma once"));
+    hw.line(QStringLiteral("#include \"include/tr_text.h\""));
+    hw.line(QString());
+    // 注册表只需保留变量名
     QStringList regs;
     // 记录已使用的变量名，避免集中生成时发生重定义
     QSet<QString> usedVarNames;
-    // 步骤6：逐行处理 CSV 数据并生成结构体初始化
-    while (lineIdx < allLines.size())
+    QStringList cols;
+    QStringList vals;
+    // 可选二进制目录：与 C 表同源，逐行收集，末尾统一排序写出
+    std::unique_ptr<TrCatalog::Writer> catalog;
+    if (!catalogPath.isEmpty())
+        catalog.reset(new TrCatalog::Writer(outLangHeaders));
+    QVector<QByteArray> catValues;
+    // 步骤6：逐条读取 CSV 数据行并生成结构体初始化（引号内允许跨行）
+    while (reader.next())
     {
-        QString line = allLines.at(lineIdx++);
-        if (!line.isEmpty() && line.endsWith(QLatin1Char('\r')))
-            line.chop(1);
-        if (line.isEmpty())
+        if (reader.isBlank())
             continue;
-        QStringList cols = parseCsvLine(line);
-            QString var = (idxVar >= 0 && idxVar < cols.size()) ? cols[idxVar] : QStringLiteral("var_%1").arg(regs.size());
+        cols.clear();
+        for (int i = 0; i < reader.fieldCount(); ++i)
+            cols << reader.field(i);
+            QString var = (idxVar >= 0 && idxVar < cols.size()) ? cols[idxVar] : QStringLiteral("var_%1").arg(st.rows);
             QString src = (idxSource >= 0 && idxSource < cols.size()) ? cols[idxSource] : QString();
             QString ln = (idxLine >= 0 && idxLine < cols.size()) ? cols[idxLine] : QString();
             if ((src.isEmpty() || ln.isEmpty()) && sourceMap.contains(var))
@@ -1419,7 +1190,7 @@ QString generateCFromCsv(const QString &csvPath,
                 src = QDir(sourceRoot).absoluteFilePath(rel);
             }
             if (!src.isEmpty() || !ln.isEmpty())
-                lines << QStringLiteral("/* source: %1 line: %2 */").arg(src, ln);
+                cw.line(QStringLiteral("/* source: %1 line: %2 */").arg(src, ln));
             // 生成阶段去重：若发现同名变量冲突，基于行号或递增后缀调整为唯一名
             // 步骤7：变量名去重——基于行号或递增后缀生成唯一名
             QString emitVar = var;
@@ -1446,49 +1217,31 @@ QString generateCFromCsv(const QString &csvPath,
             }
             usedVarNames.insert(emitVar);
             QString storage = noStatic ? QString() : QStringLiteral("static ");
-            lines << QStringLiteral("%1const %2 %3 = {").arg(storage, typeName, emitVar);
-            QStringList vals;
+            cw.line(QStringLiteral("%1const %2 %3 = {").arg(storage, typeName, emitVar));
+            vals.clear();
+            catValues.clear();
             for (int k = 0; k < outLangHeaders.size(); ++k)
             {
-                int csvIdx = indexForLang(outLangHeaders[k]);
-                int csvCol = (csvIdx >= 0 && csvIdx < csvLangIdx.size()) ? csvLangIdx[csvIdx] : -1;
-                QString v = (csvCol >= 0 && csvCol < cols.size()) ? cols[csvCol] : QString();
-                QString raw = v;
-                QString v2 = v;
-                if (!verbatim && v.contains(QStringLiteral("\\x")))
-                    v2 = decodeCsvEscapes(v);
-                // 如果启用填充，且当前值为空或为NULL，则用英文列值填充
-                if (fillMissingWithEnglish && (v2.isEmpty() || raw.compare(QStringLiteral("NULL"), Qt::CaseInsensitive) == 0))
-                {
-                    if (enHeaderIdx >= 0)
-                    {
-                        // 注意：enHeaderIdx 是 CSV 头列表中的索引（相对于 csvLangHeaders），需转换到整行列索引
-                        int encsvCol = csvLangIdx.value(enHeaderIdx, -1);
-                        QString env = (encsvCol >= 0 && encsvCol < cols.size()) ? cols[encsvCol] : QString();
-                        QString env2 = (!verbatim && env.contains(QStringLiteral("\\x"))) ? decodeCsvEscapes(env) : env;
-                        if (!env2.isEmpty())
-                            v2 = env2;
-                    }
-                }
-                if (verbatim)
-                {
-                    // 全局“保留原样”：不改变表示，直接输出原文本
-                    vals << fmtVerb(raw);
-                }
-                else if (literalColumns.contains(outLangHeaders.value(k)))
+                bool asLiteral = false;
+                const QString t = cellValue(cols, k, asLiteral);
+                QByteArray bytes;
+                if (pooled || catalog)
+                    bytes = asLiteral ? StringPool::decodeCEscapes(t) : t.toUtf8();
+                if (catalog)
+                    catValues.append(bytes);
+                if (pooled)
                 {
-                    // “直写列”：如果原文本已经是 \xNN 形式，按原样输出；否则用UTF-8直写
-                    if (raw.contains(QStringLiteral("\\x")))
-                        vals << fmtVerb(raw);
-                    else
-                        vals << fmtUtf8(v2);
+                    // 字符串池：指向池内偏移
+                    vals << QStringLiteral("%1 + %2").arg(poolName).arg(pool.offset(bytes));
                 }
                 else
                 {
-                    // 默认：统一输出为 UTF-8 字面字符串
-                    vals << fmtUtf8(v2);
+                    vals << (asLiteral ? fmtVerb(t) : fmtUtf8(t));
                 }
             }
+            // 目录以生成的变量名（去重后）为键，与 C 表一一对应
+            if (catalog)
+                catalog->add(emitVar, catValues);
             // 生成格式：一种语言一行，每行前带索引或名称注释
             // 步骤9：为每个语言值生成注释（序号或名称）与行
             int langCount = vals.size();
@@ -1496,73 +1249,81 @@ QString generateCFromCsv(const QString &csvPath,
             {
                 if (annotateMode == QStringLiteral("indices"))
                 {
-                    lines << QStringLiteral("    // [%1]").arg(i + 1);
+                    cw.line(QStringLiteral("    // [%1]").arg(i + 1));
                 }
                 else if (annotateMode == QStringLiteral("names"))
                 {
                     QString name = (i < outLangHeaders.size()) ? outLangHeaders[i] : QString();
                     if (!name.isEmpty())
-                        lines << QStringLiteral("    // [%1] %2").arg(i + 1).arg(name);
+                        cw.line(QStringLiteral("    // [%1] %2").arg(i + 1).arg(name));
                     else
-                        lines << QStringLiteral("    // [%1]").arg(i + 1);
+                        cw.line(QStringLiteral("    // [%1]").arg(i + 1));
                 }
-                lines << QStringLiteral("    %1,").arg(vals[i]);
+                cw.line(QStringLiteral("    %1,").arg(vals[i]));
             }
             // 末尾NULL哨兵：单独一行注释 + 值（强制添加）
             // 步骤10：末尾追加 NULL 哨兵一行
             int sentinelIndex = langCount + 1;
             if (annotateMode == QStringLiteral("indices"))
             {
-                lines << QStringLiteral("    // [%1]").arg(sentinelIndex);
+                cw.line(QStringLiteral("    // [%1]").arg(sentinelIndex));
             }
             else if (annotateMode == QStringLiteral("names"))
             {
-                lines << QStringLiteral("    // [%1] %2").arg(sentinelIndex).arg(QStringLiteral("NULL"));
+                cw.line(QStringLiteral("    // [%1] %2").arg(sentinelIndex).arg(QStringLiteral("NULL")));
             }
-            lines << QStringLiteral("    %1,").arg(QStringLiteral("NULL"));
-            // 去掉最后一行的逗号
-            if (!vals.isEmpty())
-            {
-                QString last = lines.takeLast();
-                lines << last.left(last.size() - 1);
-            }
-            lines << QStringLiteral("};") << QString();
-            decls << QStringLiteral("extern const %1 %2;").arg(typeName, emitVar);
-            regs << emitVar;
+            // 哨兵为最后一项：有值时不带逗号
+            cw.line(vals.isEmpty() ? QStringLiteral("    NULL,") : QStringLiteral("    NULL"));
+            cw.line(QStringLiteral("};"));
+            cw.line(QString());
+            hw.line(QStringLiteral("extern const %1 %2;").arg(typeName, emitVar));
+            if (registryEmit)
+                regs << emitVar;
+            ++st.rows;
+        }
+        if (reader.hasError())
+        {
+            // 未提交的 QSaveFile 随析构丢弃，原输出文件保持不变
+            st.error = reader.errorString();
+            return QString();
         }
         // 步骤11：可选注册表数组输出
         if (registryEmit && !registryArrayName.isEmpty())
         {
-            lines << QStringLiteral("const %1* %2[] = {").arg(typeName, registryArrayName);
+            cw.line(QStringLiteral("const %1* %2[] = {").arg(typeName, registryArrayName));
             int perReg = 6;
             for (int k = 0; k < regs.size(); k += perReg)
             {
-                QString chunk;
                 QStringList row;
                 for (int j = k; j < qMin(k + perReg, regs.size()); ++j)
                     row << (QStringLiteral("&") + regs[j]);
-                chunk = row.join(QLatin1String(", "));
-                lines << QStringLiteral("    %1,").arg(chunk);
+                // 最后一组不带逗号
+                cw.line(QStringLiteral("    ") + row.join(QLatin1String(", ")) + (k + perReg < regs.size() ? QStringLiteral(",") : QString()));
             }
-            if (!regs.isEmpty())
+            cw.line(QStringLiteral("};"));
+            cw.line(QString());
+        }
+        hw.line(QString());
+        // 目录先于源码提交：目录写出失败时 .c/.h 保持原样
+        if (catalog)
+        {
+            QString err;
+            if (!catalog->write(catalogPath, err))
             {
-                QString last = lines.takeLast();
-                lines << last.left(last.size() - 1);
+                st.error = err;
+                return QString();
             }
-            lines << QStringLiteral("};") << QString();
+            st.catalogBytes = catalog->writtenBytes();
         }
-        QString code = lines.join(QLatin1Char('\n'));
-        // 步骤12：写出 .c/.h，保持原文件编码与 BOM
-        if (!cOutputPath.isEmpty())
+        if (!cw.commit())
         {
-            writeTextPreserveCodec(cOutputPath, code);
+            st.error = QStringLiteral("无法写入: %1（%2）").arg(cOutputPath, cw.errorString());
+            return QString();
         }
-        if (!headerOutputPath.isEmpty())
+        if (!hw.commit())
         {
-            QString headerText = QStringLiteral("/* Declarations generated by DirModeEx */\n#pragma once\n#include \"include/tr_text.h\"\n\n");
-            for (const auto &d : decls)
-                headerText += d + QStringLiteral("\n");
-            writeTextPreserveCodec(headerOutputPath, headerText);
+            st.error = QStringLiteral("无法写入: %1（%2）").arg(headerOutputPath, hw.errorString());
+            return QString();
         }
         return code;
     }
@@ -1608,112 +1369,62 @@ namespace TextExtractor
         return out;
     }
 
-    static bool findNthBraceBlock(const QString &body, int nth, int &startContent, int &endContent)
+QList<ExtractedBlock> extractDispMessageInfoFile(const QString &path,
+                                                 const QString &mode,
+                                                 const QMap<QString, QString> &defines,
+                                                 const Preprocessor::IncludeContext *includes,
+                                                 const QByteArray *content)
+{
+    QList<ExtractedBlock> all;
+    QString text = content ? decodeText(*content) : readTextFile(path);
+    // 预处理保留行号，声明行号可直接使用
+    QString t = isEffectiveMode(mode) ? Preprocessor::run(text, path, defines, followsIncludes(mode) ? includes : nullptr) : text;
+    // 单遍词法定位 DispMessageInfo 初始化；第 1/2 个一级花括号分别为标题与信息
+    const QVector<CLexer::Token> toks = CLexer::tokenize(t);
+    const QVector<int> pairs = CLexer::matchBrackets(t, toks);
+    for (const CLexer::Initializer &d : CLexer::findInitializers(t, toks, pairs, QStringLiteral("DispMessageInfo")))
     {
-        int level = 0;
-        int count = 0;
-        bool inq = false;
-        for (int i = 0; i < body.size(); ++i)
+        if (d.isArray)
+            continue;
+        int nth = 0;
+        for (int i = d.openBrace + 1; i < d.closeBrace && nth < 2; ++i)
         {
-            QChar c = body[i];
-            if (!inq && c == QLatin1Char('"')) { inq = true; continue; }
-            if (inq)
-            {
-                if (c == QLatin1Char('"'))
-                {
-                    if (i + 1 < body.size() && body[i + 1] == QLatin1Char('"')) { ++i; }
-                    else { inq = false; }
-                }
+            if (!CLexer::isPunct(t, toks[i], '{') || pairs[i] < 0)
                 continue;
-            }
-            if (c == QLatin1Char('{'))
-            {
-                if (level == 0)
-                {
-                    ++count;
-                    if (count == nth)
-                    {
-                        startContent = i + 1;
-                        int j = i + 1; int inner = 1; bool inq2 = false;
-                        while (j < body.size())
-                        {
-                            QChar d = body[j];
-                            if (!inq2 && d == QLatin1Char('"')) { inq2 = true; ++j; continue; }
-                            if (inq2)
-                            {
-                                if (d == QLatin1Char('"'))
-                                {
-                                    if (j + 1 < body.size() && body[j + 1] == QLatin1Char('"')) { j += 2; continue; }
-                                    else { inq2 = false; ++j; continue; }
-                                }
-                                ++j; continue;
-                            }
-                            if (d == QLatin1Char('{')) { ++inner; }
-                            else if (d == QLatin1Char('}')) { --inner; if (inner == 0) { endContent = j; return true; } }
-                            ++j;
-                        }
-                        return false;
-                    }
-                }
-                ++level;
-            }
-            else if (c == QLatin1Char('}'))
+            ++nth;
+            QStringList strs;
+            for (int k = i + 1; k < pairs[i]; ++k)
             {
-                --level;
+                if (toks[k].kind == CLexer::TokenKind::String)
+                    strs << parseStringInitializer(t.mid(toks[k].start, toks[k].length));
             }
+            ExtractedBlock b;
+            b.variableName = d.variableName + (nth == 1 ? QLatin1String("._title") : QLatin1String("._info"));
+            b.sourceFile = path;
+            b.lineNumber = d.line;
+            b.strings = strs;
+            all.append(b);
+            i = pairs[i];
         }
-        return false;
     }
+    return all;
+}
 
 QList<ExtractedBlock> scanDispMessageInfo(const QString &root,
                                           const QStringList &extensions,
                                           const QString &mode,
                                           const QMap<QString, QString> &defines)
 {
-    QList<ExtractedBlock> all;
-    QDir dir(root);
-    auto matchExt = [&](const QString &fn)
-    { for (const QString &e : extensions) if (fn.toLower().endsWith(e.toLower())) return true; return false; };
-    QList<QString> stack; stack << dir.absolutePath();
-    while (!stack.isEmpty())
-    {
-        QString path = stack.takeLast();
-        QDir d(path);
-        QFileInfoList infos = d.entryInfoList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
-        for (const QFileInfo &fi : infos)
-        {
-            if (fi.isDir()) { stack << fi.absoluteFilePath(); continue; }
-            if (!matchExt(fi.fileName())) continue;
-            QString text = TextExtractor::readTextFile(fi.absoluteFilePath());
-            QString t = (mode == QLatin1String("effective")) ? TextExtractor::preprocess(text, defines) : text;
-            QRegularExpression re(QStringLiteral(R"((?:static\s+)?(?:const\s+)?DispMessageInfo\s+(\w+)\s*=\s*\{(.*?)\};)"), QRegularExpression::DotMatchesEverythingOption);
-            auto it = re.globalMatch(t);
-            while (it.hasNext())
-            {
-                auto m = it.next();
-                QString var = m.captured(1);
-                QString declText = m.captured(0);
-                int startPosOrig = text.indexOf(declText);
-                int lineAt = (startPosOrig >= 0) ? (text.left(startPosOrig).count(QLatin1Char('\n')) + 1)
-                                                : (t.left(m.capturedStart(0)).count(QLatin1Char('\n')) + 1);
-                QString body = m.captured(2);
-                int s1 = -1, e1 = -1, s2 = -1, e2 = -1;
-                if (findNthBraceBlock(body, 1, s1, e1))
-                {
-                    QString inner = body.mid(s1, e1 - s1);
-                    ExtractedBlock b1; b1.variableName = var + QLatin1String("._title"); b1.sourceFile = fi.absoluteFilePath(); b1.lineNumber = lineAt; b1.strings = parseStringInitializer(inner);
-                    all.append(b1);
-                }
-                if (findNthBraceBlock(body, 2, s2, e2))
-                {
-                    QString inner2 = body.mid(s2, e2 - s2);
-                    ExtractedBlock b2; b2.variableName = var + QLatin1String("._info"); b2.sourceFile = fi.absoluteFilePath(); b2.lineNumber = lineAt; b2.strings = parseStringInitializer(inner2);
-                    all.append(b2);
-                }
-            }
-        }
-    }
-    return all;
+    DirWalker::Scope walkScope(root);
+    const QStringList files = collectSourceFiles(root, extensions);
+    ExtractCache cache(root, QStringLiteral("disp"), mode, defines, QStringLiteral("DispMessageInfo"), false);
+    cache.load();
+    const auto includes = makeIncludeContext(root, mode, defines);
+    DispMapFn mapFn{mode, defines, &cache, includes.get()};
+    QList<ExtractedBlock> out = QtConcurrent::blockingMappedReduced<QList<ExtractedBlock>>(files, mapFn, AppendReduceFn<ExtractedBlock>(),
+                                                                                           QtConcurrent::OrderedReduce | QtConcurrent::SequentialReduce);
+    cache.save();
+    return out;
 }
 
-} // namespace TextExtractor
\ No newline at end of file
+} // namespace TextExtractor
@@ -25,6 +25,14 @@
 #include <QStringList>
 #include <QList>
 #include <QMap>
+#include <QHash>
+#include <memory>
+#include "string_pool.h"
+
+namespace Preprocessor {
+class IncludeContext;
+}
+class BlockTable;
 
 struct ExtractedBlock {
     QString variableName;
@@ -56,6 +64,8 @@ QStringList defaultLanguageColumns();
  * @return QString 读取的 Unicode 文本（Decoded Unicode text）
  */
 QString readTextFile(const QString &path);
+/** @brief 同 readTextFile，解码已读入的文件字节（Decode bytes already read, e.g. by ExtractCache） */
+QString decodeText(const QByteArray &data);
 
 // 去注释
 /**
@@ -67,13 +77,33 @@ QString stripComments(const QString &text);
 
 // 预处理 #if/#ifdef/#ifndef/#elif/#else/#endif，仅保留生效分支
 /**
- * @brief 轻量预处理条件编译，仅保留命中分支（Lightweight preprocessor for conditional compilation）
+ * @brief 预处理条件编译，仅保留命中分支（Preprocess conditional compilation）
+ * 条件按完整常量表达式求值（defined、算术、比较、逻辑运算）；文件内 #define/#undef 随扫描生效；
+ * 条件指令行与未生效行替换为空行，输出行号与原文一致。
  * @param text 源文本
- * @param defines 预定义宏与取值
+ * @param defines 预定义宏与取值（空取值视为 1）
  * @return 预处理后文本
  */
 QString preprocess(const QString &text, const QMap<QString, QString> &defines);
 
+// 解析模式
+/**
+ * @brief 是否为预处理模式：effective 或 effective_includes（Whether the mode preprocesses）
+ */
+bool isEffectiveMode(const QString &mode);
+/**
+ * @brief 是否跟随 #include 读取项目头文件中的宏：effective_includes（Whether the mode follows includes）
+ */
+bool followsIncludes(const QString &mode);
+/**
+ * @brief 为一次提取运行建立包含上下文；非 effective_includes 模式返回空指针
+ * 搜索目录为项目根目录及其下所有含头文件的目录；头文件宏状态在该上下文内按文件缓存，可跨线程共享。
+ * @param root 项目根目录
+ * @param mode 提取模式
+ * @param defines 预定义宏
+ */
+std::shared_ptr<const Preprocessor::IncludeContext> makeIncludeContext(const QString &root, const QString &mode, const QMap<QString, QString> &defines);
+
 // 从文本中提取初始化块
 /**
  * @brief 按类型名解析结构体初始化语句，提取字符串数组（Extract initializer string arrays by type name）
@@ -84,22 +114,59 @@ QString preprocess(const QString &text, const QMap<QString, QString> &defines);
  * @return ExtractedBlock 列表，含变量名/字符串/位置
  */
 QList<ExtractedBlock> extractBlocks(const QString &text, const QString &sourceFile, const QString &typeName, bool preserveEscapes);
+/**
+ * @brief 同 extractBlocks，但结果追加到块表（字符串直接解码进表的字符区）
+ * @return 本次追加的块数
+ */
+int extractBlocksInto(BlockTable &out, const QString &text, const QString &sourceFile, const QString &typeName, bool preserveEscapes);
 
 // 递归扫描目录
 /**
  * @brief 递归扫描目录并提取符合扩展名的源文件中的初始化文本块
  * @param root 项目根目录
  * @param extensions 目标扩展名列表（如 .c/.cpp）
- * @param mode 提取模式：raw 或 effective（是否预处理）
+ * @param mode 提取模式：raw、effective（预处理）或 effective_includes（预处理并跟随 #include）
  * @param defines 预处理宏
  * @param typeName 结构体类型名
  * @param preserveEscapes 是否保留转义
  * @return 提取结果集合
  */
 QList<ExtractedBlock> scanDirectory(const QString &root, const QStringList &extensions, const QString &mode, const QMap<QString, QString> &defines, const QString &typeName, bool preserveEscapes);
+/** @brief 同 scanDirectory，返回列式块表（逐文件结果与缓存命中均不经 QList 中转） */
+BlockTable scanDirectoryTable(const QString &root, const QStringList &extensions, const QString &mode, const QMap<QString, QString> &defines, const QString &typeName, bool preserveEscapes);
+
+// 收集源文件列表（供并发 map-reduce 共享）
+/**
+ * @brief 递归收集匹配扩展名的源文件（经 DirWalker：剪枝 build*、备份/沙箱/缓存目录并应用 .dirmakeignore），结果按路径排序
+ * @param root 项目根目录
+ * @param extensions 目标扩展名列表（为空时使用 .h/.hpp/.c/.cpp）
+ * @return 排序后的绝对路径列表（Sorted absolute paths, deterministic order）
+ */
+QStringList collectSourceFiles(const QString &root, const QStringList &extensions);
+
+// 单文件提取（并发 map 的工作单元）
+/**
+ * @brief 读取并提取单个源文件的初始化块；effective 模式下无结果时回退 raw 文本，结果按行号排序
+ * @param path 源文件绝对路径
+ * @param mode 提取模式：raw、effective 或 effective_includes
+ * @param defines 预处理宏
+ * @param typeName 结构体类型名
+ * @param preserveEscapes 是否保留转义
+ * @param includes 包含上下文（effective_includes 模式使用，见 makeIncludeContext；为空时不跟随包含）
+ * @param content 已读入的文件字节（缓存计算哈希时读取的同一份内容；为空时从 path 读取）
+ * @return 该文件内的提取结果（Per-file blocks ordered by line）
+ */
+QList<ExtractedBlock> extractFile(const QString &path, const QString &mode, const QMap<QString, QString> &defines, const QString &typeName, bool preserveEscapes,
+                                  const Preprocessor::IncludeContext *includes = nullptr, const QByteArray *content = nullptr);
+/** @brief 同 extractFile，返回列式块表 */
+BlockTable extractFileTable(const QString &path, const QString &mode, const QMap<QString, QString> &defines, const QString &typeName, bool preserveEscapes,
+                            const Preprocessor::IncludeContext *includes = nullptr, const QByteArray *content = nullptr);
 
 // 提取结构体数组（按类型名），返回每个数组的元素值集合
 QList<ExtractedArray> extractArrays(const QString &text, const QString &sourceFile, const QString &typeName, bool preserveEscapes);
+// 单文件数组提取（并发 map 的工作单元），结果按行号排序
+QList<ExtractedArray> extractArraysFile(const QString &path, const QString &mode, const QMap<QString, QString> &defines, const QString &typeName, bool preserveEscapes,
+                                       const Preprocessor::IncludeContext *includes = nullptr, const QByteArray *content = nullptr);
 QList<ExtractedArray> scanDirectoryArrays(const QString &root, const QStringList &extensions, const QString &mode, const QMap<QString, QString> &defines, const QString &typeName, bool preserveEscapes);
 
 // 写数组到独立CSV：首行写 header：source_path,line_number,array_variable,<lang columns>
@@ -119,6 +186,19 @@ bool writeArraysCsv(const QString &outputPath,
  */
 QStringList discoverLanguageColumns(const QString &root, const QStringList &extensions, const QString &typeAlias);
 
+/**
+ * @brief 同 discoverLanguageColumns，但以尚未写回的内容代替磁盘文件（Discover against pending edits）
+ * @param pending 规范化绝对路径（QDir::cleanPath）→ 待写回文本；不在其中的文件读磁盘
+ */
+QStringList discoverLanguageColumns(const QString &root, const QStringList &extensions, const QString &typeAlias,
+                                    const QHash<QString, QString> &pending);
+
+/**
+ * @brief 同 discoverLanguageColumns，并给出布局来源（Same, also reporting where the layout came from）
+ * @param definedIn 输出：命中约定头文件 include/tr_text.h 时为其路径；遍历扫描或回退默认列时为空
+ */
+QStringList discoverLanguageColumnsWithSource(const QString &root, const QStringList &extensions, const QString &typeAlias, QString &definedIn);
+
 // 写CSV（utf-8-sig），支持对非指定语言列进行UTF-8十六进制转义写出
 /**
  * @brief 将提取结果写入 CSV（默认 UTF-8 BOM），支持保留指定语言列原文，其余以 UTF-8 十六进制转义。
@@ -127,15 +207,32 @@ QStringList discoverLanguageColumns(const QString &root, const QStringList &exte
  * @param langColumns 语言列顺序
  * @param literalColumns 需要直写原文的列
  * @param replaceAsciiCommaWithCn 是否将英文逗号替换为中文逗号
+ * @param shardRows 每个分片的最大行数，0 表示不分片（分片文件名为 `<name>_partNN.csv`）
  * @return 是否写入成功
+ * @note 需要边提取边写时直接使用 Csv::StreamWriter（csv_writer.h）。
  */
 bool writeCsv(const QString &outputPath,
               const QList<ExtractedBlock> &rows,
               const QStringList &langColumns,
               const QStringList &literalColumns,
-              bool replaceAsciiCommaWithCn);
+              bool replaceAsciiCommaWithCn,
+              int shardRows = 0);
+
+/**
+ * @brief C 代码生成统计（Generation stats）
+ */
+struct GenerateStats {
+    int rows{0};          // 生成的结构体变量数
+    QStringList columns;  // 实际采用的结构体语言顺序
+    QString layoutOrigin; // 语言顺序来源：schema / cache / scan
+    QString error;        // 非空表示失败，输出文件保持原样
+    QList<StringPool::GroupStats> pool; // 字符串池模式：各语言原始/入池字节
+    qint64 poolBytes{0};  // 字符串池总字节数
+    int poolMerged{0};    // 后缀合并的字符串数
+    qint64 catalogBytes{0}; // 二进制目录字节数（未输出目录时为 0）
+};
 
-// CSV -> C 代码生成，返回代码字符串并可选写入文件及头文件
+// CSV -> C 代码生成，流式写入文件及头文件；未给 C 输出路径时返回代码字符串
 /**
  * @brief 根据 CSV 生成 C 源代码与头文件，支持直写/十六进制转义、注释模式、填充缺失项等。
  * @param csvPath 输入 CSV 路径
@@ -154,9 +251,15 @@ bool writeCsv(const QString &outputPath,
  * @param perLine 每行元素个数（保留参数）
  * @param sourceMap 变量到源位置映射
  * @param sourceRoot 溯源根目录
- * @return 生成的 C 代码字符串
+ * @param poolMode 字符串池模式：空/off 每个初始化各写字面量；dedup 全部译文去重存入一块 UTF-8 池，
+ *        初始化器以“池 + 偏移”引用；suffix 在 dedup 基础上合并互为后缀的字符串
+ * @param catalogPath 二进制译文目录输出路径（可空，格式见 tr_catalog.h）；与 C 表同源，键为生成的变量名
+ * @param schemaPath 结构体布局模式文件；为空时采用 CSV 同目录 tr_text.schema.json，
+ *        不存在则查 .csv_lang_cache 布局缓存，仍未命中才扫描项目（见 StructLayout::resolve）
+ * @param stats 可选输出：行数、语言顺序及来源、错误信息
+ * @return cOutputPath 与 catalogPath 均为空时返回生成的 C 代码；写入文件时逐行流式写出，返回空串（以 stats->error 判断成败）
  *
- * @note 写入时保留原文件编码与 BOM，并保持换行风格（CRLF/LF）。
+ * @note 写入时保留原文件编码与 BOM，并保持换行风格（CRLF/LF）；经 QSaveFile 全部写完后才替换原文件。
  */
 QString generateCFromCsv(const QString &csvPath,
                          const QString &typeName,
@@ -173,7 +276,18 @@ QString generateCFromCsv(const QString &csvPath,
                          const QString &annotateMode,
                          int perLine,
                          const QMap<QString, QPair<QString, QString>> &sourceMap,
-                         const QString &sourceRoot);
+                         const QString &sourceRoot,
+                         const QString &poolMode = QString(),
+                         const QString &catalogPath = QString(),
+                         const QString &schemaPath = QString(),
+                         GenerateStats *stats = nullptr);
+
+// 单文件 DispMessageInfo 提取（并发 map 的工作单元）
+QList<ExtractedBlock> extractDispMessageInfoFile(const QString &path,
+                                                 const QString &mode,
+                                                 const QMap<QString, QString> &defines,
+                                                 const Preprocessor::IncludeContext *includes = nullptr,
+                                                 const QByteArray *content = nullptr);
 
 // 扫描 DispMessageInfo 初始化，提取嵌套的 _Tr_TEXT 字段（_title/_info）
 QList<ExtractedBlock> scanDispMessageInfo(const QString &root,
@@ -0,0 +1,280 @@
+/**
+ * @file tr_catalog.cpp
+ * @brief 二进制译文目录实现（Binary translation catalogue implementation）
+ *
+ * 写出：条目按键字节序排序，键名、语言列名与全部译文一起交给 StringPool 去重并合并后缀，
+ * 再依次写出头部、语言表、键索引、译文偏移表与字符串区，最后回填校验和，经 QSaveFile 一次提交。
+ * 读取：QFile::map 映射后只做边界与校验和检查，查找时不复制数据。
+ */
+#include "tr_catalog.h"
+#include "string_pool.h"
+#include <QSaveFile>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    const char kMagic[4] = {'T', 'R', 'C', 'T'};
+
+    quint32 fnv1a32(const uchar *p, quint32 n)
+    {
+        quint32 h = 2166136261u;
+        for (quint32 i = 0; i < n; ++i)
+        {
+            h ^= p[i];
+            h *= 16777619u;
+        }
+        return h;
+    }
+
+    void putU16(QByteArray &out, quint16 v)
+    {
+        uchar b[2];
+        qToLittleEndian<quint16>(v, b);
+        out.append(reinterpret_cast<const char *>(b), 2);
+    }
+
+    void putU32(QByteArray &out, quint32 v)
+    {
+        uchar b[4];
+        qToLittleEndian<quint32>(v, b);
+        out.append(reinterpret_cast<const char *>(b), 4);
+    }
+}
+
+namespace TrCatalog
+{
+
+    Writer::Writer(const QStringList &languages)
+        : m_languages(languages)
+    {
+    }
+
+    void Writer::add(const QString &key, const QVector<QByteArray> &values)
+    {
+        const QByteArray k = key.toUtf8();
+        if (m_keys.contains(k))
+        {
+            ++m_duplicates;
+            return;
+        }
+        m_keys.insert(k);
+        Row r;
+        r.key = k;
+        r.values = values;
+        r.values.resize(m_languages.size());
+        m_rows.append(r);
+    }
+
+    bool Writer::write(const QString &path, QString &error)
+    {
+        error.clear();
+        m_written = 0;
+        // 键按字节序排序，与固件侧 strcmp 二分一致
+        QVector<int> order(m_rows.size());
+        for (int i = 0; i < order.size(); ++i)
+            order[i] = i;
+        std::sort(order.begin(), order.end(), [this](int a, int b) { return m_rows.at(a).key < m_rows.at(b).key; });
+
+        StringPool::Builder pool(m_languages);
+        for (const QString &lang : m_languages)
+            pool.add(lang.toUtf8(), -1);
+        for (const Row &r : m_rows)
+        {
+            pool.add(r.key, -1);
+            for (int l = 0; l < r.values.size(); ++l)
+                pool.add(r.values.at(l), l);
+        }
+        pool.build(true);
+
+        const quint32 langCount = quint32(m_languages.size());
+        const quint32 entryCount = quint32(m_rows.size());
+        const quint32 langTable = kHeaderSize;
+        const quint32 keyIndex = langTable + langCount * 4;
+        const quint32 valueTable = keyIndex + entryCount * 4;
+        const quint64 blobOffset = quint64(valueTable) + quint64(langCount) * entryCount * 4;
+        if (blobOffset + quint64(pool.size()) > 0xFFFFFFFFull)
+        {
+            error = QStringLiteral("目录超过 4GB，无法以 32 位偏移表示");
+            return false;
+        }
+
+        QByteArray out;
+        out.reserve(int(blobOffset + pool.size()));
+        out.append(kMagic, 4);
+        putU16(out, kVersion);
+        putU16(out, kHeaderSize);
+        putU32(out, 0); // flags
+        putU32(out, langCount);
+        putU32(out, entryCount);
+        putU32(out, langTable);
+        putU32(out, keyIndex);
+        putU32(out, valueTable);
+        putU32(out, quint32(blobOffset));
+        putU32(out, quint32(pool.size()));
+        putU32(out, 0); // checksum，写完后回填
+        for (const QString &lang : m_languages)
+            putU32(out, quint32(pool.offset(lang.toUtf8())));
+        for (int i : order)
+            putU32(out, quint32(pool.offset(m_rows.at(i).key)));
+        for (quint32 l = 0; l < langCount; ++l)
+        {
+            for (int i : order)
+                putU32(out, quint32(pool.offset(m_rows.at(i).values.at(int(l)))));
+        }
+        for (const StringPool::Entry &e : pool.entries())
+        {
+            out.append(e.bytes);
+            out.append('\0');
+        }
+
+        uchar sum[4];
+        qToLittleEndian<quint32>(fnv1a32(reinterpret_cast<const uchar *>(out.constData()) + kHeaderSize, quint32(out.size()) - kHeaderSize), sum);
+        std::memcpy(out.data() + 40, sum, 4);
+
+        QSaveFile f(path);
+        if (!f.open(QIODevice::WriteOnly))
+        {
+            error = QStringLiteral("无法写入目录文件: %1").arg(path);
+            return false;
+        }
+        f.write(out);
+        if (!f.commit())
+        {
+            error = f.errorString();
+            return false;
+        }
+        m_written = out.size();
+        return true;
+    }
+
+    Reader::Reader(const QString &path)
+        : m_file(path)
+    {
+    }
+
+    quint32 Reader::u32(quint32 offset) const
+    {
+        return qFromLittleEndian<quint32>(m_data + offset);
+    }
+
+    const char *Reader::blobString(quint32 offset) const
+    {
+        // 字符串区末字节在 open 时已确认为 NUL，区内任意偏移都能读到结尾
+        if (offset >= m_blobSize)
+            return nullptr;
+        return reinterpret_cast<const char *>(m_data + m_blob + offset);
+    }
+
+    bool Reader::open(QString &error)
+    {
+        error.clear();
+        if (!m_file.open(QIODevice::ReadOnly))
+        {
+            error = QStringLiteral("无法打开目录文件: %1").arg(m_file.fileName());
+            return false;
+        }
+        const qint64 size = m_file.size();
+        if (size < kHeaderSize || size > qint64(0xFFFFFFFFll))
+        {
+            error = QStringLiteral("目录文件大小无效");
+            return false;
+        }
+        m_data = m_file.map(0, size);
+        if (!m_data)
+        {
+            m_owned = m_file.readAll();
+            m_data = reinterpret_cast<const uchar *>(m_owned.constData());
+        }
+        m_size = quint32(size);
+        if (std::memcmp(m_data, kMagic, 4) != 0)
+        {
+            error = QStringLiteral("不是译文目录文件（魔数不符）");
+            return false;
+        }
+        const quint16 version = qFromLittleEndian<quint16>(m_data + 4);
+        const quint16 headerSize = qFromLittleEndian<quint16>(m_data + 6);
+        if (version != kVersion || headerSize < kHeaderSize || headerSize > m_size)
+        {
+            error = QStringLiteral("不支持的目录版本 %1").arg(version);
+            return false;
+        }
+        const quint32 langCount = u32(12);
+        m_entryCount = u32(16);
+        const quint32 langTable = u32(20);
+        m_keyIndex = u32(24);
+        m_valueTable = u32(28);
+        m_blob = u32(32);
+        m_blobSize = u32(36);
+        // 各表须完整落在文件内（64 位计算避免溢出）
+        auto fits = [this](quint32 off, quint64 bytes) { return quint64(off) + bytes <= m_size; };
+        if (!fits(langTable, quint64(langCount) * 4) || !fits(m_keyIndex, quint64(m_entryCount) * 4)
+            || !fits(m_valueTable, quint64(langCount) * m_entryCount * 4) || !fits(m_blob, m_blobSize)
+            || (m_blobSize > 0 && m_data[m_blob + m_blobSize - 1] != 0))
+        {
+            error = QStringLiteral("目录文件已截断或损坏");
+            return false;
+        }
+        if (fnv1a32(m_data + headerSize, m_size - headerSize) != u32(40))
+        {
+            error = QStringLiteral("目录文件校验和不符");
+            return false;
+        }
+        m_languages.clear();
+        for (quint32 l = 0; l < langCount; ++l)
+        {
+            const char *name = blobString(u32(langTable + l * 4));
+            m_languages << (name ? QString::fromUtf8(name) : QString());
+        }
+        return true;
+    }
+
+    int Reader::find(const QByteArray &key) const
+    {
+        int lo = 0;
+        int hi = int(m_entryCount) - 1;
+        while (lo <= hi)
+        {
+            const int mid = lo + (hi - lo) / 2;
+            const char *k = blobString(u32(m_keyIndex + quint32(mid) * 4));
+            if (!k)
+                return -1;
+            const int c = std::strcmp(k, key.constData());
+            if (c == 0)
+                return mid;
+            if (c < 0)
+                lo = mid + 1;
+            else
+                hi = mid - 1;
+        }
+        return -1;
+    }
+
+    QByteArray Reader::key(int entry) const
+    {
+        if (entry < 0 || quint32(entry) >= m_entryCount)
+            return QByteArray();
+        return QByteArray(blobString(u32(m_keyIndex + quint32(entry) * 4)));
+    }
+
+    QByteArray Reader::value(int entry, int lang) const
+    {
+        if (entry < 0 || quint32(entry) >= m_entryCount || lang < 0 || lang >= m_languages.size())
+            return QByteArray();
+        return QByteArray(blobString(u32(m_valueTable + (quint32(lang) * m_entryCount + quint32(entry)) * 4)));
+    }
+
+    QByteArray Reader::lookup(const QByteArray &key, const QString &language, bool *found) const
+    {
+        // 与生成器一致：text_xx 与 xx 均可
+        int lang = m_languages.indexOf(language);
+        if (lang < 0)
+            lang = m_languages.indexOf(language.startsWith(QLatin1String("text_")) ? language.mid(5) : QStringLiteral("text_") + language);
+        const int entry = lang >= 0 ? find(key) : -1;
+        if (found)
+            *found = entry >= 0;
+        return entry >= 0 ? value(entry, lang) : QByteArray();
+    }
+
+}
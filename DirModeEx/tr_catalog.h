@@ -0,0 +1,139 @@
+/**
+ * @file tr_catalog.h
+ * @brief 二进制译文目录接口（Binary translation catalogue APIs）
+ *
+ * 功能名称：可内存映射的译文目录（Versioned, memory-mappable catalogue）
+ * 主要用途：
+ * - 与 generateCFromCsv 同源的数据写成单个二进制文件，设备固件与测试工具可直接 mmap 后按变量名二分查找；
+ * - 只重刷目录文件即可更新译文，无需重新编译生成的 C 文件；
+ * - 字符串区复用 StringPool（去重 + 后缀合并）；
+ *
+ * 文件格式（版本 1，全部整数为小端，偏移均相对文件起始，表按 4 字节对齐）：
+ *   头部 44 字节：
+ *     0  char[4] magic "TRCT"
+ *     4  u16 version          = 1
+ *     6  u16 headerSize       = 44（读取端按此跳过未知扩展字段）
+ *     8  u32 flags            = 0
+ *    12  u32 langCount
+ *    16  u32 entryCount
+ *    20  u32 langTableOffset  → langCount 个 u32：语言列名在字符串区中的偏移
+ *    24  u32 keyIndexOffset   → entryCount 个 u32：变量名在字符串区中的偏移，按字节序（strcmp）升序
+ *    28  u32 valueTableOffset → langCount × entryCount 个 u32：按语言分组，第 l 组第 i 项为第 i 个键在语言 l 的译文偏移
+ *    32  u32 blobOffset
+ *    36  u32 blobSize
+ *    40  u32 checksum         = FNV-1a 32（覆盖 headerSize 之后的全部字节）
+ *   字符串区：以 NUL 结尾的 UTF-8 字符串；
+ *
+ * 查找：在 keyIndex 上二分得到 i，再取 valueTable[l * entryCount + i]。
+ *
+ * 使用示例：
+ *  TrCatalog::Writer w(langs);
+ *  w.add("g_text_ok", values);
+ *  QString err; w.write("texts.trc", err);
+ *
+ *  TrCatalog::Reader r("texts.trc");
+ *  if (r.open(err)) QByteArray en = r.lookup("g_text_ok", "text_en");
+ */
+#ifndef TR_CATALOG_H
+#define TR_CATALOG_H
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QVector>
+#include <QSet>
+#include <QFile>
+
+namespace TrCatalog {
+
+const quint16 kVersion = 1;
+const quint16 kHeaderSize = 44;
+
+/**
+ * @class Writer
+ * @brief 收集条目后一次写出（Collect entries, then write atomically via QSaveFile）
+ */
+class Writer
+{
+public:
+    explicit Writer(const QStringList &languages);
+
+    /**
+     * @brief 添加条目（Add an entry）
+     * @param key 变量名（须唯一，重复时保留首个）
+     * @param values 按语言顺序的 UTF-8 字节；不足的语言视为空串
+     */
+    void add(const QString &key, const QVector<QByteArray> &values);
+
+    /**
+     * @brief 写出目录文件
+     * @return 是否成功；失败时 error 给出原因
+     */
+    bool write(const QString &path, QString &error);
+
+    int entryCount() const { return m_rows.size(); }
+    /** @brief 因键重复被忽略的条目数 */
+    int duplicateCount() const { return m_duplicates; }
+    /** @brief 最近一次 write 的文件字节数 */
+    qint64 writtenBytes() const { return m_written; }
+
+private:
+    struct Row
+    {
+        QByteArray key;
+        QVector<QByteArray> values;
+    };
+    QStringList m_languages;
+    QVector<Row> m_rows;
+    QSet<QByteArray> m_keys;
+    int m_duplicates{0};
+    qint64 m_written{0};
+};
+
+/**
+ * @class Reader
+ * @brief 内存映射读取与二分查找（mmap + binary search）
+ */
+class Reader
+{
+public:
+    explicit Reader(const QString &path);
+
+    /** @brief 映射并校验（魔数、版本、各表边界、校验和） */
+    bool open(QString &error);
+
+    QStringList languages() const { return m_languages; }
+    int entryCount() const { return int(m_entryCount); }
+
+    /** @brief 二分查找键，返回条目下标；未找到返回 -1 */
+    int find(const QByteArray &key) const;
+    /** @brief 第 entry 个键名 */
+    QByteArray key(int entry) const;
+    /** @brief 第 entry 个条目在第 lang 个语言的取值 */
+    QByteArray value(int entry, int lang) const;
+
+    /**
+     * @brief 按键与语言列名查找（Lookup by key and language column）
+     * @param found 可选输出：键与语言是否都存在
+     */
+    QByteArray lookup(const QByteArray &key, const QString &language, bool *found = nullptr) const;
+
+private:
+    quint32 u32(quint32 offset) const;
+    const char *blobString(quint32 offset) const;
+
+    QFile m_file;
+    QByteArray m_owned; // 映射失败时持有数据
+    const uchar *m_data{nullptr};
+    quint32 m_size{0};
+    quint32 m_entryCount{0};
+    quint32 m_keyIndex{0};
+    quint32 m_valueTable{0};
+    quint32 m_blob{0};
+    quint32 m_blobSize{0};
+    QStringList m_languages;
+};
+
+}
+
+#endif // TR_CATALOG_H